@@ -142,7 +142,11 @@ public:
     {
         v4r::SIFTLocalEstimation<PointT> estimator;
         estimator.setInputCloud(cloud_src);
-        estimator.compute(sift_signatures);
+        v4r::LocalDescriptorMatrix signatures;
+        estimator.compute(signatures);
+        sift_signatures.resize( signatures.rows() );
+        for(int i=0; i < signatures.rows(); i++)
+            sift_signatures[i].assign( signatures.row(i).data(), signatures.row(i).data() + signatures.cols() );
         sift_keypoint_indices = estimator.getKeypointIndices();
     }
 
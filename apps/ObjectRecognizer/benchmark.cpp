@@ -0,0 +1,314 @@
+
+#include <boost/format.hpp>
+#include <boost/program_options.hpp>
+#include <glog/logging.h>
+
+#include <v4r/apps/ObjectRecognizer.h>
+
+#include <pcl/point_types.h>
+#include <pcl/io/pcd_io.h>
+#include <pcl/common/time.h>
+#include <v4r/io/filesystem.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <future>
+#include <map>
+#include <mutex>
+#include <thread>
+
+#include <omp.h>
+
+namespace po = boost::program_options;
+
+typedef pcl::PointXYZRGB PT;
+
+/**
+ * @brief The LatencyStatistics class collects computation times of all recognized views (per stage) and
+ * summarizes them as percentiles
+ */
+class LatencyStatistics
+{
+private:
+    std::map<std::string, std::vector<float> > stage_times_; ///< measured times in ms for each stage
+    std::vector<std::string> stage_order_;  ///< stages in the order they were first reported
+    std::mutex mutex_;
+
+    static float
+    percentile(const std::vector<float> &sorted, float p)
+    {
+        if( sorted.empty() )
+            return 0.f;
+
+        // nearest-rank method
+        size_t rank = static_cast<size_t>( std::ceil( p / 100.f * sorted.size() ) );
+        rank = std::min( std::max<size_t>(rank, 1), sorted.size() );
+        return sorted[rank - 1];
+    }
+
+public:
+    void
+    add(const std::vector<std::pair<std::string, float> > &elapsed_times)
+    {
+        std::lock_guard<std::mutex> lock (mutex_);
+        for(const std::pair<std::string, float> &t : elapsed_times)
+        {
+            if( stage_times_.find( t.first ) == stage_times_.end() )
+                stage_order_.push_back( t.first );
+
+            stage_times_[ t.first ].push_back( t.second );
+        }
+    }
+
+    /**
+     * @brief writeJSON writes count, mean, min, max and p50/p95/p99 (in ms) of each stage
+     */
+    void
+    writeJSON(std::ostream &os, const std::string &indent) const
+    {
+        os << "[" << std::endl;
+        for(size_t i=0; i<stage_order_.size(); i++)
+        {
+            std::vector<float> times = stage_times_.at( stage_order_[i] );
+            std::sort( times.begin(), times.end() );
+            double sum = 0.;
+            for(float t : times)
+                sum += t;
+
+            os << indent << "  { \"stage\": \"" << stage_order_[i] << "\""
+               << ", \"count\": " << times.size()
+               << ", \"mean_ms\": " << sum / times.size()
+               << ", \"min_ms\": " << times.front()
+               << ", \"p50_ms\": " << percentile(times, 50.f)
+               << ", \"p95_ms\": " << percentile(times, 95.f)
+               << ", \"p99_ms\": " << percentile(times, 99.f)
+               << ", \"max_ms\": " << times.back() << " }"
+               << (i+1 < stage_order_.size() ? "," : "") << std::endl;
+        }
+        os << indent << "]";
+    }
+};
+
+
+/**
+ * @brief loadCloud loads a test view from disk (run asynchronously to overlap I/O with recognition)
+ */
+pcl::PointCloud<PT>::Ptr
+loadCloud(const std::string &filename, float &elapsed_time_ms)
+{
+    pcl::StopWatch t;
+    pcl::PointCloud<PT>::Ptr cloud(new pcl::PointCloud<PT>());
+    pcl::io::loadPCDFile( filename, *cloud);
+    elapsed_time_ms = t.getTime();
+    return cloud;
+}
+
+
+void
+saveResults(const std::string &out_path_anno,
+            const std::vector<v4r::ObjectHypothesesGroup > &generated_object_hypotheses,
+            const std::vector<std::pair<std::string, float> > &elapsed_time)
+{
+    std::string out_path_generated_hypotheses = out_path_anno;
+    boost::replace_last(out_path_generated_hypotheses, ".anno", ".generated_hyps");
+
+    v4r::io::createDirForFileIfNotExist(out_path_anno);
+
+    // save hypotheses
+    std::ofstream f_generated ( out_path_generated_hypotheses.c_str() );
+    std::ofstream f_verified ( out_path_anno.c_str() );
+    for(size_t ohg_id=0; ohg_id<generated_object_hypotheses.size(); ohg_id++)
+    {
+        for(const v4r::ObjectHypothesis::Ptr &oh : generated_object_hypotheses[ohg_id].ohs_)
+        {
+            f_generated << oh->model_id_ << " (" << oh->confidence_ << "): ";
+            const Eigen::Matrix4f tf = oh->pose_refinement_ * oh->transform_;
+
+            for (size_t row=0; row <4; row++)
+                for(size_t col=0; col<4; col++)
+                    f_generated << tf(row, col) << " ";
+            f_generated << std::endl;
+
+            if( oh->is_verified_ )
+            {
+                f_verified << oh->model_id_ << " (" << oh->confidence_ << "): ";
+                for (size_t row=0; row <4; row++)
+                    for(size_t col=0; col<4; col++)
+                        f_verified << tf(row, col) << " ";
+                f_verified << std::endl;
+            }
+        }
+    }
+    f_generated.close();
+    f_verified.close();
+
+    // save elapsed time(s)
+    std::string out_path_times = out_path_anno;
+    boost::replace_last(out_path_times, ".anno", ".times");
+    std::ofstream f_times ( out_path_times.c_str() );
+    for( const std::pair<std::string,float> &t : elapsed_time)
+        f_times << t.second << " " << t.first << std::endl;
+    f_times.close();
+}
+
+
+int
+main (int argc, char ** argv)
+{
+    std::string test_dir;
+    std::string out_dir = "/tmp/object_recognition_results/";
+    std::string report_file = "/tmp/object_recognition_benchmark.json";
+    std::string recognizer_config = "cfg/multipipeline_config.xml";
+    int verbosity = -1;
+    int num_workers = 1;
+    int prefetch = 1;
+
+    po::options_description desc("Object Recognizer Benchmark\n======================================\n"
+                                 "Recognizes all test views with a pool of workers (one recognizer per worker, sequences are processed concurrently) "
+                                 "and reports latency percentiles of each stage as well as the throughput.\n**Allowed options");
+    desc.add_options()
+            ("help,h", "produce help message")
+            ("test_dir,t", po::value<std::string>(&test_dir)->required(), "Directory with test scenes stored as point clouds (.pcd). The camera pose is taken directly from the pcd header fields \"sensor_orientation_\" and \"sensor_origin_\" (if the test directory contains subdirectories, each subdirectory is considered as seperate sequence for multiview recognition)")
+            ("out_dir,o", po::value<std::string>(&out_dir)->default_value(out_dir), "Output directory where recognition results will be stored (skipped if empty).")
+            ("report", po::value<std::string>(&report_file)->default_value(report_file), "Output file of the benchmark report (JSON)")
+            ("recognizer_config", po::value<std::string>(&recognizer_config)->default_value(recognizer_config), "Config XML of the multi-pipeline recognizer")
+            ("workers,j", po::value<int>(&num_workers)->default_value(num_workers), "number of sequences recognized concurrently (each worker holds its own recognizer instance and model database)")
+            ("prefetch", po::value<int>(&prefetch)->default_value(prefetch), "number of views loaded asynchronously ahead of the view currently recognized by a worker")
+            ("verbosity", po::value<int>(&verbosity)->default_value(verbosity), "set verbosity level for output (<0 minimal output)")
+            ;
+    po::variables_map vm;
+    po::parsed_options parsed = po::command_line_parser(argc, argv).options(desc).allow_unregistered().run();
+    std::vector<std::string> to_pass_further = po::collect_unrecognized(parsed.options, po::include_positional);
+    po::store(parsed, vm);
+    if (vm.count("help")) { std::cout << desc << std::endl; to_pass_further.push_back("-h"); }
+    try { po::notify(vm); }
+    catch(std::exception& e) { std::cerr << "Error: " << e.what() << std::endl << std::endl << desc << std::endl;  }
+
+    if(verbosity>=0)
+    {
+        FLAGS_logtostderr = 1;
+        FLAGS_v = verbosity;
+        std::cout << "Enabling verbose logging." << std::endl;
+    }
+    google::InitGoogleLogging(argv[0]);
+
+    v4r::apps::ObjectRecognizerParameter param;
+    param.load( recognizer_config );
+    to_pass_further = param.init(to_pass_further);
+    param.output();
+
+    std::vector< std::string> sub_folder_names = v4r::io::getFoldersInDirectory( test_dir );
+    if(sub_folder_names.empty()) sub_folder_names.push_back("");
+
+    num_workers = std::max(1, std::min<int>(num_workers, sub_folder_names.size()) );
+    prefetch = std::max(0, prefetch);
+
+    // initialize recognizers one after another (the first one trains the model database if necessary, the others load the trained data)
+    pcl::StopWatch init_watch;
+    std::vector< boost::shared_ptr<v4r::apps::ObjectRecognizer<PT> > > recognizers ( num_workers );
+    for(int w=0; w<num_workers; w++)
+    {
+        recognizers[w].reset( new v4r::apps::ObjectRecognizer<PT> (param) );
+        recognizers[w]->initialize(to_pass_further);
+    }
+    const double init_time_ms = init_watch.getTime();
+
+    // share the cores among the workers (recognition components parallelize internally with OpenMP)
+    const int threads_per_worker = std::max(1, omp_get_max_threads() / num_workers);
+
+    LatencyStatistics stats;
+    std::atomic<size_t> next_sequence (0);
+    std::atomic<size_t> num_recognized_views (0);
+
+    auto worker = [&] (int w)
+    {
+        omp_set_num_threads( threads_per_worker );
+        v4r::apps::ObjectRecognizer<PT> &recognizer = *recognizers[w];
+
+        for( size_t seq_id = next_sequence++; seq_id < sub_folder_names.size(); seq_id = next_sequence++ )
+        {
+            const std::string &sub_folder_name = sub_folder_names[seq_id];
+            recognizer.resetMultiView();
+            std::vector< std::string > views = v4r::io::getFilesInDirectory( test_dir+"/"+sub_folder_name, ".*.pcd", false );
+
+            std::vector<float> load_times ( views.size(), 0.f );
+            std::vector< std::future< pcl::PointCloud<PT>::Ptr > > clouds ( views.size() );
+
+            auto startLoading = [&] (size_t v_id)
+            {
+                bf::path test_path = test_dir;
+                test_path /= sub_folder_name;
+                test_path /= views[v_id];
+                clouds[v_id] = std::async(std::launch::async, loadCloud, test_path.string(), std::ref(load_times[v_id]) );
+            };
+
+            for (size_t v_id=0; v_id<views.size(); v_id++)
+            {
+                LOG(INFO) << "Recognizing file " << sub_folder_name << "/" << views[v_id];
+
+                // keep the next views loading while this one is recognized
+                for(size_t next_v_id = v_id; next_v_id<views.size() && next_v_id<=v_id+prefetch; next_v_id++)
+                {
+                    if( !clouds[next_v_id].valid() )
+                        startLoading( next_v_id );
+                }
+
+                pcl::StopWatch wait_watch;
+                pcl::PointCloud<PT>::Ptr cloud = clouds[v_id].get();
+                const float wait_time = wait_watch.getTime();
+
+                pcl::StopWatch rec_watch;
+                std::vector<v4r::ObjectHypothesesGroup > generated_object_hypotheses = recognizer.recognize(cloud);
+                const float rec_time = rec_watch.getTime();
+
+                std::vector<std::pair<std::string, float> > elapsed_time = recognizer.getElapsedTimes();
+
+                if ( !out_dir.empty() )  // write results to disk (for each verified hypothesis add a row in the text file with object name, dummy confidence value and object pose in row-major order)
+                {
+                    std::string out_basename = views[v_id];
+                    boost::replace_last(out_basename, ".pcd", ".anno");
+                    bf::path out_path = out_dir;
+                    out_path /= sub_folder_name;
+                    out_path /= out_basename;
+                    saveResults(out_path.string(), generated_object_hypotheses, elapsed_time);
+                }
+
+                elapsed_time.push_back( std::pair<std::string,float>("Loading view (I/O)", load_times[v_id]) );
+                elapsed_time.push_back( std::pair<std::string,float>("Waiting for view", wait_time) );
+                elapsed_time.push_back( std::pair<std::string,float>("Total recognition", rec_time) );
+                stats.add( elapsed_time );
+                num_recognized_views++;
+            }
+        }
+    };
+
+    pcl::StopWatch run_watch;
+    std::vector<std::thread> threads;
+    for(int w=0; w<num_workers; w++)
+        threads.push_back( std::thread(worker, w) );
+    for(std::thread &t : threads)
+        t.join();
+    const double run_time_ms = run_watch.getTime();
+
+    const double throughput = run_time_ms > 0. ? num_recognized_views * 1000. / run_time_ms : 0.;
+
+    v4r::io::createDirForFileIfNotExist( report_file );
+    std::ofstream f_report ( report_file.c_str() );
+    f_report << "{" << std::endl;
+    f_report << "  \"test_dir\": \"" << test_dir << "\"," << std::endl;
+    f_report << "  \"sequences\": " << sub_folder_names.size() << "," << std::endl;
+    f_report << "  \"views\": " << num_recognized_views << "," << std::endl;
+    f_report << "  \"workers\": " << num_workers << "," << std::endl;
+    f_report << "  \"threads_per_worker\": " << threads_per_worker << "," << std::endl;
+    f_report << "  \"initialization_ms\": " << init_time_ms << "," << std::endl;
+    f_report << "  \"wall_time_ms\": " << run_time_ms << "," << std::endl;
+    f_report << "  \"throughput_views_per_s\": " << throughput << "," << std::endl;
+    f_report << "  \"stages\": ";
+    stats.writeJSON(f_report, "  ");
+    f_report << std::endl << "}" << std::endl;
+    f_report.close();
+
+    std::cout << "Recognized " << num_recognized_views << " views in " << run_time_ms / 1000. << " s ("
+              << throughput << " views/s) with " << num_workers << " worker(s). Report written to " << report_file << std::endl;
+}
@@ -25,6 +25,8 @@
 #include <v4r/common/normals.h>
 #include <v4r/segmentation/all_headers.h>
 
+#include <boost/dynamic_bitset.hpp>
+
 #pragma once
 
 namespace v4r
@@ -125,6 +127,7 @@ private:
     pcl::PointCloud<pcl::Normal>::ConstPtr normals_;
     std::vector< Eigen::Vector4f, Eigen::aligned_allocator<Eigen::Vector4f> > planes_;
     std::vector<std::vector<int> > plane_inliers_;
+    std::vector<int> plane_labels_; ///< plane id of each point of the last segmented cloud (-1... no plane inlier)
     typename pcl::PointCloud<PointT>::Ptr processed_cloud_;
     Eigen::Vector4f selected_plane_;
 
@@ -150,6 +153,17 @@ public:
     void
     segment(const typename pcl::PointCloud<PointT>::ConstPtr &cloud);
 
+    /**
+     * @brief removePlanes applies the distance and plane filters of the last segment() call to the points selected by mask
+     * (e.g. to the changed regions of a new frame taken from the same viewpoint). Filtered points are set to NaN to keep the cloud organized.
+     * Other than in segment(), the selected plane is treated as infinite (to also remove support surface uncovered since the last segmented cloud),
+     * whereas all other planes only remove points at pixels which have been inliers of the same plane in the last segmented cloud.
+     * @param cloud (organized) point cloud
+     * @param mask points to filter
+     */
+    void
+    removePlanes(pcl::PointCloud<PointT> &cloud, const boost::dynamic_bitset<> &mask) const;
+
     /**
      * @brief getClusters
      * @param cluster_indices
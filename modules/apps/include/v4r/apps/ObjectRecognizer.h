@@ -21,10 +21,13 @@
  *
  ******************************************************************************/
 
+#include <boost/dynamic_bitset.hpp>
 #include <boost/serialization/vector.hpp>
 #include <v4r/apps/CloudSegmenter.h>
 #include <v4r/apps/ObjectRecognizerParameter.h>
 #include <v4r/apps/visualization.h>
+#include <v4r/change_detection/object_history.h>
+#include <v4r/change_detection/voxel_occupancy_map.h>
 #include <v4r/common/normals.h>
 #include <v4r/core/macros.h>
 #include <v4r/io/filesystem.h>
@@ -79,12 +82,70 @@ private:
 
     /**
      * @brief detectChanges detect changes in multi-view sequence (e.g. objects removed or added to the scene within observation period)
+     * by comparing the current view with the occupancy map of the previous views. The view is integrated into the map afterwards.
      * @param v current view
      */
     void
     detectChanges(View &v);
 
     typename pcl::PointCloud<PointT>::Ptr registered_scene_cloud_;  ///< registered point cloud of all processed input clouds in common camera reference frame
+    typename VoxelOccupancyMap<PointT>::Ptr occupancy_map_; ///< persistent occupancy map of all views of the sequence (global reference frame), reference for change detection
+    typename ObjectsHistory<PointT>::Ptr objects_history_;   ///< verified objects of the sequence, marked removed once the occupancy map shows their space free
+
+    // TEMPORAL STUFF (static camera)
+    class Frame
+    {
+    public:
+        EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+
+        typename pcl::PointCloud<PointT>::ConstPtr cloud_;
+        typename pcl::PointCloud<PointT>::Ptr processed_cloud_;
+        pcl::PointCloud<pcl::Normal>::Ptr cloud_normals_;
+        Eigen::Vector4f support_plane_;
+        Eigen::Matrix4f camera_pose_;
+        std::vector<ObjectHypothesesGroup> hypotheses_;
+    };
+    boost::shared_ptr<Frame> last_frame_; ///< last processed frame (only kept if temporal reuse is enabled)
+
+    /**
+     * @brief detectChangedPixels compares an organized input cloud with the last processed frame (depth and color).
+     * Pixels with depth in only one of the two frames count as changed, pixels without depth in both are unchanged.
+     * @param cloud organized input cloud (same size as the last frame)
+     * @return mask of changed pixels (grown by temporal_change_dilation_px_)
+     */
+    boost::dynamic_bitset<>
+    detectChangedPixels(const pcl::PointCloud<PointT> &cloud) const;
+
+    /**
+     * @brief computeNormalsInChangedRegion recomputes the normals only within the bounding box of the changed pixels
+     * and takes the normals of the last frame for all other pixels
+     * @param cloud organized input cloud
+     * @param changed mask of changed pixels
+     * @return normals
+     */
+    pcl::PointCloud<pcl::Normal>::Ptr
+    computeNormalsInChangedRegion(const typename pcl::PointCloud<PointT>::ConstPtr &cloud, const boost::dynamic_bitset<> &changed);
+
+    /**
+     * @brief dilateMask grows a pixel mask by a box of temporal_change_dilation_px_
+     * @param mask pixel mask of an organized cloud (non-zero entries are set)
+     * @param width width of the organized cloud
+     * @param height height of the organized cloud
+     * @return dilated mask
+     */
+    boost::dynamic_bitset<>
+    dilateMask(const std::vector<unsigned char> &mask, int width, int height) const;
+
+    /**
+     * @brief getImageFootprint projects the model of an object hypothesis into the image
+     * @param oh object hypothesis
+     * @param width width of the organized cloud
+     * @param height height of the organized cloud
+     * @param footprint pixel indices the model points project onto
+     * @return false if the model of the hypothesis is not in the model database
+     */
+    bool
+    getImageFootprint(const ObjectHypothesis &oh, size_t width, size_t height, std::vector<int> &footprint) const;
 
     std::vector<std::pair<std::string, float> > elapsed_time_; ///< measurements of computation times for various components
 
@@ -164,6 +225,15 @@ public:
      */
     void
     resetMultiView();
+
+    /**
+     * @brief resetTemporal forgets the last processed frame, i.e. the next frame will be processed completely
+     */
+    void
+    resetTemporal()
+    {
+        last_frame_.reset();
+    }
 };
 
 }
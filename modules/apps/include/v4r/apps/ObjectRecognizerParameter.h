@@ -97,6 +97,13 @@ public:
     size_t min_points_for_hyp_removal_; ///< how many removed points must overlap hypothesis to be also considered removed
     size_t max_views_; ///< maximum number of views used for multi-view recognition (if more views are available, information from oldest views will be ignored)
 
+    // temporal parameters (static camera)
+    bool use_temporal_reuse_; ///< if true and the camera did not move, only regions that changed with respect to the last processed frame are processed again (single-view only)
+    float temporal_depth_change_threshold_; ///< relative depth difference (w.r.t. the depth of the pixel) for a pixel to be considered changed
+    int temporal_color_change_threshold_; ///< difference in any color channel for a pixel to be considered changed
+    float temporal_max_changed_ratio_; ///< if more than this ratio of pixels changed, the whole frame is processed again
+    int temporal_change_dilation_px_; ///< changed regions are grown by this many pixels (should cover the support of normals and keypoint descriptors)
+
     size_t icp_iterations_; ///< ICP iterations. Only used if hypotheses are not verified. Otherwise ICP is done inside HV
     size_t sift_knn_; ///< only used if greater 0. Otherwise value from xml file will be used
     size_t shot_knn_; ///< only used if greater 0. Otherwise value from xml file will be used
@@ -133,6 +140,11 @@ public:
           tolerance_for_cloud_diff_ (0.02f),
           min_points_for_hyp_removal_ (50),
           max_views_ (3),
+          use_temporal_reuse_ (false),
+          temporal_depth_change_threshold_ (0.02f),
+          temporal_color_change_threshold_ (30),
+          temporal_max_changed_ratio_ (0.3f),
+          temporal_change_dilation_px_ (15),
           icp_iterations_(0),
           sift_knn_ (0),
           shot_knn_ (0)
@@ -232,6 +244,11 @@ public:
                 ("or_use_multiview_with_kp_correspondence_transfer", po::value<bool>(&use_multiview_with_kp_correspondence_transfer_)->default_value(use_multiview_with_kp_correspondence_transfer_), "")
                 ("or_use_change_detection", po::value<bool>(&use_change_detection_)->default_value(use_change_detection_), "")
                 ("or_multivew_max_views", po::value<size_t>(&max_views_)->default_value(max_views_), "maximum number of views used for multi-view recognition (if more views are available, information from oldest views will be ignored)")
+                ("or_use_temporal_reuse", po::value<bool>(&use_temporal_reuse_)->default_value(use_temporal_reuse_), "if true and the camera did not move, only regions that changed with respect to the last processed frame are processed again (single-view only)")
+                ("or_temporal_depth_change_threshold", po::value<float>(&temporal_depth_change_threshold_)->default_value(temporal_depth_change_threshold_), "relative depth difference for a pixel to be considered changed")
+                ("or_temporal_color_change_threshold", po::value<int>(&temporal_color_change_threshold_)->default_value(temporal_color_change_threshold_), "difference in any color channel for a pixel to be considered changed")
+                ("or_temporal_max_changed_ratio", po::value<float>(&temporal_max_changed_ratio_)->default_value(temporal_max_changed_ratio_), "if more than this ratio of pixels changed, the whole frame is processed again")
+                ("or_temporal_change_dilation_px", po::value<int>(&temporal_change_dilation_px_)->default_value(temporal_change_dilation_px_), "changed regions are grown by this many pixels")
                 ("or_remove_non_upright_objects", po::value<bool>(&remove_non_upright_objects_)->default_value(remove_non_upright_objects_), "remove all hypotheses that are not standing upright on a support plane (support plane extraction must be enabled)")
                 ("or_icp_iterations", po::value<size_t>(&icp_iterations_)->default_value(icp_iterations_), "ICP iterations. Only used if hypotheses are not verified. Otherwise ICP is done inside HV")
                 ("or_sift_knn", po::value<size_t>(&sift_knn_)->default_value(sift_knn_), "knn for SIFT. only used if greater 0. Otherwise value from xml file will be used")
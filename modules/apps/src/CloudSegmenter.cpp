@@ -60,11 +60,44 @@ CloudSegmenter<PointT>::initialize(std::vector<std::string> &command_line_argume
     }
 }
 
+template<typename PointT>
+void
+CloudSegmenter<PointT>::removePlanes(pcl::PointCloud<PointT> &cloud, const boost::dynamic_bitset<> &mask) const
+{
+    const bool has_planes = !param_.skip_plane_extraction_ && !planes_.empty();
+
+    for(size_t i=0; i<cloud.points.size(); i++)
+    {
+        PointT &p = cloud.points[i];
+        if( !mask[i] || !pcl::isFinite(p) )
+            continue;
+
+        const Eigen::Vector3f xyz = p.getVector3fMap();
+        bool remove = p.z > param_.chop_z_;
+
+        if( !remove && has_planes )
+        {
+            if( param_.remove_planes_ || param_.remove_selected_plane_ )
+                remove = v4r::is_inlier(xyz, selected_plane_, param_.plane_inlier_threshold_);
+
+            if( !remove && param_.remove_planes_ && i < plane_labels_.size() && plane_labels_[i] >= 0 )
+                remove = v4r::is_inlier(xyz, planes_[ plane_labels_[i] ], param_.plane_inlier_threshold_);
+
+            if( param_.remove_points_below_selected_plane_ && !v4r::is_above_plane(xyz, selected_plane_, param_.min_distance_to_plane_) )
+                remove = true;
+        }
+
+        if( remove )
+            p.x = p.y = p.z = std::numeric_limits<float>::quiet_NaN();
+    }
+}
+
 template<typename PointT>
 void
 CloudSegmenter<PointT>::segment(const typename pcl::PointCloud<PointT>::ConstPtr &cloud)
 {
     processed_cloud_.reset (new pcl::PointCloud<PointT>(*cloud));
+    plane_labels_.clear();
 
     if( !normals_ &&
             ( (segmenter_ && segmenter_->getRequiresNormals()) ||
@@ -157,6 +190,13 @@ CloudSegmenter<PointT>::segment(const typename pcl::PointCloud<PointT>::ConstPtr
 
             selected_plane_ = planes_[selected_plane_id];
 
+            plane_labels_.assign( processed_cloud_->points.size(), -1 );
+            for(size_t plane_id=0; plane_id<plane_inliers_.size(); plane_id++)
+            {
+                for( int idx : plane_inliers_[plane_id] )
+                    plane_labels_[idx] = plane_id;
+            }
+
             // now filter
             {
                 if( param_.remove_planes_ || param_.remove_selected_plane_)
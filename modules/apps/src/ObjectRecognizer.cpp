@@ -1,6 +1,7 @@
 #include <v4r/apps/ObjectRecognizer.h>
 
 #include <iostream>
+#include <limits>
 #include <sstream>
 
 #include <boost/format.hpp>
@@ -331,14 +332,19 @@ ObjectRecognizer<PointT>::detectChanges(View &v)
     vg.filter (*cloud_filtered);
     new_observation_aligned = cloud_filtered;
 
-    if( registered_scene_cloud_ && !registered_scene_cloud_->points.empty() )
+    if( !occupancy_map_ )
+        occupancy_map_.reset( new v4r::VoxelOccupancyMap<PointT> );
+
+    if( occupancy_map_->size() )
     {
         v4r::ChangeDetector<PointT> detector;
-        detector.detect(registered_scene_cloud_, new_observation_aligned, Eigen::Affine3f(v.camera_pose_), param_.tolerance_for_cloud_diff_);
-//        v4r::ChangeDetector<PointT>::removePointsFrom(registered_scene_cloud_, detector.getRemoved());
+        detector.detect(*occupancy_map_, new_observation_aligned, Eigen::Affine3f(v.camera_pose_), param_.tolerance_for_cloud_diff_);
         *v.removed_points_ += *(detector.getRemoved());
 //        *changing_scene += *(detector.getAdded());
     }
+
+    const Eigen::Vector3f sensor_origin = v.camera_pose_.block<3,1>(0,3);
+    occupancy_map_->integrate(*new_observation_aligned, sensor_origin);
 }
 
 template<typename PointT>
@@ -357,12 +363,88 @@ ObjectRecognizer<PointT>::recognize(const typename pcl::PointCloud<PointT>::Cons
 
     elapsed_time_.clear();
 
+    // ==== CHECK FOR CHANGES W.R.T. LAST FRAME (STATIC CAMERA) =====
+    bool reuse_last_frame = false;
+    boost::dynamic_bitset<> changed_pixels;
+    if( param_.use_temporal_reuse_ && !param_.use_multiview_ && last_frame_ && cloud->isOrganized() &&
+            cloud->width == last_frame_->cloud_->width && cloud->height == last_frame_->cloud_->height &&
+            camera_pose.isApprox( last_frame_->camera_pose_ ) )
+    {
+        pcl::StopWatch t; const std::string time_desc ("Detecting changes w.r.t. last frame");
+        changed_pixels = detectChangedPixels( *cloud );
+        const size_t num_changed = changed_pixels.count();
+        float time = t.getTime();
+        VLOG(1) << time_desc << " took " << time << " ms.";
+        elapsed_time_.push_back( std::pair<std::string,float>(time_desc, time) );
+
+        if( num_changed == 0 )
+        {
+            LOG(INFO) << "Scene did not change. Taking object hypotheses of last frame.";
+            return last_frame_->hypotheses_;
+        }
+
+        reuse_last_frame = num_changed < param_.temporal_max_changed_ratio_ * cloud->points.size();
+        LOG(INFO) << num_changed << " pixels changed w.r.t. last frame. " << (reuse_last_frame ? "Only processing changed regions." : "Processing whole frame.");
+    }
+
+    // hypotheses of the last frame which are not affected by any change are kept, objects of all other hypotheses are searched again
+    std::vector<ObjectHypothesesGroup> kept_object_hypotheses;
+    boost::dynamic_bitset<> recognition_mask;
+    if( reuse_last_frame )
+    {
+        std::vector<unsigned char> dropped_footprints (cloud->points.size(), 0);
+        for(const ObjectHypothesesGroup &ohg : last_frame_->hypotheses_)
+        {
+            std::vector<std::vector<int> > footprints (ohg.ohs_.size());
+            bool is_affected = false;
+            for(size_t oh_id=0; oh_id<ohg.ohs_.size(); oh_id++)
+            {
+                if( !getImageFootprint( *ohg.ohs_[oh_id], cloud->width, cloud->height, footprints[oh_id] ) )
+                    is_affected = true;
+
+                for(size_t i=0; i<footprints[oh_id].size() && !is_affected; i++)
+                    is_affected = changed_pixels[ footprints[oh_id][i] ];
+            }
+
+            if( is_affected )
+            {
+                for(const std::vector<int> &footprint : footprints)
+                {
+                    for(int idx : footprint)
+                        dropped_footprints[idx] = 1;
+                }
+                continue;
+            }
+
+            // copy the hypotheses, the ones of the last frame might still be used by the caller
+            ObjectHypothesesGroup ohg_copy;
+            ohg_copy.global_hypotheses_ = ohg.global_hypotheses_;
+            for( const typename ObjectHypothesis::Ptr &oh : ohg.ohs_ )
+            {
+                typename ObjectHypothesis::Ptr oh_copy ( new ObjectHypothesis (*oh) );
+                oh_copy->confidence_ = oh->confidence_;
+                if( !skip_verification_ )   // verified again together with the new hypotheses
+                    oh_copy->is_verified_ = false;
+                ohg_copy.ohs_.push_back( oh_copy );
+            }
+            kept_object_hypotheses.push_back( ohg_copy );
+        }
+        LOG(INFO) << "Kept " << kept_object_hypotheses.size() << " of " << last_frame_->hypotheses_.size() << " object hypotheses groups from last frame.";
+
+        recognition_mask = changed_pixels | dilateMask( dropped_footprints, cloud->width, cloud->height );
+    }
+
     pcl::PointCloud<pcl::Normal>::Ptr normals;
     if( mrec_->needNormals() || hv_ )
     {
         pcl::StopWatch t; const std::string time_desc ("Computing normals");
-        normal_estimator_->setInputCloud( processed_cloud );
-        normals = normal_estimator_->compute();
+        if( reuse_last_frame && last_frame_->cloud_normals_ )
+            normals = computeNormalsInChangedRegion( processed_cloud, changed_pixels );
+        else
+        {
+            normal_estimator_->setInputCloud( processed_cloud );
+            normals = normal_estimator_->compute();
+        }
         mrec_->setSceneNormals( normals );
         float time = t.getTime();
         VLOG(1) << time_desc << " took " << time << " ms.";
@@ -374,10 +456,23 @@ ObjectRecognizer<PointT>::recognize(const typename pcl::PointCloud<PointT>::Cons
     {
         pcl::StopWatch t; const std::string time_desc ("Removing planes");
 
-        cloud_segmenter_->setNormals( normals );
-        cloud_segmenter_->segment( processed_cloud );
-        processed_cloud = cloud_segmenter_->getProcessedCloud();
-        support_plane = cloud_segmenter_->getSelectedPlane();
+        if( reuse_last_frame )  // planes stay the same for a static camera, only filter changed pixels
+        {
+            support_plane = last_frame_->support_plane_;
+            for(size_t i=0; i<processed_cloud->points.size(); i++)
+            {
+                if( !changed_pixels[i] )
+                    processed_cloud->points[i] = last_frame_->processed_cloud_->points[i];
+            }
+            cloud_segmenter_->removePlanes( *processed_cloud, changed_pixels );
+        }
+        else
+        {
+            cloud_segmenter_->setNormals( normals );
+            cloud_segmenter_->segment( processed_cloud );
+            processed_cloud = cloud_segmenter_->getProcessedCloud();
+            support_plane = cloud_segmenter_->getSelectedPlane();
+        }
         mrec_->setTablePlane( support_plane );
 
         float time = t.getTime();
@@ -395,7 +490,21 @@ ObjectRecognizer<PointT>::recognize(const typename pcl::PointCloud<PointT>::Cons
     {
         pcl::StopWatch t; const std::string time_desc ("Generation of object hypotheses");
 
-        mrec_->setInputCloud ( processed_cloud );
+        typename pcl::PointCloud<PointT>::Ptr recognition_cloud = processed_cloud;
+        if( reuse_last_frame )  // only look for objects in changed regions and where hypotheses have been dropped
+        {
+            recognition_cloud.reset( new pcl::PointCloud<PointT>(*processed_cloud) );
+            for(size_t i=0; i<recognition_cloud->points.size(); i++)
+            {
+                if( !recognition_mask[i] )
+                {
+                    PointT &p = recognition_cloud->points[i];
+                    p.x = p.y = p.z = std::numeric_limits<float>::quiet_NaN();
+                }
+            }
+        }
+
+        mrec_->setInputCloud ( recognition_cloud );
         mrec_->recognize();
         generated_object_hypotheses = mrec_->getObjectHypothesis();
 
@@ -453,6 +562,8 @@ ObjectRecognizer<PointT>::recognize(const typename pcl::PointCloud<PointT>::Cons
 
     }
 
+    generated_object_hypotheses.insert( generated_object_hypotheses.end(), kept_object_hypotheses.begin(), kept_object_hypotheses.end() );
+
     if(!skip_verification_)
     {
         hv_->setHypotheses( generated_object_hypotheses );
@@ -487,7 +598,7 @@ ObjectRecognizer<PointT>::recognize(const typename pcl::PointCloud<PointT>::Cons
             int num_views = std::min<int>(param_.max_views_, views_.size() + 1);
             LOG(INFO) << "Running multi-view recognition over " << num_views;
 
-            if ( param_.use_change_detection_ && !views_.empty())
+            if ( param_.use_change_detection_ )
             {
                 pcl::StopWatch t; const std::string time_desc ("Change detection");
                 detectChanges(v);
@@ -688,6 +799,54 @@ ObjectRecognizer<PointT>::recognize(const typename pcl::PointCloud<PointT>::Cons
         }
     }
 
+    if( param_.use_multiview_ && param_.use_change_detection_ && occupancy_map_ )
+    {
+        pcl::StopWatch t; const std::string time_desc ("Updating object history");
+
+        if( !objects_history_ )
+            objects_history_.reset( new v4r::ObjectsHistory<PointT> );
+
+        // objects verified in earlier views whose space the current view shows free
+        const std::vector<v4r::ObjectIdLabeled> removed_objects = objects_history_->markRemovedObjects( *occupancy_map_ );
+        for(const v4r::ObjectIdLabeled &o : removed_objects)
+            LOG(INFO) << "Object " << o.label << " (id " << o.id << ") has been removed from the scene.";
+
+        std::vector< v4r::ObjectDetection<PointT> > detections;
+        for(size_t ohg_id=0; ohg_id<generated_object_hypotheses.size(); ohg_id++)
+        {
+            for( const typename ObjectHypothesis::Ptr &oh : generated_object_hypotheses[ohg_id].ohs_)
+            {
+                if( !oh->is_verified_ )
+                    continue;
+
+                bool found_model;
+                typename Model<PointT>::ConstPtr m = model_database_->getModelById("", oh->model_id_, found_model);
+                if( !found_model )
+                    continue;
+
+                const Eigen::Matrix4f tf_global = camera_pose * oh->pose_refinement_ * oh->transform_;
+                detections.push_back( v4r::ObjectDetection<PointT>(oh->model_id_, (int)oh->unique_id_, m->getAssembled( 10 ), Eigen::Affine3f(tf_global)) );
+            }
+        }
+        objects_history_->add( detections );
+        v4r::ObjectsHistory<PointT>::incrementTime();
+
+        float time = t.getTime();
+        VLOG(1) << time_desc << " took " << time << " ms.";
+        elapsed_time_.push_back( std::pair<std::string,float>(time_desc, time) );
+    }
+
+    if( param_.use_temporal_reuse_ && !param_.use_multiview_ )
+    {
+        last_frame_.reset( new Frame );
+        last_frame_->cloud_ = cloud;
+        last_frame_->processed_cloud_ = processed_cloud;
+        last_frame_->cloud_normals_ = normals;
+        last_frame_->support_plane_ = support_plane;
+        last_frame_->camera_pose_ = camera_pose;
+        last_frame_->hypotheses_ = generated_object_hypotheses;
+    }
+
     if ( visualize_ )
     {
         const std::map<std::string, typename LocalObjectModel::ConstPtr> lomdb = local_recognition_pipeline_->getLocalObjectModelDatabase();
@@ -715,6 +874,163 @@ ObjectRecognizer<PointT>::recognize(const typename pcl::PointCloud<PointT>::Cons
     return generated_object_hypotheses;
 }
 
+template<typename PointT>
+boost::dynamic_bitset<>
+ObjectRecognizer<PointT>::detectChangedPixels(const pcl::PointCloud<PointT> &cloud) const
+{
+    const pcl::PointCloud<PointT> &last = *last_frame_->cloud_;
+    const int width = cloud.width, height = cloud.height;
+
+    std::vector<unsigned char> changed (cloud.points.size(), 0);
+#pragma omp parallel for schedule(dynamic)
+    for(int v=0; v<height; v++)
+    {
+        for(int u=0; u<width; u++)
+        {
+            const PointT &p = cloud.at(u,v);
+            const PointT &q = last.at(u,v);
+
+            const bool p_valid = pcl::isFinite(p), q_valid = pcl::isFinite(q);
+            if( !p_valid || !q_valid )  // depth appeared or vanished
+            {
+                changed[v*width + u] = p_valid != q_valid;
+                continue;
+            }
+
+            changed[v*width + u] =
+                    std::abs( p.z - q.z ) > param_.temporal_depth_change_threshold_ * q.z ||
+                    std::abs( (int)p.r - (int)q.r ) > param_.temporal_color_change_threshold_ ||
+                    std::abs( (int)p.g - (int)q.g ) > param_.temporal_color_change_threshold_ ||
+                    std::abs( (int)p.b - (int)q.b ) > param_.temporal_color_change_threshold_;
+        }
+    }
+
+    return dilateMask( changed, width, height );
+}
+
+template<typename PointT>
+boost::dynamic_bitset<>
+ObjectRecognizer<PointT>::dilateMask(const std::vector<unsigned char> &mask, int width, int height) const
+{
+    // separable box dilation
+    const int r = std::max(0, param_.temporal_change_dilation_px_);
+    std::vector<unsigned char> dilated_rows (mask.size(), 0);
+#pragma omp parallel for schedule(dynamic)
+    for(int v=0; v<height; v++)
+    {
+        int last_set = -r - 1;  // last set column left of (or at) u + r
+        for(int u=-r; u<width; u++)
+        {
+            if( u + r < width && mask[v*width + u + r] )
+                last_set = u + r;
+            if( u >= 0 && last_set >= u - r )
+                dilated_rows[v*width + u] = 1;
+        }
+    }
+
+    boost::dynamic_bitset<> dilated (mask.size(), 0);
+    for(int u=0; u<width; u++)
+    {
+        int last_set = -r - 1;
+        for(int v=-r; v<height; v++)
+        {
+            if( v + r < height && dilated_rows[(v + r)*width + u] )
+                last_set = v + r;
+            if( v >= 0 && last_set >= v - r )
+                dilated.set(v*width + u);
+        }
+    }
+
+    return dilated;
+}
+
+template<typename PointT>
+pcl::PointCloud<pcl::Normal>::Ptr
+ObjectRecognizer<PointT>::computeNormalsInChangedRegion(const typename pcl::PointCloud<PointT>::ConstPtr &cloud, const boost::dynamic_bitset<> &changed)
+{
+    pcl::PointCloud<pcl::Normal>::Ptr normals (new pcl::PointCloud<pcl::Normal>(*last_frame_->cloud_normals_));
+    const int width = cloud->width, height = cloud->height;
+
+    int min_u = width, max_u = -1, min_v = height, max_v = -1;
+    for(int v=0; v<height; v++)
+    {
+        for(int u=0; u<width; u++)
+        {
+            if( changed[v*width + u] )
+            {
+                min_u = std::min(min_u, u);
+                max_u = std::max(max_u, u);
+                min_v = std::min(min_v, v);
+                max_v = std::max(max_v, v);
+            }
+        }
+    }
+
+    if( max_u < 0 )
+        return normals;
+
+    // crop the organized cloud to the bounding box of the changed pixels (the box is already grown by the dilation)
+    typename pcl::PointCloud<PointT>::Ptr roi (new pcl::PointCloud<PointT>);
+    roi->width = max_u - min_u + 1;
+    roi->height = max_v - min_v + 1;
+    roi->is_dense = false;
+    roi->points.resize( roi->width * roi->height );
+    for(int v=min_v; v<=max_v; v++)
+    {
+        for(int u=min_u; u<=max_u; u++)
+            roi->at(u - min_u, v - min_v) = cloud->at(u,v);
+    }
+
+    normal_estimator_->setInputCloud( roi );
+    pcl::PointCloud<pcl::Normal>::Ptr roi_normals = normal_estimator_->compute();
+
+    for(int v=min_v; v<=max_v; v++)
+    {
+        for(int u=min_u; u<=max_u; u++)
+        {
+            if( changed[v*width + u] )
+                normals->at(u,v) = roi_normals->at(u - min_u, v - min_v);
+        }
+    }
+
+    return normals;
+}
+
+template<typename PointT>
+bool
+ObjectRecognizer<PointT>::getImageFootprint(const ObjectHypothesis &oh, size_t width, size_t height, std::vector<int> &footprint) const
+{
+    footprint.clear();
+
+    bool found_model;
+    typename Model<PointT>::ConstPtr m = model_database_->getModelById("", oh.model_id_, found_model);
+    if( !found_model )
+        return false;
+
+    typename pcl::PointCloud<PointT>::ConstPtr model_cloud = m->getAssembled ( 5 );
+    const Eigen::Matrix4f tf = oh.pose_refinement_ * oh.transform_;
+    const Eigen::Matrix3f rotation = tf.block<3,3>(0,0);
+    const Eigen::Vector3f translation = tf.block<3,1>(0,3);
+
+    const float f = camera_->getFocalLength();
+    const float cx = camera_->getCx();
+    const float cy = camera_->getCy();
+
+    footprint.reserve( model_cloud->points.size() );
+    for(const PointT &p : model_cloud->points)
+    {
+        const Eigen::Vector3f q = rotation * p.getVector3fMap() + translation;
+        if( q(2) <= 0.f )
+            continue;
+
+        const int u = static_cast<int>( f * q(0) / q(2) + cx + 0.5f );
+        const int v = static_cast<int>( f * q(1) / q(2) + cy + 0.5f );
+        if( u >= 0 && v >= 0 && u < (int)width && v < (int)height )
+            footprint.push_back( v*width + u );
+    }
+    return true;
+}
+
 template <typename PointT>
 void
 ObjectRecognizer<PointT>::resetMultiView()
@@ -722,6 +1038,8 @@ ObjectRecognizer<PointT>::resetMultiView()
     if(param_.use_multiview_)
     {
         views_.clear();
+        occupancy_map_.reset();
+        objects_history_.reset();
 
         typename v4r::MultiviewRecognizer<PointT>::Ptr mv_rec =
                 boost::dynamic_pointer_cast<  v4r::MultiviewRecognizer<PointT> > (mrec_);
@@ -9,8 +9,10 @@
 #include <pcl/io/pcd_io.h>
 
 #include <boost/algorithm/string.hpp>
+#include <boost/dynamic_bitset.hpp>
 #include <boost/program_options.hpp>
-#include <algorithm>    // std::next_permutation, std::sort
+#include <algorithm>    // std::sort
+#include <functional>
 #include <glog/logging.h>
 
 namespace po = boost::program_options;
@@ -144,24 +146,101 @@ RecognitionEvaluator::checkMatchvector(const std::vector< std::pair<int, int> >
     }
 }
 
-std::vector<std::vector<int> >
-PermGenerator(int n, int k)
+namespace
 {
-    std::vector<std::vector<int> > possible_permutations;
 
-    std::vector<int> d(n);
-    std::iota(d.begin(),d.end(),0);
-    do
+/**
+ * @brief fscore computes the f-score from true positives, false positives and false negatives
+ */
+float
+fscore(size_t tp, size_t fp, size_t fn)
+{
+    float recall = 1.f;
+    if (tp+fn) // if there are some ground-truth objects
+        recall = (float)tp / (tp + fn);
+
+    float precision = 1.f;
+    if(tp+fp)   // if there are some recognized objects
+        precision = (float)tp / (tp + fp);
+
+    float f = 0.f;
+    if ( precision+recall>std::numeric_limits<float>::epsilon() )
+        f = 2.f * precision * recall / (precision + recall);
+
+    return f;
+}
+
+/**
+ * @brief solveAssignment solves the linear assignment problem (Hungarian method with potentials, O(rows^2 * cols))
+ * @param cost cost matrix with rows <= cols
+ * @return column assigned to each row such that the sum of costs is minimal
+ */
+std::vector<int>
+solveAssignment(const Eigen::MatrixXd &cost)
+{
+    const int rows = cost.rows();
+    const int cols = cost.cols();
+    std::vector<double> u (rows+1, 0.), v (cols+1, 0.);
+    std::vector<int> p (cols+1, 0), way (cols+1, 0);
+
+    for(int i=1; i<=rows; i++)
     {
-        std::vector<int> p (k);
-        for (int i = 0; i < k; i++)
-            p[i] = d[i];
+        p[0] = i;
+        int j0 = 0;
+        std::vector<double> minv (cols+1, std::numeric_limits<double>::max());
+        std::vector<bool> used (cols+1, false);
+        do
+        {
+            used[j0] = true;
+            int i0 = p[j0], j1 = 0;
+            double delta = std::numeric_limits<double>::max();
+            for(int j=1; j<=cols; j++)
+            {
+                if( used[j] )
+                    continue;
+
+                double cur = cost(i0-1, j-1) - u[i0] - v[j];
+                if( cur < minv[j] )
+                {
+                    minv[j] = cur;
+                    way[j] = j0;
+                }
+                if( minv[j] < delta )
+                {
+                    delta = minv[j];
+                    j1 = j;
+                }
+            }
+            for(int j=0; j<=cols; j++)
+            {
+                if( used[j] )
+                {
+                    u[ p[j] ] += delta;
+                    v[j] -= delta;
+                }
+                else
+                    minv[j] -= delta;
+            }
+            j0 = j1;
+        } while( p[j0] != 0 );
 
-        possible_permutations.push_back(p);
-        std::reverse(d.begin()+k,d.end());
-    } while (next_permutation(d.begin(),d.end()));
+        do
+        {
+            int j1 = way[j0];
+            p[j0] = p[j1];
+            j0 = j1;
+        } while( j0 );
+    }
+
+    std::vector<int> assignment (rows, -1);
+    for(int j=1; j<=cols; j++)
+    {
+        if( p[j] )
+            assignment[ p[j]-1 ] = j-1;
+    }
+    return assignment;
+}
 
-    return possible_permutations;
 }
 
 std::vector< std::pair<int, int> >
@@ -174,151 +253,155 @@ RecognitionEvaluator::selectBestMatch (const std::vector<Hypothesis> &rec_hyps,
                                        bool is_rotation_invariant,
                                        bool is_rotational_symmetric)
 {
-    float best_fscore = -1;
-    tp=0, fp=0, fn=0;
-
-    std::vector< std::pair<int, int> > best_match;
-
-    size_t k = std::min(rec_hyps.size(), gt_hyps.size());
-    size_t n = std::max(rec_hyps.size(), gt_hyps.size());
-
-    std::vector<std::vector<int> > perms = PermGenerator( n, k );
-
-    for(const std::vector<int> &perm : perms)
+    // every hypothesis of the smaller set is matched to a hypothesis of the larger set
+    const size_t k = std::min(rec_hyps.size(), gt_hyps.size());
+    const size_t n = std::max(rec_hyps.size(), gt_hyps.size());
+    const bool rec_is_smaller = rec_hyps.size() < n;
+
+    // counts that do not depend on the match (unmatched recognized objects are false positives,
+    // non-occluded ground-truth objects are false negatives unless correctly matched)
+    int base_fp = 0, base_fn = 0;
+    if( rec_is_smaller )
     {
-        std::vector< std::pair<int, int> > rec2gt_matches ( k );
-
+        for(const Hypothesis &gt_hyp : gt_hyps)
+        {
+            if( gt_hyp.occlusion < occlusion_threshold )
+                base_fn++;
+        }
+    }
+    else
+        base_fp = n - k;
 
-        size_t tp_tmp=0, fp_tmp=0, fn_tmp=0;
+    // error and outcome of each possible match (rows: smaller set, cols: larger set)
+    Eigen::MatrixXf trans_err (k, n), rot_err (k, n);
+    Eigen::MatrixXi tp_m = Eigen::MatrixXi::Zero(k, n);
+    Eigen::MatrixXi fp_m = Eigen::MatrixXi::Zero(k, n);
+    Eigen::MatrixXi fn_m = Eigen::MatrixXi::Zero(k, n);
 
-        if( rec_hyps.size() < n)
+    for(size_t i=0; i<k; i++)
+    {
+        for(size_t j=0; j<n; j++)
         {
-            boost::dynamic_bitset<> taken_gts(n,0);
+            const Hypothesis &rec_hyp = rec_hyps [ rec_is_smaller ? i : j ];
+            const Hypothesis &gt_hyp = gt_hyps [ rec_is_smaller ? j : i ];
+            const bool gt_is_visible = gt_hyp.occlusion < occlusion_threshold;
 
-            for( size_t i=0; i< k; i++)
+            if( computeError( rec_hyp.pose, gt_hyp.pose, model_centroid, trans_err(i,j), rot_err(i,j), is_rotation_invariant, is_rotational_symmetric) )
             {
-                std::pair<int, int> &p = rec2gt_matches[i];
-                p.first = i;
-                p.second = perm[i];
-                taken_gts.set(perm[i]);
+                if( gt_is_visible )
+                {
+                    fn_m(i,j)++;
+                    fp_m(i,j)++;
+                }
+                else if( trans_err(i,j) > translation_error_threshold_m )   //ignore rotation erros for occluded objects
+                    fp_m(i,j)++;
             }
+            else
+                tp_m(i,j)++;
 
-            for(size_t i=0; i<n; i++)
-            {
-                if(!taken_gts[i] && gt_hyps [i].occlusion < occlusion_threshold)
-                    fn_tmp++;
-            }
+            if( rec_is_smaller && gt_is_visible )   // this ground-truth object is matched and therefore not counted in base_fn
+                fn_m(i,j)--;
         }
-        else
+    }
+
+    std::vector<int> best_perm;
+
+    // number of possible matches n!/(n-k)!
+    const size_t max_enumerated_matches = 40320;
+    size_t num_matches = 1;
+    for(size_t i=0; i<k && num_matches <= max_enumerated_matches; i++)
+        num_matches *= n - i;
+
+    if( num_matches <= max_enumerated_matches )
+    {
+        // check all possible matches (in lexicographic order, first match with best f-score wins)
+        float best_fscore = -1.f;
+        std::vector<int> perm (k);
+        boost::dynamic_bitset<> taken (n, 0);
+
+        std::function<void(size_t, int, int, int)> search = [&] (size_t i, int tp_tmp, int fp_tmp, int fn_tmp)
         {
-            boost::dynamic_bitset<> taken_recs(n,0);
-            for( size_t i=0; i< k; i++)
+            if( i == k )
             {
-                std::pair<int, int> &p = rec2gt_matches[i];
-                p.first = perm[i];
-                p.second = i;
-                taken_recs.set(perm[i]);
+                float f = fscore(tp_tmp, fp_tmp, fn_tmp);
+                if( f > best_fscore )
+                {
+                    best_fscore = f;
+                    best_perm = perm;
+                }
+                return;
             }
-            for(size_t i=0; i<n; i++)
+
+            for(size_t j=0; j<n; j++)
             {
-                if(!taken_recs[i])
-                    fp_tmp++;
-            }
-        }
+                if( taken[j] )
+                    continue;
 
-        std::vector<float> translation_errors_tmp(k);
-        std::vector<float> rotational_errors_tmp(k);
-        for( size_t i=0; i< k; i++)
+                taken.set(j);
+                perm[i] = j;
+                search( i+1, tp_tmp + tp_m(i,j), fp_tmp + fp_m(i,j), fn_tmp + fn_m(i,j) );
+                taken.reset(j);
+            }
+        };
+        search( 0, 0, base_fp, base_fn );
+    }
+    else
+    {
+        // fscore() rates tp = fp = fn = 0 with 1, which the ratio below cannot express. Such a match minimizes
+        // 2tp + fp + fn (the sum is never negative), so look for it first and use it if it exists.
+        const Eigen::MatrixXi denominator_m = 2 * tp_m + fp_m + fn_m;
+        const std::vector<int> empty_perm = solveAssignment( denominator_m.cast<double>() );
+        int min_denominator = base_fp + base_fn;
+        for(size_t i=0; i<k; i++)
+            min_denominator += denominator_m(i, empty_perm[i]);
+
+        if( !min_denominator )
+            best_perm = empty_perm;
+
+        // otherwise maximize f-score = 2tp / (2tp + fp + fn) by Dinkelbach's method, i.e. repeatedly solve the
+        // assignment problem maximizing 2tp - lambda (2tp + fp + fn) with lambda being the best f-score so far
+        double lambda = 0.;
+        for(size_t it=0; it<100 && min_denominator; it++)
         {
-            const std::pair<int,int> &x = rec2gt_matches[i];
-            VLOG(1) <<x.first<<"/"<<x.second<< " " << std::endl;
-
-          const Hypothesis &rec_hyp = rec_hyps [ x.first ] ;
-          const Hypothesis &gt_hyp = gt_hyps [ x.second ] ;
-
-          if( computeError( rec_hyp.pose, gt_hyp.pose, model_centroid, translation_errors_tmp[i], rotational_errors_tmp[i], is_rotation_invariant, is_rotational_symmetric))
-          {
-
-              if( gt_hyp.occlusion < occlusion_threshold)
-              {
-                  fn_tmp++;
-                  fp_tmp++;
-                  VLOG(1) << "Adding false negative and false positive";
-              }
-              else
-              {
-                  if(translation_errors_tmp[i] > translation_error_threshold_m )    //ignore rotation erros for occluded objects
-                  {
-                      fp_tmp++;
-                      VLOG(1) << "Adding false positve but ignoring false negative due to occlusion";
-                  }
-                  else
-                      VLOG(1) << "Ignoring due to occlusion";
-              }
-          }
-          else
-          {
-              VLOG(1) << "Adding true positve";
-              tp_tmp++;
-          }
+            Eigen::MatrixXd cost = ( lambda * denominator_m.cast<double>() - 2. * tp_m.cast<double>() );
+            const std::vector<int> perm = solveAssignment( cost );
 
-        }
-
-
-        float recall = 1.f;
-        if (tp_tmp+fn_tmp) // if there are some ground-truth objects
-            recall = (float)tp_tmp / (tp_tmp + fn_tmp);
+            int tp_tmp = 0, fp_tmp = base_fp, fn_tmp = base_fn;
+            for(size_t i=0; i<k; i++)
+            {
+                tp_tmp += tp_m(i, perm[i]);
+                fp_tmp += fp_m(i, perm[i]);
+                fn_tmp += fn_m(i, perm[i]);
+            }
 
-        float precision = 1.f;
-        if(tp_tmp+fp_tmp)   // if there are some recognized objects
-            precision = (float)tp_tmp / (tp_tmp + fp_tmp);
+            const double ratio = 2. * tp_tmp / ( 2 * tp_tmp + fp_tmp + fn_tmp );
 
-        float fscore = 0.f;
-        if ( precision+recall>std::numeric_limits<float>::epsilon() )
-            fscore = 2.f * precision * recall / (precision + recall);
+            if( !best_perm.empty() && ratio <= lambda + 1e-9 )
+                break;
 
-        if ( (fscore > best_fscore) ) // || (fscore==best_fscore && translation_errors_tmp/tp_tmp < translation_errors/tp))
-        {
-            best_fscore = fscore;
-            translation_errors = translation_errors_tmp;
-            rotational_errors = rotational_errors_tmp;
-            tp = tp_tmp;
-            fp = fp_tmp;
-            fn = fn_tmp;
-            best_match = rec2gt_matches;
+            best_perm = perm;
+            lambda = ratio;
         }
+    }
 
+    std::vector< std::pair<int, int> > best_match (k);
+    translation_errors.resize(k);
+    rotational_errors.resize(k);
+    int tp_tmp = 0, fp_tmp = base_fp, fn_tmp = base_fn;
 
-//        std::vector<float> translation_errors_tmp;
-//        std::vector<float> rotational_errors_tmp;
-//        size_t tp_tmp, fp_tmp, fn_tmp;
-//        checkMatchvector(rec2gt_matches, rec_hyps, gt_hyps, model_centroid, translation_errors_tmp, rotational_errors_tmp,
-//                         tp_tmp, fp_tmp, fn_tmp, is_rotation_invariant, is_rotational_symmetric);
-
-//        float recall = 1.f;
-//        if (tp_tmp+fn_tmp) // if there are some ground-truth objects
-//            recall = (float)tp_tmp / (tp_tmp + fn_tmp);
-
-//        float precision = 1.f;
-//        if(tp_tmp+fp_tmp)   // if there are some recognized objects
-//            precision = (float)tp_tmp / (tp_tmp + fp_tmp);
-
-//        float fscore = 0.f;
-//        if ( precision+recall>std::numeric_limits<float>::epsilon() )
-//            fscore = 2.f * precision * recall / (precision + recall);
-
-//        if ( (fscore > best_fscore) ) // || (fscore==best_fscore && translation_errors_tmp/tp_tmp < translation_errors/tp))
-//        {
-//            best_fscore = fscore;
-//            translation_errors = translation_errors_tmp;
-//            rotational_errors = rotational_errors_tmp;
-//            tp = tp_tmp;
-//            fp = fp_tmp;
-//            fn = fn_tmp;
-//            best_match = rec2gt_matches;
-//        }
+    for(size_t i=0; i<k; i++)
+    {
+        const int j = best_perm[i];
+        best_match[i] = rec_is_smaller ? std::pair<int, int>(i, j) : std::pair<int, int>(j, i);
+        translation_errors[i] = trans_err(i, j);
+        rotational_errors[i] = rot_err(i, j);
+        tp_tmp += tp_m(i, j);
+        fp_tmp += fp_m(i, j);
+        fn_tmp += fn_m(i, j);
     }
-
+    tp = tp_tmp;
+    fp = fp_tmp;
+    fn = fn_tmp;
 
     VLOG(1) << "BEST MATCH: ";
     for(auto &x:best_match)
@@ -465,8 +548,20 @@ RecognitionEvaluator::compute_recognition_rate (size_t &total_tp, size_t &total_
     total_fp = 0;
     total_fn = 0;
 
-    for( const std::string anno_file : annotation_files )
+    // result line of each annotation file (empty if not evaluated)
+    std::vector<std::string> result_lines ( annotation_files.size() );
+    std::vector<size_t> tp_views ( annotation_files.size(), 0 );
+    std::vector<size_t> fp_views ( annotation_files.size(), 0 );
+    std::vector<size_t> fn_views ( annotation_files.size(), 0 );
+
+    // annotation files are evaluated independently, only visualization needs to be sequential
+    const bool evaluate_in_parallel = !visualize_ && !save_images_to_disk_;
+
+#pragma omp parallel for schedule(dynamic) if(evaluate_in_parallel)
+    for( size_t anno_id=0; anno_id<annotation_files.size(); anno_id++ )
     {
+        const std::string &anno_file = annotation_files[anno_id];
+
         bf::path gt_path = gt_dir;
         gt_path /= anno_file;
 
@@ -702,12 +797,15 @@ RecognitionEvaluator::compute_recognition_rate (size_t &total_tp, size_t &total_
             }
         }
 
-        std::cout << anno_file << ": " << tp_view << " " << fp_view << " " << fn_view << " " << sum_translation_error_view << " " << sum_rotational_error_view << " " << time_view <<std::endl;
-        of << anno_file << " " << tp_view << " " << fp_view << " " << fn_view << " " << sum_translation_error_view << " " << sum_rotational_error_view << " " << time_view << std::endl;
+        std::stringstream result_line;
+        result_line << tp_view << " " << fp_view << " " << fn_view << " " << sum_translation_error_view << " " << sum_rotational_error_view << " " << time_view;
+        result_lines[anno_id] = result_line.str();
+        tp_views[anno_id] = tp_view;
+        fp_views[anno_id] = fp_view;
+        fn_views[anno_id] = fn_view;
 
-        total_tp += tp_view;
-        total_fp += fp_view;
-        total_fn += fn_view;
+#pragma omp critical (compute_recognition_rate_output)
+        std::cout << anno_file << ": " << result_lines[anno_id] << std::endl;
 
         if(visualize_)
         {
@@ -746,6 +844,19 @@ RecognitionEvaluator::compute_recognition_rate (size_t &total_tp, size_t &total_
             vis_->spin();
         }
     }
+
+    // write results in the order of the annotation files
+    for( size_t anno_id=0; anno_id<annotation_files.size(); anno_id++ )
+    {
+        if( result_lines[anno_id].empty() )
+            continue;
+
+        of << annotation_files[anno_id] << " " << result_lines[anno_id] << std::endl;
+
+        total_tp += tp_views[anno_id];
+        total_fp += fp_views[anno_id];
+        total_fn += fn_views[anno_id];
+    }
     of.close();
 }
 
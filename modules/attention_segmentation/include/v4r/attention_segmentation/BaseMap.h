@@ -32,12 +32,14 @@
 #include "v4r/attention_segmentation/pyramidSimple.h"
 #include "v4r/attention_segmentation/pyramidItti.h"
 #include "v4r/attention_segmentation/pyramidFrintrop.h"
+#include "v4r/attention_segmentation/pyramidCache.h"
 
 namespace v4r
 {
 
 enum PyramidType
 {
+  NO_PYRAMID      = -1,
   SIMPLE_PYRAMID  = 0,
   ITTI_PYRAMID    = 1,
   FRINTROP_PYRAMID,
@@ -86,6 +88,14 @@ public:
   void setMapName(std::string mapName_);
   std::string getMapName();
   
+  /** share channels and pyramids with other maps of the same frame **/
+  void setPyramidCache(PyramidCache::Ptr pyramidCache_);
+  PyramidCache::Ptr getPyramidCache();
+  
+  /** print [INFO] messages **/
+  void setVerbose(bool verbose_);
+  bool getVerbose();
+  
   virtual int calculate() = 0;
   virtual int calculatePyramid(int pyramidType = SIMPLE_PYRAMID);
   
@@ -113,6 +123,9 @@ protected:
   bool                                     calculated;//
   cv::Mat                                  map;//
   bool                                     refine;
+  PyramidCache::Ptr                        pyramidCache;
+  std::string                              frameKey;
+  bool                                     verbose;
   //BasePyramid::Ptr                         pyramid;
 
   std::string mapName;
@@ -132,6 +145,14 @@ protected:
   virtual int combinePyramid(BasePyramid::Ptr pyramid);
   
   virtual void refineMap();
+  
+  void printInfo(const char *format, ...) const;
+  /** the shared cache (with the frame of image registered), or a private one if no cache was set **/
+  PyramidCache::Ptr getFrameCache();
+  /** name of a channel of image in the cache returned by the last getFrameCache() **/
+  std::string cacheKey(const std::string &name) const;
+  /** pass cache and verbosity of the map on to a pyramid **/
+  void initPyramidCache(BasePyramid::Ptr pyramid, PyramidCache::Ptr cache, const std::string &channel = "");
 
 };
 
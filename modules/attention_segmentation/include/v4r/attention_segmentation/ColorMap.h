@@ -60,6 +60,7 @@ private:
   float getMaxColorDistance(float &r_color, float &g_color, float &b_color, float &a_color);
   void LabColorMap(cv::Mat &image_cur, int image_width, int image_height, float max_dist, float a_color, float b_color, cv::Mat &map_cur);
   void RGBColorMap(cv::Mat &image_cur, int image_width, int image_height, float max_dist, float r_color, float g_color, float b_color, cv::Mat &map_cur);
+  void createColorImage(PyramidCache::Ptr cache, bool blurred, cv::Mat &image_cur);
 
 protected:  
   virtual int checkParameters();
@@ -49,11 +49,11 @@ private:
   cv::Mat R, G, B, Y, I;
   int     numberOfOrientations;
   
-  void initializePyramid(FrintropPyramid::Ptr pyramid, cv::Mat &IM, bool onSwitch_);//
-  void initializePyramid(SimplePyramid::Ptr pyramid, cv::Mat &IM);//
-  void createColorChannels();//
+  void initializePyramid(FrintropPyramid::Ptr pyramid, cv::Mat &IM, PyramidCache::Ptr cache, const std::string &channel, bool onSwitch_);//
+  void initializePyramid(SimplePyramid::Ptr pyramid, cv::Mat &IM, PyramidCache::Ptr cache, const std::string &channel);//
+  void createColorChannels(PyramidCache::Ptr cache);//
   int createFeatureMapsI(FrintropPyramid::Ptr pyramid);//
-  int createFeatureMapsO(SimplePyramid::Ptr pyramid, float angle);//
+  int createFeatureMapsO(SimplePyramid::Ptr pyramid, PyramidCache::Ptr cache, float angle);//
   
 protected:  
   virtual int checkParameters();//
@@ -80,6 +80,15 @@ private:
   int M_min, M_max;                // minimum and maximum scale factor
   int filtersNumber;               // size of gabor filters (orientations * number scales)
 //   CvGabor gabor;
+
+  int kernelRadius;                // radius of the largest gabor kernel
+  cv::Size spectraSize;            // dft size the kernel spectra are computed for
+  std::vector<cv::Mat> kernelSpectra;   // spectra of the complex gabor kernels (real + i*imag)
+  std::vector<cv::Mat> rowSums;         // row-wise prefix sums of the filter responses (CV_32S, height x width+1)
+  std::vector<cv::Mat> rowSqSums;       // row-wise prefix sums of the squared filter responses
+
+  /** Compute the spectra of all gabor kernels for the given dft size (only if the size changed) **/
+  void computeKernelSpectra(cv::Size dftSize);
   
 public:
   
@@ -113,6 +122,7 @@ public:
   
   std::vector<cv::Mat> gaborFilters;         // Gabor filter image saved as IplImage 
   
+  /** Filter the input image with the whole filter bank (once per image, shared by all patches) **/
   void computeGaborFilters();
   
 };
@@ -32,6 +32,7 @@
 #ifndef GC_GRAPHCUT_H
 #define GC_GRAPHCUT_H
 
+#include <map>
 #include <set>
 #include <vector>
 #include <stdio.h>
@@ -70,6 +71,7 @@ private:
   bool initialized;                                 ///< flag to process
   bool processed;                                   ///< flag to get results
   unsigned num_edges;                               ///< Number of edges
+  unsigned num_nodes;                               ///< Number of nodes (selected surfaces)
   std::vector<int> surfaces_reindex2;
 
   bool have_surfaces;
@@ -78,8 +80,8 @@ private:
   bool have_relations;
   std::vector<v4r::Relation> relations;
   
-  gc::Edge *edges;                                  ///< Edges between the nodes, representing a probability
-  universe *u;                                      ///< universe to cut graph
+  std::vector<gc::Edge> edges;                      ///< Edges between the nodes, representing a probability
+  boost::shared_ptr<universe> u;                    ///< universe to cut graph
   
   std::string ClassName;
   
@@ -90,8 +92,9 @@ private:
   /** Initialize the graph cut algorithm with number of nodes and with all available relations **/
   bool init();
 
-  /** Process graph cut **/
+  /** Process graph cut (single pass over the sorted edges with union-find) **/
   void process();
+  /** Process graph cut, merged patches combine their relations to common neighbours **/
   void process2();
   
   /** Print the results of the graph cut **/
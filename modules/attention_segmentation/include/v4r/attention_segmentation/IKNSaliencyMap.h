@@ -55,10 +55,10 @@ private:
   int     weightOfOrientations;
   int     numberOfOrientations;
   
-  void initializePyramid(IttiPyramid::Ptr pyramid, cv::Mat &IM, bool changeSign_ = false);
-  void createColorChannels();
+  void initializePyramid(IttiPyramid::Ptr pyramid, cv::Mat &IM, PyramidCache::Ptr cache, const std::string &channel, bool changeSign_ = false);
+  void createColorChannels(PyramidCache::Ptr cache);
   int createFeatureMapsI(IttiPyramid::Ptr pyramid);
-  int createFeatureMapsO(IttiPyramid::Ptr pyramidO, float angle);
+  int createFeatureMapsO(IttiPyramid::Ptr pyramidO, PyramidCache::Ptr cache, float angle);
   int createFeatureMapsRG(IttiPyramid::Ptr pyramidR, IttiPyramid::Ptr pyramidG);
   
 protected:  
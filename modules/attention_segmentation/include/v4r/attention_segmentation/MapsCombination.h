@@ -26,6 +26,7 @@
 #define MAPS_COMBINATION_HPP
 
 #include "v4r/attention_segmentation/headers.h"
+#include "v4r/attention_segmentation/BaseMap.h"
 
 namespace v4r
 {
@@ -41,6 +42,10 @@ enum CombinationTypes
 // assume that maps are normalized to (0,1) range
 int CombineMaps(std::vector<cv::Mat> &maps, cv::Mat &combinedMap, int combination_type = AM_SUM, 
                 int normalization_type = v4r::NT_NONE);
+
+// calculates independent (distinct) maps concurrently, all maps share the pyramid cache of the frame
+int CalculateMaps(std::vector<BaseMap*> &maps, PyramidCache::Ptr cache = PyramidCache::Ptr(new PyramidCache()),
+                  int pyramidType = NO_PYRAMID);
   
 } //namespace v4r
 
@@ -59,6 +59,7 @@ private:
   float bandwidth;
   
   void orientationMap(cv::Mat &image_cur, int image_width, int image_height, float angle, float max_sum, float bandwidth, cv::Mat &map_cur);
+  void createGrayImage(PyramidCache::Ptr cache, cv::Mat &image_gray);
   
 protected:  
   virtual int checkParameters();//
@@ -41,6 +41,12 @@
 #include <stdio.h>
 #include <float.h>
 #include <ostream>
+#include <map>
+
+#include <boost/shared_ptr.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/lock_guard.hpp>
+#include <Eigen/Dense>
 
 #include "v4r/attention_segmentation/svm.h"
 #include "v4r/attention_segmentation//SurfaceModel.h"
@@ -57,30 +63,62 @@ class SVMPredictorSingle
  
 public:
   
+  /**
+   * @brief Loaded libsvm model together with a dense copy of the support vectors.
+   * Models are immutable once loaded and shared between all predictors using the same file.
+   */
+  struct Model
+  {
+    boost::shared_ptr<svm_model> model;         ///< libsvm model
+    Eigen::MatrixXd SV;                         ///< dense support vectors (one row per SV)
+    Eigen::VectorXd SV_sq_norm;                 ///< squared norm of each support vector (RBF)
+    std::vector<int> start;                     ///< index of the first SV of each class
+    bool probability;                           ///< model supports probability estimates
+    
+    typedef boost::shared_ptr<const Model> ConstPtr;
+  };
+  
+  /**
+   * @brief Scaling parameters as written by svm-scale.
+   */
+  struct Scaling
+  {
+    double lower, upper;                        ///< lower/upper limits
+    std::vector<double> feature_max;            ///< maximum feature value for scaling
+    std::vector<double> feature_min;            ///< minimum feature value for scaling
+    std::vector<bool> feature_scaled;
+    
+    typedef boost::shared_ptr<const Scaling> ConstPtr;
+  };
+  
 private:
   
   std::string model_filename;
+  std::string scaling_filename;
   
   bool have_model_filename;
   bool have_model_node;
   bool have_relations;
   bool have_type;
   
-  struct svm_model *model;                      ///< SVM model
+  Model::ConstPtr model;                        ///< SVM model (shared)
   
   bool predict_probability;                     ///< Predict with probability values
   std::vector<v4r::Relation> relations;
   int type;
-  int max_nr_attr;                              ///< Maximum attributes = maximum size of feature vector
-  struct svm_node *node;                        ///< node of svm
   bool scale;                                   ///< set scaling on/off
-  double lower, upper;                          ///< lower/upper limits
-  std::vector<double> feature_max;              ///< maximum feature value for scaling
-  std::vector<double> feature_min;              ///< minimum feature value for scaling
-  std::vector<bool> feature_scaled;
+  Scaling::ConstPtr scaling;                    ///< scaling parameters (shared)
   
   void checkSmallPatches(unsigned int max_size);
-  void scaleValues(std::vector<double> &val);
+  void scaleValues(std::vector<double> &val) const;
+  void predictBatch(const std::vector<int> &indices);
+  
+  static Model::ConstPtr loadModel(const std::string &filename);
+  static Scaling::ConstPtr loadScaling(const std::string &filename);
+  
+  static boost::mutex cache_mutex;
+  static std::map<std::string, Model::ConstPtr> model_cache;
+  static std::map<std::string, Scaling::ConstPtr> scaling_cache;
   
   bool have_surfaces;
   std::vector<v4r::SurfaceModel::Ptr> surfaces;              ///< Surfaces
@@ -90,6 +128,7 @@ public:
   ~SVMPredictorSingle();
   
   void setPredictProbability(bool _predict_probability) { predict_probability = _predict_probability; };
+  /** Set model file; each file is parsed only once and then shared between all predictors **/
   void setModelFilename(std::string _model_filename);
   void setRelations(std::vector<v4r::Relation> _relations);
   /** Set surfaces **/
@@ -97,7 +136,7 @@ public:
   void setType(int _type);
   /** Classification of all feature vectors of a view of a specific type (1=neighboring / 2=non-neighboring **/
   void compute();
-  /** Set scaling of result vector **/
+  /** Set scaling of result vector; each file is parsed only once and then shared between all predictors **/
   void setScaling(bool _scale, std::string filename);
   
   /** Get modified relations **/
@@ -105,6 +144,9 @@ public:
   
   double predict(std::vector<double> &val, std::vector<double> &prob);
   
+  /** Drop all cached models and scaling parameters (e.g. after retraining) **/
+  static void clearCache();
+  
 };
 
 inline std::vector<v4r::Relation> SVMPredictorSingle::getRelations()
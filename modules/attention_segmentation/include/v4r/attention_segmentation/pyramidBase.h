@@ -27,6 +27,7 @@
 
 #include <v4r/core/macros.h>
 #include "v4r/attention_segmentation/headers.h"
+#include "v4r/attention_segmentation/pyramidCache.h"
 
 namespace v4r
 {
@@ -76,6 +77,13 @@ public:
   bool getNormals(pcl::PointCloud<pcl::Normal>::Ptr &normals_);
   bool getNormals(unsigned int level, pcl::PointCloud<pcl::Normal>::Ptr &normals_);
 
+  /** take image (channel name) and depth pyramids from a shared per-frame cache **/
+  void setCache(PyramidCache::Ptr cache_, const std::string &cacheChannel_ = "");
+  
+  /** print [INFO] messages **/
+  void setVerbose(bool verbose_);
+  bool getVerbose();
+
   void setMaxMapValue(float max_map_value_);
   float getMaxMapValue();
 
@@ -137,6 +145,12 @@ protected:
 
   std::string pyramidName;
 
+  PyramidCache::Ptr    cache;
+  std::string          cacheChannel;
+  bool                 verbose;
+
+  void printInfo(const char *format, ...) const;
+
   virtual void calculate();
   virtual void checkLevels();
   virtual void combineConspicuityMaps(cv::Mat &sm_map, cv::Mat &consp_map);
@@ -0,0 +1,130 @@
+/**
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see http://www.gnu.org/licenses/
+ */
+
+
+#ifndef PYRAMID_CACHE_HPP
+#define PYRAMID_CACHE_HPP
+
+#include <map>
+#include <string>
+
+#include <boost/shared_ptr.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/lock_guard.hpp>
+
+#include <v4r/core/macros.h>
+#include "v4r/attention_segmentation/headers.h"
+
+namespace v4r
+{
+
+/**
+ * Per-frame cache of the data shared by the saliency maps: feature channels (intensity, colour
+ * opponents, ...), their gaussian pyramids, Gabor orientation responses and depth pyramids.
+ * Every entry is computed once on first request and then handed out as shallow copy, i.e.
+ * consumers must not modify returned images in place.
+ * Channel names have to contain the key of the frame they are computed from (getFrameKey()), so
+ * maps working on different images can share one cache. Depth pyramids are identified by
+ * cloud/normals/indices, which are kept alive by the cache.
+ * All methods are thread safe, so maps sharing one cache can be calculated concurrently.
+ * Call clear() whenever the input (image, cloud) changes.
+ */
+class V4R_EXPORTS PyramidCache
+{
+public:
+
+  /** pyramids built by BasePyramid::buildDepthPyramid() **/
+  class DepthPyramid
+  {
+  public:
+    std::vector<cv::Mat> pyramidImages;
+    std::vector<cv::Mat> pyramidX;
+    std::vector<cv::Mat> pyramidY;
+    std::vector<cv::Mat> pyramidZ;
+    std::vector<cv::Mat> pyramidNx;
+    std::vector<cv::Mat> pyramidNy;
+    std::vector<cv::Mat> pyramidNz;
+    std::vector<pcl::PointIndices::Ptr> pyramidIndices;
+    std::vector<pcl::PointCloud<pcl::PointXYZRGB>::Ptr > pyramidCloud;
+    std::vector<pcl::PointCloud<pcl::Normal>::Ptr > pyramidNormals;
+  };
+
+  PyramidCache();
+  typedef boost::shared_ptr<PyramidCache> Ptr;
+
+  /** drop everything, has to be called for every new frame **/
+  void clear();
+
+  /**
+   * key of the frame the image belongs to (size and index of the first stored image with identical content),
+   * a copy of every new image is kept to compare the following requests with
+   * */
+  std::string getFrameKey(const cv::Mat &image);
+
+  /** store a feature channel, an existing channel with the same name is kept **/
+  void setChannel(const std::string &name, const cv::Mat &channel);
+  bool getChannel(const std::string &name, cv::Mat &channel);
+
+  /**
+   * gaussian pyramid (cv::buildPyramid) of the channel with levels 0..max_level,
+   * image is used as channel if it is not stored yet
+   * */
+  void getPyramid(const std::string &name, const cv::Mat &image, int max_level, std::vector<cv::Mat> &pyramid);
+
+  /**
+   * |I*G0| + |I*G90| for every level of the channel pyramid, with G0/G90 from makeGaborFilter(angle)
+   * */
+  void getOrientationPyramid(const std::string &name, const cv::Mat &image, int max_level, float angle,
+                             std::vector<cv::Mat> &responses);
+
+  /** depth pyramids for cloud/normals/indices, built once per max_level **/
+  void getDepthPyramid(pcl::PointCloud<pcl::PointXYZRGB>::Ptr &cloud, pcl::PointCloud<pcl::Normal>::Ptr &normals,
+                       pcl::PointIndices::Ptr &indices, int width, int height, int max_level, DepthPyramid &depthPyramid);
+
+private:
+
+  class Entry
+  {
+  public:
+    boost::mutex mutex;
+    cv::Mat channel;
+    std::vector<cv::Mat> pyramid;
+    std::map<float, std::vector<cv::Mat> > orientations;
+  };
+
+  class DepthEntry
+  {
+  public:
+    boost::mutex mutex;
+    bool computed;
+    DepthPyramid depthPyramid;
+    // the key contains the addresses, holding the data prevents them from being reused during the frame
+    pcl::PointCloud<pcl::PointXYZRGB>::Ptr cloud;
+    pcl::PointCloud<pcl::Normal>::Ptr normals;
+    pcl::PointIndices::Ptr indices;
+    DepthEntry() : computed(false) {}
+  };
+
+  boost::mutex mutex;
+  std::vector<cv::Mat> frames;
+  std::map<std::string, boost::shared_ptr<Entry> > entries;
+  std::map<std::string, boost::shared_ptr<DepthEntry> > depthEntries;
+
+  boost::shared_ptr<Entry> getEntry(const std::string &name);
+  void buildPyramid(Entry &entry, int max_level);
+};
+
+}
+#endif //PYRAMID_CACHE_HPP
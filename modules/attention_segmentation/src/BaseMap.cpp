@@ -24,6 +24,8 @@
 
 #include "v4r/attention_segmentation/BaseMap.h"
 
+#include <stdarg.h>
+
 namespace v4r
 {
 
@@ -52,6 +54,10 @@ void BaseMap::reset()
   calculated = false;
   
   refine = true;
+  
+  pyramidCache.reset();
+  frameKey = "";
+  verbose = false;
 
   mapName = "BaseMap";
   
@@ -81,7 +87,7 @@ void BaseMap::print()
 
 int BaseMap::checkParameters()
 {
-  printf("[INFO]: %s: Please implement checkParameters function! Further results are undefined!\n",mapName.c_str());
+  printInfo("[INFO]: %s: Please implement checkParameters function! Further results are undefined!\n",mapName.c_str());
   return(AM_OK);
 }
 
@@ -89,16 +95,16 @@ int BaseMap::calculatePyramid(int pyramidType)
 {
   switch (pyramidType) {
     case SIMPLE_PYRAMID:
-      printf("[INFO]: %s: Simple pyramid will be calculated!\n",mapName.c_str());
+      printInfo("[INFO]: %s: Simple pyramid will be calculated!\n",mapName.c_str());
       return(calculatePyramidSimple());
     case ITTI_PYRAMID:
-      printf("[INFO]: %s: Itti pyramid will be calculated!\n",mapName.c_str());
+      printInfo("[INFO]: %s: Itti pyramid will be calculated!\n",mapName.c_str());
       return(calculatePyramidItti());
     case FRINTROP_PYRAMID:
-      printf("[INFO]: %s: Frintrop pyramid will be calculated!\n",mapName.c_str());
+      printInfo("[INFO]: %s: Frintrop pyramid will be calculated!\n",mapName.c_str());
       return(calculatePyramidFrintrop());
     default: 
-      printf("[INFO]: %s: Pyramid type wasn't detected, Simple pyramid will be calculated instead!\n",mapName.c_str());
+      printInfo("[INFO]: %s: Pyramid type wasn't detected, Simple pyramid will be calculated instead!\n",mapName.c_str());
       return(calculatePyramidSimple());
   }
   
@@ -107,28 +113,28 @@ int BaseMap::calculatePyramid(int pyramidType)
 
 int BaseMap::calculatePyramidSimple()
 {
-  printf("[INFO]: %s: Sorry, but Simple pyramid calculation is not available!\n",mapName.c_str());
+  printInfo("[INFO]: %s: Sorry, but Simple pyramid calculation is not available!\n",mapName.c_str());
   calculated = false;
   return(AM_OK);
 }
 
 int BaseMap::calculatePyramidItti()
 {
-  printf("[INFO]: %s: Sorry, but Itti pyramid calculation is not available!\n",mapName.c_str());
+  printInfo("[INFO]: %s: Sorry, but Itti pyramid calculation is not available!\n",mapName.c_str());
   calculated = false;
   return(AM_OK);
 }
 
 int BaseMap::calculatePyramidFrintrop()
 {
-  printf("[INFO]: %s: Sorry, but Frintrop pyramid calculation is not available!\n",mapName.c_str());
+  printInfo("[INFO]: %s: Sorry, but Frintrop pyramid calculation is not available!\n",mapName.c_str());
   calculated = false;
   return(AM_OK);
 }
 
 int BaseMap::combinePyramid(BasePyramid::Ptr pyramid)
 {
-  printf("[INFO]: %s: Sorry, but combinePyramid calculation is not available!\n",mapName.c_str());
+  printInfo("[INFO]: %s: Sorry, but combinePyramid calculation is not available!\n",mapName.c_str());
   calculated = false;
   return(AM_OK);
 }
@@ -137,13 +143,13 @@ void BaseMap::refineMap()
 {
   if(!haveIndices)
   {
-    printf("[INFO]: %s: Map refinement is available only when indices are set!\n",mapName.c_str());
+    printInfo("[INFO]: %s: Map refinement is available only when indices are set!\n",mapName.c_str());
     return;
   }
   
   if(!refine)
   {
-    printf("[INFO]: %s: You should at first allow refinement!\n",mapName.c_str());
+    printInfo("[INFO]: %s: You should at first allow refinement!\n",mapName.c_str());
     return;
   }
   
@@ -169,7 +175,7 @@ void BaseMap::refineMap()
     }
   }
   
-  printf("[INFO]: %s: Map was refined!\n",mapName.c_str());
+  printInfo("[INFO]: %s: Map was refined!\n",mapName.c_str());
   
 }
 
@@ -188,7 +194,7 @@ void BaseMap::setMask(const cv::Mat &mask_)
   haveMask = true;
   calculated = false;
 
-  printf("[INFO]: %s: got mask.\n",mapName.c_str());
+  printInfo("[INFO]: %s: got mask.\n",mapName.c_str());
 }
 
 void BaseMap::setNormalizationType(int normalization_type_)
@@ -196,7 +202,7 @@ void BaseMap::setNormalizationType(int normalization_type_)
   normalization_type = normalization_type_;
   calculated = false;
 
-  printf("[INFO]: %s: normalization_type is set to: %d\n",mapName.c_str(),normalization_type);
+  printInfo("[INFO]: %s: normalization_type is set to: %d\n",mapName.c_str(),normalization_type);
 }
 
 void BaseMap::setCombinationType(int combination_type_)
@@ -204,7 +210,7 @@ void BaseMap::setCombinationType(int combination_type_)
   combination_type = combination_type_;
   calculated = false;
 
-  printf("[INFO]: %s: combination_type is set to: %d\n",mapName.c_str(),combination_type);
+  printInfo("[INFO]: %s: combination_type is set to: %d\n",mapName.c_str(),combination_type);
 }
 
 void BaseMap::setFilterSize(int filter_size_)
@@ -212,7 +218,7 @@ void BaseMap::setFilterSize(int filter_size_)
   filter_size = filter_size_;
   calculated = false;
 
-  printf("[INFO]: %s: filter_size is set to: %d\n",mapName.c_str(),filter_size);
+  printInfo("[INFO]: %s: filter_size is set to: %d\n",mapName.c_str(),filter_size);
 }
 
 void BaseMap::setWidth(int width_)
@@ -220,7 +226,7 @@ void BaseMap::setWidth(int width_)
   width = width_;
   calculated = false;
 
-  printf("[INFO]: %s: width is set to: %d\n",mapName.c_str(),width);
+  printInfo("[INFO]: %s: width is set to: %d\n",mapName.c_str(),width);
 }
 
 void BaseMap::setHeight(int height_)
@@ -228,14 +234,14 @@ void BaseMap::setHeight(int height_)
   height = height_;
   calculated = false;
 
-  printf("[INFO]: %s: height is set to: %d\n",mapName.c_str(),height);
+  printInfo("[INFO]: %s: height is set to: %d\n",mapName.c_str(),height);
 }
 
 void BaseMap::setMapName(std::string mapName_)
 {
   mapName = mapName_;
 
-  printf("[INFO]: %s: mapName is set to: %s\n",mapName.c_str(),mapName.c_str());
+  printInfo("[INFO]: %s: mapName is set to: %s\n",mapName.c_str(),mapName.c_str());
 }
 
 void BaseMap::setCloud(pcl::PointCloud<pcl::PointXYZRGB>::Ptr cloud_)
@@ -244,7 +250,7 @@ void BaseMap::setCloud(pcl::PointCloud<pcl::PointXYZRGB>::Ptr cloud_)
   haveCloud = true;
   calculated = false;
 
-  printf("[INFO]: %s: got point cloud.\n",mapName.c_str());
+  printInfo("[INFO]: %s: got point cloud.\n",mapName.c_str());
 }
 
 void BaseMap::setNormals(pcl::PointCloud<pcl::Normal>::Ptr normals_)
@@ -253,7 +259,7 @@ void BaseMap::setNormals(pcl::PointCloud<pcl::Normal>::Ptr normals_)
   haveNormals = true;
   calculated = false;
   
-  printf("[INFO]: %s: got normals.\n",mapName.c_str());
+  printInfo("[INFO]: %s: got normals.\n",mapName.c_str());
 }
 
 void BaseMap::setIndices(pcl::PointIndices::Ptr indices_)
@@ -262,7 +268,7 @@ void BaseMap::setIndices(pcl::PointIndices::Ptr indices_)
   haveIndices = true;
   calculated = false;
 
-  printf("[INFO]: %s: got indices.\n",mapName.c_str());
+  printInfo("[INFO]: %s: got indices.\n",mapName.c_str());
 }
 
 void BaseMap::setImage(const cv::Mat &image_)
@@ -276,7 +282,7 @@ void BaseMap::setImage(const cv::Mat &image_)
 
   calculated = false;
 
-  printf("[INFO]: %s: got image.\n",mapName.c_str());
+  printInfo("[INFO]: %s: got image.\n",mapName.c_str());
 }
 
 bool BaseMap::getImage(cv::Mat &image_)
@@ -364,4 +370,59 @@ bool BaseMap::getRefine()
   return(refine);
 }
 
+void BaseMap::setPyramidCache(PyramidCache::Ptr pyramidCache_)
+{
+  pyramidCache = pyramidCache_;
+  calculated = false;
+}
+
+PyramidCache::Ptr BaseMap::getPyramidCache()
+{
+  return(pyramidCache);
+}
+
+void BaseMap::setVerbose(bool verbose_)
+{
+  verbose = verbose_;
+}
+
+bool BaseMap::getVerbose()
+{
+  return(verbose);
+}
+
+void BaseMap::printInfo(const char *format, ...) const
+{
+  if(!verbose)
+    return;
+  
+  va_list args;
+  va_start(args,format);
+  vprintf(format,args);
+  va_end(args);
+}
+
+PyramidCache::Ptr BaseMap::getFrameCache()
+{
+  if(pyramidCache)
+  {
+    frameKey = pyramidCache->getFrameKey(image);
+    return(pyramidCache);
+  }
+  
+  frameKey = "";
+  return(PyramidCache::Ptr(new PyramidCache()));
+}
+
+std::string BaseMap::cacheKey(const std::string &name) const
+{
+  return(name + "@" + frameKey);
+}
+
+void BaseMap::initPyramidCache(BasePyramid::Ptr pyramid, PyramidCache::Ptr cache, const std::string &channel)
+{
+  pyramid->setVerbose(verbose);
+  pyramid->setCache(cache,channel.empty() ? channel : cacheKey(channel));
+}
+
 } //namespace v4r
\ No newline at end of file
@@ -24,6 +24,8 @@
 
 #include "v4r/attention_segmentation/ColorMap.h"
 
+#include <sstream>
+
 namespace v4r
 {
 
@@ -57,14 +59,14 @@ void ColorSaliencyMap::setUseLAB(bool useLAB_)
 {
   useLAB = useLAB_;
   calculated = false;
-  printf("[INFO]: %s: Use LAB color: %s.\n",mapName.c_str(),useLAB ? "yes" : "no");
+  printInfo("[INFO]: %s: Use LAB color: %s.\n",mapName.c_str(),useLAB ? "yes" : "no");
 }
 
 void ColorSaliencyMap::setColor(cv::Scalar color_)
 {
   color = color_;
   calculated = false;
-  printf("[INFO]: %s: Base color: %f,%f,%f.\n",mapName.c_str(),color(0),color(1),color(2));
+  printInfo("[INFO]: %s: Base color: %f,%f,%f.\n",mapName.c_str(),color(0),color(1),color(2));
 }
 
 bool ColorSaliencyMap::getUseLAB()
@@ -228,6 +230,32 @@ void ColorSaliencyMap::RGBColorMap(cv::Mat &image_cur, int image_width, int imag
   }
 }
 
+/**
+ * blurred or original image in the used color space, shared via cache
+ * */
+void ColorSaliencyMap::createColorImage(PyramidCache::Ptr cache, bool blurred, cv::Mat &image_cur)
+{
+  std::stringstream channel;
+  channel << (useLAB ? "lab" : "bgr");
+  if(blurred)
+    channel << "_blur" << filter_size;
+  
+  if(cache->getChannel(cacheKey(channel.str()),image_cur))
+    return;
+  
+  image.copyTo(image_cur);
+  
+  if(blurred)
+    cv::blur(image_cur,image_cur,cv::Size(filter_size,filter_size));
+  
+  if(useLAB)
+  {
+    cvtColor(image_cur,image_cur,CV_BGR2Lab);
+  }
+  
+  cache->setChannel(cacheKey(channel.str()),image_cur);
+}
+
 int ColorSaliencyMap::calculate()
 {
   calculated = false;
@@ -236,17 +264,10 @@ int ColorSaliencyMap::calculate()
   if(rt_code != AM_OK)
     return(rt_code);
 
-  printf("[INFO]: %s: Computation started.\n",mapName.c_str());
+  printInfo("[INFO]: %s: Computation started.\n",mapName.c_str());
   
   cv::Mat image_cur;
-  image.copyTo(image_cur);
-  
-  cv::blur(image_cur,image_cur,cv::Size(filter_size,filter_size));
-  
-  if(useLAB)
-  {
-    cvtColor(image_cur,image_cur,CV_BGR2Lab);
-  }
+  createColorImage(getFrameCache(),true,image_cur);
 
   float r_color = 0;
   float g_color = 0;
@@ -268,7 +289,7 @@ int ColorSaliencyMap::calculate()
   v4r::normalize(map,normalization_type);
 
   calculated = true;
-  printf("[INFO]: %s: Computation succeed.\n",mapName.c_str());
+  printInfo("[INFO]: %s: Computation succeed.\n",mapName.c_str());
   return(AM_OK);
 }
 
@@ -280,10 +301,13 @@ int ColorSaliencyMap::calculatePyramidSimple()
   if(rt_code != AM_OK)
     return(rt_code);
   
-  printf("[INFO]: %s: Computation Simple pyramid started.\n",mapName.c_str());
+  printInfo("[INFO]: %s: Computation Simple pyramid started.\n",mapName.c_str());
   
   SimplePyramid::Ptr pyramid( new SimplePyramid() );
   
+  PyramidCache::Ptr cache = getFrameCache();
+  initPyramidCache(pyramid,cache,useLAB ? "lab" : "bgr");
+  
   pyramid->setStartLevel(0);
   pyramid->setMaxLevel(6);
   pyramid->setSMLevel(0);
@@ -292,21 +316,17 @@ int ColorSaliencyMap::calculatePyramidSimple()
   pyramid->setNormalizationType(normalization_type);
   
   cv::Mat image_cur;
-  image.copyTo(image_cur);
-  
-  if(useLAB)
-  {
-    cvtColor(image_cur,image_cur,CV_BGR2Lab);
-  }
+  createColorImage(cache,false,image_cur);
   
   pyramid->setImage(image_cur);
   pyramid->buildPyramid();
-  pyramid->print();
+  if(verbose)
+    pyramid->print();
 
   combinePyramid(pyramid);
   
   calculated = true;
-  printf("[INFO]: %s: Pyramid computation succeed.\n",mapName.c_str());
+  printInfo("[INFO]: %s: Pyramid computation succeed.\n",mapName.c_str());
   return(AM_OK);
 }
 
@@ -318,10 +338,13 @@ int ColorSaliencyMap::calculatePyramidItti()
   if(rt_code != AM_OK)
     return(rt_code);
   
-  printf("[INFO]: %s: Computation Itti pyramid started.\n",mapName.c_str());
+  printInfo("[INFO]: %s: Computation Itti pyramid started.\n",mapName.c_str());
   
   IttiPyramid::Ptr pyramid( new IttiPyramid() );
   
+  PyramidCache::Ptr cache = getFrameCache();
+  initPyramidCache(pyramid,cache,useLAB ? "lab" : "bgr");
+  
   pyramid->setSMLevel(0);
   pyramid->setWidth(width);
   pyramid->setHeight(height);
@@ -335,21 +358,17 @@ int ColorSaliencyMap::calculatePyramidItti()
   pyramid->setChangeSign(false);
   
   cv::Mat image_cur;
-  image.copyTo(image_cur);
-  
-  if(useLAB)
-  {
-    cvtColor(image_cur,image_cur,CV_BGR2Lab);
-  }
+  createColorImage(cache,false,image_cur);
   
   pyramid->setImage(image_cur);
   pyramid->buildPyramid();
-  pyramid->print();
+  if(verbose)
+    pyramid->print();
 
   combinePyramid(pyramid);
   
   calculated = true;
-  printf("[INFO]: %s: Pyramid computation succeed.\n",mapName.c_str());
+  printInfo("[INFO]: %s: Pyramid computation succeed.\n",mapName.c_str());
   return(AM_OK);
 }
 
@@ -361,10 +380,13 @@ int ColorSaliencyMap::calculatePyramidFrintrop()
   if(rt_code != AM_OK)
     return(rt_code);
   
-  printf("[INFO]: %s: Computation Frintrop pyramid started.\n",mapName.c_str());
+  printInfo("[INFO]: %s: Computation Frintrop pyramid started.\n",mapName.c_str());
   
   FrintropPyramid::Ptr pyramid( new FrintropPyramid() );
   
+  PyramidCache::Ptr cache = getFrameCache();
+  initPyramidCache(pyramid,cache,useLAB ? "lab" : "bgr");
+  
   pyramid->setStartLevel(0);
   pyramid->setMaxLevel(6);
   pyramid->setSMLevel(0);
@@ -378,21 +400,17 @@ int ColorSaliencyMap::calculatePyramidFrintrop()
   pyramid->setOnSwitch(true);
   
   cv::Mat image_cur;
-  image.copyTo(image_cur);
-  
-  if(useLAB)
-  {
-    cvtColor(image_cur,image_cur,CV_BGR2Lab);
-  }
+  createColorImage(cache,false,image_cur);
   
   pyramid->setImage(image_cur);
   pyramid->buildPyramid();
-  pyramid->print();
+  if(verbose)
+    pyramid->print();
 
   combinePyramid(pyramid);
   
   calculated = true;
-  printf("[INFO]: %s: Pyramid computation succeed.\n",mapName.c_str());
+  printInfo("[INFO]: %s: Pyramid computation succeed.\n",mapName.c_str());
   return(AM_OK);
 }
 
@@ -406,7 +424,7 @@ int ColorSaliencyMap::combinePyramid(BasePyramid::Ptr pyramid)
   
   for(unsigned int i = pyramid->getStartLevel(); i <= (unsigned int)pyramid->getMaxLevel(); ++i)
   {
-    printf("[INFO]: %s: Computating feature map for level %d.\n",mapName.c_str(),i);
+    printInfo("[INFO]: %s: Computating feature map for level %d.\n",mapName.c_str(),i);
 
     // start creating parameters
     cv::Mat current_image;
@@ -446,7 +464,7 @@ int ColorSaliencyMap::combinePyramid(BasePyramid::Ptr pyramid)
      return(AM_CUSTOM);
     }
     
-    printf("[INFO]: %s: Feature map at level %d is set.\n",mapName.c_str(),i);
+    printInfo("[INFO]: %s: Feature map at level %d is set.\n",mapName.c_str(),i);
   }
   // combine saliency maps
   pyramid->combinePyramid(true);
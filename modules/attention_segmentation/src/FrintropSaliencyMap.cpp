@@ -55,7 +55,7 @@ void FrintropSaliencyMap::setNumberOfOrientations(int numberOfOrientations_)
 {
   numberOfOrientations = numberOfOrientations_;
   calculated = false;
-  printf("[INFO]: %s: numberOfOrientations: %d.\n",mapName.c_str(),numberOfOrientations);
+  printInfo("[INFO]: %s: numberOfOrientations: %d.\n",mapName.c_str(),numberOfOrientations);
 }
 
 int FrintropSaliencyMap::getNumberOfOrientations()
@@ -100,18 +100,31 @@ int FrintropSaliencyMap::checkParameters()
   return(AM_OK);
 }
 
-void FrintropSaliencyMap::createColorChannels()
+void FrintropSaliencyMap::createColorChannels(PyramidCache::Ptr cache)
 {
+  if(cache->getChannel(cacheKey("frintrop_I"),I))
+  {
+    if( (image.channels() <= 1) ||
+        (cache->getChannel(cacheKey("frintrop_R"),R) && cache->getChannel(cacheKey("frintrop_G"),G) &&
+         cache->getChannel(cacheKey("frintrop_B"),B) && cache->getChannel(cacheKey("frintrop_Y"),Y)) )
+    {
+      return;
+    }
+  }
+  
   if(image.channels() > 1)
     cv::cvtColor(image,I,CV_RGB2GRAY);
   else
     image.copyTo(I);
   
   I.convertTo(I,CV_32F,1.0f/255);
+  cache->setChannel(cacheKey("frintrop_I"),I);
   
   if(image.channels() > 1)
   {
     ColorSaliencyMap colorSaliencyMap;
+    colorSaliencyMap.setVerbose(verbose);
+    colorSaliencyMap.setPyramidCache(cache);
     colorSaliencyMap.setImage(image);
     colorSaliencyMap.setUseLAB(true);
     // red
@@ -146,11 +159,18 @@ void FrintropSaliencyMap::createColorChannels()
       printf("[INFO]: FrintropSaliencyMap:createColorChannels:Y: computation failed.\n");
       exit(0);
     }
+    
+    cache->setChannel(cacheKey("frintrop_R"),R);
+    cache->setChannel(cacheKey("frintrop_G"),G);
+    cache->setChannel(cacheKey("frintrop_B"),B);
+    cache->setChannel(cacheKey("frintrop_Y"),Y);
   }
 }
 
-void FrintropSaliencyMap::initializePyramid(FrintropPyramid::Ptr pyramid, cv::Mat &IM, bool onSwitch_)
+void FrintropSaliencyMap::initializePyramid(FrintropPyramid::Ptr pyramid, cv::Mat &IM, PyramidCache::Ptr cache, const std::string &channel, bool onSwitch_)
 { 
+  initPyramidCache(pyramid,cache,channel);
+  
   pyramid->setStartLevel(2);//
   pyramid->setMaxLevel(4);//
   pyramid->setSMLevel(0);//
@@ -165,11 +185,14 @@ void FrintropSaliencyMap::initializePyramid(FrintropPyramid::Ptr pyramid, cv::Ma
   
   pyramid->setImage(IM);
   pyramid->buildPyramid();
-  pyramid->print();
+  if(verbose)
+    pyramid->print();
 }
 
-void FrintropSaliencyMap::initializePyramid(SimplePyramid::Ptr pyramid, cv::Mat &IM)
+void FrintropSaliencyMap::initializePyramid(SimplePyramid::Ptr pyramid, cv::Mat &IM, PyramidCache::Ptr cache, const std::string &channel)
 { 
+  initPyramidCache(pyramid,cache,channel);
+  
   pyramid->setStartLevel(2);//
   pyramid->setMaxLevel(4);//
   pyramid->setSMLevel(0);//
@@ -179,7 +202,8 @@ void FrintropSaliencyMap::initializePyramid(SimplePyramid::Ptr pyramid, cv::Mat
   
   pyramid->setImage(IM);
   pyramid->buildPyramid();
-  pyramid->print();
+  if(verbose)
+    pyramid->print();
 }
 
 int FrintropSaliencyMap::calculate()
@@ -190,15 +214,16 @@ int FrintropSaliencyMap::calculate()
   if(rt_code != AM_OK)
     return(rt_code);
 
-  printf("[INFO]: %s: Computation started.\n",mapName.c_str());
+  printInfo("[INFO]: %s: Computation started.\n",mapName.c_str());
   
-  createColorChannels();
+  PyramidCache::Ptr cache = getFrameCache();
+  createColorChannels(cache);
   
   FrintropPyramid::Ptr pyramidIOn( new FrintropPyramid() );
-  initializePyramid(pyramidIOn,I,true);
+  initializePyramid(pyramidIOn,I,cache,"frintrop_I",true);
   
   FrintropPyramid::Ptr pyramidIOff( new FrintropPyramid() );
-  initializePyramid(pyramidIOff,I,false);
+  initializePyramid(pyramidIOff,I,cache,"frintrop_I",false);
   
   std::vector<SimplePyramid::Ptr> pyramidO;
   pyramidO.resize(numberOfOrientations);
@@ -206,7 +231,7 @@ int FrintropSaliencyMap::calculate()
   for(int i = 0; i < numberOfOrientations; ++i)
   {
     pyramidO.at(i) = SimplePyramid::Ptr( new SimplePyramid() );
-    initializePyramid(pyramidO.at(i),I);
+    initializePyramid(pyramidO.at(i),I,cache,"frintrop_I");
   }
   
   FrintropPyramid::Ptr pyramidR( new FrintropPyramid() );
@@ -216,10 +241,10 @@ int FrintropSaliencyMap::calculate()
   
   if(image.channels() > 1)
   {
-    initializePyramid(pyramidR,R,true);
-    initializePyramid(pyramidG,G,true);
-    initializePyramid(pyramidB,B,true);
-    initializePyramid(pyramidY,Y,true); 
+    initializePyramid(pyramidR,R,cache,"frintrop_R",true);
+    initializePyramid(pyramidG,G,cache,"frintrop_G",true);
+    initializePyramid(pyramidB,B,cache,"frintrop_B",true);
+    initializePyramid(pyramidY,Y,cache,"frintrop_Y",true); 
   }
   
   rt_code = createFeatureMapsI(pyramidIOn);
@@ -232,7 +257,7 @@ int FrintropSaliencyMap::calculate()
   for(int i = 0; i < numberOfOrientations; ++ i)
   {
     float angle = i*180.0/numberOfOrientations;
-    rt_code = createFeatureMapsO(pyramidO.at(i),angle);
+    rt_code = createFeatureMapsO(pyramidO.at(i),cache,angle);
     if(rt_code != AM_OK)
       return(rt_code);
   }
@@ -364,7 +389,7 @@ int FrintropSaliencyMap::calculate()
   
   calculated = true;
 
-  printf("[INFO]: %s: Computation finished.\n",mapName.c_str());  
+  printInfo("[INFO]: %s: Computation finished.\n",mapName.c_str());  
 
   return(AM_OK);
 }
@@ -373,7 +398,7 @@ int FrintropSaliencyMap::createFeatureMapsI(FrintropPyramid::Ptr pyramid)
 {
   for(unsigned int i = pyramid->getStartLevel(); i <= (unsigned int)pyramid->getMaxLevel(); ++i)
   {
-    printf("[INFO]: %s: Computating feature map for level %d.\n",mapName.c_str(),i);
+    printInfo("[INFO]: %s: Computating feature map for level %d.\n",mapName.c_str(),i);
 
     cv::Mat current_image;
     if(!pyramid->getImage(i,current_image))
@@ -388,7 +413,7 @@ int FrintropSaliencyMap::createFeatureMapsI(FrintropPyramid::Ptr pyramid)
      return(AM_CUSTOM);
     }
     
-    printf("[INFO]: %s: Feature map at level %d is set.\n",mapName.c_str(),i);
+    printInfo("[INFO]: %s: Feature map at level %d is set.\n",mapName.c_str(),i);
   }
   // combine saliency maps
   pyramid->combinePyramid(true); 
@@ -397,28 +422,17 @@ int FrintropSaliencyMap::createFeatureMapsI(FrintropPyramid::Ptr pyramid)
   
 }
 
-int FrintropSaliencyMap::createFeatureMapsO(SimplePyramid::Ptr pyramid, float angle)
+int FrintropSaliencyMap::createFeatureMapsO(SimplePyramid::Ptr pyramid, PyramidCache::Ptr cache, float angle)
 {
+  // Gabor responses are shared between all maps using the intensity channel
+  std::vector<cv::Mat> responses;
+  cache->getOrientationPyramid(cacheKey("frintrop_I"),I,pyramid->getMaxLevel(),angle,responses);
+  
   for(unsigned int i = pyramid->getStartLevel(); i <= (unsigned int)pyramid->getMaxLevel(); ++i)
   {
-    printf("[INFO]: %s: Computating feature map for level %d.\n",mapName.c_str(),i);
+    printInfo("[INFO]: %s: Computating feature map for level %d.\n",mapName.c_str(),i);
 
-    cv::Mat current_image;
-    if(!pyramid->getImage(i,current_image))
-    {
-      printf("[ERROR]: Something went wrong! Can't get image for level %d!\n",i);
-      return(AM_CUSTOM);
-    }
-    
-    cv::Mat gaborKernel0, gaborKernel90;
-    v4r::makeGaborFilter(gaborKernel0,gaborKernel90,angle);
-    cv::Mat temp0, temp90;
-    cv::filter2D(current_image,temp0,-1,gaborKernel0);
-    temp0 = cv::abs(temp0);
-    cv::filter2D(current_image,temp90,-1,gaborKernel90);
-    temp90 = cv::abs(temp90);
-    cv::Mat current_map;
-    cv::add(temp0,temp90,current_map);
+    cv::Mat current_map = responses.at(i);
     
     if(!pyramid->setFeatureMap(i,current_map))
     {
@@ -426,7 +440,7 @@ int FrintropSaliencyMap::createFeatureMapsO(SimplePyramid::Ptr pyramid, float an
      return(AM_CUSTOM);
     }
     
-    printf("[INFO]: %s: Feature map at level %d is set.\n",mapName.c_str(),i);
+    printInfo("[INFO]: %s: Feature map at level %d is set.\n",mapName.c_str(),i);
   }
   // combine saliency maps
   pyramid->combinePyramid(true); 
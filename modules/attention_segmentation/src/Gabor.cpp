@@ -54,6 +54,15 @@ Gabor::Gabor()
   M_min = -2;       // Minimum scale factor (icpr=-2)
   M_max = 2;        // Maximum scale factor (icpr=2)
   filtersNumber = N*abs(M_max - M_min +1);
+
+  // kernel size only depends on the scale
+  kernelRadius = 0;
+  for(int scale = M_min; scale <= M_max; scale++)
+  {
+    CvGabor gabor;
+    gabor.Init(0.,scale,Sigma,F);
+    kernelRadius = std::max(kernelRadius, (int)(gabor.get_mask_width()-1)/2);
+  }
 }
 
 Gabor::~Gabor()
@@ -163,28 +172,95 @@ void Gabor::setIndices(cv::Rect _rect)
 //   have_gabor_filters = true;
 // }
 
+void Gabor::computeKernelSpectra(cv::Size dftSize)
+{
+  if( (dftSize == spectraSize) && ((int)kernelSpectra.size() == filtersNumber) )
+    return;
+
+  kernelSpectra.resize(filtersNumber);
+
+  #pragma omp parallel for
+  for(int idx = 0; idx < filtersNumber; idx++)
+  {
+    int ori = idx / abs(M_max - M_min +1);
+    int scale = M_min + idx % abs(M_max - M_min +1);
+
+    double orientation = (((double)(PI*ori))/N);
+    CvGabor gabor;
+    gabor.Init(orientation,scale,Sigma,F);
+
+    // CvGabor::conv_img correlates the transposed image with the kernel, i.e. the image with the transposed kernel
+    cv::Mat real = cv::cvarrToMat(gabor.get_matrix(CV_GABOR_REAL)).t();
+    cv::Mat imag = cv::cvarrToMat(gabor.get_matrix(CV_GABOR_IMAG)).t();
+    int radius = (real.rows-1)/2;
+
+    // complex kernel with its center wrapped around to the origin
+    cv::Mat kernel = cv::Mat::zeros(dftSize, CV_32FC2);
+    for(int dy = -radius; dy <= radius; dy++)
+    {
+      for(int dx = -radius; dx <= radius; dx++)
+      {
+        cv::Vec2f &k = kernel.at<cv::Vec2f>((dy+dftSize.height)%dftSize.height, (dx+dftSize.width)%dftSize.width);
+        k[0] = real.at<float>(dy+radius,dx+radius);
+        k[1] = imag.at<float>(dy+radius,dx+radius);
+      }
+    }
+    cv::dft(kernel, kernelSpectra.at(idx));
+  }
+
+  spectraSize = dftSize;
+}
+
 void Gabor::computeGaborFilters()
 {
   gaborFilters.resize(filtersNumber);
-  
-  CvGabor gabor;
-  // orientation
-  for(int ori = 0; ori < N; ori++) 
+  rowSums.resize(filtersNumber);
+  rowSqSums.resize(filtersNumber);
+
+  // replicate the border (as cvFilter2D does) and transform the image once for all filters
+  cv::Mat padded;
+  cv::copyMakeBorder(image, padded, kernelRadius, kernelRadius, kernelRadius, kernelRadius, cv::BORDER_REPLICATE);
+  cv::Size dftSize(cv::getOptimalDFTSize(padded.cols), cv::getOptimalDFTSize(padded.rows));
+
+  cv::Mat imageDft = cv::Mat::zeros(dftSize, CV_32FC1);
+  cv::Mat imageRoi = imageDft(cv::Rect(0,0,padded.cols,padded.rows));
+  padded.convertTo(imageRoi, CV_32F);
+  cv::dft(imageDft, imageDft, cv::DFT_COMPLEX_OUTPUT);
+
+  computeKernelSpectra(dftSize);
+
+  #pragma omp parallel for
+  for(int idx = 0; idx < filtersNumber; idx++)
   {
-    // scale
-    for(int scale = M_min; scale <= M_max; scale++) 
+    // correlation with the complex kernel gives real and imaginary response at once (up to the sign of the imaginary part)
+    cv::Mat response;
+    cv::mulSpectrums(imageDft, kernelSpectra.at(idx), response, 0, true);
+    cv::idft(response, response, cv::DFT_SCALE);
+
+    cv::Mat channels[2];
+    cv::split(response(cv::Rect(kernelRadius,kernelRadius,width,height)), channels);
+    cv::Mat magnitude;
+    cv::magnitude(channels[0], channels[1], magnitude);
+
+    // same 8-bit quantisation as CvGabor::conv_img
+    cv::normalize(magnitude, magnitude, 0, 255, cv::NORM_MINMAX);
+    magnitude.convertTo(gaborFilters.at(idx), CV_8U);
+
+    // prefix sums along the rows, so that patch statistics cost O(runs) instead of O(pixels)
+    //@ep: responses are read as char (as done by the former per-pixel loops, the relation classifiers are trained on these values)
+    rowSums.at(idx).create(height, width+1, CV_32S);
+    rowSqSums.at(idx).create(height, width+1, CV_32S);
+    for(int i = 0; i < height; i++)
     {
-      int idx = ori*abs(M_max - M_min +1) + (scale-M_min);
-      
-      double orientation = (((double)(PI*ori))/N);  
-      gabor.Init(orientation,scale,Sigma,F);
-      //@ep: BUG this is not optimal at all, we should either compute gabor filter once, or only for each patch
-      //@ep: TODO figure out what type to use
-      IplImage temp_image = image;
-      IplImage* temp_filter = cvCreateImage(cvGetSize(&temp_image), 8, 1);
-      gabor.conv_img(&temp_image,temp_filter,CV_GABOR_MAG);
-      gaborFilters.at(idx) = cv::cvarrToMat(temp_filter,true);
-      cvReleaseImage(&temp_filter);
+      const char *r = gaborFilters.at(idx).ptr<char>(i);
+      int *s = rowSums.at(idx).ptr<int>(i);
+      int *sq = rowSqSums.at(idx).ptr<int>(i);
+      s[0] = sq[0] = 0;
+      for(int j = 0; j < width; j++)
+      {
+        s[j+1] = s[j] + r[j];
+        sq[j+1] = sq[j] + r[j]*r[j];
+      }
     }
   }
   
@@ -211,34 +287,48 @@ void Gabor::compute()
   double mean = 0.0f;
   double stddev = 0.0f;
   
-  // calculate mean value
-  for(int fi = 0; fi < filtersNumber; fi++) 
+  // sum and squared sum of each filter response over the patch (from runs of consecutive indices)
+  std::vector<double> sum(filtersNumber, 0.), sqSum(filtersNumber, 0.);
+  for(unsigned int idx = 0; idx < indices->indices.size(); )
   {
-    for(unsigned int idx = 0; idx < indices->indices.size(); idx++)
+    int i = indices->indices.at(idx) / width;
+    int j_start = indices->indices.at(idx) % width;
+    int j_end = j_start + 1;
+    idx++;
+    while( (idx < indices->indices.size()) && (indices->indices.at(idx) == i*width + j_end) && (j_end < width) )
     {
-      int i = indices->indices.at(idx) / width;
-      int j = indices->indices.at(idx) % width;
-      //@ep: BUG there is a bug here potentially because of char/uchar
-      mean += ((double) gaborFilters.at(fi).at<char>(i,j) / normalise);
+      j_end++;
+      idx++;
     }
-    
-    mean /= ((double) indices->indices.size());
+
+    for(int fi = 0; fi < filtersNumber; fi++)
+    {
+      const int *s = rowSums.at(fi).ptr<int>(i);
+      const int *sq = rowSqSums.at(fi).ptr<int>(i);
+      sum.at(fi) += s[j_end] - s[j_start];
+      sqSum.at(fi) += sq[j_end] - sq[j_start];
+    }
+  }
+  
+  double n = (double) indices->indices.size();
+  
+  // calculate mean value
+  // (mean and stddev are accumulated over the filters as in the former per-pixel loops)
+  for(int fi = 0; fi < filtersNumber; fi++) 
+  {
+    mean += sum.at(fi) / normalise;
+    mean /= n;
     
     featureVector.at(2*fi) = mean;
-    
   }
   
   // calculate standard deviation
   for(int fi = 0; fi < filtersNumber; fi++) 
   {
-    for(unsigned int idx = 0; idx < indices->indices.size(); idx++)
-    {
-      int i = indices->indices.at(idx) / width;
-      int j = indices->indices.at(idx) % width;
-      stddev += pow(((double) gaborFilters.at(fi).at<char>(i,j) / normalise) - mean, 2);
-    }
+    // sum over the patch of (x/normalise - mean)^2
+    stddev += sqSum.at(fi) / (normalise*normalise) - 2. * mean * sum.at(fi) / normalise + n * mean * mean;
     
-    stddev /= ((double) (indices->indices.size()-1));
+    stddev /= (n-1);
     stddev = sqrt(stddev);
 
     featureVector.at(2*fi+1) = stddev;
@@ -33,7 +33,7 @@
 #include <cmath>
 
 #ifndef GC_DEBUG
-#define GC_DEBUG true
+#define GC_DEBUG false
 #endif
 
 namespace gc
@@ -105,23 +105,28 @@ void Graph::BuildFromSVM(std::vector<gc::Edge> &e, unsigned &num_edges, std::vec
   int sink = 0;
   for(unsigned i=0; i<surfaces.size(); i++)
   {
-    if(!(surfaces.at(i)->selected)) 
-	continue;
-    
-    if(!find_sink)
+    if(surfaces.at(i)->selected)
     {
       sink = i;
       find_sink = true;
+      break;
     }
+  }
+
+  // nodes already related to the sink
+  std::vector<bool> sink_related(surfaces.size(), false);
+  for(unsigned j=0; j<relations.size(); j++)
+  {
+    if(find_sink && relations[j].id_0 == sink)
+      sink_related.at(relations[j].id_1) = true;
+  }
+
+  for(unsigned i=0; i<surfaces.size(); i++)
+  {
+    if(!(surfaces.at(i)->selected)) 
+	continue;
     
-    bool node_found = false;
-    for(unsigned j=0; j<relations.size(); j++)
-    {
-      if(relations[j].id_0 == sink && relations[j].id_1 == ((int)i))
-      {
-        node_found = true;
-      }
-    }
+    bool node_found = sink_related.at(i);
     
     if(!node_found) {
       if(GC_DEBUG) 
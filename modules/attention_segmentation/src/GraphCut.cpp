@@ -50,6 +50,8 @@ GraphCut::GraphCut()
   print = false;
   have_surfaces = false;
   have_relations = false;
+  num_edges = 0;
+  num_nodes = 0;
   
   ClassName = "GraphCut";
 }
@@ -100,20 +102,18 @@ bool GraphCut::init()
       if(relations.at(i).id_1 > maxID)
         maxID = relations.at(i).id_1;
     }
+    
+    // look up existing relations instead of scanning all of them for every pair
+    std::set<std::pair<int,int> > related;
+    for(unsigned int k = 0; k < relations.size(); k++)
+      related.insert(std::make_pair(std::min(relations.at(k).id_0,relations.at(k).id_1),
+                                    std::max(relations.at(k).id_0,relations.at(k).id_1)));
+    
     for(int i=0; i<maxID; i++) 
     {
       for(int j=i+1; j<=maxID; j++) 
       {
-        bool foundRelation = false;
-        for(int k=0; k<(int)relations.size(); k++) 
-	{
-          if((relations.at(k).id_0 == i && relations.at(k).id_1 == j) ||
-             (relations.at(k).id_1 == i && relations.at(k).id_0 == j))
-	  {
-            foundRelation = true;
-	  }
-        }
-        if(!foundRelation) 
+        if(related.find(std::make_pair(i,j)) == related.end()) 
 	{
           v4r::Relation r;
           r.id_0 = i; 
@@ -131,16 +131,24 @@ bool GraphCut::init()
   std::vector<gc::Edge> e;
   
   Graph graph(surfaces, relations);
-  
-  std::cerr << "graph initialized" << std::endl;
-  
   graph.BuildFromSVM(e, num_edges, surfaces_reindex2);
-  
-  std::cerr << "graph created" << std::endl;
 
-  edges = new gc::Edge[num_edges];
+  // edges directly from the sparse relation list (relations to unselected surfaces are skipped)
+  edges.clear();
+  edges.reserve(num_edges);
   for(unsigned i=0; i<num_edges; i++)
-    edges[i] = e[i];
+  {
+    if((e[i].a >= 0) && (e[i].b >= 0))
+      edges.push_back(e[i]);
+  }
+  num_edges = edges.size();
+
+  num_nodes = 0;
+  for(unsigned i=0; i<surfaces_reindex2.size(); i++)
+  {
+    if(surfaces_reindex2[i] >= 0)
+      num_nodes++;
+  }
 
   if(num_edges == 0) 
   { 
@@ -148,7 +156,7 @@ bool GraphCut::init()
     return false;
   } 
   else {
-    u = new universe(num_edges);
+    u.reset(new universe(num_nodes));
     initialized = true;
     if(GC_DEBUG) 
       printf("[GraphCut::Initialize] num_edges: %u\n", num_edges);
@@ -185,102 +193,70 @@ void GraphCut::process()
   if(GC_DEBUG) printf("[GraphCut::process] Start processing.\n");
 
   // sort edges by weight  
-  std::cerr << "before sorting" << std::endl;
-  std::sort(edges, edges + num_edges, smallerEdge);
-  std::cerr << "after sorting" << std::endl;
+  std::sort(edges.begin(), edges.end(), smallerEdge);
 
-  // init thresholds
-  float *threshold = new float[num_edges];
-  for (unsigned i = 0; i < num_edges; i++)
-    threshold[i] = THRESHOLD(1, THRESHOLD_CONSTANT);
+  // init thresholds (per component, indexed by the root node)
+  std::vector<float> threshold(num_nodes, THRESHOLD(1, THRESHOLD_CONSTANT));
   
-  std::cerr << "after threshold initialization" << std::endl;
-  
-  if(GC_DEBUG) printf("THRESHOLD: %4.3f\n", threshold[0]);
+  if(GC_DEBUG) printf("THRESHOLD: %4.3f\n", THRESHOLD(1, THRESHOLD_CONSTANT));
   
   // for each edge, in non-decreasing weight order...
   for (unsigned i = 0; i < num_edges; i++)
   {
-    if(GC_DEBUG)
-    {
-      u->printAll();
-      for (unsigned j = 0; j < num_edges; j++)
-      {
-        printf("get edge %i\n", j);
-        gc::Edge *pedge = &edges[j];
-        printf("  all edges: %u:", j);
-        printf("  %u-%u with thrd: %4.3f", pedge->a, pedge->b, threshold[j]);
-        printf("  => universe: %u-%u\n", u->find(pedge->a), u->find(pedge->b));
-      }
-    }
-    
-    if(GC_DEBUG) printf("\nstart with edge %u: ", i);
-
-    gc::Edge *pedge = &edges[i];
-    int a = u->find(pedge->a);    // components conected by this edge
-    int b = u->find(pedge->b);
-    if(GC_DEBUG) printf("node: %u-%u / universe: %u-%u: ", pedge->a, pedge->b, a, b);
+    const gc::Edge &edge = edges[i];
+    int a = u->find(edge.a);    // components conected by this edge
+    int b = u->find(edge.b);
     
     if (a != b)
     {
       if(GC_DEBUG)
-        printf("weight: %4.3f and thds: %4.3f-%4.3f\n", pedge->w, threshold[a], threshold[b]);
+        printf("edge %u: %u-%u / universe: %u-%u: weight: %4.3f and thds: %4.3f-%4.3f\n", i, edge.a, edge.b, a, b, edge.w, threshold[a], threshold[b]);
       
-      if ((pedge->w <= threshold[a]) && (pedge->w <= threshold[b])) 
+      if ((edge.w <= threshold[a]) && (edge.w <= threshold[b])) 
       {
         u->join(a, b);
         a = u->find(a);
+        threshold[a] = edge.w + THRESHOLD(u->size(a), THRESHOLD_CONSTANT);
         if(GC_DEBUG)
-          printf("  => join: threshold[%u] = w(%4.3f) + %4.3f => ", a, pedge->w, threshold[a]);
-        threshold[a] = pedge->w + THRESHOLD(u->size(a), THRESHOLD_CONSTANT);
-        if(GC_DEBUG)
-          printf("%4.3f (size: %u)\n", threshold[a], u->size(a));
+          printf("  => join: threshold[%u] = %4.3f (size: %u)\n", a, threshold[a], u->size(a));
       }
     }
   }
 
   int num_components = u->num_sets();
-  if(GC_DEBUG) printf("[GraphCut::process] Number of components: %u => What does that mean?\n", num_components);
+  if(GC_DEBUG) printf("[GraphCut::process] Number of components: %u\n", num_components);
 
-  // copy graph cut groups
-  std::vector<std::vector<int> > graphCutGroups;
-  graphCutGroups.clear();
-  int cut_labels[surfaces.size()];             // cut-ids for all models
-  std::set<int> graphCutLabels;                      // all graph cut labels
+  // copy graph cut groups (groups are numbered in the order of their smallest root label)
+  std::vector<int> cut_labels(surfaces.size(), -1);  // cut-ids for all models
+  std::vector<int> group_of_root(num_nodes, -1);
   for(unsigned int i = 0; i < surfaces.size(); i++) {
-    
-    cut_labels[i] = -1;
-    
     if(!(surfaces.at(i)->selected)) 
-	continue;
+      continue;
     
-    int cut_id = u->find(surfaces_reindex2.at(i));
-    cut_labels[i] = cut_id;
-    if(graphCutLabels.find(cut_id) == graphCutLabels.end())
-      graphCutLabels.insert(cut_id);
-  }
-  
-  std::set<int>::iterator it;
-  for(it = graphCutLabels.begin(); it != graphCutLabels.end(); it++) {
-    std::vector<int> cluster;
-    for(unsigned int i = 0; i< surfaces.size(); i++)
-      if((*it == cut_labels[i]) && (cut_labels[i] >= 0))
-        cluster.push_back(i);
-    graphCutGroups.push_back(cluster);
+    cut_labels[i] = u->find(surfaces_reindex2.at(i));
   }
   
-  for(unsigned int i = 0; i < surfaces.size(); ++i)
+  std::vector<int> roots;
+  for(unsigned int i = 0; i < surfaces.size(); i++)
+    if(cut_labels[i] >= 0)
+      roots.push_back(cut_labels[i]);
+  std::sort(roots.begin(), roots.end());
+  roots.erase(std::unique(roots.begin(), roots.end()), roots.end());
+  for(unsigned int i = 0; i < roots.size(); i++)
+    group_of_root[roots[i]] = i;
+
+  std::vector<std::vector<int> > graphCutGroups(roots.size());
+  for(unsigned int i = 0; i < surfaces.size(); i++)
   {
     surfaces.at(i)->label = -1;
+    if(cut_labels[i] < 0)
+      continue;
+    
+    int group = group_of_root[cut_labels[i]];
+    graphCutGroups[group].push_back(i);
+    surfaces.at(i)->label = group;
   }
   
-  for(unsigned int i = 0; i < graphCutGroups.size(); i++)
-    for(unsigned int j = 0; j < graphCutGroups[i].size(); j++)
-    {
-      printf("[GraphCut::process] Surface %u is in groud %u:\n",graphCutGroups[i][j],i);
-      surfaces[graphCutGroups[i][j]]->label = i;
-    }
-  
   if(print) {
     printf("[GraphCut::process] Resulting groups:\n");
     for(unsigned int i = 0; i < relations.size(); i++) {
@@ -297,8 +273,8 @@ void GraphCut::process()
     }
   }
       
-  delete []threshold;
-  delete []edges;
+  edges.clear();
+  u.reset();
   initialized = false;
   processed = true;
 }
@@ -312,19 +288,6 @@ void GraphCut::process2()
     throw std::runtime_error(error_message);
   }
 
-//   std::vector<v4r::Relation>::iterator itr = relations.begin();
-//   while(itr != relations.end())
-//   {
-//     if(itr->valid)
-//     {
-//       itr++;
-//     }
-//     else
-//     {
-//       itr = relations.erase(itr,itr+1);
-//     }
-//   }
-
   if(relations.size() < 1)
   {
     printf("[GraphCut::init] Warning: No relations available!\n");
@@ -335,19 +298,35 @@ void GraphCut::process2()
   std::sort(relations.begin(),relations.end(),smallerRelations);
   std::vector<bool> used_relations(relations.size(),false);
 
-  for(unsigned int i = 0; i < relations.size(); ++i)
-  {
-//     printf("%d--%d\n",relations.at(i).id_0,relations.at(i).id_1);
-  }
-  
-  std::vector<std::vector<int> > universe(surfaces.size());
+  // universes are identified by one of their surfaces, parent points to the universe a surface was merged into
+  std::vector<int> parent(surfaces.size());
+  std::vector<int> universe_surfaces(surfaces.size(), 0);   // number of surfaces in the universe
+  std::vector<int> universe_points(surfaces.size(), 0);     // number of points in the universe
   std::vector<float> threshold(surfaces.size());
 
   for(unsigned int i = 0; i < surfaces.size(); ++i)
   {
+    parent.at(i) = i;
     threshold.at(i) = THRESHOLD_CONSTANT;
     if(surfaces.at(i)->selected)
-      universe.at(i).push_back(i);
+    {
+      universe_surfaces.at(i) = 1;
+      universe_points.at(i) = surfaces.at(i)->indices.size();
+    }
+  }
+
+  // sparse neighbourhood of each universe: neighbouring universe -> (unused) relations between them
+  // (there may be more than one relation per pair of surfaces, all of them are kept in sorted order and
+  // combined pairwise or re-pointed on merges)
+  std::vector<std::map<int,std::vector<int> > > neighbours(surfaces.size());
+  for(unsigned int r_idx = 0; r_idx < relations.size(); r_idx++)
+  {
+    int id_0 = relations.at(r_idx).id_0;
+    int id_1 = relations.at(r_idx).id_1;
+    if(id_0 == id_1)
+      continue;
+    neighbours.at(id_0)[id_1].push_back(r_idx);
+    neighbours.at(id_1)[id_0].push_back(r_idx);
   }
   
   // for each edge, in non-decreasing weight order...
@@ -356,238 +335,109 @@ void GraphCut::process2()
     if(used_relations.at(r_idx))
       continue;
 
-//     printf("Processing relation %d\n",r_idx);
-    
-    //if probability that patches are disconnected by relation is lower than constant, than connect pathes
-    if( ((relations.at(r_idx).rel_probability[0]) <= (threshold.at(relations.at(r_idx).id_0))) && ((relations.at(r_idx).rel_probability[0]) <= (threshold.at(relations.at(r_idx).id_1))) )
-    {
-//       printf("Relation will be connected\n");
-
-      int id_0 = relations.at(r_idx).id_0;
-      int id_1 = relations.at(r_idx).id_1;
-
-//       printf("id0 = %d; id1 = %d\n",id_0,id_1);
+    int id_0 = relations.at(r_idx).id_0;
+    int id_1 = relations.at(r_idx).id_1;
 
-      //calculate the size of each universe
-      int uni0_size = 0;
-      for(unsigned int i = 0; i < universe.at(id_0).size(); ++i)
-      {
-        uni0_size += surfaces.at(universe.at(id_0).at(i))->indices.size();
-      }
-      int uni1_size = 0;
-      for(unsigned int i = 0; i < universe.at(id_1).size(); ++i)
-      {
-        uni1_size += surfaces.at(universe.at(id_1).at(i))->indices.size();
-      }
+    //if probability that patches are disconnected by relation is lower than constant, than connect pathes
+    if( (id_0 == id_1) ||
+        (relations.at(r_idx).rel_probability[0] > threshold.at(id_0)) || (relations.at(r_idx).rel_probability[0] > threshold.at(id_1)) )
+      continue;
 
-//       printf("Size of universe 0 -- %d\n",uni0_size);
-//       printf("Size of universe 1 -- %d\n",uni1_size);
-      
-      float w_uni0 = ((float)uni0_size)/((float)uni0_size + (float)uni1_size);
-      float w_uni1 = ((float)uni1_size)/((float)uni0_size + (float)uni1_size);
+    int uni0_size = universe_points.at(id_0);
+    int uni1_size = universe_points.at(id_1);
       
-      //add one part of the universe to another
-      if( uni0_size > uni1_size )
-      {
-//         printf("Universe 1 will be added to universe 0\n");
+    float w_uni0 = ((float)uni0_size)/((float)uni0_size + (float)uni1_size);
+    float w_uni1 = ((float)uni1_size)/((float)uni0_size + (float)uni1_size);
+    
+    //add the smaller universe to the bigger one
+    int to = id_1, from = id_0;
+    float w_to = w_uni1, w_from = w_uni0;
+    if( uni0_size > uni1_size )
+    {
+      to = id_0;
+      from = id_1;
+      w_to = w_uni0;
+      w_from = w_uni1;
+    }
 
-        //id_1 --> id_0
-        for(unsigned int i = 0; i < universe.at(id_1).size(); ++i)
-        {
-          universe.at(id_0).push_back(universe.at(id_1).at(i));
-//           printf("adding surface %d\n",universe.at(id_1).at(i));
-        }
-        universe.at(id_1).clear();
-        threshold.at(id_0) = relations.at(r_idx).rel_probability[0] + THRESHOLD(universe.at(id_0).size(), THRESHOLD_CONSTANT);
-        used_relations.at(r_idx) = true;
-
-        for(unsigned int i = 0; i < relations.size(); ++i)
-        {
-          if(used_relations.at(i))
-            continue;
-
-//           printf("looking at relation %d (%d--%d)\n",i,relations.at(i).id_0,relations.at(i).id_1);
-          
-          if( (relations.at(i).id_0 == id_0) && (relations.at(i).id_1 != id_1) )
-          {
-            int new_id = relations.at(i).id_1;
-            for(unsigned int j = 0; j < relations.size(); ++j)
-            {
-              if(used_relations.at(j))
-                continue;
-
-              if( ( (relations.at(j).id_0 == new_id) && (relations.at(j).id_1 == id_1) ) || ( (relations.at(j).id_0 == id_1) && (relations.at(j).id_1 == new_id) ) )
-              {
-//                 relations.at(i).id_1 = id_0;
-                relations.at(i).rel_probability[0] = w_uni1*relations.at(j).rel_probability[0] + w_uni0*relations.at(i).rel_probability[0];
-                relations.at(i).rel_probability[1] = 1 - relations.at(j).rel_probability[0];
-                used_relations.at(j) = true;
-
-//                 printf("relation %d (%d--%d) is eliminated and will be added to relation %d (%d--%d)\n",j,relations.at(j).id_0,relations.at(j).id_1,i,relations.at(i).id_0,relations.at(i).id_1);
-                break;
-              }
-            }
-          }
-          else if( (relations.at(i).id_1 == id_0) && (relations.at(i).id_0 != id_1) )
-          {
-            int new_id = relations.at(i).id_0;
-            for(unsigned int j = 0; j < relations.size(); ++j)
-            {
-              if(used_relations.at(j))
-                continue;
-              
-              if( ( (relations.at(j).id_0 == new_id) && (relations.at(j).id_1 == id_1) ) || ( (relations.at(j).id_0 == id_1) && (relations.at(j).id_1 == new_id) ) )
-              {
-                //                 relations.at(i).id_1 = id_0;
-                relations.at(i).rel_probability[0] = w_uni1*relations.at(j).rel_probability[0] + w_uni0*relations.at(i).rel_probability[0];
-                relations.at(i).rel_probability[1] = 1 - relations.at(j).rel_probability[0];
-                used_relations.at(j) = true;
-
-//                 printf("relation %d (%d--%d) is eliminated and will be added to relation %d (%d--%d)\n",j,relations.at(j).id_0,relations.at(j).id_1,i,relations.at(i).id_0,relations.at(i).id_1);
-                break;
-              }
-            }
-          }
-        }
+    parent.at(from) = to;
+    universe_surfaces.at(to) += universe_surfaces.at(from);
+    universe_points.at(to) += universe_points.at(from);
+    universe_surfaces.at(from) = 0;
+    universe_points.at(from) = 0;
+    threshold.at(to) = relations.at(r_idx).rel_probability[0] + THRESHOLD(universe_surfaces.at(to), THRESHOLD_CONSTANT);
+    used_relations.at(r_idx) = true;
+
+    // further relations between the two universes would become relations of the universe to itself
+    std::vector<int> &between = neighbours.at(to)[from];
+    for(unsigned int k = 0; k < between.size(); ++k)
+      used_relations.at(between.at(k)) = true;
+    neighbours.at(to).erase(from);
+    neighbours.at(from).erase(to);
+
+    // relations of the merged universe are either combined with a relation to the same neighbour or moved
+    for(std::map<int,std::vector<int> >::iterator it = neighbours.at(from).begin(); it != neighbours.at(from).end(); ++it)
+    {
+      int new_id = it->first;
+      const std::vector<int> &rel_from = it->second;
+      neighbours.at(new_id).erase(from);
 
-        for(unsigned int i = 0; i < relations.size(); ++i)
-        {
-          if(used_relations.at(i))
-            continue;
-          
-          if(relations.at(i).id_0 == id_1)
-          {
-//             printf("relation %d (%d--%d) was moved to relation ",i,relations.at(i).id_0,relations.at(i).id_1);
-            relations.at(i).id_0 = id_0;
-//             printf("(%d--%d)\n",i,relations.at(i).id_0,relations.at(i).id_1);
-          }
-          else if(relations.at(i).id_1 == id_1)
-          {
-//             printf("relation %d (%d--%d) was moved to relation ",i,relations.at(i).id_0,relations.at(i).id_1);
-            relations.at(i).id_1 = id_0;
-//             printf("(%d--%d)\n",i,relations.at(i).id_0,relations.at(i).id_1);
-          }
-          
-        }
-        
+      std::vector<int> &rel_to = neighbours.at(to)[new_id];
+      unsigned int num_combined = std::min(rel_from.size(), rel_to.size());
+      for(unsigned int k = 0; k < num_combined; ++k)
+      {
+        int i = rel_to.at(k);
+        int j = rel_from.at(k);
+        // size weighted average of the relations of both universes
+        relations.at(i).rel_probability[0] = w_from*relations.at(j).rel_probability[0] + w_to*relations.at(i).rel_probability[0];
+        relations.at(i).rel_probability[1] = 1 - relations.at(j).rel_probability[0];
+        used_relations.at(j) = true;
       }
-      else
+      for(unsigned int k = num_combined; k < rel_from.size(); ++k)
       {
-//         printf("Universe 0 will be added to universe 1\n");
-
-        //id_0 --> id_1
-        for(unsigned int i = 0; i < universe.at(id_0).size(); ++i)
-        {
-          universe.at(id_1).push_back(universe.at(id_0).at(i));
-//           printf("adding surface %d\n",universe.at(id_0).at(i));
-        }
-        universe.at(id_0).clear();
-        threshold.at(id_1) = relations.at(r_idx).rel_probability[0] + THRESHOLD(universe.at(id_1).size(), THRESHOLD_CONSTANT);
-        used_relations.at(r_idx) = true;
-
-        for(unsigned int i = 0; i < relations.size(); ++i)
-        {
-          if(used_relations.at(i))
-            continue;
-
-//           printf("looking at relation %d (%d--%d)\n",i,relations.at(i).id_0,relations.at(i).id_1);
-          
-          if( (relations.at(i).id_0 == id_1) && (relations.at(i).id_1 != id_0) )
-          {
-            int new_id = relations.at(i).id_1;
-            for(unsigned int j = 0; j < relations.size(); ++j)
-            {
-              if(used_relations.at(j))
-                continue;
-              
-              if( ( (relations.at(j).id_0 == new_id) && (relations.at(j).id_1 == id_0) ) || ( (relations.at(j).id_0 == id_0) && (relations.at(j).id_1 == new_id) ) )
-              {
-                //                 relations.at(i).id_1 = id_0;
-                relations.at(i).rel_probability[0] = w_uni1*relations.at(j).rel_probability[0] + w_uni0*relations.at(i).rel_probability[0];
-                relations.at(i).rel_probability[1] = 1 - relations.at(j).rel_probability[0];
-                used_relations.at(j) = true;
-
-//                 printf("relation %d (%d--%d) is eliminated and will be added to relation %d (%d--%d)\n",j,relations.at(j).id_0,relations.at(j).id_1,i,relations.at(i).id_0,relations.at(i).id_1);
-                break;
-              }
-            }
-          }
-          else if( (relations.at(i).id_1 == id_1) && (relations.at(i).id_0 != id_0) )
-          {
-            int new_id = relations.at(i).id_0;
-            for(unsigned int j = 0; j < relations.size(); ++j)
-            {
-              if(used_relations.at(j))
-                continue;
-              
-              if( ( (relations.at(j).id_0 == new_id) && (relations.at(j).id_1 == id_0) ) || ( (relations.at(j).id_0 == id_0) && (relations.at(j).id_1 == new_id) ) )
-              {
-                //                 relations.at(i).id_1 = id_0;
-                relations.at(i).rel_probability[0] = w_uni1*relations.at(j).rel_probability[0] + w_uni0*relations.at(i).rel_probability[0];
-                relations.at(i).rel_probability[1] = 1 - relations.at(j).rel_probability[0];
-                used_relations.at(j) = true;
-
-//                 printf("relation %d (%d--%d) is eliminated and will be added to relation %d (%d--%d)\n",j,relations.at(j).id_0,relations.at(j).id_1,i,relations.at(i).id_0,relations.at(i).id_1);
-                break;
-              }
-            }
-          }
-        }
-
-        for(unsigned int i = 0; i < relations.size(); ++i)
-        {
-          if(used_relations.at(i))
-            continue;
-          
-          if(relations.at(i).id_0 == id_0)
-          {
-//             printf("relation %d (%d--%d) was moved to relation ",i,relations.at(i).id_0,relations.at(i).id_1);
-            relations.at(i).id_0 = id_1;
-//             printf("(%d--%d)\n",i,relations.at(i).id_0,relations.at(i).id_1);
-          }
-          else if(relations.at(i).id_1 == id_0)
-          {
-//             printf("relation %d (%d--%d) was moved to relation ",i,relations.at(i).id_0,relations.at(i).id_1);
-            relations.at(i).id_1 = id_1;
-//             printf("(%d--%d)\n",i,relations.at(i).id_0,relations.at(i).id_1);
-          }
-
-        }
+        int j = rel_from.at(k);
+        if(relations.at(j).id_0 == from)
+          relations.at(j).id_0 = to;
+        else
+          relations.at(j).id_1 = to;
+        rel_to.push_back(j);
       }
+      std::sort(rel_to.begin(),rel_to.end());
+      neighbours.at(new_id)[to] = rel_to;
     }
-
-//     printf("Finished relation!\n");
+    neighbours.at(from).clear();
   }
 
-  printf("Wow, we are here!\n");
-  
-  std::vector<int> universe_number(universe.size(),-1);
+  // number the remaining universes in the order of their ids
+  std::vector<int> universe_number(surfaces.size(),-1);
   int current_uni_number = 0;
-  for(unsigned int i = 0; i < universe.size(); ++i)
+  for(unsigned int i = 0; i < surfaces.size(); ++i)
   {
-    if(universe.at(i).size() > 0)
+    if(universe_surfaces.at(i) > 0)
     {
       universe_number.at(i) = current_uni_number;
       current_uni_number++;
     }
   }
 
-//   printf("And here!\n");
-  
   for(unsigned int i = 0; i < surfaces.size(); ++i)
   {
     surfaces.at(i)->label = -1;
-  }
+    if(!(surfaces.at(i)->selected))
+      continue;
 
-//   printf("And here too!\n");
-  
-  for(unsigned int i = 0; i < universe.size(); ++i)
-  {
-    for(unsigned int j = 0; j < universe.at(i).size(); ++j)
+    int root = i;
+    while(parent.at(root) != root)
+      root = parent.at(root);
+    // path compression
+    for(int k = i; parent.at(k) != root; )
     {
-      int idx = universe.at(i).at(j);
-      surfaces.at(idx)->label = universe_number.at(i);
+      int next = parent.at(k);
+      parent.at(k) = root;
+      k = next;
     }
+
+    surfaces.at(i)->label = universe_number.at(root);
   }
 }
 
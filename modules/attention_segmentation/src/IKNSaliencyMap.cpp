@@ -63,9 +63,9 @@ void IKNSaliencyMap::setWeights(int weightOfColor_, int weightOfIntensities_, in
   weightOfIntensities = weightOfIntensities_;
   weightOfOrientations = weightOfOrientations_;
   calculated = false;
-  printf("[INFO]: %s: weightOfColor: %d.\n",mapName.c_str(),weightOfColor);
-  printf("[INFO]: %s: weightOfIntensities: %d.\n",mapName.c_str(),weightOfIntensities);
-  printf("[INFO]: %s: weightOfOrientations: %d.\n",mapName.c_str(),weightOfOrientations);
+  printInfo("[INFO]: %s: weightOfColor: %d.\n",mapName.c_str(),weightOfColor);
+  printInfo("[INFO]: %s: weightOfIntensities: %d.\n",mapName.c_str(),weightOfIntensities);
+  printInfo("[INFO]: %s: weightOfOrientations: %d.\n",mapName.c_str(),weightOfOrientations);
 }
 
 void IKNSaliencyMap::getWeights(int &weightOfColor_, int &weightOfIntensities_, int &weightOfOrientations_)
@@ -79,7 +79,7 @@ void IKNSaliencyMap::setNumberOfOrientations(int numberOfOrientations_)
 {
   numberOfOrientations = numberOfOrientations_;
   calculated = false;
-  printf("[INFO]: %s: numberOfOrientations: %d.\n",mapName.c_str(),numberOfOrientations);
+  printInfo("[INFO]: %s: numberOfOrientations: %d.\n",mapName.c_str(),numberOfOrientations);
 }
 
 int IKNSaliencyMap::getNumberOfOrientations()
@@ -129,8 +129,10 @@ int IKNSaliencyMap::checkParameters()
   return(AM_OK);
 }
 
-void IKNSaliencyMap::initializePyramid(IttiPyramid::Ptr pyramid, cv::Mat &IM, bool changeSign_)
+void IKNSaliencyMap::initializePyramid(IttiPyramid::Ptr pyramid, cv::Mat &IM, PyramidCache::Ptr cache, const std::string &channel, bool changeSign_)
 {
+  initPyramidCache(pyramid,cache,channel);
+  
   pyramid->setStartLevel(0);//
   pyramid->setMaxLevel(8);//
   pyramid->setSMLevel(4);//
@@ -146,7 +148,8 @@ void IKNSaliencyMap::initializePyramid(IttiPyramid::Ptr pyramid, cv::Mat &IM, bo
   
   pyramid->setImage(IM);
   pyramid->buildPyramid();
-  pyramid->print();
+  if(verbose)
+    pyramid->print();
 }
 
 int IKNSaliencyMap::calculate()
@@ -157,30 +160,31 @@ int IKNSaliencyMap::calculate()
   if(rt_code != AM_OK)
     return(rt_code);
 
-  printf("[INFO]: %s: Computation started.\n",mapName.c_str());
+  printInfo("[INFO]: %s: Computation started.\n",mapName.c_str());
 
-  createColorChannels();
+  PyramidCache::Ptr cache = getFrameCache();
+  createColorChannels(cache);
   
   //----
   // I
   IttiPyramid::Ptr pyramidI( new IttiPyramid() );
-  initializePyramid(pyramidI,I);
+  initializePyramid(pyramidI,I,cache,"ikn_I");
   
   // R
   IttiPyramid::Ptr pyramidR( new IttiPyramid() );
-  initializePyramid(pyramidR,R);
+  initializePyramid(pyramidR,R,cache,"ikn_R");
   
   // G
   IttiPyramid::Ptr pyramidG( new IttiPyramid() );
-  initializePyramid(pyramidG,G);
+  initializePyramid(pyramidG,G,cache,"ikn_G");
   
   // B
   IttiPyramid::Ptr pyramidB( new IttiPyramid() );
-  initializePyramid(pyramidB,B);
+  initializePyramid(pyramidB,B,cache,"ikn_B");
   
   // Y
   IttiPyramid::Ptr pyramidY( new IttiPyramid() );
-  initializePyramid(pyramidY,Y);
+  initializePyramid(pyramidY,Y,cache,"ikn_Y");
   
   // O
   std::vector<IttiPyramid::Ptr> pyramidO;
@@ -188,7 +192,7 @@ int IKNSaliencyMap::calculate()
   for(int i = 0; i < numberOfOrientations; ++ i)
   {
     pyramidO.at(i) = IttiPyramid::Ptr( new IttiPyramid() );
-    initializePyramid(pyramidO.at(i),I);
+    initializePyramid(pyramidO.at(i),I,cache,"ikn_I");
   }
   
   // create feature maps
@@ -199,7 +203,7 @@ int IKNSaliencyMap::calculate()
   for(int i = 0; i < numberOfOrientations; ++ i)
   {
     float angle = i*180.0/numberOfOrientations;
-    rt_code = createFeatureMapsO(pyramidO.at(i),angle);
+    rt_code = createFeatureMapsO(pyramidO.at(i),cache,angle);
     if(rt_code != AM_OK)
       return(rt_code);
   }
@@ -288,13 +292,19 @@ int IKNSaliencyMap::calculate()
   
   calculated = true;
   
-  printf("[INFO]: %s: Computation finished.\n",mapName.c_str());
+  printInfo("[INFO]: %s: Computation finished.\n",mapName.c_str());
 
   return(AM_OK);
 }
 
-void IKNSaliencyMap::createColorChannels()
+void IKNSaliencyMap::createColorChannels(PyramidCache::Ptr cache)
 {
+  if(cache->getChannel(cacheKey("ikn_I"),I) && cache->getChannel(cacheKey("ikn_R"),R) && cache->getChannel(cacheKey("ikn_G"),G) &&
+     cache->getChannel(cacheKey("ikn_B"),B) && cache->getChannel(cacheKey("ikn_Y"),Y))
+  {
+    return;
+  }
+  
   I = cv::Mat_<float>::zeros(height,width);
   R = cv::Mat_<float>::zeros(height,width);
   G = cv::Mat_<float>::zeros(height,width);
@@ -364,13 +374,19 @@ void IKNSaliencyMap::createColorChannels()
       Y.at<float>(r,c) = dY;
     }
   }
+  
+  cache->setChannel(cacheKey("ikn_I"),I);
+  cache->setChannel(cacheKey("ikn_R"),R);
+  cache->setChannel(cacheKey("ikn_G"),G);
+  cache->setChannel(cacheKey("ikn_B"),B);
+  cache->setChannel(cacheKey("ikn_Y"),Y);
 }
 
 int IKNSaliencyMap::createFeatureMapsI(IttiPyramid::Ptr pyramid)
 {
   for(unsigned int i = pyramid->getStartLevel(); i <= (unsigned int)pyramid->getMaxLevel(); ++i)
   {
-    printf("[INFO]: %s: Computating feature map for level %d.\n",mapName.c_str(),i);
+    printInfo("[INFO]: %s: Computating feature map for level %d.\n",mapName.c_str(),i);
 
     cv::Mat current_image;
     if(!pyramid->getImage(i,current_image))
@@ -385,7 +401,7 @@ int IKNSaliencyMap::createFeatureMapsI(IttiPyramid::Ptr pyramid)
      return(AM_CUSTOM);
     }
     
-    printf("[INFO]: %s: Feature map at level %d is set.\n",mapName.c_str(),i);
+    printInfo("[INFO]: %s: Feature map at level %d is set.\n",mapName.c_str(),i);
   }
   // combine saliency maps
   pyramid->combinePyramid(true); 
@@ -394,28 +410,17 @@ int IKNSaliencyMap::createFeatureMapsI(IttiPyramid::Ptr pyramid)
   
 }
   
-int IKNSaliencyMap::createFeatureMapsO(IttiPyramid::Ptr pyramid, float angle)
+int IKNSaliencyMap::createFeatureMapsO(IttiPyramid::Ptr pyramid, PyramidCache::Ptr cache, float angle)
 {
+  // Gabor responses are shared between all maps using the intensity channel
+  std::vector<cv::Mat> responses;
+  cache->getOrientationPyramid(cacheKey("ikn_I"),I,pyramid->getMaxLevel(),angle,responses);
+  
   for(unsigned int i = pyramid->getStartLevel(); i <= (unsigned int)pyramid->getMaxLevel(); ++i)
   {
-    printf("[INFO]: %s: Computating feature map for level %d.\n",mapName.c_str(),i);
+    printInfo("[INFO]: %s: Computating feature map for level %d.\n",mapName.c_str(),i);
 
-    cv::Mat current_image;
-    if(!pyramid->getImage(i,current_image))
-    {
-      printf("[ERROR]: Something went wrong! Can't get image for level %d!\n",i);
-      return(AM_CUSTOM);
-    }
-    
-    cv::Mat gaborKernel0, gaborKernel90;
-    v4r::makeGaborFilter(gaborKernel0,gaborKernel90,angle);
-    cv::Mat temp0, temp90;
-    cv::filter2D(current_image,temp0,-1,gaborKernel0);
-    temp0 = cv::abs(temp0);
-    cv::filter2D(current_image,temp90,-1,gaborKernel90);
-    temp90 = cv::abs(temp90);
-    cv::Mat current_map;
-    cv::add(temp0,temp90,current_map);
+    cv::Mat current_map = responses.at(i);
     
     if(!pyramid->setFeatureMap(i,current_map))
     {
@@ -423,7 +428,7 @@ int IKNSaliencyMap::createFeatureMapsO(IttiPyramid::Ptr pyramid, float angle)
      return(AM_CUSTOM);
     }
     
-    printf("[INFO]: %s: Feature map at level %d is set.\n",mapName.c_str(),i);
+    printInfo("[INFO]: %s: Feature map at level %d is set.\n",mapName.c_str(),i);
   }
   // combine saliency maps
   pyramid->combinePyramid(true); 
@@ -436,7 +441,7 @@ int IKNSaliencyMap::createFeatureMapsRG(IttiPyramid::Ptr pyramidR, IttiPyramid::
 {
   for(unsigned int i = pyramidR->getStartLevel(); i <= (unsigned int)pyramidR->getMaxLevel(); ++i)
   {
-    printf("[INFO]: %s::createFeatureMapsRG: Computating feature map for level %d.\n",mapName.c_str(),i);
+    printInfo("[INFO]: %s::createFeatureMapsRG: Computating feature map for level %d.\n",mapName.c_str(),i);
 
     cv::Mat current_imageR;
     if(!pyramidR->getImage(i,current_imageR))
@@ -460,7 +465,7 @@ int IKNSaliencyMap::createFeatureMapsRG(IttiPyramid::Ptr pyramidR, IttiPyramid::
      return(AM_CUSTOM);
     }
     
-    printf("[INFO]: %s: Feature map at level %d is set.\n",mapName.c_str(),i);
+    printInfo("[INFO]: %s: Feature map at level %d is set.\n",mapName.c_str(),i);
   }
   // combine saliency maps
   pyramidR->combinePyramid(true); 
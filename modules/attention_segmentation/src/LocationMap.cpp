@@ -57,14 +57,14 @@ void LocationSaliencyMap::setLocation(int location_)
 {
   location = location_;
   calculated = false;
-  printf("[INFO]: %s: location is set to: %d\n",mapName.c_str(),location);
+  printInfo("[INFO]: %s: location is set to: %d\n",mapName.c_str(),location);
 }
 
 void LocationSaliencyMap::setCenter(cv::Point _center_point)
 {
   center_point = _center_point;
   calculated = false;
-  printf("[INFO]: %s: center_point is set to: (%d,%d)\n",mapName.c_str(),center_point.x,center_point.y);
+  printInfo("[INFO]: %s: center_point is set to: (%d,%d)\n",mapName.c_str(),center_point.x,center_point.y);
 }
 
 int LocationSaliencyMap::checkParameters()
@@ -95,7 +95,7 @@ int LocationSaliencyMap::calculate()
   if(rt_code != AM_OK)
     return(rt_code);
 
-  printf("[INFO]: %s: Computation started.\n",mapName.c_str());
+  printInfo("[INFO]: %s: Computation started.\n",mapName.c_str());
   
   cv::Point center;
   float a = 1;
@@ -165,7 +165,7 @@ int LocationSaliencyMap::calculate()
   v4r::normalize(map,normalization_type);
 
   calculated = true;
-  printf("[INFO]: %s: Computation succeed.\n",mapName.c_str());
+  printInfo("[INFO]: %s: Computation succeed.\n",mapName.c_str());
   return(AM_OK);
 }
 } //namespace v4r
\ No newline at end of file
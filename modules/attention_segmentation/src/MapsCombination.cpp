@@ -80,4 +80,31 @@ int CombineMaps(std::vector<cv::Mat> &maps, cv::Mat &combinedMap, int combinatio
   }
 }
 
+int CalculateMaps(std::vector<BaseMap*> &maps, PyramidCache::Ptr cache, int pyramidType)
+{
+  std::vector<int> rt_codes(maps.size(),AM_OK);
+  
+  #pragma omp parallel for schedule(dynamic)
+  for(int i = 0; i < (int)maps.size(); ++i)
+  {
+    maps.at(i)->setPyramidCache(cache);
+    
+    if(pyramidType == NO_PYRAMID)
+      rt_codes.at(i) = maps.at(i)->calculate();
+    else
+      rt_codes.at(i) = maps.at(i)->calculatePyramid(pyramidType);
+  }
+  
+  for(unsigned int i = 0; i < rt_codes.size(); ++i)
+  {
+    if(rt_codes.at(i) != AM_OK)
+    {
+      printf("[ERROR] CalculateMaps: computation of %s failed!\n",maps.at(i)->getMapName().c_str());
+      return(rt_codes.at(i));
+    }
+  }
+  
+  return(AM_OK);
+}
+
 }
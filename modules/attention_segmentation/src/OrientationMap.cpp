@@ -59,14 +59,14 @@ void OrientationSaliencyMap::setAngle(float angle_)
 {
   angle = angle_;
   calculated = false;
-  printf("[INFO]: %s: angle: %f.\n",mapName.c_str(),angle);
+  printInfo("[INFO]: %s: angle: %f.\n",mapName.c_str(),angle);
 }
 
 void OrientationSaliencyMap::setBandwidth(float bandwidth_)
 {
   bandwidth = bandwidth_;
   calculated = false;
-  printf("[INFO]: %s: bandwidth: %f.\n",mapName.c_str(),bandwidth);
+  printInfo("[INFO]: %s: bandwidth: %f.\n",mapName.c_str(),bandwidth);
 }
 
 float OrientationSaliencyMap::getAngle()
@@ -129,76 +129,50 @@ int OrientationSaliencyMap::calculate()
   if(rt_code != AM_OK)
     return(rt_code);
 
-  printf("[INFO]: %s: Computation started.\n",mapName.c_str());
+  printInfo("[INFO]: %s: Computation started.\n",mapName.c_str());
   
-  cv::Mat image_cur;
-  image.copyTo(image_cur);
-  image_cur.convertTo(image_cur,CV_32F,1.0f/255);
   cv::Mat image_gray;
-  cv::cvtColor(image_cur,image_gray,CV_BGR2GRAY);
+  createGrayImage(getFrameCache(),image_gray);
   
-  cv::blur(image_gray,image_gray,cv::Size(filter_size,filter_size));
+  cv::Mat image_blurred;
+  cv::blur(image_gray,image_blurred,cv::Size(filter_size,filter_size));
   
-  orientationMap(image_gray,width,height,angle,max_sum,bandwidth,map);
+  orientationMap(image_blurred,width,height,angle,max_sum,bandwidth,map);
   
   cv::blur(map,map,cv::Size(filter_size,filter_size));
 
   v4r::normalize(map,normalization_type);
 
   calculated = true;
-  printf("[INFO]: %s: Computation succeed.\n",mapName.c_str());
+  printInfo("[INFO]: %s: Computation succeed.\n",mapName.c_str());
   return(AM_OK);
 }
 
-void OrientationSaliencyMap::orientationMap(cv::Mat &image_cur, int image_width, int image_height, float angle, float max_sum, float bandwidth, cv::Mat &map_cur)
+/**
+ * gray image in [0,1], shared via cache
+ * */
+void OrientationSaliencyMap::createGrayImage(PyramidCache::Ptr cache, cv::Mat &image_gray)
 {
-  map_cur = cv::Mat_<float>::zeros(image_height,image_width);
+  if(cache->getChannel(cacheKey("gray"),image_gray))
+    return;
+  
+  cv::Mat image_cur;
+  image.convertTo(image_cur,CV_32F,1.0f/255);
+  cv::cvtColor(image_cur,image_gray,CV_BGR2GRAY);
   
+  cache->setChannel(cacheKey("gray"),image_gray);
+}
+
+void OrientationSaliencyMap::orientationMap(cv::Mat &image_cur, int image_width, int image_height, float angle, float max_sum, float bandwidth, cv::Mat &map_cur)
+{
   //create Gabor kernel
   cv::Mat gaborKernel;
   v4r::makeGaborKernel2D(gaborKernel,max_sum,angle,bandwidth);
   assert (gaborKernel.rows == gaborKernel.cols);
   assert (gaborKernel.rows % 2 == 1);
-  int gaborFilerSize = gaborKernel.rows / 2;
   
-  for(int r = 0; r < image_height; ++r)
-  {
-    //for(int c = gaborFilerSize; c < width-gaborFilerSize; ++c)
-    for(int c = 0; c < image_width; ++c)
-    {
-      float value = 0;
-      for(int j = r-gaborFilerSize; j <= r+gaborFilerSize; ++j) // rows
-      {
-	int yy = j;
-	if(j < 0)
-	{
-	  yy = -j;
-	}
-	if(j >= image_height)
-	{
-	  yy = image_height-(j-image_height+1)-1;
-	}
-	  
-	for(int i = c-gaborFilerSize; i <= c+gaborFilerSize; ++i) // cols
-	{
-	  int xx = i;
-	  if(i < 0)
-	  {
-	    xx = -i;
-	  }
-	  if(i >= image_width)
-	  {
-	    xx = image_width-(i-image_width+1)-1;
-	  }
-	    
-	  value += image_cur.at<float>(yy,xx)*gaborKernel.at<float>(j-(r-gaborFilerSize),(i-(c-gaborFilerSize)));
-        }
-      }
-
-      map_cur.at<float>(r,c) = value;
-      
-    }
-  }
+  // correlation with reflected borders
+  cv::filter2D(image_cur,map_cur,CV_32F,gaborKernel,cv::Point(-1,-1),0,cv::BORDER_REFLECT_101);
   
   map_cur = cv::abs(map_cur);
   map_cur = map_cur / max_sum;
@@ -215,10 +189,13 @@ int OrientationSaliencyMap::calculatePyramidSimple()
   if(rt_code != AM_OK)
     return(rt_code);
   
-  printf("[INFO]: %s: Computation Simple pyramid started.\n",mapName.c_str());
+  printInfo("[INFO]: %s: Computation Simple pyramid started.\n",mapName.c_str());
   
   SimplePyramid::Ptr pyramid( new SimplePyramid() );
   
+  PyramidCache::Ptr cache = getFrameCache();
+  initPyramidCache(pyramid,cache,"gray");
+  
   pyramid->setStartLevel(0);
   pyramid->setMaxLevel(6);
   pyramid->setSMLevel(0);
@@ -226,20 +203,18 @@ int OrientationSaliencyMap::calculatePyramidSimple()
   pyramid->setHeight(height);
   pyramid->setNormalizationType(normalization_type);
   
-  cv::Mat image_cur;
-  image.copyTo(image_cur);
-  image_cur.convertTo(image_cur,CV_32F,1.0f/255);
   cv::Mat image_gray;
-  cv::cvtColor(image_cur,image_gray,CV_BGR2GRAY);
+  createGrayImage(cache,image_gray);
   
   pyramid->setImage(image_gray);
   pyramid->buildPyramid();
-  pyramid->print();
+  if(verbose)
+    pyramid->print();
 
   combinePyramid(pyramid);
   
   calculated = true;
-  printf("[INFO]: %s: Pyramid computation succeed.\n",mapName.c_str());
+  printInfo("[INFO]: %s: Pyramid computation succeed.\n",mapName.c_str());
   return(AM_OK);
 }
 
@@ -251,10 +226,13 @@ int OrientationSaliencyMap::calculatePyramidItti()
   if(rt_code != AM_OK)
     return(rt_code);
   
-  printf("[INFO]: %s: Computation Itti pyramid started.\n",mapName.c_str());
+  printInfo("[INFO]: %s: Computation Itti pyramid started.\n",mapName.c_str());
   
   IttiPyramid::Ptr pyramid( new IttiPyramid() );
   
+  PyramidCache::Ptr cache = getFrameCache();
+  initPyramidCache(pyramid,cache,"gray");
+  
   pyramid->setSMLevel(0);
   pyramid->setWidth(width);
   pyramid->setHeight(height);
@@ -267,20 +245,18 @@ int OrientationSaliencyMap::calculatePyramidItti()
   
   pyramid->setChangeSign(false);
   
-  cv::Mat image_cur;
-  image.copyTo(image_cur);
-  image_cur.convertTo(image_cur,CV_32F,1.0f/255);
   cv::Mat image_gray;
-  cv::cvtColor(image_cur,image_gray,CV_BGR2GRAY);
+  createGrayImage(cache,image_gray);
   
   pyramid->setImage(image_gray);
   pyramid->buildPyramid();
-  pyramid->print();
+  if(verbose)
+    pyramid->print();
 
   combinePyramid(pyramid);
   
   calculated = true;
-  printf("[INFO]: %s: Pyramid computation succeed.\n",mapName.c_str());
+  printInfo("[INFO]: %s: Pyramid computation succeed.\n",mapName.c_str());
   return(AM_OK);
 }
 
@@ -292,10 +268,13 @@ int OrientationSaliencyMap::calculatePyramidFrintrop()
   if(rt_code != AM_OK)
     return(rt_code);
   
-  printf("[INFO]: %s: Computation Frintrop pyramid started.\n",mapName.c_str());
+  printInfo("[INFO]: %s: Computation Frintrop pyramid started.\n",mapName.c_str());
   
   FrintropPyramid::Ptr pyramid( new FrintropPyramid() );
   
+  PyramidCache::Ptr cache = getFrameCache();
+  initPyramidCache(pyramid,cache,"gray");
+  
   pyramid->setStartLevel(0);
   pyramid->setMaxLevel(6);
   pyramid->setSMLevel(0);
@@ -308,20 +287,18 @@ int OrientationSaliencyMap::calculatePyramidFrintrop()
   pyramid->setR(R);
   pyramid->setOnSwitch(true);
   
-  cv::Mat image_cur;
-  image.copyTo(image_cur);
-  image_cur.convertTo(image_cur,CV_32F,1.0f/255);
   cv::Mat image_gray;
-  cv::cvtColor(image_cur,image_gray,CV_BGR2GRAY);
+  createGrayImage(cache,image_gray);
   
   pyramid->setImage(image_gray);
   pyramid->buildPyramid();
-  pyramid->print();
+  if(verbose)
+    pyramid->print();
 
   combinePyramid(pyramid);
   
   calculated = true;
-  printf("[INFO]: %s: Pyramid computation succeed.\n",mapName.c_str());
+  printInfo("[INFO]: %s: Pyramid computation succeed.\n",mapName.c_str());
   return(AM_OK);
 }
 
@@ -329,7 +306,7 @@ int OrientationSaliencyMap::combinePyramid(BasePyramid::Ptr pyramid)
 {
   for(unsigned int i = pyramid->getStartLevel(); i <= (unsigned int)pyramid->getMaxLevel(); ++i)
   {
-    printf("[INFO]: %s: Computating feature map for level %d.\n",mapName.c_str(),i);
+    printInfo("[INFO]: %s: Computating feature map for level %d.\n",mapName.c_str(),i);
 
     // start creating parameters
     cv::Mat current_image;
@@ -367,7 +344,7 @@ int OrientationSaliencyMap::combinePyramid(BasePyramid::Ptr pyramid)
      return(AM_CUSTOM);
     }
     
-    printf("[INFO]: %s: Feature map at level %d is set.\n",mapName.c_str(),i);
+    printInfo("[INFO]: %s: Feature map at level %d is set.\n",mapName.c_str(),i);
   }
   // combine saliency maps
   pyramid->combinePyramid(true);
@@ -71,35 +71,35 @@ void RelativeSurfaceOrientationMap::setOrientationNormal(pcl::Normal orientation
   orientation_normal = orientation_normal_;
   haveOrientationNormal = true;
   calculated = false;
-  printf("[INFO]: %s: orientation_normal is set to: (%f,%f,%f)\n",mapName.c_str(),orientation_normal.normal[0],orientation_normal.normal[1],orientation_normal.normal[2]);
+  printInfo("[INFO]: %s: orientation_normal is set to: (%f,%f,%f)\n",mapName.c_str(),orientation_normal.normal[0],orientation_normal.normal[1],orientation_normal.normal[2]);
 }
 
 void RelativeSurfaceOrientationMap::setOrientationType(int orientationType_)
 {
   orientationType = orientationType_;
   calculated = false;
-  printf("[INFO]: %s: orientationType is set to: %d\n",mapName.c_str(),orientationType);
+  printInfo("[INFO]: %s: orientationType is set to: %d\n",mapName.c_str(),orientationType);
 }
 
 void RelativeSurfaceOrientationMap::setNormalThreshold(float normal_threshold_)
 {
   normal_threshold = normal_threshold_;
   calculated = false;
-  printf("[INFO]: %s: heightType is set to: %f\n",mapName.c_str(),normal_threshold);
+  printInfo("[INFO]: %s: heightType is set to: %f\n",mapName.c_str(),normal_threshold);
 }
 
 // void RelativeSurfaceOrientationMap::setCameraParameters(std::vector<float> &cameraParametrs_)
 // {
 //   if(cameraParametrs_.size() != 4)
 //   {
-//     printf("[INFO]: %s: There should be 4 camera parameters! You have %ld\n",mapName.c_str(),cameraParametrs_.size());
+//     printInfo("[INFO]: %s: There should be 4 camera parameters! You have %ld\n",mapName.c_str(),cameraParametrs_.size());
 //     return;
 //   }
 //   
 //   cameraParametrs = cameraParametrs_;
 //   haveCameraParameters = true;
 //   calculated = false;
-//   printf("[INFO]: %s: cameraParametrs is set to: [%f,%f,%f,%f]\n",mapName.c_str(),cameraParametrs.at(0),cameraParametrs.at(1),cameraParametrs.at(2),cameraParametrs.at(3));
+//   printInfo("[INFO]: %s: cameraParametrs is set to: [%f,%f,%f,%f]\n",mapName.c_str(),cameraParametrs.at(0),cameraParametrs.at(1),cameraParametrs.at(2),cameraParametrs.at(3));
 // }
 
 bool RelativeSurfaceOrientationMap::getOrientationNormal(pcl::Normal &orientation_normal_)
@@ -222,7 +222,7 @@ int RelativeSurfaceOrientationMap::calculate()
   if(rt_code != AM_OK)
     return(rt_code);
   
-  printf("[INFO]: %s: Computation started.\n",mapName.c_str());
+  printInfo("[INFO]: %s: Computation started.\n",mapName.c_str());
   
   // Retrieve normal values
   float a = orientation_normal.normal[0];
@@ -247,7 +247,7 @@ int RelativeSurfaceOrientationMap::calculate()
   //v4r::normalize(map,v4r::NT_NONE);
   
   calculated = true;
-  printf("[INFO]: %s: Computation succeed.\n",mapName.c_str());
+  printInfo("[INFO]: %s: Computation succeed.\n",mapName.c_str());
 
   return(AM_OK);
 }
@@ -269,7 +269,7 @@ int RelativeSurfaceOrientationMap::combinePyramid(BasePyramid::Ptr pyramid)
   
   for(unsigned int i = pyramid->getStartLevel(); i <= (unsigned int)pyramid->getMaxLevel(); ++i)
   {
-    printf("[INFO]: %s: Computating feature map for level %d.\n",mapName.c_str(),i);
+    printInfo("[INFO]: %s: Computating feature map for level %d.\n",mapName.c_str(),i);
 
     // start creating parameters
     pcl::PointCloud<pcl::Normal>::Ptr current_normals;
@@ -309,7 +309,7 @@ int RelativeSurfaceOrientationMap::combinePyramid(BasePyramid::Ptr pyramid)
      return(AM_CUSTOM);
     }
     
-    printf("[INFO]: %s: Feature map at level %d is set.\n",mapName.c_str(),i);
+    printInfo("[INFO]: %s: Feature map at level %d is set.\n",mapName.c_str(),i);
   }
   // combine saliency maps
   pyramid->combinePyramid();
@@ -331,10 +331,12 @@ int RelativeSurfaceOrientationMap::calculatePyramidSimple()
   if(rt_code != AM_OK)
     return(rt_code);
   
-  printf("[INFO]: %s: Computation Simple pyramid started.\n",mapName.c_str());
+  printInfo("[INFO]: %s: Computation Simple pyramid started.\n",mapName.c_str());
   
   SimplePyramid::Ptr pyramid( new SimplePyramid() );
   
+  initPyramidCache(pyramid,getFrameCache());
+  
   pyramid->setStartLevel(0);
   pyramid->setMaxLevel(4);
   pyramid->setSMLevel(0);
@@ -348,7 +350,8 @@ int RelativeSurfaceOrientationMap::calculatePyramidSimple()
   pyramid->setNormals(normals);
   
   pyramid->buildDepthPyramid();
-  pyramid->print();
+  if(verbose)
+    pyramid->print();
 
   rt_code = combinePyramid(pyramid);
   if(rt_code != AM_OK)
@@ -359,7 +362,7 @@ int RelativeSurfaceOrientationMap::calculatePyramidSimple()
   //v4r::normalize(map,v4r::NT_NONE);
   
   calculated = true;
-  printf("[INFO]: %s: Pyramid computation succeed.\n",mapName.c_str());
+  printInfo("[INFO]: %s: Pyramid computation succeed.\n",mapName.c_str());
   return(AM_OK);
 }
 
@@ -372,10 +375,12 @@ int RelativeSurfaceOrientationMap::calculatePyramidItti()
   if(rt_code != AM_OK)
     return(rt_code);
   
-  printf("[INFO]: %s: Computation Itti pyramid started.\n",mapName.c_str());
+  printInfo("[INFO]: %s: Computation Itti pyramid started.\n",mapName.c_str());
   
   IttiPyramid::Ptr pyramid( new IttiPyramid() );
   
+  initPyramidCache(pyramid,getFrameCache());
+  
   pyramid->setSMLevel(0);
   pyramid->setWidth(width);
   pyramid->setHeight(height);
@@ -394,7 +399,8 @@ int RelativeSurfaceOrientationMap::calculatePyramidItti()
   pyramid->setNormals(normals);
   
   pyramid->buildDepthPyramid();
-  pyramid->print();
+  if(verbose)
+    pyramid->print();
 
   rt_code = combinePyramid(pyramid);
   if(rt_code != AM_OK)
@@ -405,7 +411,7 @@ int RelativeSurfaceOrientationMap::calculatePyramidItti()
   //v4r::normalize(map,v4r::NT_NONE);
   
   calculated = true;
-  printf("[INFO]: %s: Pyramid computation succeed.\n",mapName.c_str());
+  printInfo("[INFO]: %s: Pyramid computation succeed.\n",mapName.c_str());
   return(AM_OK);
 }
 
@@ -417,10 +423,12 @@ int RelativeSurfaceOrientationMap::calculatePyramidFrintrop()
   if(rt_code != AM_OK)
     return(rt_code);
   
-  printf("[INFO]: %s: Computation Frintrop pyramid started.\n",mapName.c_str());
+  printInfo("[INFO]: %s: Computation Frintrop pyramid started.\n",mapName.c_str());
   
   FrintropPyramid::Ptr pyramid( new FrintropPyramid() );
   
+  initPyramidCache(pyramid,getFrameCache());
+  
   pyramid->setStartLevel(0);
   pyramid->setMaxLevel(6);
   pyramid->setSMLevel(0);
@@ -439,7 +447,8 @@ int RelativeSurfaceOrientationMap::calculatePyramidFrintrop()
   pyramid->setNormals(normals);
   
   pyramid->buildDepthPyramid();
-  pyramid->print();
+  if(verbose)
+    pyramid->print();
 
   rt_code = combinePyramid(pyramid);
   if(rt_code != AM_OK)
@@ -470,7 +479,7 @@ int RelativeSurfaceOrientationMap::calculatePyramidFrintrop()
   //v4r::normalize(map,v4r::NT_NONE);
   
   calculated = true;
-  printf("[INFO]: %s: Pyramid computation succeed.\n",mapName.c_str());
+  printInfo("[INFO]: %s: Pyramid computation succeed.\n",mapName.c_str());
   return(AM_OK);
 }
 
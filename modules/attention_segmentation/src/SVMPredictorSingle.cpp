@@ -32,12 +32,37 @@
 
 #include "v4r/attention_segmentation/SVMPredictorSingle.h"
 
+#include <sstream>
+#include <cmath>
+#include <algorithm>
+
 namespace svm
 {
 
-#define max(x,y) (((x)>(y))?(x):(y))
-#define min(x,y) (((x)<(y))?(x):(y))
+namespace
+{
+
+void destroyModel(svm_model *model)
+{
+  svm_free_and_destroy_model(&model);
+}
+
+inline double powi(double base, int times)
+{
+  double tmp = base, ret = 1.0;
+  for(int t=times; t>0; t/=2)
+  {
+    if(t%2==1) ret*=tmp;
+    tmp = tmp * tmp;
+  }
+  return ret;
+}
+
+}
 
+boost::mutex SVMPredictorSingle::cache_mutex;
+std::map<std::string, SVMPredictorSingle::Model::ConstPtr> SVMPredictorSingle::model_cache;
+std::map<std::string, SVMPredictorSingle::Scaling::ConstPtr> SVMPredictorSingle::scaling_cache;
   
 /**
  * @brief Constructor of SVMPredictorSingle
@@ -47,12 +72,10 @@ SVMPredictorSingle::SVMPredictorSingle()
   have_model_filename = false;
   have_model_node = false;
   have_relations = false;
+  have_surfaces = false;
   predict_probability = true;
   have_type = false;
-  max_nr_attr = 64;
   scale = false;
-  lower = -1.;
-  upper = 1.;
 }
 
 /**
@@ -60,10 +83,6 @@ SVMPredictorSingle::SVMPredictorSingle()
  */
 SVMPredictorSingle::~SVMPredictorSingle()
 {
-  if(have_model_filename)
-    svm_free_and_destroy_model(&model);
-  if(have_model_node)
-    free(node);
 }
 
 void SVMPredictorSingle::setSurfaces(const std::vector<v4r::SurfaceModel::Ptr> _surfaces)
@@ -72,28 +91,71 @@ void SVMPredictorSingle::setSurfaces(const std::vector<v4r::SurfaceModel::Ptr> _
   have_surfaces = true;
 }
 
-void SVMPredictorSingle::setModelFilename(std::string _model_filename) 
-{ 
-  model_filename = _model_filename; 
+/**
+ * @brief Load a libsvm model (or take it from the cache) and prepare the dense support vectors
+ * @param filename Model file
+ */
+SVMPredictorSingle::Model::ConstPtr SVMPredictorSingle::loadModel(const std::string &filename)
+{
+  boost::lock_guard<boost::mutex> lock(cache_mutex);
+  
+  std::map<std::string, Model::ConstPtr>::const_iterator it = model_cache.find(filename);
+  if(it != model_cache.end())
+    return it->second;
   
-  // allocate memory for model (and nodes)
-  if((model=svm_load_model(model_filename.c_str()))==0)
+  struct svm_model *svm_model_ptr;
+  if((svm_model_ptr=svm_load_model(filename.c_str()))==0)
   {
-    fprintf(stderr,"can't open model file %s\n",model_filename.c_str());
+    fprintf(stderr,"can't open model file %s\n",filename.c_str());
     exit(1);
   }
   
+  boost::shared_ptr<Model> m(new Model());
+  m->model.reset(svm_model_ptr, destroyModel);
+  m->probability = (svm_check_probability_model(svm_model_ptr) != 0);
+  
+  // dense copy of the support vectors (feature indices start with 1)
+  int dim = 0;
+  for(int i = 0; i < svm_model_ptr->l; i++)
+    for(const svm_node *n = svm_model_ptr->SV[i]; n->index != -1; ++n)
+      dim = std::max(dim, n->index);
+  
+  m->SV = Eigen::MatrixXd::Zero(svm_model_ptr->l, dim);
+  for(int i = 0; i < svm_model_ptr->l; i++)
+    for(const svm_node *n = svm_model_ptr->SV[i]; n->index != -1; ++n)
+      if(n->index > 0)
+        m->SV(i, n->index-1) = n->value;
+  m->SV_sq_norm = m->SV.rowwise().squaredNorm();
+  
+  if(svm_model_ptr->nSV != NULL)
+  {
+    m->start.resize(svm_model_ptr->nr_class);
+    m->start[0] = 0;
+    for(int i = 1; i < svm_model_ptr->nr_class; i++)
+      m->start[i] = m->start[i-1] + svm_model_ptr->nSV[i-1];
+  }
+  
+  model_cache[filename] = m;
+  return m;
+}
+
+void SVMPredictorSingle::setModelFilename(std::string _model_filename) 
+{ 
+  if(!model || (model_filename != _model_filename))
+    model = loadModel(_model_filename);
+  model_filename = _model_filename;
+  
   have_model_filename = true; 
+  have_model_node = false;
   
-  node = (struct svm_node *) malloc(max_nr_attr*sizeof(struct svm_node));
   if(predict_probability) {
-    if(svm_check_probability_model(model) == 0) {
+    if(!model->probability) {
       printf("[SVMPredictorSingle::SVMPredictorSingle] Error: Model does not support probability estimates.\n");
       return;
     }
   }
   else {
-    if(svm_check_probability_model(model) != 0)
+    if(model->probability)
       printf("[SVMPredictorSingle::SVMPredictorSingle] Warning: Model supports probability estimates, but disabled in prediction.");
   }
   
@@ -102,9 +164,7 @@ void SVMPredictorSingle::setModelFilename(std::string _model_filename)
 
 void SVMPredictorSingle::setRelations(std::vector<v4r::Relation> _relations)
 {
-//   std::cerr << "relations 3 " << _relations.size() << std::endl;
   relations = _relations;
-//   std::cerr << "relations 4 " << relations.size() << std::endl;
   have_relations = true;
 }
 
@@ -151,27 +211,138 @@ void SVMPredictorSingle::compute()
     exit(1);
   }
   
-  //@ep: reallocate node structure according to the size of the feature vector
-  
+  std::vector<int> indices;
+  indices.reserve(relations.size());
   for(unsigned int i = 0; i < relations.size(); i++) 
   {
-//     if(!(relations.at(i).valid))
-//       continue;
-   
     if(relations.at(i).type == type)
-    {
-//       std::cerr << "relations.rel_value " << relations.at(i).rel_value.size() << std::endl;
-      relations.at(i).prediction = predict(relations.at(i).rel_value,relations.at(i).rel_probability);
-    }
-  } 
+      indices.push_back(i);
+  }
   
-//   std::cerr << "relations " << relations.size() << std::endl;
+  const svm_model *m = model->model.get();
+  if((m->param.svm_type == C_SVC || m->param.svm_type == NU_SVC) && (m->param.kernel_type != PRECOMPUTED))
+  {
+    predictBatch(indices);
+  }
+  else
+  {
+    for(unsigned int i = 0; i < indices.size(); i++)
+      relations.at(indices[i]).prediction = predict(relations.at(indices[i]).rel_value,relations.at(indices[i]).rel_probability);
+  }
   
   //@ep: this function seems to be wrong to me
   //checkSmallPatches(30);
 	
 }
 
+/**
+ * @brief Classify the given relations at once (classification models only)
+ * Kernel values of all relations against all support vectors are computed with one matrix product,
+ * decision values and probabilities are then evaluated in parallel for each relation.
+ * @param indices Indices of the relations to classify
+ */
+void SVMPredictorSingle::predictBatch(const std::vector<int> &indices)
+{
+  if(indices.empty())
+    return;
+  
+  const svm_model *m = model->model.get();
+  const int nr_class = m->nr_class;
+  const int nr_pairs = nr_class*(nr_class-1)/2;
+  const bool with_probability = predict_probability && model->probability;
+  const int n = (int)indices.size();
+  const int sv_dim = (int)model->SV.cols();
+  
+  if(scale)
+  {
+    #pragma omp parallel for
+    for(int r = 0; r < n; r++)
+      scaleValues(relations[indices[r]].rel_value);
+  }
+  
+  // features not used by any support vector only contribute to the norm of x
+  Eigen::MatrixXd X = Eigen::MatrixXd::Zero(n, sv_dim);
+  Eigen::VectorXd X_sq_norm(n);
+  for(int r = 0; r < n; r++)
+  {
+    const std::vector<double> &val = relations[indices[r]].rel_value;
+    double sq_norm = 0.;
+    for(unsigned idx = 0; idx < val.size(); idx++)
+    {
+      if((int)idx < sv_dim)
+        X(r,idx) = val[idx];
+      sq_norm += val[idx]*val[idx];
+    }
+    X_sq_norm[r] = sq_norm;
+  }
+  
+  Eigen::MatrixXd K = X * model->SV.transpose();
+  
+  #pragma omp parallel for schedule(dynamic)
+  for(int r = 0; r < n; r++)
+  {
+    v4r::Relation &rel = relations[indices[r]];
+    
+    for(int i = 0; i < m->l; i++)
+    {
+      double &k = K(r,i);
+      switch(m->param.kernel_type)
+      {
+        case POLY:
+          k = powi(m->param.gamma*k + m->param.coef0, m->param.degree);
+          break;
+        case RBF:
+          k = exp(-m->param.gamma * std::max(0., X_sq_norm[r] + model->SV_sq_norm[i] - 2.*k));
+          break;
+        case SIGMOID:
+          k = tanh(m->param.gamma*k + m->param.coef0);
+          break;
+        default:
+          break;
+      }
+    }
+    
+    std::vector<double> dec_values(nr_pairs);
+    std::vector<int> vote(nr_class, 0);
+    int p = 0;
+    for(int i = 0; i < nr_class; i++)
+    {
+      for(int j = i+1; j < nr_class; j++)
+      {
+        const int si = model->start[i];
+        const int sj = model->start[j];
+        double sum = 0.;
+        for(int k = 0; k < m->nSV[i]; k++)
+          sum += m->sv_coef[j-1][si+k] * K(r,si+k);
+        for(int k = 0; k < m->nSV[j]; k++)
+          sum += m->sv_coef[i][sj+k] * K(r,sj+k);
+        dec_values[p] = sum - m->rho[p];
+        
+        if(dec_values[p] > 0)
+          ++vote[i];
+        else
+          ++vote[j];
+        p++;
+      }
+    }
+    
+    rel.rel_probability.clear();
+    if(with_probability)
+    {
+      rel.rel_probability.resize(nr_class);
+      rel.prediction = svm_predict_probability_from_values(m, &dec_values[0], &rel.rel_probability[0]);
+    }
+    else
+    {
+      int vote_max_idx = 0;
+      for(int i = 1; i < nr_class; i++)
+        if(vote[i] > vote[vote_max_idx])
+          vote_max_idx = i;
+      rel.prediction = m->label[vote_max_idx];
+    }
+  }
+}
+
 /**
  * @brief Process the relation extraction algorithm
  * @param type Type of SVM relation
@@ -183,146 +354,136 @@ double SVMPredictorSingle::predict(std::vector<double> &val, std::vector<double>
   if(scale)
     scaleValues(val);
   
-  int svm_type = svm_get_svm_type(model);
-  int nr_class = svm_get_nr_class(model);
-  double *prob_estimates=NULL;
+  const svm_model *m = model->model.get();
+  int svm_type = svm_get_svm_type(m);
+  int nr_class = svm_get_nr_class(m);
   prob.clear();
 
   if(predict_probability) 
   {
     if (svm_type == NU_SVR || svm_type == EPSILON_SVR)
-      printf("Prob. model for test data: target value = predicted value + z,\nz: Laplace distribution e^(-|z|/sigma)/(2sigma),sigma=%g\n", svm_get_svr_probability(model));
-    else
-      prob_estimates = (double *) malloc(nr_class*sizeof(double));
+      printf("Prob. model for test data: target value = predicted value + z,\nz: Laplace distribution e^(-|z|/sigma)/(2sigma),sigma=%g\n", svm_get_svr_probability(m));
   }
   
   // we copy now the feature vector
-  //@ep: BUG in case the number of attributes is bigger than 63 we will run into a bug
-  double predict_label;
+  std::vector<svm_node> node(val.size()+1);
   for(unsigned idx = 0; idx < val.size(); idx++) 
   {
     node[idx].index = idx+1;
     node[idx].value = val.at(idx);
-    node[idx+1].index = -1;
   }
+  node[val.size()].index = -1;
 
+  double predict_label;
   if (predict_probability && (svm_type==C_SVC || svm_type==NU_SVC)) 
   {
-    predict_label = svm_predict_probability(model, node, prob_estimates);
     prob.resize(nr_class);
-    for(int j=0; j <nr_class; j++)
-      prob.at(j) = prob_estimates[j];
+    predict_label = svm_predict_probability(m, &node[0], &prob[0]);
   }
   else
   {
-    predict_label = svm_predict(model, node);
+    predict_label = svm_predict(m, &node[0]);
   }
   
   return predict_label;
 }
 
-
 /**
- * @brief Set scaling for structural level with supplied model.
- * @param _scale on/off
+ * @brief Load scaling parameters written by svm-scale (or take them from the cache)
+ * @param filename Scaling file
+ * @return Scaling parameters, empty if the file can not be opened
  */
-void SVMPredictorSingle::setScaling(bool _scale, std::string filename)
+SVMPredictorSingle::Scaling::ConstPtr SVMPredictorSingle::loadScaling(const std::string &filename)
 {
-  scale = _scale;
-  if(!scale)
-    return;
+  boost::lock_guard<boost::mutex> lock(cache_mutex);
+  
+  std::map<std::string, Scaling::ConstPtr>::const_iterator it = scaling_cache.find(filename);
+  if(it != scaling_cache.end())
+    return it->second;
+  
+  std::ifstream fp(filename.c_str());
+  if( !fp.is_open() )
+    return Scaling::ConstPtr();
   
   printf("Scaling values...\n");
   
-  /* pass 1: find out max index of attributes */
+  boost::shared_ptr<Scaling> s(new Scaling());
+  s->lower = -1.;
+  s->upper = 1.;
+  
+  std::string line;
+  getline(fp,line);
+  getline(fp,line);
+  std::stringstream ss;
+  ss << line;
+  ss >> s->lower >> s->upper;
+  
   int max_index = 0;
-  //int min_index = 1;
-
-  std::ifstream fp1(filename.c_str());
-  if( fp1.is_open() )
+  std::vector<int> indices;
+  std::vector<double> min_values, max_values;
+  while( fp.good() )
   {
-    std::string line;
-    getline(fp1,line);
-    getline(fp1,line);
-    std::stringstream ss;
-    ss << line;
-    ss >> lower >> upper;
+    std::string line2;
+    getline(fp,line2);
     
-    while( fp1.good() )
-    {
-      std::string line2;
-      getline(fp1,line2);
-      
-      if(line2.empty())
-	break;
-      
-      std::stringstream ss2;
-      ss2 << line2;
-      
-      int index;
-      double min_value, max_value;
-      ss2 >> index >> min_value >> max_value;
-      
-      if(index > max_index)
-	max_index = index;
-    }
-    fp1.close();
-  }
-  else
-  {
-    scale = false;
-    return;
+    if(line2.empty())
+      break;
+    
+    std::stringstream ss2;
+    ss2 << line2;
+    
+    int index;
+    double min_value, max_value;
+    ss2 >> index >> min_value >> max_value;
+    
+    indices.push_back(index);
+    min_values.push_back(min_value);
+    max_values.push_back(max_value);
+    if(index > max_index)
+      max_index = index;
   }
+  fp.close();
   
-  feature_max.resize(max_index+1);
-  feature_min.resize(max_index+1);
-  feature_scaled.resize(max_index+1);
-  
-  for(int i = 0; i <= max_index; ++i)
+  s->feature_max.assign(max_index+1, 0.);
+  s->feature_min.assign(max_index+1, 0.);
+  s->feature_scaled.assign(max_index+1, false);
+  for(unsigned i = 0; i < indices.size(); i++)
   {
-    feature_min.at(i) = 0;
-    feature_max.at(i) = 0;
-    feature_scaled.at(i) = false;
+    s->feature_min.at(indices[i]) = min_values[i];
+    s->feature_max.at(indices[i]) = max_values[i];
+    s->feature_scaled.at(indices[i]) = true;
   }
   
-  std::ifstream fp2(filename.c_str());
-  if( fp2.is_open() )
-  {
-    std::string line;
-    getline(fp2,line);
-    getline(fp2,line);
-    
-    while( fp2.good() )
-    {
-      std::string line2;
-      getline(fp2,line2);
-      
-      if(line2.empty())
-	break;
-      
-      std::stringstream ss;
-      ss << line2;
-      
-      int index;
-      double min_value, max_value;
-      ss >> index >> min_value >> max_value;
-      
-      feature_min.at(index) = min_value;
-      feature_max.at(index) = max_value;
-      feature_scaled.at(index) = true;
-    }
-    fp2.close();
-  }
-  else
-  {
-    scale = false;
+  scaling_cache[filename] = s;
+  return s;
+}
+
+/**
+ * @brief Set scaling for structural level with supplied model.
+ * @param _scale on/off
+ */
+void SVMPredictorSingle::setScaling(bool _scale, std::string filename)
+{
+  scale = _scale;
+  if(!scale)
     return;
-  }
   
+  if(!scaling || (scaling_filename != filename))
+    scaling = loadScaling(filename);
+  scaling_filename = filename;
+  
+  if(!scaling)
+    scale = false;
 }
 
-void SVMPredictorSingle::scaleValues(std::vector<double> &val)
+void SVMPredictorSingle::scaleValues(std::vector<double> &val) const
 {
+  const std::vector<double> &feature_min = scaling->feature_min;
+  const std::vector<double> &feature_max = scaling->feature_max;
+  const std::vector<bool> &feature_scaled = scaling->feature_scaled;
+  const double lower = scaling->lower;
+  const double upper = scaling->upper;
+  
   if((val.size()+1) != feature_min.size())
   {
     printf("SVMPredictorSingle::scaleValues val.size %d != feature_min.size %d\n", (int)val.size(), (int)feature_min.size());
@@ -354,6 +515,13 @@ void SVMPredictorSingle::scaleValues(std::vector<double> &val)
   }
 }
 
+void SVMPredictorSingle::clearCache()
+{
+  boost::lock_guard<boost::mutex> lock(cache_mutex);
+  model_cache.clear();
+  scaling_cache.clear();
+}
+
 /** HACK: We do not allow small patches to be connected to two big patches. **/
 void SVMPredictorSingle::checkSmallPatches(unsigned int max_size)
 {
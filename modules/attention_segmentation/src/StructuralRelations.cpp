@@ -114,7 +114,9 @@ void StructuralRelations::init()
   
   if(usedRelations & R_GS)
   {
-    permanentGabor.reset( new Gabor() );
+    // keep the filter bank over frames (kernel spectra are only recomputed if the image size changes)
+    if(!permanentGabor)
+      permanentGabor.reset( new Gabor() );
     permanentGabor->setInputImage(gray_image2); //gray_image
     permanentGabor->computeGaborFilters();
     
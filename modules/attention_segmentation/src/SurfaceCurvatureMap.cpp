@@ -100,7 +100,7 @@ void SurfaceCurvatureMap::setCurvatureType(int curvatureType_)
 {
   curvatureType = curvatureType_;
   calculated = false;
-  printf("[INFO]: %s: curvatureType: %d.\n",mapName.c_str(),curvatureType);
+  printInfo("[INFO]: %s: curvatureType: %d.\n",mapName.c_str(),curvatureType);
 }
 
 int SurfaceCurvatureMap::getCurvatureType()
@@ -116,7 +116,7 @@ int SurfaceCurvatureMap::calculate()
   if(rt_code != AM_OK)
     return(rt_code);
   
-  printf("[INFO]: %s: Computation started.\n",mapName.c_str());
+  printInfo("[INFO]: %s: Computation started.\n",mapName.c_str());
   
   float curvatureCoefficient = getCurvatureCoefficient(curvatureType);
 
@@ -128,7 +128,7 @@ int SurfaceCurvatureMap::calculate()
   
   v4r::normalize(map,normalization_type);
   calculated = true;
-  printf("[INFO]: %s: Computation succeed.\n",mapName.c_str());
+  printInfo("[INFO]: %s: Computation succeed.\n",mapName.c_str());
 
   return(AM_OK);
 }
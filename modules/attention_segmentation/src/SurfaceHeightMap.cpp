@@ -71,7 +71,7 @@ void SurfaceHeightSaliencyMap::setModelCoefficients(pcl::ModelCoefficients::Ptr
   coefficients = coefficients_;
   haveModelCoefficients = true;
   calculated = false;
-  printf("[INFO]: %s: model coefficients are [ ",mapName.c_str());
+  printInfo("[INFO]: %s: model coefficients are [ ",mapName.c_str());
   for(size_t i = 0; i < coefficients->values.size(); ++i)
   {
     printf("%f, ",coefficients->values.at(i));
@@ -83,21 +83,21 @@ void SurfaceHeightSaliencyMap::setDistanceFromTop(float distance_from_top_)
 {
   distance_from_top = distance_from_top_;
   calculated = false;
-  printf("[INFO]: %s: distance_from_top is set to: %f\n",mapName.c_str(),distance_from_top);
+  printInfo("[INFO]: %s: distance_from_top is set to: %f\n",mapName.c_str(),distance_from_top);
 }
 
 void SurfaceHeightSaliencyMap::setMaxDistance(int max_distance_)
 {
   max_distance = max_distance_;
   calculated = false;
-  printf("[INFO]: %s: max_distance is set to: %f\n",mapName.c_str(),max_distance);
+  printInfo("[INFO]: %s: max_distance is set to: %f\n",mapName.c_str(),max_distance);
 }
 
 void SurfaceHeightSaliencyMap::setHeightType(int heightType_)
 {
   heightType = heightType_;
   calculated = false;
-  printf("[INFO]: %s: heightType is set to: %d\n",mapName.c_str(),heightType);
+  printInfo("[INFO]: %s: heightType is set to: %d\n",mapName.c_str(),heightType);
 }
 
 bool SurfaceHeightSaliencyMap::getModelCoefficients(pcl::ModelCoefficients::Ptr &coefficients_)
@@ -198,7 +198,7 @@ int SurfaceHeightSaliencyMap::calculateHeightMap()
     return(AM_OK);
   }
   
-  printf("[INFO]: %s: Computation started.\n",mapName.c_str());
+  printInfo("[INFO]: %s: Computation started.\n",mapName.c_str());
   
   calculateHeightMap(cloud,indices,width,height,heightCoefficient,map);
 
@@ -210,7 +210,7 @@ int SurfaceHeightSaliencyMap::calculateHeightMap()
   //v4r::normalize(map,v4r::NT_NONE);
   
   calculated = true;
-  printf("[INFO]: %s: Computation succeed.\n",mapName.c_str());
+  printInfo("[INFO]: %s: Computation succeed.\n",mapName.c_str());
   return(AM_OK);
 }
 
@@ -337,7 +337,7 @@ int SurfaceHeightSaliencyMap::calculatePointDistanceMap()
   if(rt_code != AM_OK)
     return(rt_code);
   
-  printf("[INFO]: %s: Computation started.\n",mapName.c_str());
+  printInfo("[INFO]: %s: Computation started.\n",mapName.c_str());
 
   rt_code = calculatePointDistanceMap(cloud,indices,width,height,map);
   if(rt_code != AM_OK)
@@ -351,7 +351,7 @@ int SurfaceHeightSaliencyMap::calculatePointDistanceMap()
   //v4r::normalize(map,v4r::NT_NONE);
   
   calculated = true;
-  printf("[INFO]: %s: Computation succeed.\n",mapName.c_str());
+  printInfo("[INFO]: %s: Computation succeed.\n",mapName.c_str());
   return(AM_OK);
 }
 
@@ -422,10 +422,12 @@ int SurfaceHeightSaliencyMap::calculatePyramidSimple()
   if(rt_code != AM_OK)
     return(rt_code);
   
-  printf("[INFO]: %s: Computation Simple pyramid started.\n",mapName.c_str());
+  printInfo("[INFO]: %s: Computation Simple pyramid started.\n",mapName.c_str());
   
   SimplePyramid::Ptr pyramid( new SimplePyramid() );
   
+  initPyramidCache(pyramid,getFrameCache());
+  
   pyramid->setStartLevel(0);
   pyramid->setMaxLevel(4);
   pyramid->setSMLevel(0);
@@ -439,7 +441,8 @@ int SurfaceHeightSaliencyMap::calculatePyramidSimple()
   pyramid->setNormals(normals);
   
   pyramid->buildDepthPyramid();
-  pyramid->print();
+  if(verbose)
+    pyramid->print();
 
   rt_code = combinePyramid(pyramid);
   if(rt_code != AM_OK)
@@ -450,7 +453,7 @@ int SurfaceHeightSaliencyMap::calculatePyramidSimple()
   //v4r::normalize(map,v4r::NT_NONE);
   
   calculated = true;
-  printf("[INFO]: %s: Pyramid computation succeed.\n",mapName.c_str());
+  printInfo("[INFO]: %s: Pyramid computation succeed.\n",mapName.c_str());
   return(AM_OK);
 }
 
@@ -462,10 +465,12 @@ int SurfaceHeightSaliencyMap::calculatePyramidItti()
   if(rt_code != AM_OK)
     return(rt_code);
   
-  printf("[INFO]: %s: Computation Itti pyramid started.\n",mapName.c_str());
+  printInfo("[INFO]: %s: Computation Itti pyramid started.\n",mapName.c_str());
   
   IttiPyramid::Ptr pyramid( new IttiPyramid() );
   
+  initPyramidCache(pyramid,getFrameCache());
+  
   pyramid->setSMLevel(0);
   pyramid->setWidth(width);
   pyramid->setHeight(height);
@@ -484,7 +489,8 @@ int SurfaceHeightSaliencyMap::calculatePyramidItti()
   pyramid->setNormals(normals);
   
   pyramid->buildDepthPyramid();
-  pyramid->print();
+  if(verbose)
+    pyramid->print();
 
   rt_code = combinePyramid(pyramid);
   if(rt_code != AM_OK)
@@ -495,7 +501,7 @@ int SurfaceHeightSaliencyMap::calculatePyramidItti()
   //v4r::normalize(map,v4r::NT_NONE);
   
   calculated = true;
-  printf("[INFO]: %s: Pyramid computation succeed.\n",mapName.c_str());
+  printInfo("[INFO]: %s: Pyramid computation succeed.\n",mapName.c_str());
   return(AM_OK);
 }
 
@@ -507,12 +513,14 @@ int SurfaceHeightSaliencyMap::calculatePyramidFrintrop()
   if(rt_code != AM_OK)
     return(rt_code);
   
-  printf("[INFO]: %s: Computation Frintrop pyramid started.\n",mapName.c_str());
+  printInfo("[INFO]: %s: Computation Frintrop pyramid started.\n",mapName.c_str());
   
   //ON pyramid
   
   FrintropPyramid::Ptr pyramid( new FrintropPyramid() );
   
+  initPyramidCache(pyramid,getFrameCache());
+  
   pyramid->setStartLevel(2);
   pyramid->setMaxLevel(4);
   pyramid->setSMLevel(0);
@@ -531,7 +539,8 @@ int SurfaceHeightSaliencyMap::calculatePyramidFrintrop()
   pyramid->setNormals(normals);
   
   pyramid->buildDepthPyramid();
-  pyramid->print();
+  if(verbose)
+    pyramid->print();
 
   rt_code = combinePyramid(pyramid);
   if(rt_code != AM_OK)
@@ -562,7 +571,7 @@ int SurfaceHeightSaliencyMap::calculatePyramidFrintrop()
   //v4r::normalize(map,v4r::NT_NONE);
   
   calculated = true;
-  printf("[INFO]: %s: Pyramid computation succeed.\n",mapName.c_str());
+  printInfo("[INFO]: %s: Pyramid computation succeed.\n",mapName.c_str());
   return(AM_OK);
 }
   
@@ -570,7 +579,7 @@ int SurfaceHeightSaliencyMap::combinePyramid(BasePyramid::Ptr pyramid)
 {
   for(unsigned int i = pyramid->getStartLevel(); i <= (unsigned int)pyramid->getMaxLevel(); ++i)
   {
-    printf("[INFO]: %s: Computating feature map for level %d.\n",mapName.c_str(),i);
+    printInfo("[INFO]: %s: Computating feature map for level %d.\n",mapName.c_str(),i);
 
     // start creating parameters
     pcl::PointCloud<pcl::PointXYZRGB>::Ptr current_cloud;
@@ -643,7 +652,7 @@ int SurfaceHeightSaliencyMap::combinePyramid(BasePyramid::Ptr pyramid)
      return(AM_CUSTOM);
     }
     
-    printf("[INFO]: %s: Feature map at level %d is set.\n",mapName.c_str(),i);
+    printInfo("[INFO]: %s: Feature map at level %d is set.\n",mapName.c_str(),i);
   }
   // combine saliency maps
   pyramid->combinePyramid();
@@ -150,7 +150,7 @@ void Symmetry3DMap::setR(int R_)
 {
   R = R_;
   calculated = false;
-  printf("[INFO]: %s: R: %d.\n",mapName.c_str(),R);
+  printInfo("[INFO]: %s: R: %d.\n",mapName.c_str(),R);
 }
 
 int Symmetry3DMap::getR()
@@ -183,7 +183,7 @@ int Symmetry3DMap::calculate()
   if(rt_code != AM_OK)
     return(rt_code);
   
-  printf("[INFO]: %s: Computation started.\n",mapName.c_str());
+  printInfo("[INFO]: %s: Computation started.\n",mapName.c_str());
   
   symmetry3DMap(cloud,normals,indices,width,height,R,map,filter_size);
   
@@ -194,7 +194,7 @@ int Symmetry3DMap::calculate()
   v4r::normalize(map,normalization_type);
   //v4r::normalize(map,v4r::NT_NONE);
   calculated = true;
-  printf("[INFO]: %s: Computation succeed.\n",mapName.c_str());
+  printInfo("[INFO]: %s: Computation succeed.\n",mapName.c_str());
 
   return(AM_OK);
 }
@@ -459,10 +459,12 @@ int Symmetry3DMap::calculatePyramidSimple()
   if(rt_code != AM_OK)
     return(rt_code);
   
-  printf("[INFO]: %s: Computation Simple pyramid started.\n",mapName.c_str());
+  printInfo("[INFO]: %s: Computation Simple pyramid started.\n",mapName.c_str());
   
   SimplePyramid::Ptr pyramid( new SimplePyramid() );
   
+  initPyramidCache(pyramid,getFrameCache());
+  
   pyramid->setStartLevel(0);
   pyramid->setMaxLevel(2);
   pyramid->setSMLevel(0);
@@ -476,7 +478,8 @@ int Symmetry3DMap::calculatePyramidSimple()
   pyramid->setNormals(normals);
   
   pyramid->buildDepthPyramid();
-  pyramid->print();
+  if(verbose)
+    pyramid->print();
 
   rt_code = combinePyramid(pyramid);
   if(rt_code != AM_OK)
@@ -487,7 +490,7 @@ int Symmetry3DMap::calculatePyramidSimple()
   //v4r::normalize(map,v4r::NT_NONE);
   
   calculated = true;
-  printf("[INFO]: %s: Pyramid computation succeed.\n",mapName.c_str());
+  printInfo("[INFO]: %s: Pyramid computation succeed.\n",mapName.c_str());
   return(AM_OK);
 }
 
@@ -499,10 +502,12 @@ int Symmetry3DMap::calculatePyramidItti()
   if(rt_code != AM_OK)
     return(rt_code);
   
-  printf("[INFO]: %s: Computation Itti pyramid started.\n",mapName.c_str());
+  printInfo("[INFO]: %s: Computation Itti pyramid started.\n",mapName.c_str());
   
   IttiPyramid::Ptr pyramid( new IttiPyramid() );
   
+  initPyramidCache(pyramid,getFrameCache());
+  
   pyramid->setSMLevel(0);
   pyramid->setWidth(width);
   pyramid->setHeight(height);
@@ -521,7 +526,8 @@ int Symmetry3DMap::calculatePyramidItti()
   pyramid->setNormals(normals);
   
   pyramid->buildDepthPyramid();
-  pyramid->print();
+  if(verbose)
+    pyramid->print();
 
   rt_code = combinePyramid(pyramid);
   if(rt_code != AM_OK)
@@ -532,7 +538,7 @@ int Symmetry3DMap::calculatePyramidItti()
   //v4r::normalize(map,v4r::NT_NONE);
   
   calculated = true;
-  printf("[INFO]: %s: Pyramid computation succeed.\n",mapName.c_str());
+  printInfo("[INFO]: %s: Pyramid computation succeed.\n",mapName.c_str());
   return(AM_OK);
 }
 
@@ -544,10 +550,12 @@ int Symmetry3DMap::calculatePyramidFrintrop()
   if(rt_code != AM_OK)
     return(rt_code);
   
-  printf("[INFO]: %s: Computation Frintrop pyramid started.\n",mapName.c_str());
+  printInfo("[INFO]: %s: Computation Frintrop pyramid started.\n",mapName.c_str());
   
   FrintropPyramid::Ptr pyramid( new FrintropPyramid() );
   
+  initPyramidCache(pyramid,getFrameCache());
+  
   pyramid->setStartLevel(0);
   pyramid->setMaxLevel(4);
   pyramid->setSMLevel(0);
@@ -566,7 +574,8 @@ int Symmetry3DMap::calculatePyramidFrintrop()
   pyramid->setNormals(normals);
   
   pyramid->buildDepthPyramid();
-  pyramid->print();
+  if(verbose)
+    pyramid->print();
 
   rt_code = combinePyramid(pyramid);
   if(rt_code != AM_OK)
@@ -597,7 +606,7 @@ int Symmetry3DMap::calculatePyramidFrintrop()
   //v4r::normalize(map,v4r::NT_NONE);
   
   calculated = true;
-  printf("[INFO]: %s: Pyramid computation succeed.\n",mapName.c_str());
+  printInfo("[INFO]: %s: Pyramid computation succeed.\n",mapName.c_str());
   return(AM_OK);
 }
 
@@ -605,7 +614,7 @@ int Symmetry3DMap::combinePyramid(BasePyramid::Ptr pyramid)
 {
   for(unsigned int i = pyramid->getStartLevel(); i <= (unsigned int)pyramid->getMaxLevel(); ++i)
   {
-    printf("[INFO]: %s: Computating feature map for level %d.\n",mapName.c_str(),i);
+    printInfo("[INFO]: %s: Computating feature map for level %d.\n",mapName.c_str(),i);
 
     // start creating parameters
     pcl::PointCloud<pcl::PointXYZRGB>::Ptr current_cloud;
@@ -658,7 +667,7 @@ int Symmetry3DMap::combinePyramid(BasePyramid::Ptr pyramid)
      return(AM_CUSTOM);
     }
     
-    printf("[INFO]: %s: Feature map at level %d is set.\n",mapName.c_str(),i);
+    printInfo("[INFO]: %s: Feature map at level %d is set.\n",mapName.c_str(),i);
   }
   // combine saliency maps
   pyramid->combinePyramid();
@@ -81,21 +81,21 @@ void SymmetryMap::setR1(int R1_)
 {
   R1 = R1_;
   calculated = false;
-  printf("[INFO]: %s: R1: %d.\n",mapName.c_str(),R1);
+  printInfo("[INFO]: %s: R1: %d.\n",mapName.c_str(),R1);
 }
 
 void SymmetryMap::setR2(int R2_)
 {
   R2 = R2_;
   calculated = false;
-  printf("[INFO]: %s: R2: %d.\n",mapName.c_str(),R2);
+  printInfo("[INFO]: %s: R2: %d.\n",mapName.c_str(),R2);
 }
 
 void SymmetryMap::setS(int S_)
 {
   S = S_;
   calculated = false;
-  printf("[INFO]: %s: S: %d.\n",mapName.c_str(),S);
+  printInfo("[INFO]: %s: S: %d.\n",mapName.c_str(),S);
 }
 
 int SymmetryMap::getR1()
@@ -200,7 +200,7 @@ int SymmetryMap::calculate()
   if(rt_code != AM_OK)
     return(rt_code);
 
-  printf("[INFO]: %s: Computation started.\n",mapName.c_str());
+  printInfo("[INFO]: %s: Computation started.\n",mapName.c_str());
   
   initialize();
   
@@ -215,7 +215,7 @@ int SymmetryMap::calculate()
   v4r::normalize(map,normalization_type);
 
   calculated = true;
-  printf("[INFO]: %s: Computation succeed.\n",mapName.c_str());
+  printInfo("[INFO]: %s: Computation succeed.\n",mapName.c_str());
   return(AM_OK);
 }
 
@@ -228,12 +228,14 @@ int SymmetryMap::calculatePyramidSimple()
   if(rt_code != AM_OK)
     return(rt_code);
   
-  printf("[INFO]: %s: Computation Simple pyramid started.\n",mapName.c_str());
+  printInfo("[INFO]: %s: Computation Simple pyramid started.\n",mapName.c_str());
   
   initialize();
   
   SimplePyramid::Ptr pyramid( new SimplePyramid() );
   
+  initPyramidCache(pyramid,getFrameCache(),"gray_rgb");
+  
   pyramid->setStartLevel(1);
   pyramid->setMaxLevel(5);
   pyramid->setSMLevel(0);
@@ -250,12 +252,13 @@ int SymmetryMap::calculatePyramidSimple()
   
   pyramid->setImage(image_cur);
   pyramid->buildPyramid();
-  pyramid->print();
+  if(verbose)
+    pyramid->print();
 
   combinePyramid(pyramid);
   
   calculated = true;
-  printf("[INFO]: %s: Pyramid computation succeed.\n",mapName.c_str());
+  printInfo("[INFO]: %s: Pyramid computation succeed.\n",mapName.c_str());
   return(AM_OK);
 }
 
@@ -263,7 +266,7 @@ int SymmetryMap::combinePyramid(BasePyramid::Ptr pyramid)
 {
   for(unsigned int i = pyramid->getStartLevel(); i <= (unsigned int)pyramid->getMaxLevel(); ++i)
   {
-    printf("[INFO]: %s: Computating feature map for level %d.\n",mapName.c_str(),i);
+    printInfo("[INFO]: %s: Computating feature map for level %d.\n",mapName.c_str(),i);
 
     // start creating parameters
     cv::Mat current_image;
@@ -296,7 +299,7 @@ int SymmetryMap::combinePyramid(BasePyramid::Ptr pyramid)
      return(AM_CUSTOM);
     }
     
-    printf("[INFO]: %s: Feature map at level %d is set.\n",mapName.c_str(),i);
+    printInfo("[INFO]: %s: Feature map at level %d is set.\n",mapName.c_str(),i);
   }
   // combine saliency maps
   pyramid->combinePyramid(true);
@@ -16,7 +16,7 @@ along with this program; if not, write to the Free Software
 Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
 */
 
-// disjoint-set forests using union-by-rank and path compression (sort of).
+// disjoint-set forests using union-by-size and path compression.
 
 #include "v4r/attention_segmentation/disjoint-set.h"
 
@@ -43,20 +43,24 @@ int universe::find(int x) {
   while (y != elts[y].p) {
     y = elts[y].p;
   }
-  elts[x].p = y;
+  // full path compression
+  while (x != y) {
+    int p = elts[x].p;
+    elts[x].p = y;
+    x = p;
+  }
   return y;
 }
 
+// union by size (x and y have to be roots)
 void universe::join(int x, int y) 
 {
-  if (elts[x].rank > elts[y].rank) {
+  if (elts[x].size > elts[y].size) {
     elts[y].p = x;
     elts[x].size += elts[y].size;
   } else {
     elts[x].p = y;
     elts[y].size += elts[x].size;
-    if (elts[x].rank == elts[y].rank)
-      elts[y].rank++;
   }
   num--;
 }
@@ -24,6 +24,8 @@
 
 #include "v4r/attention_segmentation/pyramidBase.h"
 
+#include <stdarg.h>
+
 namespace v4r
 {
 
@@ -55,9 +57,45 @@ void BasePyramid::reset()
   haveNormalPyramid = false;
   haveIndicePyramid = false;
 
+  cache.reset();
+  cacheChannel = "";
+  verbose = false;
+
   pyramidName = "BasePyramid";
 }
 
+void BasePyramid::printInfo(const char *format, ...) const
+{
+  if(!verbose)
+    return;
+  
+  va_list args;
+  va_start(args,format);
+  vprintf(format,args);
+  va_end(args);
+}
+
+void BasePyramid::setCache(PyramidCache::Ptr cache_, const std::string &cacheChannel_)
+{
+  cache = cache_;
+  cacheChannel = cacheChannel_;
+  calculated = false;
+  haveImagePyramid = false;
+  haveDepthPyramid = false;
+  haveNormalPyramid = false;
+  haveIndicePyramid = false;
+}
+
+void BasePyramid::setVerbose(bool verbose_)
+{
+  verbose = verbose_;
+}
+
+bool BasePyramid::getVerbose()
+{
+  return(verbose);
+}
+
 void BasePyramid::setStartLevel(int start_level_)
 {
   start_level = start_level_;
@@ -66,7 +104,7 @@ void BasePyramid::setStartLevel(int start_level_)
   haveDepthPyramid = false;
   haveNormalPyramid = false;
   haveIndicePyramid = false;
-  printf("[INFO]: %s: start_level is set to: %d\n",pyramidName.c_str(),start_level);
+  printInfo("[INFO]: %s: start_level is set to: %d\n",pyramidName.c_str(),start_level);
 }
 
 int BasePyramid::getStartLevel()
@@ -82,7 +120,7 @@ void BasePyramid::setMaxLevel(int max_level_)
   haveDepthPyramid = false;
   haveNormalPyramid = false;
   haveIndicePyramid = false;
-  printf("[INFO]: %s: max_level is set to: %d\n",pyramidName.c_str(),max_level);
+  printInfo("[INFO]: %s: max_level is set to: %d\n",pyramidName.c_str(),max_level);
 }
 
 int BasePyramid::getMaxLevel()
@@ -97,7 +135,7 @@ void BasePyramid::setSMLevel(int sm_level_)
   haveImagePyramid = false;
   haveDepthPyramid = false;
   haveNormalPyramid = false;
-  printf("[INFO]: %s: sm_level is set to: %d\n",pyramidName.c_str(),sm_level);
+  printInfo("[INFO]: %s: sm_level is set to: %d\n",pyramidName.c_str(),sm_level);
 }
 
 int BasePyramid::getSMLevel()
@@ -113,7 +151,7 @@ void BasePyramid::setNormalizationType(int normalization_type_)
   haveDepthPyramid = false;
   haveNormalPyramid = false;
   haveIndicePyramid = false;
-  printf("[INFO]: %s: normalization_type is set to: %d\n",pyramidName.c_str(),normalization_type);
+  printInfo("[INFO]: %s: normalization_type is set to: %d\n",pyramidName.c_str(),normalization_type);
 }
 
 int BasePyramid::getNormalizationType()
@@ -126,7 +164,7 @@ void BasePyramid::setWidth(int width_)
   width = width_;
   calculated = false;
   haveImagePyramid = false;
-  printf("[INFO]: %s: width is set to: %d\n",pyramidName.c_str(),width);
+  printInfo("[INFO]: %s: width is set to: %d\n",pyramidName.c_str(),width);
 }
 
 int BasePyramid::getWidth()
@@ -150,7 +188,7 @@ void BasePyramid::setHeight(int height_)
   height = height_;
   calculated = false;
   haveImagePyramid = false;
-  printf("[INFO]: %s: height is set to: %d\n",pyramidName.c_str(),height);
+  printInfo("[INFO]: %s: height is set to: %d\n",pyramidName.c_str(),height);
 }
 
 int BasePyramid::getHeight()
@@ -173,7 +211,7 @@ void BasePyramid::setCombinationType(int combination_type_)
 {
   combination_type = combination_type_;
   calculated = false;
-  printf("[INFO]: %s: combination_type is set to: %d\n",pyramidName.c_str(),combination_type);
+  printInfo("[INFO]: %s: combination_type is set to: %d\n",pyramidName.c_str(),combination_type);
 }
 
 int BasePyramid::getCombinationType()
@@ -184,7 +222,7 @@ int BasePyramid::getCombinationType()
 void BasePyramid::setImage(cv::Mat &image_)
 {
   image_.copyTo(image);
-  printf("[INFO]: %s: image is set\n",pyramidName.c_str());
+  printInfo("[INFO]: %s: image is set\n",pyramidName.c_str());
   width = image.cols;
   height = image.rows;
   haveImage = true;
@@ -220,7 +258,7 @@ bool BasePyramid::getImage(unsigned int level, cv::Mat &image_)
 void BasePyramid::setCloud(pcl::PointCloud<pcl::PointXYZRGB>::Ptr &cloud_)
 { 
   cloud = cloud_;
-  printf("[INFO]: %s: cloud is set\n",pyramidName.c_str());
+  printInfo("[INFO]: %s: cloud is set\n",pyramidName.c_str());
   //width = cloud->width;
   //height = cloud->height;
   haveCloud = true;
@@ -252,7 +290,7 @@ bool BasePyramid::getCloud(unsigned int level, pcl::PointCloud<pcl::PointXYZRGB>
 void BasePyramid::setIndices(pcl::PointIndices::Ptr &indices_)
 { 
   indices = indices_;
-  printf("[INFO]: %s: indices are set\n",pyramidName.c_str());
+  printInfo("[INFO]: %s: indices are set\n",pyramidName.c_str());
   haveIndices = true;
   calculated = false;
   haveDepthPyramid = false;
@@ -284,10 +322,10 @@ void BasePyramid::setNormals(pcl::PointCloud<pcl::Normal>::Ptr &normals_)
 {
   if((!haveCloud) || (!haveIndices))
   {
-    printf("[INFO]: %s: Please set cloud and indices before normals\n",pyramidName.c_str());
+    printInfo("[INFO]: %s: Please set cloud and indices before normals\n",pyramidName.c_str());
   }
   normals = normals_;
-  printf("[INFO]: %s: normals are set\n",pyramidName.c_str());
+  printInfo("[INFO]: %s: normals are set\n",pyramidName.c_str());
   haveNormals = true;
   calculated = false;
   haveNormalPyramid = false;
@@ -318,7 +356,7 @@ void BasePyramid::setMaxMapValue(float max_map_value_)
 {
   max_map_value = max_map_value_;
   calculated = false;
-  printf("[INFO]: %s: max_map_value is set to: %f\n",pyramidName.c_str(),max_map_value);
+  printInfo("[INFO]: %s: max_map_value is set to: %f\n",pyramidName.c_str(),max_map_value);
 }
 
 float BasePyramid::getMaxMapValue()
@@ -396,17 +434,20 @@ int BasePyramid::buildPyramid()
   if(rt_code != AM_OK)
     return(rt_code);
 
-  printf("[INFO]: %s: Pyramid computation started.\n",pyramidName.c_str());
+  printInfo("[INFO]: %s: Pyramid computation started.\n",pyramidName.c_str());
 
   int max_level_ = max_level;
   pyramidImages.clear();
-  cv::buildPyramid(image,pyramidImages,max_level_);
+  if(cache && !cacheChannel.empty())
+    cache->getPyramid(cacheChannel,image,max_level_,pyramidImages);
+  else
+    cv::buildPyramid(image,pyramidImages,max_level_);
   
   pyramidFeatures.resize(pyramidImages.size());
 
   haveImagePyramid = true;
   
-  printf("[INFO]: %s: Pyramid computation succeed.\n",pyramidName.c_str());
+  printInfo("[INFO]: %s: Pyramid computation succeed.\n",pyramidName.c_str());
 
   return(AM_OK);
 }
@@ -417,36 +458,23 @@ int BasePyramid::buildDepthPyramid()
   if(rt_code != AM_OK)
     return(rt_code);
 
-  printf("[INFO]: %s: Depth pyramid computation started.\n",pyramidName.c_str());
+  printInfo("[INFO]: %s: Depth pyramid computation started.\n",pyramidName.c_str());
 
-  cv::Mat xchannel, ychannel, zchannel;
-  v4r::pointCloud_2_channels(xchannel,ychannel,zchannel,cloud,width,height,indices);
-  
-  v4r::buildDepthPyramid(xchannel,pyramidX,zchannel,max_level);
-  v4r::buildDepthPyramid(ychannel,pyramidY,zchannel,max_level);
-  v4r::buildDepthPyramid(zchannel,pyramidZ,zchannel,max_level);
-  
-  cv::Mat xnormals, ynormals, znormals;
-  v4r::normals_2_channels(xnormals,ynormals,znormals,normals,width,height,indices);
-  
-  v4r::buildDepthPyramid(xnormals,pyramidNx,zchannel,max_level);
-  v4r::buildDepthPyramid(ynormals,pyramidNy,zchannel,max_level);
-  v4r::buildDepthPyramid(znormals,pyramidNz,zchannel,max_level);
-  
-  cv::Mat indices_image;
-  v4r::indices_2_image(indices_image,width,height,indices);
-  
-  v4r::buildDepthPyramid(indices_image,pyramidImages,indices_image,max_level);
-  
-  v4r::createIndicesPyramid(pyramidImages,pyramidIndices);
-  v4r::createPointCloudPyramid(pyramidX,pyramidY,pyramidZ,pyramidImages,pyramidCloud);
-  v4r::createNormalPyramid(pyramidNx,pyramidNy,pyramidNz,pyramidImages,pyramidNormals);
+  // without a shared cache the pyramids are still built by the cache, but only for this pyramid
+  PyramidCache::Ptr depthCache = cache ? cache : PyramidCache::Ptr(new PyramidCache());
+  PyramidCache::DepthPyramid depthPyramid;
+  depthCache->getDepthPyramid(cloud,normals,indices,width,height,max_level,depthPyramid);
   
-//   for(int i = 0; i < pyramidCloud.at(6)->points.size(); ++i)
-//   {
-//     std::cerr << "(" << pyramidCloud.at(6)->points.at(i).x << "," << pyramidCloud.at(6)->points.at(i).y << "," << pyramidCloud.at(6)->points.at(i).z << ") ";
-//   }
-//   std::cerr << std::endl << std::endl;
+  pyramidImages = depthPyramid.pyramidImages;
+  pyramidX = depthPyramid.pyramidX;
+  pyramidY = depthPyramid.pyramidY;
+  pyramidZ = depthPyramid.pyramidZ;
+  pyramidNx = depthPyramid.pyramidNx;
+  pyramidNy = depthPyramid.pyramidNy;
+  pyramidNz = depthPyramid.pyramidNz;
+  pyramidIndices = depthPyramid.pyramidIndices;
+  pyramidCloud = depthPyramid.pyramidCloud;
+  pyramidNormals = depthPyramid.pyramidNormals;
   
   pyramidFeatures.resize(pyramidImages.size());
   
@@ -455,19 +483,19 @@ int BasePyramid::buildDepthPyramid()
   haveNormalPyramid = true;
   haveIndicePyramid = true;
   
-  printf("[INFO]: %s: Depth pyramid computation succeed.\n",pyramidName.c_str());
+  printInfo("[INFO]: %s: Depth pyramid computation succeed.\n",pyramidName.c_str());
   
   return(AM_OK);
 }
 
 void BasePyramid::combinePyramid(bool standard)
 {
-  printf("[INFO]: %s: Sory, but combinePyramid() is not implemented.\n",pyramidName.c_str());
+  printInfo("[INFO]: %s: Sory, but combinePyramid() is not implemented.\n",pyramidName.c_str());
 }
 
 void BasePyramid::calculate()
 {
-  printf("[INFO]: %s: Sory, but calculate() is not implemented.\n",pyramidName.c_str());
+  printInfo("[INFO]: %s: Sory, but calculate() is not implemented.\n",pyramidName.c_str());
 }
 
 void BasePyramid::checkLevels()
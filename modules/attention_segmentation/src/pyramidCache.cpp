@@ -0,0 +1,193 @@
+/**
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see http://www.gnu.org/licenses/
+ */
+
+
+#include "v4r/attention_segmentation/pyramidCache.h"
+
+#include <sstream>
+
+namespace v4r
+{
+
+PyramidCache::PyramidCache()
+{
+}
+
+void PyramidCache::clear()
+{
+  boost::lock_guard<boost::mutex> lock(mutex);
+  frames.clear();
+  entries.clear();
+  depthEntries.clear();
+}
+
+std::string PyramidCache::getFrameKey(const cv::Mat &image)
+{
+  boost::lock_guard<boost::mutex> lock(mutex);
+  unsigned int frame = 0;
+  for(; frame < frames.size(); ++frame)
+  {
+    const cv::Mat &stored = frames.at(frame);
+    if( (stored.size() == image.size()) && (stored.type() == image.type()) &&
+        (image.empty() || (cv::norm(stored,image,cv::NORM_INF) == 0)) )
+      break;
+  }
+  
+  if(frame == frames.size())
+    frames.push_back(image.clone());
+  
+  std::stringstream key;
+  key << image.cols << "x" << image.rows << "_" << frame;
+  return(key.str());
+}
+
+boost::shared_ptr<PyramidCache::Entry> PyramidCache::getEntry(const std::string &name)
+{
+  boost::lock_guard<boost::mutex> lock(mutex);
+  boost::shared_ptr<Entry> &entry = entries[name];
+  if(!entry)
+    entry.reset(new Entry());
+  return(entry);
+}
+
+void PyramidCache::setChannel(const std::string &name, const cv::Mat &channel)
+{
+  boost::shared_ptr<Entry> entry = getEntry(name);
+  boost::lock_guard<boost::mutex> lock(entry->mutex);
+  if(entry->channel.empty())
+    entry->channel = channel;
+}
+
+bool PyramidCache::getChannel(const std::string &name, cv::Mat &channel)
+{
+  boost::shared_ptr<Entry> entry = getEntry(name);
+  boost::lock_guard<boost::mutex> lock(entry->mutex);
+  if(entry->channel.empty())
+    return(false);
+  
+  channel = entry->channel;
+  return(true);
+}
+
+void PyramidCache::buildPyramid(Entry &entry, int max_level)
+{
+  // levels do not depend on the depth of the pyramid, so a deeper pyramid serves all requests
+  if((int)entry.pyramid.size() < max_level+1)
+  {
+    entry.pyramid.clear();
+    cv::buildPyramid(entry.channel,entry.pyramid,max_level);
+  }
+}
+
+void PyramidCache::getPyramid(const std::string &name, const cv::Mat &image, int max_level, std::vector<cv::Mat> &pyramid)
+{
+  boost::shared_ptr<Entry> entry = getEntry(name);
+  boost::lock_guard<boost::mutex> lock(entry->mutex);
+  if(entry->channel.empty())
+    entry->channel = image;
+  
+  buildPyramid(*entry,max_level);
+  pyramid.assign(entry->pyramid.begin(),entry->pyramid.begin()+max_level+1);
+}
+
+void PyramidCache::getOrientationPyramid(const std::string &name, const cv::Mat &image, int max_level, float angle,
+                                         std::vector<cv::Mat> &responses)
+{
+  boost::shared_ptr<Entry> entry = getEntry(name);
+  boost::lock_guard<boost::mutex> lock(entry->mutex);
+  if(entry->channel.empty())
+    entry->channel = image;
+  
+  buildPyramid(*entry,max_level);
+  
+  std::vector<cv::Mat> &orientation = entry->orientations[angle];
+  if((int)orientation.size() < max_level+1)
+  {
+    cv::Mat gaborKernel0, gaborKernel90;
+    v4r::makeGaborFilter(gaborKernel0,gaborKernel90,angle);
+    
+    for(int i = orientation.size(); i <= max_level; ++i)
+    {
+      cv::Mat temp0, temp90;
+      cv::filter2D(entry->pyramid.at(i),temp0,-1,gaborKernel0);
+      temp0 = cv::abs(temp0);
+      cv::filter2D(entry->pyramid.at(i),temp90,-1,gaborKernel90);
+      temp90 = cv::abs(temp90);
+      
+      cv::Mat current_map;
+      cv::add(temp0,temp90,current_map);
+      orientation.push_back(current_map);
+    }
+  }
+  
+  responses.assign(orientation.begin(),orientation.begin()+max_level+1);
+}
+
+void PyramidCache::getDepthPyramid(pcl::PointCloud<pcl::PointXYZRGB>::Ptr &cloud, pcl::PointCloud<pcl::Normal>::Ptr &normals,
+                                   pcl::PointIndices::Ptr &indices, int width, int height, int max_level, DepthPyramid &depthPyramid)
+{
+  std::stringstream key;
+  key << cloud.get() << " " << normals.get() << " " << indices.get() << " " << (cloud ? cloud->points.size() : 0) << " "
+      << width << " " << height << " " << max_level;
+  
+  boost::shared_ptr<DepthEntry> entry;
+  {
+    boost::lock_guard<boost::mutex> lock(mutex);
+    boost::shared_ptr<DepthEntry> &e = depthEntries[key.str()];
+    if(!e)
+    {
+      e.reset(new DepthEntry());
+      e->cloud = cloud;
+      e->normals = normals;
+      e->indices = indices;
+    }
+    entry = e;
+  }
+  
+  boost::lock_guard<boost::mutex> lock(entry->mutex);
+  if(!entry->computed)
+  {
+    DepthPyramid &dp = entry->depthPyramid;
+    
+    cv::Mat xchannel, ychannel, zchannel;
+    v4r::pointCloud_2_channels(xchannel,ychannel,zchannel,cloud,width,height,indices);
+    
+    v4r::buildDepthPyramid(xchannel,dp.pyramidX,zchannel,max_level);
+    v4r::buildDepthPyramid(ychannel,dp.pyramidY,zchannel,max_level);
+    v4r::buildDepthPyramid(zchannel,dp.pyramidZ,zchannel,max_level);
+    
+    cv::Mat xnormals, ynormals, znormals;
+    v4r::normals_2_channels(xnormals,ynormals,znormals,normals,width,height,indices);
+    
+    v4r::buildDepthPyramid(xnormals,dp.pyramidNx,zchannel,max_level);
+    v4r::buildDepthPyramid(ynormals,dp.pyramidNy,zchannel,max_level);
+    v4r::buildDepthPyramid(znormals,dp.pyramidNz,zchannel,max_level);
+    
+    cv::Mat indices_image;
+    v4r::indices_2_image(indices_image,width,height,indices);
+    
+    v4r::buildDepthPyramid(indices_image,dp.pyramidImages,indices_image,max_level);
+    
+    v4r::createIndicesPyramid(dp.pyramidImages,dp.pyramidIndices);
+    v4r::createPointCloudPyramid(dp.pyramidX,dp.pyramidY,dp.pyramidZ,dp.pyramidImages,dp.pyramidCloud);
+    v4r::createNormalPyramid(dp.pyramidNx,dp.pyramidNy,dp.pyramidNz,dp.pyramidImages,dp.pyramidNormals);
+    
+    entry->computed = true;
+  }
+  
+  depthPyramid = entry->depthPyramid;
+}
+
+} //namespace v4r
@@ -52,7 +52,7 @@ void FrintropPyramid::setR(std::vector<int> &R_)
   R = R_;
   calculated = false;
   haveImagePyramid = false;
-  printf("[INFO]: %s: R is set to: [ ",pyramidName.c_str());
+  printInfo("[INFO]: %s: R is set to: [ ",pyramidName.c_str());
   for(size_t i = 0; i < R.size(); ++i)
   {
     printf("%d ",R.at(i));
@@ -70,7 +70,7 @@ void FrintropPyramid::setOnSwitch(bool onSwitch_)
   onSwitch = onSwitch_;
   calculated = false;
   //haveImagePyramid = false;
-  printf("[INFO]: %s: onSwitch is set to: %s\n",pyramidName.c_str(),onSwitch ? "yes" : "no");
+  printInfo("[INFO]: %s: onSwitch is set to: %s\n",pyramidName.c_str(),onSwitch ? "yes" : "no");
 }
 
 bool FrintropPyramid::getOnSwitch()
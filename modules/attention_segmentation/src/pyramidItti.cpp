@@ -57,7 +57,7 @@ void IttiPyramid::setLowestC(int lowest_c_)
   haveImage = false;
   calculated = false;
   haveImagePyramid = false;
-  printf("[INFO]: %s: lowest_c is set to: %d\n",pyramidName.c_str(),lowest_c);
+  printInfo("[INFO]: %s: lowest_c is set to: %d\n",pyramidName.c_str(),lowest_c);
 }
 
 int IttiPyramid::getLowestC()
@@ -71,7 +71,7 @@ void IttiPyramid::setHighestC(int highest_c_)
   haveImage = false;
   calculated = false;
   haveImagePyramid = false;
-  printf("[INFO]: %s: highest_c is set to: %d\n",pyramidName.c_str(),highest_c);
+  printInfo("[INFO]: %s: highest_c is set to: %d\n",pyramidName.c_str(),highest_c);
 }
 
 int IttiPyramid::getHighestC()
@@ -85,7 +85,7 @@ void IttiPyramid::setSmallestCS(int smallest_cs_)
   haveImage = false;
   calculated = false;
   haveImagePyramid = false;
-  printf("[INFO]: %s: smallest_cs is set to: %d\n",pyramidName.c_str(),smallest_cs);
+  printInfo("[INFO]: %s: smallest_cs is set to: %d\n",pyramidName.c_str(),smallest_cs);
 }
 
 int IttiPyramid::getSmallestCS()
@@ -99,7 +99,7 @@ void IttiPyramid::setLargestCS(int largest_cs_)
   haveImage = false;
   calculated = false;
   haveImagePyramid = false;
-  printf("[INFO]: %s: largest_cs is set to: %d\n",pyramidName.c_str(),largest_cs);
+  printInfo("[INFO]: %s: largest_cs is set to: %d\n",pyramidName.c_str(),largest_cs);
 }
 
 int IttiPyramid::getLargestCS()
@@ -113,7 +113,7 @@ void IttiPyramid::setNumberOfFeatures(int number_of_features_)
   haveImage = false;
   calculated = false;
   haveImagePyramid = false;
-  printf("[INFO]: %s: number_of_features is set to: %d\n",pyramidName.c_str(),number_of_features);
+  printInfo("[INFO]: %s: number_of_features is set to: %d\n",pyramidName.c_str(),number_of_features);
 }
 
 int IttiPyramid::getNumberOfFeatures()
@@ -127,7 +127,7 @@ void IttiPyramid::setChangeSign(bool changeSign_)
   haveImage = false;
   calculated = false;
   haveImagePyramid = false;
-  printf("[INFO]: %s: changeSign is set to: %s\n",pyramidName.c_str(),changeSign ? "yes" : "no");
+  printInfo("[INFO]: %s: changeSign is set to: %s\n",pyramidName.c_str(),changeSign ? "yes" : "no");
 }
 
 bool IttiPyramid::getChangeSign()
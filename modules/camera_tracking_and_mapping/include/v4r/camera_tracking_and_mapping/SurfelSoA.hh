@@ -0,0 +1,114 @@
+/**
+ * $Id$
+ *
+ * Software License Agreement (GNU General Public License)
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef KP_TSF_SURFEL_SOA_HH
+#define KP_TSF_SURFEL_SOA_HH
+
+#include <vector>
+#include <limits>
+#include <stdint.h>
+#include <Eigen/Dense>
+#include <opencv2/core/core.hpp>
+#include <boost/shared_ptr.hpp>
+#include <v4r/common/impl/DataMatrix2D.hpp>
+#include <v4r/camera_tracking_and_mapping/Surfel.hh>
+#include <v4r/core/macros.h>
+
+namespace v4r
+{
+
+
+
+/**
+ * @brief The SurfelSoA class
+ * Compact structure-of-arrays layout of an organized surfel cloud
+ * (float3 position/normal, float weight/radius, packed rgb)
+ */
+class V4R_EXPORTS SurfelSoA
+{
+public:
+  int rows, cols;
+  std::vector<float> pt;          ///< x,y,z interleaved per surfel
+  std::vector<float> n;           ///< nx,ny,nz interleaved per surfel
+  std::vector<float> weight;
+  std::vector<float> radius;
+  std::vector<uint32_t> rgb;      ///< 0x00RRGGBB (pcl layout)
+
+  SurfelSoA() : rows(0), cols(0) {}
+
+  void resize(const int _rows, const int _cols);
+  void clear();
+
+  inline int size() const { return rows*cols; }
+  inline bool empty() const { return rows*cols==0; }
+
+  inline Eigen::Map<const Eigen::Vector3f> getPt(const int i) const { return Eigen::Map<const Eigen::Vector3f>(&pt[3*i]); }
+  inline Eigen::Map<Eigen::Vector3f> getPt(const int i) { return Eigen::Map<Eigen::Vector3f>(&pt[3*i]); }
+  inline Eigen::Map<const Eigen::Vector3f> getN(const int i) const { return Eigen::Map<const Eigen::Vector3f>(&n[3*i]); }
+  inline Eigen::Map<Eigen::Vector3f> getN(const int i) { return Eigen::Map<Eigen::Vector3f>(&n[3*i]); }
+  inline float getWeight(const int i) const { return weight[i]; }
+  inline float getRadius(const int i) const { return radius[i]; }
+  inline uint8_t getR(const int i) const { return (rgb[i]>>16)&0xff; }
+  inline uint8_t getG(const int i) const { return (rgb[i]>>8)&0xff; }
+  inline uint8_t getB(const int i) const { return rgb[i]&0xff; }
+
+  void set(const v4r::DataMatrix2D<Surfel> &sf_cloud);
+  void get(v4r::DataMatrix2D<Surfel> &sf_cloud) const;
+
+  void computeNormals(int nb_dist=1);
+  void computeRadius(const cv::Mat_<double> &intrinsic);
+
+  static inline uint32_t packRGB(const int &r, const int &g, const int &b) { return ((uint32_t)(r&0xff)<<16) | ((uint32_t)(g&0xff)<<8) | (uint32_t)(b&0xff); }
+
+  typedef boost::shared_ptr< ::v4r::SurfelSoA> Ptr;
+  typedef boost::shared_ptr< ::v4r::SurfelSoA const> ConstPtr;
+};
+
+
+/**
+ * @brief The SurfelSnapshot class
+ * Immutable, epoch stamped version of the filtered surfel cloud which is published by the
+ * data integration thread and can be read without locking the shared tracking data
+ */
+class V4R_EXPORTS SurfelSnapshot
+{
+public:
+  SurfelSoA cloud;
+  Eigen::Matrix4f pose;
+  uint64_t timestamp;
+  uint64_t epoch;
+
+  SurfelSnapshot() : pose(Eigen::Matrix4f::Identity()), timestamp(std::numeric_limits<uint64_t>::max()), epoch(0) {}
+
+  EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+
+  typedef boost::shared_ptr< ::v4r::SurfelSnapshot> Ptr;
+  typedef boost::shared_ptr< ::v4r::SurfelSnapshot const> ConstPtr;
+};
+
+
+
+/*************************** INLINE METHODES **************************/
+
+
+} //--END--
+
+#endif
+
@@ -40,7 +40,9 @@
 #include <pcl/point_types.h>
 #include <v4r/common/impl/DataMatrix2D.hpp> 
 #include <v4r/camera_tracking_and_mapping/Surfel.hh>
+#include <v4r/camera_tracking_and_mapping/SurfelSoA.hh>
 #include <v4r/camera_tracking_and_mapping/TSFFrame.hh>
+#include <v4r/keypoints/LKPyramid.h>
 #include <queue>
 #include <v4r/core/macros.h>
 
@@ -54,6 +56,12 @@ namespace v4r
  */
 class V4R_EXPORTS TSFData 
 {
+private:
+  boost::mutex mtx_snapshot;           // only guards the front/back swap, never held while copying
+  SurfelSnapshot::Ptr snapshots[2];    // double buffered filtered cloud
+  int snapshot_front;
+  uint64_t snapshot_epoch;
+
 public:
   boost::mutex mtx_shm;
 
@@ -65,6 +73,7 @@ public:
 
   cv::Mat image;
   cv::Mat prev_gray, gray;
+  v4r::LKPyramid::Ptr prev_pyr;   /// lk pyramid of prev_gray (built once per keyframe)
   pcl::PointCloud<pcl::PointXYZRGB> cloud;  ///// new cloud
   uint64_t timestamp;
 
@@ -92,6 +101,10 @@ public:
   inline void lock() { mtx_shm.lock(); }
   inline void unlock() { mtx_shm.unlock(); }
 
+  SurfelSnapshot::Ptr getSnapshotBuffer();
+  void publishSnapshot(const SurfelSnapshot::Ptr &snapshot);
+  SurfelSnapshot::ConstPtr getSnapshot();
+
   static void convert(const v4r::DataMatrix2D<v4r::Surfel> &sf_cloud, pcl::PointCloud<pcl::PointXYZRGBNormal> &cloud, const double &thr_weight=-1000000, const double &thr_delta_angle=180. );
   static void convert(const v4r::DataMatrix2D<v4r::Surfel> &sf_cloud, cv::Mat &image);
 };
@@ -115,7 +115,7 @@ private:
   void operate();
 
   bool selectFrame(const Eigen::Matrix4f &pose0, const Eigen::Matrix4f &pose1);
-  void integrateData(const pcl::PointCloud<pcl::PointXYZRGB> &cloud, const Eigen::Matrix4f &pose, const Eigen::Matrix4f &filt_pose, v4r::DataMatrix2D<Surfel> &filt_cloud);
+  void integrateData(const pcl::PointCloud<pcl::PointXYZRGB> &cloud, const Eigen::Matrix4f &pose, const Eigen::Matrix4f &filt_pose, const v4r::DataMatrix2D<Surfel> &filt_cloud, v4r::DataMatrix2D<Surfel> &new_filt_cloud);
   inline float sqr(const float &d) {return d*d;}
 
 
@@ -89,6 +89,7 @@ public:
     double nnr;
     bool refine_plk;
     bool detect_loops;
+    bool optimize_window;                // sliding window bundle adjustment after each new keyframe
     int nb_tracked_frames;
     RefineProjectedPointLocationLK::Parameter plk_param;
     v4r::RansacSolvePnPdepth::Parameter pnp;
@@ -97,7 +98,7 @@ public:
      : win_size(cv::Size(21,21)), max_level(2), termcrit(cv::TermCriteria(CV_TERMCRIT_ITER|CV_TERMCRIT_EPS,20,0.03)), max_error(100),
        max_count(500), max_dev_vr_normal(75),
        max_delta_angle_loop(30), max_cam_dist_loop(1.5), max_delta_angle_eq_pose(5), max_cam_dist_eq_pose(0.1),
-       nnr(0.95), refine_plk(false), detect_loops(true), nb_tracked_frames(2),
+       nnr(0.95), refine_plk(false), detect_loops(true), optimize_window(false), nb_tracked_frames(2),
        plk_param(RefineProjectedPointLocationLK::Parameter(5., 0.01, 0.1, 10, 15., 0.3, true, cv::Size(21,21))),
        pnp(v4r::RansacSolvePnPdepth::Parameter(1.5, 0.01, 2000, INT_MIN, 4, 0.015))
     {}
@@ -137,6 +138,7 @@ private:
   cv::FlannBasedMatcher matcher;
 
   TSFOptimizeBundle ba;
+  std::set<int> updated_frames;   // older keyframes with new projections (for the sliding window bundle adjustment)
 
   void operate();
 
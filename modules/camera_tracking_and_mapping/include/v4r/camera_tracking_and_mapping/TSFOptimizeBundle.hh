@@ -33,7 +33,11 @@
 #ifndef KP_TSF_OPTIMIZE_BUNDLE_HH
 #define KP_TSF_OPTIMIZE_BUNDLE_HH
 
+#include <map>
+#include <set>
 #include <Eigen/Dense>
+#include <Eigen/StdVector>
+#include <boost/shared_ptr.hpp>
 #include <opencv2/core/core.hpp>
 #include "opencv2/imgproc/imgproc.hpp"
 #include <ceres/ceres.h>
@@ -72,15 +76,29 @@ public:
     bool optimize_tangential_p2;
     bool optimize_delta_cloud_rgb_pose_global;
     bool optimize_delta_cloud_rgb_pose;
+    int window_size;               // number of (newest) keyframes optimized by optimizeWindow (<=0 .. unbounded)
+    int max_iterations_window;
     Parameter()
       : depth_error_scale(100), use_robust_loss(true), loss_scale(2.),
         optimize_focal_length(true), optimize_principal_point(true),
         optimize_radial_k1(false), optimize_radial_k2(false), optimize_radial_k3(false),
         optimize_tangential_p1(false), optimize_tangential_p2(false),
-        optimize_delta_cloud_rgb_pose_global(false), optimize_delta_cloud_rgb_pose(false) {}
+        optimize_delta_cloud_rgb_pose_global(false), optimize_delta_cloud_rgb_pose(false),
+        window_size(10), max_iterations_window(10) {}
   };
 
 private:
+  typedef Eigen::Matrix<double, 6, 1> Vector6d;
+  typedef std::map<int, Vector6d, std::less<int>, Eigen::aligned_allocator<std::pair<const int, Vector6d> > > PoseMap;
+
+  class WindowResidual
+  {
+  public:
+    int frame0, frame1;     // keyframe of the point, keyframe of the projection
+    int point;              // point index in frame0 (-1 .. point to plane residual)
+    WindowResidual(int _frame0=-1, int _frame1=-1, int _point=-1) : frame0(_frame0), frame1(_frame1), point(_point) {}
+  };
+
   Parameter param;
 
   cv::Mat_<double> dist_coeffs;
@@ -95,6 +113,19 @@ private:
   std::vector<int> const_intrinsics;
   bool const_all_intrinsics;
 
+  // persistent problem of the sliding window bundle adjustment (optimizeWindow)
+  boost::shared_ptr<ceres::Problem> win_problem;
+  int win_start;                                              // first keyframe of the window
+  std::vector<double> win_intrinsics;                         // constant within the window
+  PoseMap win_poses;                                          // window keyframes and fixed keyframes linked to the window
+  std::map<int, int> win_pose_nb_res;
+  std::map< std::pair<int,int>, Eigen::Vector3d > win_points; // (keyframe, point) -> parameter block
+  std::map< std::pair<int,int>, int > win_point_nb_res;
+  std::map<ceres::ResidualBlockId, WindowResidual> win_residuals;
+  std::map<int, std::vector<ceres::ResidualBlockId> > win_frame_residuals;
+  std::vector< std::vector<unsigned> > win_nb_projs;          // per keyframe and point: projections already in the problem
+  int win_gauge;                                              // keyframe fixed if the window is not linked to fixed keyframes
+
   void convertPosesToRt(const std::vector<TSFFrame::Ptr> &map);
   void convertPosesFromRt(std::vector<TSFFrame::Ptr> &map);
   void convertPosesFromRtRGB(std::vector<TSFFrame::Ptr> &map);
@@ -103,12 +134,21 @@ private:
   void optimizeCloudPosesRGBPoses(std::vector<TSFFrame::Ptr> &map);
   void optimizeCloudPosesDeltaRGBPose(std::vector<TSFFrame::Ptr> &map);
 
+  double *getWindowPose(const TSFFrame &frame);
+  double *getWindowPoint(const TSFFrame &frame, int j);
+  void addWindowResiduals(const std::vector<TSFFrame::Ptr> &map, int i);
+  void removeWindowResidual(ceres::ResidualBlockId id);
+  void moveWindow(int new_start);
+  void setWindowGauge();
+
 
 public:
   TSFOptimizeBundle( const Parameter &p=Parameter());
   ~TSFOptimizeBundle();
 
   void optimize(std::vector<TSFFrame::Ptr> &map);
+  void optimizeWindow(std::vector<TSFFrame::Ptr> &map, const std::set<int> &updated_frames=std::set<int>());
+  void resetWindow();
 
   void getCameraParameter(cv::Mat &_intrinsic, cv::Mat &_dist_coeffs);
 
@@ -110,6 +110,8 @@ public:
   void getFilteredCloudNormals(pcl::PointCloud<pcl::PointXYZRGB> &cloud, pcl::PointCloud<pcl::Normal> &normals, Eigen::Matrix4f &pose, uint64_t &timestamp);
   void getFilteredCloud(pcl::PointCloud<pcl::PointXYZRGB> &cloud, Eigen::Matrix4f &pose, uint64_t &timestamp);
   void getSurfelCloud(v4r::DataMatrix2D<Surfel> &cloud, Eigen::Matrix4f &pose, uint64_t &timestamp, bool need_normals=false);
+  /** @brief zero copy access to the last published filtered cloud (never blocks the tracker) */
+  inline SurfelSnapshot::ConstPtr getSurfelSnapshot() { return data.getSnapshot(); }
 
   void setCameraParameter(const cv::Mat &_intrinsic);
   void setParameter(const Parameter &p);
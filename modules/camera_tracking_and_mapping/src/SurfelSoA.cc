@@ -0,0 +1,181 @@
+/**
+ * $Id$
+ *
+ * Software License Agreement (GNU General Public License)
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#include <v4r/camera_tracking_and_mapping/SurfelSoA.hh>
+#include <cmath>
+
+
+
+
+namespace v4r
+{
+
+
+using namespace std;
+
+
+
+
+/***************************************************************************************/
+
+/**
+ * @brief SurfelSoA::resize
+ * @param _rows
+ * @param _cols
+ */
+void SurfelSoA::resize(const int _rows, const int _cols)
+{
+  rows = _rows;
+  cols = _cols;
+  unsigned sz = rows*cols;
+  pt.resize(3*sz);
+  n.resize(3*sz);
+  weight.resize(sz);
+  radius.resize(sz);
+  rgb.resize(sz);
+}
+
+/**
+ * @brief SurfelSoA::clear
+ */
+void SurfelSoA::clear()
+{
+  rows = cols = 0;
+  pt.clear();
+  n.clear();
+  weight.clear();
+  radius.clear();
+  rgb.clear();
+}
+
+/**
+ * @brief SurfelSoA::set
+ * @param sf_cloud
+ */
+void SurfelSoA::set(const v4r::DataMatrix2D<Surfel> &sf_cloud)
+{
+  resize(sf_cloud.rows, sf_cloud.cols);
+
+  float *d_pt = (pt.size()>0 ? &pt[0] : 0);
+  float *d_n = (n.size()>0 ? &n[0] : 0);
+
+  for (unsigned i=0; i<sf_cloud.data.size(); i++, d_pt+=3, d_n+=3)
+  {
+    const Surfel &s = sf_cloud.data[i];
+    d_pt[0] = s.pt[0]; d_pt[1] = s.pt[1]; d_pt[2] = s.pt[2];
+    d_n[0] = s.n[0]; d_n[1] = s.n[1]; d_n[2] = s.n[2];
+    weight[i] = s.weight;
+    radius[i] = s.radius;
+    rgb[i] = packRGB(s.r, s.g, s.b);
+  }
+}
+
+/**
+ * @brief SurfelSoA::get
+ * @param sf_cloud
+ */
+void SurfelSoA::get(v4r::DataMatrix2D<Surfel> &sf_cloud) const
+{
+  sf_cloud.resize(rows, cols);
+
+  for (unsigned i=0; i<sf_cloud.data.size(); i++)
+  {
+    Surfel &s = sf_cloud.data[i];
+    s.pt = getPt(i);
+    s.n = getN(i);
+    s.weight = getWeight(i);
+    s.radius = getRadius(i);
+    s.r = getR(i);
+    s.g = getG(i);
+    s.b = getB(i);
+  }
+}
+
+/**
+ * @brief SurfelSoA::computeRadius
+ * @param intrinsic
+ */
+void SurfelSoA::computeRadius(const cv::Mat_<double> &intrinsic)
+{
+  const float norm = 1./sqrt(2)*(2./(intrinsic(0,0)+intrinsic(1,1)));
+  const float *d_pt = (pt.size()>0 ? &pt[0] : 0);
+
+  for (unsigned i=0; i<radius.size(); i++, d_pt+=3)
+  {
+    if (std::isnan(d_pt[0]) || std::isnan(d_pt[1]) || std::isnan(d_pt[2]))
+      radius[i] = 0.;
+    else radius[i] = norm*d_pt[2];
+  }
+}
+
+/**
+ * @brief SurfelSoA::computeNormals
+ * Same neighbourhood pattern as TSFDataIntegration::computeNormals, but thread safe
+ * (local pattern) and working on the packed point array
+ * @param nb_dist
+ */
+void SurfelSoA::computeNormals(int nb_dist)
+{
+  const int npat[4][4] = { {nb_dist,0,0,nb_dist}, {0,nb_dist,-nb_dist,0}, {-nb_dist,0,0,-nb_dist}, {0,-nb_dist,0,nb_dist} };
+  const float nan = std::numeric_limits<float>::quiet_NaN();
+
+  int z, idx, idx2=0, idx3=0;
+  Eigen::Vector3f l1, l2;
+
+  for (int v=0; v<rows; v++)
+  {
+    for (int u=0; u<cols; u++)
+    {
+      idx = v*cols+u;
+      const Eigen::Vector3f p1 = getPt(idx);
+      if (std::isnan(p1[0]) || std::isnan(p1[1]) || std::isnan(p1[2]))
+        continue;
+      for (z=0; z<4; z++)
+      {
+        const int *p = npat[z];
+        if (u+p[0]>=0 && u+p[0]<cols && v+p[1]>=0 && v+p[1]<rows &&
+            u+p[2]>=0 && u+p[2]<cols && v+p[3]>=0 && v+p[3]<rows)
+        {
+          idx2 = (v+p[1])*cols+u+p[0];
+          if (std::isnan(pt[3*idx2]) || std::isnan(pt[3*idx2+1]) || std::isnan(pt[3*idx2+2]))
+            continue;
+          idx3 = (v+p[3])*cols+u+p[2];
+          if (std::isnan(pt[3*idx3]) || std::isnan(pt[3*idx3+1]) || std::isnan(pt[3*idx3+2]))
+            continue;
+          break;
+        }
+      }
+      Eigen::Map<Eigen::Vector3f> n1 = getN(idx);
+      if (z<4)
+      {
+        l1 = getPt(idx2)-p1;
+        l2 = getPt(idx3)-p1;
+        n1 = l1.cross(l2).normalized();
+        if (n1.dot(p1) > 0) n1 *= -1;
+      }
+      else n1 = Eigen::Vector3f(nan,nan,nan);
+    }
+  }
+}
+
+
+}
+
@@ -50,10 +50,11 @@ using namespace std;
  * Constructor/Destructor
  */
 TSFData::TSFData()
- : need_init(false), init_points(0), lk_flags(0), timestamp(std::numeric_limits<uint64_t>::max()), pose(Eigen::Matrix4f::Identity()), have_pose(false), filt_pose(Eigen::Matrix4f::Identity()), filt_timestamp(std::numeric_limits<uint64_t>::max()), kf_timestamp(std::numeric_limits<uint64_t>::max()), kf_pose(Eigen::Matrix4f::Identity()), cnt_pose_lost_map(0), nb_frames_integrated(0)
+ : snapshot_front(0), snapshot_epoch(0), need_init(false), init_points(0), lk_flags(0), timestamp(std::numeric_limits<uint64_t>::max()), pose(Eigen::Matrix4f::Identity()), have_pose(false), filt_pose(Eigen::Matrix4f::Identity()), filt_timestamp(std::numeric_limits<uint64_t>::max()), kf_timestamp(std::numeric_limits<uint64_t>::max()), kf_pose(Eigen::Matrix4f::Identity()), cnt_pose_lost_map(0), nb_frames_integrated(0)
 {
   filt_cloud.reset(new DataMatrix2D<Surfel>() );
   last_pose_map(0,0) = std::numeric_limits<float>::quiet_NaN();
+  snapshots[0].reset(new SurfelSnapshot());
 }
 
 TSFData::~TSFData()
@@ -76,6 +77,7 @@ void TSFData::reset()
   lk_flags = 0;
   gray = cv::Mat();
   prev_gray = cv::Mat();
+  prev_pyr.reset(0);
   points[0].clear(); points[1].clear();
   points3d[0].clear(); points3d[1].clear();
   cloud.clear();
@@ -91,6 +93,52 @@ void TSFData::reset()
   cnt_pose_lost_map = 0;
   last_pose_map(0,0) = std::numeric_limits<float>::quiet_NaN();
   unlock();
+
+  mtx_snapshot.lock();
+  snapshots[0].reset(new SurfelSnapshot());
+  snapshots[1].reset();
+  snapshot_front = 0;
+  snapshot_epoch = 0;
+  mtx_snapshot.unlock();
+}
+
+/**
+ * @brief TSFData::getSnapshotBuffer
+ * Returns the back buffer for the next publication. The buffer is reused if no reader
+ * holds it anymore, otherwise a new one is allocated (readers keep their snapshot alive)
+ * @return
+ */
+SurfelSnapshot::Ptr TSFData::getSnapshotBuffer()
+{
+  boost::mutex::scoped_lock lock(mtx_snapshot);
+  SurfelSnapshot::Ptr &back = snapshots[1-snapshot_front];
+  if (!back || !back.unique())
+    back.reset(new SurfelSnapshot());
+  return back;
+}
+
+/**
+ * @brief TSFData::publishSnapshot
+ * Swaps the filled back buffer to the front and stamps it with a new epoch
+ * @param snapshot (must have been obtained by getSnapshotBuffer)
+ */
+void TSFData::publishSnapshot(const SurfelSnapshot::Ptr &snapshot)
+{
+  boost::mutex::scoped_lock lock(mtx_snapshot);
+  snapshot->epoch = ++snapshot_epoch;
+  snapshots[1-snapshot_front] = snapshot;
+  snapshot_front = 1-snapshot_front;
+}
+
+/**
+ * @brief TSFData::getSnapshot
+ * Lock free w.r.t. mtx_shm, i.e. readers never block the tracker or the mapping thread
+ * @return the last published filtered cloud
+ */
+SurfelSnapshot::ConstPtr TSFData::getSnapshot()
+{
+  boost::mutex::scoped_lock lock(mtx_snapshot);
+  return snapshots[snapshot_front];
 }
 
 
@@ -65,6 +65,8 @@ TSFDataIntegration::~TSFDataIntegration()
 
 /**
  * operate
+ * The filtered cloud is double buffered: the current one (data->filt_cloud) is only read,
+ * the next one is integrated into the back buffer and published by swapping the pointers
  */
 void TSFDataIntegration::operate()
 {
@@ -73,8 +75,10 @@ void TSFDataIntegration::operate()
   pcl::PointCloud<pcl::PointXYZRGB> cloud;  ///// new cloud
   Eigen::Matrix4f pose;      /// global pose of the current frame (depth, gray, points[1], ....)
   uint64_t timestamp = 0;
-  v4r::DataMatrix2D<Surfel> filt_cloud;
+  v4r::DataMatrix2D<Surfel>::Ptr filt_cloud;
+  v4r::DataMatrix2D<Surfel>::Ptr back_cloud(new v4r::DataMatrix2D<Surfel>());
   Eigen::Matrix4f filt_pose;
+  bool add_map_frame;
 
   while(run)
   {
@@ -84,7 +88,7 @@ void TSFDataIntegration::operate()
     {
       have_todo = true;
       cloud = data->cloud;
-      filt_cloud = *data->filt_cloud;
+      filt_cloud = data->filt_cloud;
       timestamp = data->timestamp;
       pose = data->pose;
       filt_pose = data->filt_pose;
@@ -94,31 +98,58 @@ void TSFDataIntegration::operate()
     if (have_todo)
     {
       //v4r::ScopeTime t("TSFDataIntegration::operate");
-      if ((int)cloud.width!=filt_cloud.cols || (int)cloud.height!=filt_cloud.rows)
+      if ((int)cloud.width!=filt_cloud->cols || (int)cloud.height!=filt_cloud->rows)
       {
-        initCloud(cloud, filt_cloud);
+        back_cloud->clear();
+        initCloud(cloud, *back_cloud);
       }
       else
       {
-        integrateData(cloud, pose, filt_pose, filt_cloud);
-        //computeNormals(filt_cloud);
+        integrateData(cloud, pose, filt_pose, *filt_cloud, *back_cloud);
+        //computeNormals(*back_cloud);
       }
 
+      // publish a compact snapshot for readers (normals/radius are computed here and not under the lock)
+      SurfelSnapshot::Ptr snapshot = data->getSnapshotBuffer();
+      snapshot->cloud.set(*back_cloud);
+      snapshot->cloud.computeNormals();
+      if (!intrinsic.empty()) snapshot->cloud.computeRadius(intrinsic);
+      snapshot->pose = pose;
+      snapshot->timestamp = timestamp;
+      data->publishSnapshot(snapshot);
+
+      add_map_frame = false;
       data->lock();
-      *data->filt_cloud = filt_cloud;
-      data->filt_timestamp = timestamp;
-      data->filt_pose = pose;
-      data->nb_frames_integrated++;
-      if (std::isnan(data->last_pose_map(0,0)) || selectFrame(data->last_pose_map, pose))
+      if (data->filt_cloud.get()==filt_cloud.get())   // not reset in the meantime
       {
-        if (data->filt_cloud->data.size()>0 && data->nb_frames_integrated>param.min_frames_integrated)
+        data->filt_cloud = back_cloud;
+        data->filt_timestamp = timestamp;
+        data->filt_pose = pose;
+        data->nb_frames_integrated++;
+        if (std::isnan(data->last_pose_map(0,0)) || selectFrame(data->last_pose_map, pose))
         {
-          data->map_frames.push( TSFFrame::Ptr( new TSFFrame(-1,pose,*data->filt_cloud,(data->cnt_pose_lost_map>0?false:true)) ) );
-          data->cnt_pose_lost_map = 0;
-          data->last_pose_map = pose;
+          if (back_cloud->data.size()>0 && data->nb_frames_integrated>param.min_frames_integrated)
+          {
+            add_map_frame = true;
+            data->last_pose_map = pose;
+          }
         }
       }
       data->unlock();
+
+      if (add_map_frame)
+      {
+        // only this thread writes the filtered clouds, i.e. the published one can be copied without lock
+        TSFFrame::Ptr frame( new TSFFrame(-1,pose,*back_cloud,true) );
+        data->lock();
+        frame->have_track = (data->cnt_pose_lost_map>0?false:true);
+        data->map_frames.push( frame );
+        data->cnt_pose_lost_map = 0;
+        data->unlock();
+      }
+
+      back_cloud = filt_cloud;  // the former front buffer is reused for the next frame
+      filt_cloud = v4r::DataMatrix2D<Surfel>::Ptr();
     }
 
     if (!have_todo) usleep(10000);
@@ -166,7 +197,7 @@ void TSFDataIntegration::initCloud(const pcl::PointCloud<pcl::PointXYZRGB> &clou
 /**
  * @brief TSFDataIntegration::addCloud
  */
-void TSFDataIntegration::integrateData(const pcl::PointCloud<pcl::PointXYZRGB> &cloud, const Eigen::Matrix4f &pose, const Eigen::Matrix4f &filt_pose, v4r::DataMatrix2D<Surfel> &filt_cloud)
+void TSFDataIntegration::integrateData(const pcl::PointCloud<pcl::PointXYZRGB> &cloud, const Eigen::Matrix4f &pose, const Eigen::Matrix4f &filt_pose, const v4r::DataMatrix2D<Surfel> &filt_cloud, v4r::DataMatrix2D<Surfel> &new_filt_cloud)
 {
   if (intrinsic.empty())
     throw std::runtime_error("[TSFDataIntegration::addCloud] Camera parameter not set!");
@@ -332,12 +363,13 @@ void TSFDataIntegration::integrateData(const pcl::PointCloud<pcl::PointXYZRGB> &
 
   // integrate new data
   float inv_norm;
+  new_filt_cloud.resize(filt_cloud.rows, filt_cloud.cols);
   for (unsigned v=0; v<cloud.height; v++)
   {
     for (unsigned u=0; u<cloud.width; u++)
     {
       const float &dw = depth_weight(v,u);
-      Surfel &sf = filt_cloud(v,u);
+      Surfel &sf = new_filt_cloud(v,u);
       const pcl::PointXYZRGB &pt = cloud(u,v);
 
       if (!param.filter_occlusions || occ_mask(v,u)<128)
@@ -349,6 +381,8 @@ void TSFDataIntegration::integrateData(const pcl::PointCloud<pcl::PointXYZRGB> &
         else
         {
           const float &tz = tmp_z(v,u);
+          sf.n = filt_cloud(v,u).n;
+          sf.radius = filt_cloud(v,u).radius;
           inv_norm = 1./depth_norm(v,u);
           sf.pt[2] = tz*inv_norm;
           sf.weight = dw*inv_norm;
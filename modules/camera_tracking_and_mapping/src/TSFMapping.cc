@@ -114,6 +114,8 @@ void TSFMapping::operate()
         }
 
         if (param.detect_loops) addLoops();
+        if (param.optimize_window) ba.optimizeWindow(map_frames, updated_frames);
+        updated_frames.clear();
         cout<<"  Number keyframes: "<<map_frames.size()<<endl;
       }
       
@@ -301,6 +303,7 @@ void TSFMapping::addFeatureLinks(TSFFrame &frame0, TSFFrame &frame1, const cv::M
       frame1.loop_links.push_back(frame0.idx);
     else frame1.fw_link = frame0.idx;
   }
+  updated_frames.insert(frame1.idx);
 }
 
 /**
@@ -558,6 +561,7 @@ void TSFMapping::addLoops()
                   frame0.loop_links.push_back(frame1.idx);
                 if (addProjectionsPLK(frame0.idx, frame0.sf_cloud, refined1, converged1, frame2.projections) > 5)
                   frame2.loop_links.push_back(frame0.idx);
+                updated_frames.insert(frame2.idx);
               }
             }
           }
@@ -611,6 +615,8 @@ void TSFMapping::reset()
 {
   stop();
   map_frames.clear();
+  updated_frames.clear();
+  ba.resetWindow();
 }
 
 /**
@@ -634,6 +640,7 @@ void TSFMapping::transformMap(const Eigen::Matrix4f &transform)
     v4r::TSFFrame &frame = *map_frames[i];
     frame.pose = frame.pose*transform;
   }
+  ba.resetWindow();
 }
 
 
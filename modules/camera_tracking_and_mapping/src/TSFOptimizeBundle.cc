@@ -34,6 +34,7 @@
 #include <v4r/camera_tracking_and_mapping/TSFOptimizeBundle.hh>
 #include <v4r/camera_tracking_and_mapping/BACostFunctions.hpp>
 #include <v4r/keypoints/impl/invPose.hpp>
+#include <algorithm>
 
 
 namespace v4r
@@ -49,7 +50,7 @@ using namespace std;
  * Constructor/Destructor
  */
 TSFOptimizeBundle::TSFOptimizeBundle(const Parameter &p)
-  : const_all_intrinsics(true)
+  : const_all_intrinsics(true), win_start(0), win_gauge(-1)
 {
   setParameter(p);
 }
@@ -559,6 +560,9 @@ void TSFOptimizeBundle::optimize(std::vector<TSFFrame::Ptr> &map)
   convertPosesFromRt(map);
   convertPosesFromRtRGB(map);
 
+  // the window problem is stale now
+  resetWindow();
+
 //  Eigen::Matrix3d Rrgb, Rpc;
 //  Eigen::Matrix4d pose_rgb(Eigen::Matrix4d::Identity()), pose_pc(Eigen::Matrix4d::Identity()), inv_pose;
 //  for (unsigned i=0; i<poses_Rt.size(); i++)
@@ -576,6 +580,310 @@ void TSFOptimizeBundle::optimize(std::vector<TSFFrame::Ptr> &map)
 //  }
 }
 
+/**
+ * @brief TSFOptimizeBundle::resetWindow
+ * drops the persistent problem of the sliding window bundle adjustment
+ */
+void TSFOptimizeBundle::resetWindow()
+{
+  win_problem.reset();
+  win_start = 0;
+  win_intrinsics.clear();
+  win_poses.clear();
+  win_pose_nb_res.clear();
+  win_points.clear();
+  win_point_nb_res.clear();
+  win_residuals.clear();
+  win_frame_residuals.clear();
+  win_nb_projs.clear();
+  win_gauge = -1;
+}
+
+/**
+ * @brief TSFOptimizeBundle::getWindowPose
+ * returns the (persistent) pose parameter block of a keyframe, keyframes outside of the window are constant
+ */
+double *TSFOptimizeBundle::getWindowPose(const TSFFrame &frame)
+{
+  PoseMap::iterator it = win_poses.find(frame.idx);
+  if (it!=win_poses.end())
+    return &it->second[0];
+
+  Vector6d &pose_Rt = win_poses[frame.idx];
+  Eigen::Matrix3d R = frame.pose.topLeftCorner<3, 3>().cast<double>();
+  ceres::RotationMatrixToAngleAxis(&R(0,0), &pose_Rt(0));
+  pose_Rt.tail<3>() = frame.pose.block<3,1>(0, 3).cast<double>();
+  win_pose_nb_res[frame.idx] = 0;
+
+  win_problem->AddParameterBlock(&pose_Rt[0], 6);
+  if (frame.idx<win_start) win_problem->SetParameterBlockConstant(&pose_Rt[0]);
+  return &pose_Rt[0];
+}
+
+/**
+ * @brief TSFOptimizeBundle::getWindowPoint
+ * returns the (persistent) parameter block of a keyframe point (in keyframe coordinates)
+ */
+double *TSFOptimizeBundle::getWindowPoint(const TSFFrame &frame, int j)
+{
+  std::pair<int,int> key(frame.idx, j);
+  std::map< std::pair<int,int>, Eigen::Vector3d >::iterator it = win_points.find(key);
+  if (it!=win_points.end())
+    return &it->second[0];
+
+  Eigen::Vector3d &pt3 = win_points[key];
+  pt3 = frame.points3d[j].cast<double>();
+  win_point_nb_res[key] = 0;
+
+  win_problem->AddParameterBlock(&pt3[0], 3);
+  if (frame.idx<win_start) win_problem->SetParameterBlockConstant(&pt3[0]);
+  return &pt3[0];
+}
+
+/**
+ * @brief TSFOptimizeBundle::addWindowResiduals
+ * adds the projections of keyframe i which are not in the problem yet and which are linked to the window
+ */
+void TSFOptimizeBundle::addWindowResiduals(const std::vector<TSFFrame::Ptr> &map, int i)
+{
+  const TSFFrame &frame = *map[i];
+  std::vector<unsigned> &nb_projs = win_nb_projs[i];
+  nb_projs.resize(frame.projections.size(), 0);
+
+  for (unsigned j=0; j<frame.projections.size(); j++)
+  {
+    const Eigen::Vector3f &n0 = frame.normals[j];
+
+    for (unsigned k=nb_projs[j]; k<frame.projections[j].size(); k++)
+    {
+      const triple<int, cv::Point2f, Eigen::Vector3f> &proj = frame.projections[j][k];
+      int idx1 = proj.first;
+      if (i<win_start && idx1<win_start)
+        continue;
+
+      double *cam0 = getWindowPose(frame);
+      double *cam1 = getWindowPose(*map[idx1]);
+
+      if (win_intrinsics.size()==4 || win_intrinsics.size()==9)
+      {
+        double *pt3 = getWindowPoint(frame, j);
+        ceres::CostFunction *cost;
+        if (win_intrinsics.size()==4)
+          cost = new ceres::AutoDiffCostFunction< ReprojectionErrorGlobalPoseCamViewData, 2, 4, 6, 6, 3 >(
+                   new ReprojectionErrorGlobalPoseCamViewData(proj.second.x,proj.second.y));
+        else
+          cost = new ceres::AutoDiffCostFunction< RadialDistortionReprojectionErrorGlobalPoseCamViewData, 2, 9, 6, 6, 3 >(
+                   new RadialDistortionReprojectionErrorGlobalPoseCamViewData(proj.second.x,proj.second.y));
+        ceres::ResidualBlockId id = win_problem->AddResidualBlock(cost,
+                   (param.use_robust_loss?new ceres::CauchyLoss(param.loss_scale):NULL), &win_intrinsics[0], cam0, cam1, pt3);
+        win_residuals[id] = WindowResidual(i, idx1, j);
+        win_frame_residuals[i].push_back(id);
+        if (idx1!=i) win_frame_residuals[idx1].push_back(id);
+        win_pose_nb_res[i]++;
+        win_pose_nb_res[idx1]++;
+        win_point_nb_res[std::make_pair(i,(int)j)]++;
+      }
+
+      const Eigen::Vector3f &pt3v = proj.third;
+      if (!isnan(pt3v[0]) && !isnan(pt3v[1]) && !isnan(pt3v[2]) && !isnan(n0[0]) && !isnan(n0[1]) && !isnan(n0[2]))
+      {
+        ceres::ResidualBlockId id = win_problem->AddResidualBlock(
+              new ceres::AutoDiffCostFunction< PointToPlaneErrorGlobalPoseCamViewData, 3, 6, 6 >(
+                new PointToPlaneErrorGlobalPoseCamViewData(frame.points3d[j].cast<double>(),n0.cast<double>(),pt3v.cast<double>(),param.depth_error_scale)),
+              (param.use_robust_loss?new ceres::CauchyLoss(param.loss_scale):NULL), cam0, cam1);
+        win_residuals[id] = WindowResidual(i, idx1, -1);
+        win_frame_residuals[i].push_back(id);
+        if (idx1!=i) win_frame_residuals[idx1].push_back(id);
+        win_pose_nb_res[i]++;
+        win_pose_nb_res[idx1]++;
+      }
+    }
+
+    nb_projs[j] = frame.projections[j].size();
+  }
+}
+
+/**
+ * @brief TSFOptimizeBundle::removeWindowResidual
+ * removes a residual and the parameter blocks which are not used anymore
+ */
+void TSFOptimizeBundle::removeWindowResidual(ceres::ResidualBlockId id)
+{
+  std::map<ceres::ResidualBlockId, WindowResidual>::iterator it = win_residuals.find(id);
+  if (it==win_residuals.end())
+    return;
+
+  const WindowResidual r = it->second;
+  win_residuals.erase(it);
+  win_problem->RemoveResidualBlock(id);
+
+  if (r.point>=0)
+  {
+    std::pair<int,int> key(r.frame0, r.point);
+    if (--win_point_nb_res[key]<=0)
+    {
+      win_problem->RemoveParameterBlock(&win_points[key][0]);
+      win_points.erase(key);
+      win_point_nb_res.erase(key);
+    }
+  }
+
+  int frames[2] = {r.frame0, r.frame1};
+  for (unsigned i=0; i<(r.frame0==r.frame1?1:2); i++)
+  {
+    if (--win_pose_nb_res[frames[i]]<=0)
+    {
+      win_problem->RemoveParameterBlock(&win_poses[frames[i]][0]);
+      win_poses.erase(frames[i]);
+      win_pose_nb_res.erase(frames[i]);
+      win_frame_residuals.erase(frames[i]);
+      if (win_gauge==frames[i]) win_gauge = -1;
+    }
+  }
+}
+
+/**
+ * @brief TSFOptimizeBundle::moveWindow
+ * keyframes leaving the window are fixed (i.e. the window is conditioned on them) as long as they are
+ * linked to the window, residuals between fixed keyframes are removed
+ */
+void TSFOptimizeBundle::moveWindow(int new_start)
+{
+  for (int i=win_start; i<new_start; i++)
+  {
+    PoseMap::iterator itp = win_poses.find(i);
+    if (itp!=win_poses.end())
+      win_problem->SetParameterBlockConstant(&itp->second[0]);
+
+    std::map< std::pair<int,int>, Eigen::Vector3d >::iterator itpt = win_points.lower_bound(std::make_pair(i,0));
+    for ( ; itpt!=win_points.end() && itpt->first.first==i; itpt++)
+      win_problem->SetParameterBlockConstant(&itpt->second[0]);
+  }
+
+  int old_start = win_start;
+  win_start = new_start;
+
+  for (int i=old_start; i<new_start; i++)
+  {
+    std::map<int, std::vector<ceres::ResidualBlockId> >::iterator it = win_frame_residuals.find(i);
+    if (it==win_frame_residuals.end())
+      continue;
+
+    std::vector<ceres::ResidualBlockId> ids;
+    ids.swap(it->second);
+    std::vector<ceres::ResidualBlockId> keep;
+
+    for (unsigned j=0; j<ids.size(); j++)
+    {
+      std::map<ceres::ResidualBlockId, WindowResidual>::const_iterator itr = win_residuals.find(ids[j]);
+      if (itr==win_residuals.end())
+        continue;
+      if (itr->second.frame0<win_start && itr->second.frame1<win_start)
+        removeWindowResidual(ids[j]);
+      else keep.push_back(ids[j]);
+    }
+
+    it = win_frame_residuals.find(i);
+    if (it!=win_frame_residuals.end()) it->second.swap(keep);
+  }
+}
+
+/**
+ * @brief TSFOptimizeBundle::setWindowGauge
+ * if the window is not linked to a fixed keyframe, the oldest keyframe of the window is fixed
+ */
+void TSFOptimizeBundle::setWindowGauge()
+{
+  bool have_fixed = (win_poses.size()>0 && win_poses.begin()->first<win_start);
+
+  if (win_gauge>=0 && (have_fixed || win_gauge<win_start))
+  {
+    if (win_gauge>=win_start)
+      win_problem->SetParameterBlockVariable(&win_poses[win_gauge][0]);
+    win_gauge = -1;
+  }
+
+  if (!have_fixed && win_gauge<0 && win_poses.size()>0)
+  {
+    win_gauge = win_poses.begin()->first;
+    win_problem->SetParameterBlockConstant(&win_poses.begin()->second[0]);
+  }
+}
+
+/**
+ * @brief TSFOptimizeBundle::optimizeWindow
+ * Sliding window bundle adjustment of the newest param.window_size keyframes. The problem is kept
+ * alive between calls, i.e. only the projections added since the last call are inserted (new keyframes and
+ * the keyframes listed in updated_frames). Keyframes leaving the window are held constant as long as
+ * they are linked to the window and dropped afterwards, hence the costs depend on the window and not on
+ * the size of the map. Poses and points of the window are written back to the map.
+ * If the camera parameter are not set, only the point to plane (depth) residuals are used.
+ * @param map
+ * @param updated_frames keyframes (besides the new ones) with new projections
+ */
+void TSFOptimizeBundle::optimizeWindow(std::vector<TSFFrame::Ptr> &map, const std::set<int> &updated_frames)
+{
+  if (map.size()<2)
+    return;
+
+  if (!win_problem || win_nb_projs.size()>map.size())
+  {
+    resetWindow();
+    ceres::Problem::Options problem_options;
+    problem_options.enable_fast_removal = true;
+    win_problem.reset(new ceres::Problem(problem_options));
+
+    win_intrinsics = lm_intrinsics;
+    if (win_intrinsics.size()>0)
+    {
+      win_problem->AddParameterBlock(&win_intrinsics[0], win_intrinsics.size());
+      win_problem->SetParameterBlockConstant(&win_intrinsics[0]);
+    }
+  }
+
+  int new_start = (param.window_size>0 ? std::max(0, (int)map.size()-param.window_size) : 0);
+  if (new_start>win_start) moveWindow(new_start);
+
+  int nb_frames = win_nb_projs.size();
+  win_nb_projs.resize(map.size());
+
+  for (std::set<int>::const_iterator it=updated_frames.begin(); it!=updated_frames.end(); it++)
+  {
+    if (*it>=0 && *it<nb_frames)
+      addWindowResiduals(map, *it);
+  }
+  for (int i=nb_frames; i<(int)map.size(); i++)
+    addWindowResiduals(map, i);
+
+  if (win_residuals.size()==0)
+    return;
+
+  setWindowGauge();
+
+  ceres::Solver::Options options;
+  options.use_nonmonotonic_steps = true;
+  options.preconditioner_type = ceres::SCHUR_JACOBI;
+  options.linear_solver_type = ceres::ITERATIVE_SCHUR;
+  options.use_inner_iterations = true;
+  options.max_num_iterations = param.max_iterations_window;
+  options.minimizer_progress_to_stdout = false;
+
+  ceres::Solver::Summary summary;
+  ceres::Solve(options, win_problem.get(), &summary);
+
+  Eigen::Matrix3d R;
+  for (PoseMap::const_iterator it=win_poses.lower_bound(win_start); it!=win_poses.end(); it++)
+  {
+    ceres::AngleAxisToRotationMatrix(&it->second(0), &R(0,0));
+    map[it->first]->pose.topLeftCorner<3, 3>() = R.cast<float>();
+    map[it->first]->pose.block<3,1>(0, 3) = it->second.tail<3>().cast<float>();
+  }
+
+  std::map< std::pair<int,int>, Eigen::Vector3d >::const_iterator itpt = win_points.lower_bound(std::make_pair(win_start,0));
+  for ( ; itpt!=win_points.end(); itpt++)
+    map[itpt->first.first]->points3d[itpt->first.second] = itpt->second.cast<float>();
+}
+
 /**
  * @brief TSFOptimizeBundle::getCameraParameter
  * @param _intrinsic
@@ -632,6 +940,8 @@ void TSFOptimizeBundle::setCameraParameter(const cv::Mat &_intrinsic, const cv::
   lm_intrinsics[1] = intrinsic(1,1);
   lm_intrinsics[2] = intrinsic(0,2);
   lm_intrinsics[3] = intrinsic(1,2);
+
+  resetWindow();
 }
 
 /**
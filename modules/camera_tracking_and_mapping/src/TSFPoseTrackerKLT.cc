@@ -96,11 +96,13 @@ void TSFPoseTrackerKLT::operate()
       cv::goodFeaturesToTrack(im_gray, points, param.max_count, 0.01, 10, cv::Mat(), 3, 0, 0.04);
       getPoints3D(cloud, points, points3d);
       filterValidPoints3D(points, points3d);
+      LKPyramid::Ptr kf_pyr(new LKPyramid(im_gray, param.win_size, 3));
 
       data->lock();
       data->init_points = points.size();
       data->lk_flags = 0;
       im_gray.copyTo(data->prev_gray);
+      data->prev_pyr = kf_pyr;
       data->points[0] = points;
       data->points3d[0] = points3d;
       data->kf_pose = pose;
@@ -336,7 +338,10 @@ bool TSFPoseTrackerKLT::trackCamera(double &conf_ransac_iter, double &conf_track
   bool have_pose = false;
   conf_ransac_iter = conf_tracked_points = 0;
 
-  cv::calcOpticalFlowPyrLK(data->prev_gray, data->gray, data->points[0], data->points[1], status, err, param.win_size, 3, param.termcrit, data->lk_flags, 0.001);
+  // the keyframe pyramid is shared by all frames tracked against it
+  getLKPyramid(data->prev_gray, param.win_size, 3, data->prev_pyr);
+
+  cv::calcOpticalFlowPyrLK(data->prev_pyr->pyr, data->gray, data->points[0], data->points[1], status, err, param.win_size, 3, param.termcrit, data->lk_flags, 0.001);
   data->lk_flags = cv::OPTFLOW_USE_INITIAL_FLOW;
 
   // update lk points
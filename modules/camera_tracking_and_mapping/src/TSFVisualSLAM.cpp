@@ -141,26 +141,23 @@ bool TSFVisualSLAM::track(const pcl::PointCloud<pcl::PointXYZRGB> &cloud, const
  */
 void TSFVisualSLAM::getFilteredCloudNormals(pcl::PointCloud<pcl::PointXYZRGBNormal> &cloud, Eigen::Matrix4f &pose, uint64_t &timestamp)
 {
-  data.lock();
-  v4r::DataMatrix2D<Surfel> &cfilt = *data.filt_cloud;
-  cloud.resize(cfilt.data.size());
+  SurfelSnapshot::ConstPtr snapshot = data.getSnapshot();
+  const SurfelSoA &cfilt = snapshot->cloud;
+  cloud.resize(cfilt.size());
   cloud.width = cfilt.cols;
   cloud.height = cfilt.rows;
   cloud.is_dense = false;
-  TSFDataIntegration::computeNormals(cfilt);
-  for (unsigned i=0; i<cfilt.data.size(); i++)
+  for (int i=0; i<cfilt.size(); i++)
   {
-    const Surfel &s = cfilt.data[i];
     pcl::PointXYZRGBNormal &o = cloud.points[i];
-    o.getVector3fMap() = s.pt;
-    o.r = s.r;
-    o.g = s.g;
-    o.b = s.b;
-    o.getNormalVector3fMap() = s.n;
+    o.getVector3fMap() = cfilt.getPt(i);
+    o.r = cfilt.getR(i);
+    o.g = cfilt.getG(i);
+    o.b = cfilt.getB(i);
+    o.getNormalVector3fMap() = cfilt.getN(i);
   }
-  timestamp = data.filt_timestamp;
-  pose = data.filt_pose;
-  data.unlock();
+  timestamp = snapshot->timestamp;
+  pose = snapshot->pose;
 }
 
 /**
@@ -172,29 +169,25 @@ void TSFVisualSLAM::getFilteredCloudNormals(pcl::PointCloud<pcl::PointXYZRGBNorm
  */
 void TSFVisualSLAM::getFilteredCloudNormals(pcl::PointCloud<pcl::PointXYZRGBNormal> &cloud, std::vector<float> &radius, Eigen::Matrix4f &pose, uint64_t &timestamp)
 {
-  data.lock();
-  v4r::DataMatrix2D<Surfel> &cfilt = *data.filt_cloud;
-  tsfDataIntegration.computeRadius(cfilt, intrinsic);
-  cloud.resize(cfilt.data.size());
+  SurfelSnapshot::ConstPtr snapshot = data.getSnapshot();
+  const SurfelSoA &cfilt = snapshot->cloud;
+  cloud.resize(cfilt.size());
   cloud.width = cfilt.cols;
   cloud.height = cfilt.rows;
   cloud.is_dense = false;
   radius.resize(cloud.points.size());
-  TSFDataIntegration::computeNormals(cfilt);
-  for (unsigned i=0; i<cfilt.data.size(); i++)
+  for (int i=0; i<cfilt.size(); i++)
   {
-    const Surfel &s = cfilt.data[i];
     pcl::PointXYZRGBNormal &o = cloud.points[i];
-    o.getVector3fMap() = s.pt;
-    o.r = s.r;
-    o.g = s.g;
-    o.b = s.b;
-    o.getNormalVector3fMap() = s.n;
-    radius[i] = s.radius;
+    o.getVector3fMap() = cfilt.getPt(i);
+    o.r = cfilt.getR(i);
+    o.g = cfilt.getG(i);
+    o.b = cfilt.getB(i);
+    o.getNormalVector3fMap() = cfilt.getN(i);
+    radius[i] = cfilt.getRadius(i);
   }
-  timestamp = data.filt_timestamp;
-  pose = data.filt_pose;
-  data.unlock();
+  timestamp = snapshot->timestamp;
+  pose = snapshot->pose;
 }
 
 /**
@@ -205,30 +198,27 @@ void TSFVisualSLAM::getFilteredCloudNormals(pcl::PointCloud<pcl::PointXYZRGBNorm
  */
 void TSFVisualSLAM::getFilteredCloudNormals(pcl::PointCloud<pcl::PointXYZRGB> &cloud, pcl::PointCloud<pcl::Normal> &normals, Eigen::Matrix4f &pose, uint64_t &timestamp)
 {
-  data.lock();
-  v4r::DataMatrix2D<Surfel> &cfilt = *data.filt_cloud;
-  cloud.resize(cfilt.data.size());
+  SurfelSnapshot::ConstPtr snapshot = data.getSnapshot();
+  const SurfelSoA &cfilt = snapshot->cloud;
+  cloud.resize(cfilt.size());
   cloud.width = cfilt.cols;
   cloud.height = cfilt.rows;
   cloud.is_dense = false;
-  normals.resize(cfilt.data.size());
+  normals.resize(cfilt.size());
   normals.width = cfilt.cols;
   normals.height = cfilt.rows;
   normals.is_dense = false;
-  TSFDataIntegration::computeNormals(cfilt);
-  for (unsigned i=0; i<cfilt.data.size(); i++)
+  for (int i=0; i<cfilt.size(); i++)
   {
-    const Surfel &s = cfilt.data[i];
     pcl::PointXYZRGB &o = cloud.points[i];
-    o.getVector3fMap() = s.pt;
-    o.r = s.r;
-    o.g = s.g;
-    o.b = s.b;
-    normals.points[i].getNormalVector3fMap() = s.n;
+    o.getVector3fMap() = cfilt.getPt(i);
+    o.r = cfilt.getR(i);
+    o.g = cfilt.getG(i);
+    o.b = cfilt.getB(i);
+    normals.points[i].getNormalVector3fMap() = cfilt.getN(i);
   }
-  timestamp = data.filt_timestamp;
-  pose = data.filt_pose;
-  data.unlock();
+  timestamp = snapshot->timestamp;
+  pose = snapshot->pose;
 }
 
 /**
@@ -238,24 +228,22 @@ void TSFVisualSLAM::getFilteredCloudNormals(pcl::PointCloud<pcl::PointXYZRGB> &c
  */
 void TSFVisualSLAM::getFilteredCloud(pcl::PointCloud<pcl::PointXYZRGB> &cloud, Eigen::Matrix4f &pose, uint64_t &timestamp)
 {
-  data.lock();
-  const v4r::DataMatrix2D<Surfel> &cfilt = *data.filt_cloud;
-  cloud.resize(cfilt.data.size());
+  SurfelSnapshot::ConstPtr snapshot = data.getSnapshot();
+  const SurfelSoA &cfilt = snapshot->cloud;
+  cloud.resize(cfilt.size());
   cloud.width = cfilt.cols;
   cloud.height = cfilt.rows;
   cloud.is_dense = false;
-  for (unsigned i=0; i<cfilt.data.size(); i++)
+  for (int i=0; i<cfilt.size(); i++)
   {
-    const Surfel &s = cfilt.data[i];
     pcl::PointXYZRGB &o = cloud.points[i];
-    o.getVector3fMap() = s.pt;
-    o.r = s.r;
-    o.g = s.g;
-    o.b = s.b;
+    o.getVector3fMap() = cfilt.getPt(i);
+    o.r = cfilt.getR(i);
+    o.g = cfilt.getG(i);
+    o.b = cfilt.getB(i);
   }
-  timestamp = data.filt_timestamp;
-  pose = data.filt_pose;
-  data.unlock();
+  timestamp = snapshot->timestamp;
+  pose = snapshot->pose;
 }
 
 /**
@@ -263,6 +251,8 @@ void TSFVisualSLAM::getFilteredCloud(pcl::PointCloud<pcl::PointXYZRGB> &cloud, E
  * @param cloud
  * @param pose
  * @param timestamp
+ * @param need_normals
+ * (exact copy of the filtered cloud, use getSurfelSnapshot to read it without locking the tracking data)
  */
 void TSFVisualSLAM::getSurfelCloud(v4r::DataMatrix2D<Surfel> &cloud, Eigen::Matrix4f &pose, uint64_t &timestamp, bool need_normals)
 {
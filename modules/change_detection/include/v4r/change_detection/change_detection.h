@@ -25,6 +25,7 @@
 #pragma once
 
 #include <v4r/core/macros.h>
+#include <v4r/change_detection/voxel_occupancy_map.h>
 
 #include <pcl/common/eigen.h>
 #include <pcl/search/kdtree.h>
@@ -70,6 +71,15 @@ public:
     void detect(const typename pcl::PointCloud<PointT>::ConstPtr &source, const CloudPtr target, const Eigen::Affine3f sensor_pose,
 			float diff_tolerance = DEFAULT_PARAMETERS.cloud_difference_tolerance);
 
+    /**
+     * @brief same as detect() but compares against a persistent occupancy map of the reference scene. Added points
+     * are the points of target not within diff_tolerance of an occupied voxel, removed points are the occupied voxels
+     * the sensor sees through (this replaces the occlusion and viewport checks).
+     * The map is not updated, call VoxelOccupancyMap::integrate() if target should become part of the reference.
+     */
+    void detect(const VoxelOccupancyMap<PointT> &reference, const CloudPtr target, const Eigen::Affine3f sensor_pose,
+            float diff_tolerance = DEFAULT_PARAMETERS.cloud_difference_tolerance);
+
 	bool isObjectRemoved(CloudPtr object_cloud) const;
 
     static float computePlanarity(const typename pcl::PointCloud<PointT>::ConstPtr input_cloud);
@@ -55,6 +55,40 @@ std::vector<ObjectIdLabeled> ObjectsHistory<PointType>::markRemovedObjects(
 	return removed;
 }
 
+template<class PointType>
+std::vector<ObjectIdLabeled> ObjectsHistory<PointType>::markRemovedObjects(
+		const VoxelOccupancyMap<PointType> &occupancy_map, float min_free_ratio) {
+	std::vector<ObjectIdLabeled> removed;
+
+	for(typename Db::iterator entry = db.begin(); entry != db.end(); entry++) {
+		if(entry->second.getLastEvent() == ObjectState::REMOVED) {
+			continue;	// there is no pose to query the map at
+		}
+
+		typename pcl::PointCloud<PointType>::Ptr cloud_posed(new pcl::PointCloud<PointType>());
+		pcl::transformPointCloud(*(entry->second.getCloud()), *cloud_posed,
+				entry->second.getLastPose());
+
+		size_t free = 0, observed = 0;
+		for(size_t i = 0; i < cloud_posed->points.size(); i++) {
+			typename VoxelOccupancyMap<PointType>::State state = occupancy_map.getState(cloud_posed->points[i]);
+			if(state != VoxelOccupancyMap<PointType>::UNKNOWN) {
+				observed++;
+				if(state == VoxelOccupancyMap<PointType>::FREE) {
+					free++;
+				}
+			}
+		}
+
+		if(observed > 0 && free > min_free_ratio * observed) {
+			int id = entry->second.markRemoved(time);
+			removed.push_back(ObjectIdLabeled(id, entry->first));
+		}
+	}
+
+	return removed;
+}
+
 template<class PointType>
 std::vector< ObjectChangeForVisual<PointType> > ObjectsHistory<PointType>::getChanges(
 		ObjectState::EventT changeType) {
@@ -38,6 +38,7 @@
 #include <v4r/core/macros.h>
 #include <v4r/change_detection/change_detection.h>
 #include <v4r/change_detection/object_detection.h>
+#include <v4r/change_detection/voxel_occupancy_map.h>
 
 namespace v4r {
 
@@ -225,6 +226,13 @@ public:
 	void add(const std::vector< ObjectDetection<PointType> > &detections);
 	std::vector<ObjectIdLabeled> markRemovedObjects(const ChangeDetector<PointType> &change_detector);
 
+	/**
+	 * Queries the occupancy map of the scene directly: an object is removed if most of its observed voxels
+	 * (at its last pose) are free now.
+	 */
+	std::vector<ObjectIdLabeled> markRemovedObjects(const VoxelOccupancyMap<PointType> &occupancy_map,
+			float min_free_ratio = 0.5f);
+
 	typename pcl::PointCloud<PointType>::Ptr getLastCloudOf(const ObjectLabel &label) {
 		typename Db::iterator entry = db.find(label);
 		typename pcl::PointCloud<PointType>::Ptr cloud_posed(new pcl::PointCloud<PointType>());
@@ -0,0 +1,181 @@
+/******************************************************************************
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ ******************************************************************************/
+
+
+#pragma once
+
+#include <stdint.h>
+#include <unordered_map>
+#include <vector>
+
+#include <boost/shared_ptr.hpp>
+#include <pcl/point_cloud.h>
+#include <pcl/common/eigen.h>
+
+#include <v4r/core/macros.h>
+
+namespace v4r
+{
+
+class V4R_EXPORTS VoxelOccupancyMapParameters
+{
+public:
+    float resolution;       ///< edge length of a voxel in m
+    float max_range;        ///< measurements further away from the sensor only clear space up to this range
+    float surface_margin;   ///< free space updates stop this far in front of the measured surface (in m)
+    float log_odds_hit;     ///< log-odds added to a voxel containing a measurement
+    float log_odds_miss;    ///< log-odds added to a voxel traversed by a ray
+    float log_odds_min;     ///< lower clamping bound (keeps the map able to adapt to changes)
+    float log_odds_max;     ///< upper clamping bound
+    float occupied_threshold;   ///< voxels above this log-odds are occupied
+    float free_threshold;       ///< voxels below this log-odds are free
+    bool store_free_space;  ///< if false, rays only update voxels that have been hit before (saves memory as free space is not stored explicitly)
+    int max_search_radius;  ///< tolerances of isOccupiedNear() / difference() are clamped to this many voxels (bounds the neighbourhood scanned per point)
+
+    VoxelOccupancyMapParameters() :
+            resolution(0.01f),
+            max_range(3.5f),
+            surface_margin(0.02f),
+            log_odds_hit(0.85f),
+            log_odds_miss(-0.4f),
+            log_odds_min(-2.f),
+            log_odds_max(3.5f),
+            occupied_threshold(0.f),
+            free_threshold(0.f),
+            store_free_space(false),
+            max_search_radius(3)
+    { }
+};
+
+/**
+ * @brief Persistent occupancy map of a (reference) scene stored in a sparse voxel hash grid.
+ * Observations are integrated incrementally: voxels containing points become more likely occupied, voxels traversed
+ * by the rays from the sensor to the points become more likely free. Each occupied voxel keeps the last point
+ * observed in it, so the reference scene can be recovered as a point cloud.
+ * Comparing a new observation against the map costs one hash lookup per point (added points) and one ray traversal
+ * per point (removed points), there is no search structure to rebuild per call.
+ */
+template<class PointT>
+class V4R_EXPORTS VoxelOccupancyMap
+{
+public:
+    typedef pcl::PointCloud<PointT> Cloud;
+    typedef typename Cloud::Ptr CloudPtr;
+    typedef typename Cloud::ConstPtr CloudConstPtr;
+    typedef boost::shared_ptr< VoxelOccupancyMap<PointT> > Ptr;
+    typedef boost::shared_ptr< VoxelOccupancyMap<PointT> const> ConstPtr;
+
+    enum State
+    {
+        UNKNOWN,
+        FREE,
+        OCCUPIED
+    };
+
+    VoxelOccupancyMap(const VoxelOccupancyMapParameters &p = VoxelOccupancyMapParameters()) :
+        param_(p), scan_(0)
+    { }
+
+    /**
+     * @brief integrates an observation into the map
+     * @param cloud registered observation (in the frame of the map)
+     * @param sensor_origin position of the sensor in the frame of the map
+     */
+    void integrate(const Cloud &cloud, const Eigen::Vector3f &sensor_origin);
+
+    /**
+     * @brief state of the voxel containing pt
+     */
+    State getState(const PointT &pt) const;
+
+    /**
+     * @brief checks if an occupied voxel lies within tolerance of pt
+     * The voxel containing pt is checked first. Otherwise the voxels of the (2r+1)^3 neighbourhood with
+     * r = ceil(tolerance / resolution) whose box lies within tolerance are looked up, i.e. the cost grows cubically
+     * with tolerance / resolution. r is clamped to max_search_radius.
+     */
+    bool isOccupiedNear(const PointT &pt, float tolerance) const;
+
+    /**
+     * diff = A \ map (points of A that are not within tolerance of an occupied voxel)
+     * indices = indexes of preserved points from A
+     */
+    void difference(const Cloud &A, Cloud &diff, std::vector<int> &indices, float tolerance) const;
+
+    /**
+     * @brief finds the occupied voxels of the map the observation sees through, i.e. which are traversed by the rays
+     * from the sensor to the observed points. These are the parts of the reference scene that disappeared. Occluded or
+     * not observed parts of the map are never traversed, so no further occlusion or viewport check is needed.
+     * @param cloud registered observation (in the frame of the map)
+     * @param sensor_origin position of the sensor in the frame of the map
+     * @param removed last observed point of each of these voxels
+     */
+    void findRemoved(const Cloud &cloud, const Eigen::Vector3f &sensor_origin, Cloud &removed) const;
+
+    /**
+     * @brief returns the last observed point of each occupied voxel
+     */
+    void getOccupiedCloud(Cloud &cloud) const;
+
+    void clear()
+    {
+        voxels_.clear();
+        points_.clear();
+        scan_ = 0;
+    }
+
+    size_t size() const
+    {
+        return voxels_.size();
+    }
+
+    const VoxelOccupancyMapParameters &getParameters() const
+    {
+        return param_;
+    }
+
+private:
+    typedef uint64_t Key;
+
+    struct Voxel
+    {
+        float log_odds;
+        int point_idx;      ///< index of the last point observed in this voxel (-1 if never hit)
+        unsigned int scan;  ///< last scan that updated this voxel (each voxel is updated at most once per scan)
+        Voxel() : log_odds(0.f), point_idx(-1), scan(0) { }
+    };
+
+    VoxelOccupancyMapParameters param_;
+    std::unordered_map<Key, Voxel> voxels_;
+    Cloud points_;
+    unsigned int scan_;
+
+    void getCoordinates(const Eigen::Vector3f &p, int &x, int &y, int &z) const;
+    static Key getKey(int x, int y, int z);
+    State getState(const Voxel &v) const;
+
+    void update(Voxel &v, float log_odds) const;
+
+    template<typename Visitor>
+    void castRay(const Eigen::Vector3f &origin, const Eigen::Vector3f &end, float margin, Visitor &visit) const;
+};
+
+}
@@ -114,6 +114,19 @@ void ChangeDetector<PointT>::detect(const typename pcl::PointCloud<PointT>::Cons
      */
 }
 
+template<class PointT>
+void ChangeDetector<PointT>::detect(const VoxelOccupancyMap<PointT> &reference, const CloudPtr new_scene,
+        const Eigen::Affine3f sensor_pose,
+        float diff_tolerance)
+{
+    added->clear();
+    removed->clear();
+
+    std::vector<int> indices_dummy;
+    reference.difference(*new_scene, *added, indices_dummy, diff_tolerance);
+    reference.findRemoved(*new_scene, sensor_pose.translation(), *removed);
+}
+
 template<class PointT>
 bool ChangeDetector<PointT>::isObjectRemoved(CloudPtr object_cloud) const
 {
@@ -0,0 +1,338 @@
+/*
+ * voxel_occupancy_map.cpp
+ *
+ *  Created on: 19.10.2026
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <unordered_set>
+
+#include <pcl/common/io.h>
+
+#include <v4r/change_detection/voxel_occupancy_map.h>
+
+namespace v4r
+{
+
+template<class PointT>
+void VoxelOccupancyMap<PointT>::getCoordinates(const Eigen::Vector3f &p, int &x, int &y, int &z) const
+{
+    x = (int)std::floor(p(0) / param_.resolution);
+    y = (int)std::floor(p(1) / param_.resolution);
+    z = (int)std::floor(p(2) / param_.resolution);
+}
+
+/**
+ * 21 bit per axis, i.e. +-10km for 1cm voxels
+ */
+template<class PointT>
+typename VoxelOccupancyMap<PointT>::Key VoxelOccupancyMap<PointT>::getKey(int x, int y, int z)
+{
+    static const int offset = 1 << 20;
+    static const Key mask = (1 << 21) - 1;
+    return ( (Key)(x + offset) & mask ) | ( ((Key)(y + offset) & mask) << 21 ) | ( ((Key)(z + offset) & mask) << 42 );
+}
+
+template<class PointT>
+typename VoxelOccupancyMap<PointT>::State VoxelOccupancyMap<PointT>::getState(const Voxel &v) const
+{
+    if(v.log_odds > param_.occupied_threshold)
+        return OCCUPIED;
+    if(v.log_odds < param_.free_threshold)
+        return FREE;
+    return UNKNOWN;
+}
+
+template<class PointT>
+void VoxelOccupancyMap<PointT>::update(Voxel &v, float log_odds) const
+{
+    v.log_odds = std::min( param_.log_odds_max, std::max( param_.log_odds_min, v.log_odds + log_odds ) );
+}
+
+/**
+ * 3D DDA (Amanatides & Woo) in voxel units. Visits every voxel the segment from origin to end intersects,
+ * stopping margin (in m) in front of end.
+ */
+template<class PointT>
+template<typename Visitor>
+void VoxelOccupancyMap<PointT>::castRay(const Eigen::Vector3f &origin, const Eigen::Vector3f &end, float margin, Visitor &visit) const
+{
+    const Eigen::Vector3f o = origin / param_.resolution;
+    Eigen::Vector3f dir = end / param_.resolution - o;
+    const float length = dir.norm() - margin / param_.resolution;
+    if(length <= 0.f)
+        return;
+    dir.normalize();
+
+    int idx[3], step[3];
+    float t_max[3], t_delta[3];
+    for(int a=0; a<3; a++)
+    {
+        idx[a] = (int)std::floor(o(a));
+        if(dir(a) > 0.f)
+        {
+            step[a] = 1;
+            t_max[a] = (idx[a] + 1 - o(a)) / dir(a);
+            t_delta[a] = 1.f / dir(a);
+        }
+        else if(dir(a) < 0.f)
+        {
+            step[a] = -1;
+            t_max[a] = (idx[a] - o(a)) / dir(a);
+            t_delta[a] = -1.f / dir(a);
+        }
+        else
+        {
+            step[a] = 0;
+            t_max[a] = t_delta[a] = std::numeric_limits<float>::infinity();
+        }
+    }
+
+    float t = 0.f;
+    while(t < length)
+    {
+        visit( getKey(idx[0], idx[1], idx[2]) );
+
+        int a = t_max[0] < t_max[1] ? (t_max[0] < t_max[2] ? 0 : 2) : (t_max[1] < t_max[2] ? 1 : 2);
+        t = t_max[a];
+        idx[a] += step[a];
+        t_max[a] += t_delta[a];
+    }
+}
+
+template<class PointT>
+void VoxelOccupancyMap<PointT>::integrate(const Cloud &cloud, const Eigen::Vector3f &sensor_origin)
+{
+    scan_++;
+
+    // one ray per measured voxel, the voxel keeps the last point falling into it
+    std::unordered_map<Key, int> hits;
+    std::unordered_map<Key, Eigen::Vector3f> out_of_range;
+    hits.reserve(cloud.points.size());
+    for(size_t i=0; i<cloud.points.size(); i++)
+    {
+        const PointT &pt = cloud.points[i];
+        if( !pcl::isFinite(pt) )
+            continue;
+
+        const Eigen::Vector3f p = pt.getVector3fMap();
+        int x, y, z;
+        getCoordinates(p, x, y, z);
+        const Key key = getKey(x, y, z);
+
+        const Eigen::Vector3f ray = p - sensor_origin;
+        const float range = ray.norm();
+        if( range > param_.max_range )
+            out_of_range[key] = sensor_origin + ray * (param_.max_range / range);
+        else
+            hits[key] = i;
+    }
+
+    auto clear = [&](Key key)
+    {
+        if( hits.find(key) != hits.end() )    // measured in this scan
+            return;
+
+        typename std::unordered_map<Key, Voxel>::iterator it = voxels_.find(key);
+        if( it == voxels_.end() )
+        {
+            if( !param_.store_free_space )
+                return;
+            it = voxels_.insert( std::make_pair(key, Voxel()) ).first;
+        }
+
+        Voxel &v = it->second;
+        if( v.scan == scan_ )
+            return;
+        v.scan = scan_;
+        update(v, param_.log_odds_miss);
+    };
+
+    for(typename std::unordered_map<Key, int>::const_iterator it = hits.begin(); it != hits.end(); ++it)
+        castRay(sensor_origin, cloud.points[it->second].getVector3fMap(), param_.surface_margin, clear);
+
+    for(typename std::unordered_map<Key, Eigen::Vector3f>::const_iterator it = out_of_range.begin(); it != out_of_range.end(); ++it)
+        castRay(sensor_origin, it->second, 0.f, clear);
+
+    for(typename std::unordered_map<Key, int>::const_iterator it = hits.begin(); it != hits.end(); ++it)
+    {
+        Voxel &v = voxels_[it->first];
+        v.scan = scan_;
+        update(v, param_.log_odds_hit);
+
+        if(v.point_idx < 0)
+        {
+            v.point_idx = points_.points.size();
+            points_.points.push_back( cloud.points[it->second] );
+        }
+        else
+            points_.points[v.point_idx] = cloud.points[it->second];
+    }
+    points_.width = points_.points.size();
+    points_.height = 1;
+}
+
+template<class PointT>
+typename VoxelOccupancyMap<PointT>::State VoxelOccupancyMap<PointT>::getState(const PointT &pt) const
+{
+    if( !pcl::isFinite(pt) )
+        return UNKNOWN;
+
+    int x, y, z;
+    getCoordinates(pt.getVector3fMap(), x, y, z);
+    typename std::unordered_map<Key, Voxel>::const_iterator it = voxels_.find( getKey(x, y, z) );
+    if( it == voxels_.end() )
+        return UNKNOWN;
+
+    return getState(it->second);
+}
+
+template<class PointT>
+bool VoxelOccupancyMap<PointT>::isOccupiedNear(const PointT &pt, float tolerance) const
+{
+    if( !pcl::isFinite(pt) )
+        return false;
+
+    const Eigen::Vector3f p = pt.getVector3fMap();
+
+    // unchanged parts of the scene usually hit the voxel of the point itself
+    int x_p, y_p, z_p;
+    getCoordinates(p, x_p, y_p, z_p);
+    typename std::unordered_map<Key, Voxel>::const_iterator it = voxels_.find( getKey(x_p, y_p, z_p) );
+    if( it != voxels_.end() && getState(it->second) == OCCUPIED )
+        return true;
+
+    const float tol = std::min<float>(tolerance, param_.max_search_radius * param_.resolution);
+    int min_x, min_y, min_z, max_x, max_y, max_z;
+    getCoordinates(p - Eigen::Vector3f::Constant(tol), min_x, min_y, min_z);
+    getCoordinates(p + Eigen::Vector3f::Constant(tol), max_x, max_y, max_z);
+
+    // a point of an occupied voxel can only be within tolerance if the voxel box is
+    for(int z=min_z; z<=max_z; z++)
+    {
+        for(int y=min_y; y<=max_y; y++)
+        {
+            for(int x=min_x; x<=max_x; x++)
+            {
+                const Eigen::Vector3f box_min = Eigen::Vector3f(x, y, z) * param_.resolution;
+                const Eigen::Vector3f box_max = box_min + Eigen::Vector3f::Constant(param_.resolution);
+                const Eigen::Vector3f closest = p.cwiseMax(box_min).cwiseMin(box_max);
+                if( (closest - p).squaredNorm() > tol * tol )
+                    continue;
+
+                it = voxels_.find( getKey(x, y, z) );
+                if( it != voxels_.end() && getState(it->second) == OCCUPIED )
+                    return true;
+            }
+        }
+    }
+    return false;
+}
+
+template<class PointT>
+void VoxelOccupancyMap<PointT>::difference(const Cloud &A, Cloud &diff, std::vector<int> &indices, float tolerance) const
+{
+    if(A.empty())
+        return;
+
+    std::vector<char> keep(A.points.size());
+#pragma omp parallel for schedule(dynamic, 1024)
+    for(size_t i = 0; i < A.points.size(); i++)
+        keep[i] = pcl::isFinite( A.points[i] ) && !isOccupiedNear(A.points[i], tolerance);
+
+    indices.resize( A.points.size() );
+    size_t kept=0;
+    for(size_t i = 0; i < A.points.size(); i++)
+    {
+        if(keep[i])
+            indices[kept++] = i;
+    }
+    indices.resize(kept);
+
+    pcl::copyPointCloud(A, indices, diff);
+    diff.header = A.header;
+    diff.is_dense = true;
+}
+
+template<class PointT>
+void VoxelOccupancyMap<PointT>::findRemoved(const Cloud &cloud, const Eigen::Vector3f &sensor_origin, Cloud &removed) const
+{
+    // one ray per measured voxel
+    std::unordered_set<Key> hits;
+    std::vector<Eigen::Vector3f, Eigen::aligned_allocator<Eigen::Vector3f> > ends;
+    std::vector<float> margins;
+    hits.reserve(cloud.points.size());
+    for(size_t i=0; i<cloud.points.size(); i++)
+    {
+        const PointT &pt = cloud.points[i];
+        if( !pcl::isFinite(pt) )
+            continue;
+
+        const Eigen::Vector3f p = pt.getVector3fMap();
+        int x, y, z;
+        getCoordinates(p, x, y, z);
+        if( !hits.insert( getKey(x, y, z) ).second )
+            continue;
+
+        const Eigen::Vector3f ray = p - sensor_origin;
+        const float range = ray.norm();
+        if( range > param_.max_range )
+        {
+            ends.push_back( sensor_origin + ray * (param_.max_range / range) );
+            margins.push_back( 0.f );
+        }
+        else
+        {
+            ends.push_back( p );
+            margins.push_back( param_.surface_margin );
+        }
+    }
+
+    std::unordered_set<Key> seen_through;
+#pragma omp parallel
+    {
+        std::vector<Key> seen_through_local;
+        auto check = [&](Key key)
+        {
+            typename std::unordered_map<Key, Voxel>::const_iterator it = voxels_.find(key);
+            if( it != voxels_.end() && getState(it->second) == OCCUPIED && it->second.point_idx >= 0 &&
+                    hits.find(key) == hits.end() )
+                seen_through_local.push_back(key);
+        };
+
+#pragma omp for schedule(dynamic, 256) nowait
+        for(size_t i=0; i<ends.size(); i++)
+            castRay(sensor_origin, ends[i], margins[i], check);
+
+#pragma omp critical
+        seen_through.insert(seen_through_local.begin(), seen_through_local.end());
+    }
+
+    removed.points.clear();
+    removed.points.reserve( seen_through.size() );
+    for(typename std::unordered_set<Key>::const_iterator it = seen_through.begin(); it != seen_through.end(); ++it)
+        removed.points.push_back( points_.points[ voxels_.find(*it)->second.point_idx ] );
+    removed.width = removed.points.size();
+    removed.height = 1;
+    removed.is_dense = true;
+}
+
+template<class PointT>
+void VoxelOccupancyMap<PointT>::getOccupiedCloud(Cloud &cloud) const
+{
+    cloud.points.clear();
+    for(typename std::unordered_map<Key, Voxel>::const_iterator it = voxels_.begin(); it != voxels_.end(); ++it)
+    {
+        if( getState(it->second) == OCCUPIED && it->second.point_idx >= 0 )
+            cloud.points.push_back( points_.points[it->second.point_idx] );
+    }
+    cloud.width = cloud.points.size();
+    cloud.height = 1;
+    cloud.is_dense = true;
+}
+
+}
+
+template class V4R_EXPORTS v4r::VoxelOccupancyMap<pcl::PointXYZRGB>;
@@ -35,6 +35,7 @@
 #include <v4r/core/macros.h>
 #include <boost/shared_ptr.hpp>
 #include <Eigen/Core>
+#include <vector>
 
 namespace v4r
 {
@@ -45,29 +46,56 @@ public:
     typedef boost::shared_ptr< EigenFLANN > Ptr;
     typedef boost::shared_ptr< EigenFLANN const> ConstPtr;
 
+    enum IndexType
+    {
+        KDTREE = 0,       ///< randomized kd-trees of FLANN (approximate)
+        BRUTE_FORCE = 1,  ///< exact blocked linear search
+        PQ = 2            ///< product quantization (approximate, compact codes for large databases)
+    };
+
     class V4R_EXPORTS Parameter
     {
     public:
         int kdtree_splits_;
-        int distance_metric_; ///< defines the norm used for feature matching (1... L1 norm, 2... L2 norm)
+        int distance_metric_; ///< defines the norm used for feature matching (1... L1 norm, 2... L2 norm, 3... ChiSquare (not for kd-trees))
         int knn_;
+        int index_type_;    ///< search structure (0... FLANN kd-tree, 1... exact brute force, 2... product quantization)
+        int pq_subspaces_;  ///< number of sub-quantizers for product quantization (each encodes a slice of the dimensions with 8 bit)
+        int pq_rerank_;     ///< number of product quantization candidates per query that are re-ranked with exact distances (0... no re-ranking)
 
         Parameter(
                 int kdtree_splits = 128,
                 int distance_metric = 2,
-                int knn = 1
+                int knn = 1,
+                int index_type = KDTREE,
+                int pq_subspaces = 16,
+                int pq_rerank = 64
                 )
             : kdtree_splits_ (kdtree_splits),
               distance_metric_ (distance_metric),
-              knn_ (knn)
+              knn_ (knn),
+              index_type_ (index_type),
+              pq_subspaces_ (pq_subspaces),
+              pq_rerank_ (pq_rerank)
         {}
     }param_;
 
 private:
+    typedef Eigen::Matrix<float, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor> RowMatrixXf;
+
     boost::shared_ptr< typename flann::Index<flann::L1<float> > > flann_index_l1_;
     boost::shared_ptr< typename flann::Index<flann::L2<float> > > flann_index_l2_;
     boost::shared_ptr<flann::Matrix<float> > flann_data_;
 
+    Eigen::VectorXf data_sq_norms_;           ///< squared L2 norm of each data row (brute force L2)
+    std::vector<RowMatrixXf> pq_codebooks_;   ///< 256 (or less) centroids per sub-quantizer
+    std::vector<int> pq_subspace_start_;      ///< first dimension of each sub-quantizer (and total dimension at the end)
+    std::vector<unsigned char> pq_codes_;     ///< code of each data row (num_data x num_subspaces)
+
+    void bruteForceSearch(const RowMatrixXf &queries, Eigen::MatrixXi &indices, Eigen::MatrixXf &distances) const;
+    void pqSearch(const RowMatrixXf &queries, Eigen::MatrixXi &indices, Eigen::MatrixXf &distances) const;
+    void trainPQ();
+
 public:
     EigenFLANN(const Parameter &p = Parameter()) : param_(p) { }
 
@@ -83,7 +111,7 @@ public:
     /**
      * @brief nearestKSearch perform nearest neighbor search for the rows queries in query_signature
      * @param query_signature (rows = num queries; cols = feature dimension)
-     * @param indices (rows = num queries; cols = nearest neighbor indices)
+     * @param indices (rows = num queries; cols = nearest neighbor indices, at most as many as there are data points)
      * @param distances (rows = num queries; cols = nearest neighbor distances)
      * @return
      */
@@ -0,0 +1,96 @@
+/**
+ * $Id$
+ * 
+ * Software License Agreement (GNU General Public License)
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef V4R_SPSC_QUEUE_HPP
+#define V4R_SPSC_QUEUE_HPP
+
+#include <vector>
+#include <memory>
+#include <atomic>
+#include <utility>
+
+namespace v4r
+{
+
+/**
+ * SPSCQueue
+ * Bounded lock-free queue for exactly one producer and one consumer thread.
+ * Items are moved in and out, i.e. T can be a move-only type.
+ */
+template <typename T, typename Alloc=std::allocator<T> >
+class SPSCQueue
+{
+private:
+  std::vector<T,Alloc> buffer;
+  std::atomic<size_t> head;   // next item to pop (written by the consumer)
+  std::atomic<size_t> tail;   // next free slot (written by the producer)
+
+  SPSCQueue(const SPSCQueue &);
+  SPSCQueue &operator=(const SPSCQueue &);
+
+public:
+  /** one slot is kept free to distinguish a full from an empty queue **/
+  SPSCQueue(size_t capacity=2) : buffer(capacity+1), head(0), tail(0) {}
+
+  /** producer: returns false (and leaves item untouched) if the queue is full **/
+  inline bool push(T &&item)
+  {
+    const size_t t = tail.load(std::memory_order_relaxed);
+    const size_t next = (t+1) % buffer.size();
+
+    if (next == head.load(std::memory_order_acquire))
+      return false;
+
+    buffer[t] = std::move(item);
+    tail.store(next, std::memory_order_release);
+    return true;
+  }
+
+  /** consumer: returns false if the queue is empty **/
+  inline bool pop(T &item)
+  {
+    const size_t h = head.load(std::memory_order_relaxed);
+
+    if (h == tail.load(std::memory_order_acquire))
+      return false;
+
+    item = std::move(buffer[h]);
+    buffer[h] = T();                    // release the resources of the slot
+    head.store((h+1) % buffer.size(), std::memory_order_release);
+    return true;
+  }
+
+  /** only valid if neither producer nor consumer are running **/
+  inline void clear()
+  {
+    T item;
+    while (pop(item)) ;
+  }
+
+  /** producer: a push would fail (e.g. to skip preparing an item) **/
+  inline bool full() const { return (tail.load(std::memory_order_relaxed)+1) % buffer.size() == head.load(std::memory_order_acquire); }
+  inline bool empty() const { return head.load(std::memory_order_acquire) == tail.load(std::memory_order_acquire); }
+  inline size_t capacity() const { return buffer.size()-1; }
+};
+
+} //--END--
+
+#endif
+
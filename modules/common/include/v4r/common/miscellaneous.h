@@ -294,6 +294,23 @@ filterVector(const std::vector<T> &in, const std::vector<int> &indices)
     return out;
 }
 
+/**
+  * @brief: keeps the rows of a matrix indicated by some indices (in place, without reallocation)
+  * @param[inout] mat matrix
+  * @param[in] indices rows to keep (ascending)
+  */
+template<typename MatrixT>
+inline void
+filterRows(MatrixT &mat, const std::vector<int> &indices)
+{
+    for(size_t i = 0; i < indices.size(); i++)
+    {
+        if( (int)i != indices[i] )
+            mat.row(i) = mat.row( indices[i] );
+    }
+    mat.conservativeResize( indices.size(), mat.cols() );
+}
+
 /**
  * @brief checks if value is in the range between min and max
  * @param[in] value to check
@@ -85,6 +85,16 @@ public:
     pcl::PointCloud<pcl::Normal>::Ptr
     compute () = 0;
 
+    /**
+     * @brief clone
+     * @return copy of the normal estimator which can be used concurrently to this instance (empty if the estimator can not be copied)
+     */
+    virtual boost::shared_ptr< NormalEstimator<PointT> >
+    clone() const
+    {
+        return boost::shared_ptr< NormalEstimator<PointT> >();
+    }
+
     typedef boost::shared_ptr< NormalEstimator<PointT> > Ptr;
     typedef boost::shared_ptr< NormalEstimator<PointT> const> ConstPtr;
 };
@@ -119,6 +119,12 @@ public:
         return NormalEstimatorType::PCL_INTEGRAL_NORMAL;
     }
 
+    typename NormalEstimator<PointT>::Ptr
+    clone() const
+    {
+        return typename NormalEstimator<PointT>::Ptr( new NormalEstimatorIntegralImage<PointT>(*this) );
+    }
+
     typedef boost::shared_ptr< NormalEstimatorIntegralImage> Ptr;
     typedef boost::shared_ptr< NormalEstimatorIntegralImage const> ConstPtr;
 };
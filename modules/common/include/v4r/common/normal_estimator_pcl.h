@@ -117,6 +117,12 @@ public:
         return NormalEstimatorType::PCL_INTEGRAL_NORMAL;
     }
 
+    typename NormalEstimator<PointT>::Ptr
+    clone() const
+    {
+        return typename NormalEstimator<PointT>::Ptr( new NormalEstimatorPCL<PointT>(*this) );
+    }
+
     typedef boost::shared_ptr< NormalEstimatorPCL> Ptr;
     typedef boost::shared_ptr< NormalEstimatorPCL const> ConstPtr;
 };
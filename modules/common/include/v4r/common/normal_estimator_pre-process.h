@@ -137,6 +137,12 @@ public:
         return NormalEstimatorType::PCL_INTEGRAL_NORMAL;
     }
 
+    typename NormalEstimator<PointT>::Ptr
+    clone() const
+    {
+        return typename NormalEstimator<PointT>::Ptr( new NormalEstimatorPreProcess<PointT>(*this) );
+    }
+
     typedef boost::shared_ptr< NormalEstimatorPreProcess> Ptr;
     typedef boost::shared_ptr< NormalEstimatorPreProcess const> ConstPtr;
 };
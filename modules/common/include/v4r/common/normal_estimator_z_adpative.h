@@ -147,6 +147,12 @@ public:
         return NormalEstimatorType::Z_ADAPTIVE;
     }
 
+    typename NormalEstimator<PointT>::Ptr
+    clone() const
+    {
+        return typename NormalEstimator<PointT>::Ptr( new ZAdaptiveNormalsPCL<PointT>(*this) );
+    }
+
     typedef boost::shared_ptr< ZAdaptiveNormalsPCL> Ptr;
     typedef boost::shared_ptr< ZAdaptiveNormalsPCL const> ConstPtr;
 };
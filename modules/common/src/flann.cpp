@@ -1,16 +1,100 @@
 #include <v4r/common/flann.h>
+#include <glog/logging.h>
+#include <algorithm>
+#include <limits>
+#include <boost/random.hpp>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
 
 namespace v4r
 {
 
+namespace
+{
+
+const int QUERY_BLOCK = 64;     ///< queries per block (brute force)
+const int DATA_BLOCK = 1024;    ///< data rows per block (brute force)
+
+/**
+ * @brief sorted list of the k nearest candidates found so far
+ */
+class KnnList
+{
+public:
+    int k_, size_;
+    int *idx_;
+    float *dist_;
+
+    KnnList(int k, int *idx, float *dist) : k_(k), size_(0), idx_(idx), dist_(dist) {}
+
+    inline float worst() const { return size_ < k_ ? std::numeric_limits<float>::max() : dist_[k_-1]; }
+
+    inline void insert(int idx, float dist)
+    {
+        if( dist >= worst() )
+            return;
+
+        int pos = size_ < k_ ? size_++ : k_-1;
+        while( pos > 0 && dist_[pos-1] > dist )
+        {
+            dist_[pos] = dist_[pos-1];
+            idx_[pos] = idx_[pos-1];
+            pos--;
+        }
+        dist_[pos] = dist;
+        idx_[pos] = idx;
+    }
+};
+
+/**
+ * @brief distance of two vectors as used by FLANN (1... L1, 2... squared L2, 3... ChiSquare)
+ */
+template<typename DerivedA, typename DerivedB>
+inline float distance(const Eigen::MatrixBase<DerivedA> &a, const Eigen::MatrixBase<DerivedB> &b, int metric)
+{
+    if( metric == 1 )
+        return (a - b).array().abs().sum();
+    else if( metric == 3 )
+        return ( (a - b).array().square() / (a + b).array().max(std::numeric_limits<float>::min()) ).sum();
+    return (a - b).squaredNorm();
+}
+
+int numThreads()
+{
+#ifdef _OPENMP
+    return omp_get_max_threads();
+#else
+    return 1;
+#endif
+}
+
+}
+
 bool
 EigenFLANN::nearestKSearch (const Eigen::MatrixXf &query_signature, Eigen::MatrixXi &indices, Eigen::MatrixXf &distances) const
 {
-    flann::Matrix<int> flann_indices (new int[query_signature.rows() * param_.knn_], query_signature.rows(), param_.knn_);
-    flann::Matrix<float> flann_distances (new float[query_signature.rows() * param_.knn_], query_signature.rows(), param_.knn_);
+    if( param_.index_type_ == BRUTE_FORCE || param_.index_type_ == PQ || param_.distance_metric_ == 3 )
+    {
+        if( !flann_data_ )
+            return false;
+
+        const RowMatrixXf queries = query_signature;
+
+        if( param_.index_type_ == PQ && !pq_codes_.empty() )
+            pqSearch(queries, indices, distances);
+        else
+            bruteForceSearch(queries, indices, distances);
+        return true;
+    }
 
-    indices.resize( query_signature.rows(), param_.knn_ );
-    distances.resize( query_signature.rows(), param_.knn_ );
+    const int k = std::min<int>(param_.knn_, flann_data_->rows);
+    flann::Matrix<int> flann_indices (new int[query_signature.rows() * k], query_signature.rows(), k);
+    flann::Matrix<float> flann_distances (new float[query_signature.rows() * k], query_signature.rows(), k);
+
+    indices.resize( query_signature.rows(), k );
+    distances.resize( query_signature.rows(), k );
 
     flann::Matrix<float> query_desc (new float[ query_signature.rows() *  query_signature.cols()],  query_signature.rows(), query_signature.cols());
     for ( int row_id = 0; row_id < query_signature.rows(); row_id++ )
@@ -23,18 +107,18 @@ EigenFLANN::nearestKSearch (const Eigen::MatrixXf &query_signature, Eigen::Matri
 
     if(param_.distance_metric_==2)
     {
-        if(!flann_index_l2_->knnSearch ( query_desc, flann_indices, flann_distances, param_.knn_, flann::SearchParams ( param_.kdtree_splits_ ) ))
+        if(!flann_index_l2_->knnSearch ( query_desc, flann_indices, flann_distances, k, flann::SearchParams ( param_.kdtree_splits_ ) ))
             return false;
     }
     else
     {
-        if(!flann_index_l1_->knnSearch ( query_desc, flann_indices, flann_distances, param_.knn_, flann::SearchParams ( param_.kdtree_splits_ ) ))
+        if(!flann_index_l1_->knnSearch ( query_desc, flann_indices, flann_distances, k, flann::SearchParams ( param_.kdtree_splits_ ) ))
             return false;
     }
 
     for ( int row_id = 0; row_id < query_signature.rows(); row_id++ )
     {
-        for(int i=0; i<param_.knn_; i++)
+        for(int i=0; i<k; i++)
         {
             indices(row_id, i) = flann_indices[row_id][i];
             distances(row_id, i) = flann_distances[row_id][i];
@@ -43,10 +127,248 @@ EigenFLANN::nearestKSearch (const Eigen::MatrixXf &query_signature, Eigen::Matri
 
     delete[] flann_indices.ptr ();
     delete[] flann_distances.ptr ();
+    delete[] query_desc.ptr ();
 
     return true;
 }
 
+void
+EigenFLANN::bruteForceSearch(const RowMatrixXf &queries, Eigen::MatrixXi &indices, Eigen::MatrixXf &distances) const
+{
+    const int num_queries = queries.rows();
+    const int num_data = flann_data_->rows;
+    const int dim = flann_data_->cols;
+    const int k = std::min(param_.knn_, num_data);
+    const int metric = param_.distance_metric_;
+    Eigen::Map<const RowMatrixXf> data (flann_data_->ptr(), num_data, dim);
+
+    CHECK( queries.cols() == dim ) << "Query dimension (" << queries.cols() << ") does not match data dimension (" << dim << ")!";
+
+    // the work is split into query blocks x data parts. With few queries, each query block is searched
+    // in several data parts concurrently and the partial results are merged afterwards
+    const int num_query_blocks = (num_queries + QUERY_BLOCK - 1) / QUERY_BLOCK;
+    const int num_data_blocks = (num_data + DATA_BLOCK - 1) / DATA_BLOCK;
+    const int num_parts = std::max(1, std::min( num_data_blocks, numThreads() / std::max(1, num_query_blocks) ) );
+
+    std::vector<int> part_idx ( (size_t)num_queries * num_parts * k, -1 );
+    std::vector<float> part_dist ( part_idx.size(), std::numeric_limits<float>::max() );
+
+    Eigen::VectorXf query_sq_norms;
+    if( metric == 2 )
+        query_sq_norms = queries.rowwise().squaredNorm();
+
+#pragma omp parallel for schedule(dynamic)
+    for(int task=0; task < num_query_blocks * num_parts; task++)
+    {
+        const int qb = task / num_parts;
+        const int part = task % num_parts;
+        const int q_start = qb * QUERY_BLOCK;
+        const int q_rows = std::min(QUERY_BLOCK, num_queries - q_start);
+        const int d_first_block = (long)num_data_blocks * part / num_parts;
+        const int d_last_block = (long)num_data_blocks * (part + 1) / num_parts;
+
+        std::vector<KnnList> lists;
+        lists.reserve(q_rows);
+        for(int q=0; q < q_rows; q++)
+        {
+            size_t offset = ( (size_t)(q_start + q) * num_parts + part ) * k;
+            lists.push_back( KnnList(k, &part_idx[offset], &part_dist[offset]) );
+        }
+
+        Eigen::MatrixXf dist_block;
+
+        for(int db = d_first_block; db < d_last_block; db++)
+        {
+            const int d_start = db * DATA_BLOCK;
+            const int d_rows = std::min(DATA_BLOCK, num_data - d_start);
+
+            if( metric == 2 )
+            {
+                // |q|^2 + |d|^2 - 2 q.d, the dot products as one matrix product
+                dist_block.noalias() = -2.f * queries.middleRows(q_start, q_rows) * data.middleRows(d_start, d_rows).transpose();
+                dist_block.colwise() += query_sq_norms.segment(q_start, q_rows);
+                dist_block.rowwise() += data_sq_norms_.segment(d_start, d_rows).transpose();
+            }
+            else
+            {
+                dist_block.resize(q_rows, d_rows);
+                for(int q=0; q < q_rows; q++)
+                    for(int d=0; d < d_rows; d++)
+                        dist_block(q, d) = distance( queries.row(q_start + q), data.row(d_start + d), metric );
+            }
+
+            for(int d=0; d < d_rows; d++)
+                for(int q=0; q < q_rows; q++)
+                    lists[q].insert( d_start + d, std::max(0.f, dist_block(q, d)) );
+        }
+    }
+
+    // merge the results of the data parts
+    indices.resize( num_queries, k );
+    distances.resize( num_queries, k );
+
+    for(int q=0; q < num_queries; q++)
+    {
+        std::vector<int> idx (k, -1);
+        std::vector<float> dist (k, std::numeric_limits<float>::max());
+        KnnList merged (k, &idx[0], &dist[0]);
+
+        for(int j=0; j < num_parts * k; j++)
+        {
+            size_t offset = (size_t)q * num_parts * k + j;
+            if( part_idx[offset] >= 0 )
+                merged.insert( part_idx[offset], part_dist[offset] );
+        }
+
+        for(int i=0; i < k; i++)
+        {
+            indices(q, i) = idx[i];
+            distances(q, i) = dist[i];
+        }
+    }
+}
+
+void
+EigenFLANN::trainPQ()
+{
+    const int num_data = flann_data_->rows;
+    const int dim = flann_data_->cols;
+    const int num_subspaces = std::max(1, std::min(param_.pq_subspaces_, dim) );
+    const int num_centroids = std::min(256, num_data);
+    const int max_training_samples = 256 * 64;
+    const int iterations = 15;
+    Eigen::Map<const RowMatrixXf> data (flann_data_->ptr(), num_data, dim);
+
+    pq_subspace_start_.resize( num_subspaces + 1 );
+    for(int m=0; m <= num_subspaces; m++)
+        pq_subspace_start_[m] = (long)dim * m / num_subspaces;
+
+    // random subset of the data for training the sub-quantizers (fixed seed for reproducible codes)
+    boost::mt19937 rng (42);
+    std::vector<int> samples (num_data);
+    for(int i=0; i < num_data; i++)
+        samples[i] = i;
+    for(int i=0; i < std::min(num_data, max_training_samples); i++)
+    {
+        boost::uniform_int<int> dist(i, num_data - 1);
+        std::swap( samples[i], samples[ dist(rng) ] );
+    }
+    samples.resize( std::min(num_data, max_training_samples) );
+
+    pq_codebooks_.resize( num_subspaces );
+    pq_codes_.resize( (size_t)num_data * num_subspaces );
+
+#pragma omp parallel for schedule(dynamic)
+    for(int m=0; m < num_subspaces; m++)
+    {
+        const int start = pq_subspace_start_[m];
+        const int sub_dim = pq_subspace_start_[m+1] - start;
+        RowMatrixXf &centroids = pq_codebooks_[m];
+
+        // k-means (Lloyd), initialized with the first training samples
+        centroids.resize(num_centroids, sub_dim);
+        for(int c=0; c < num_centroids; c++)
+            centroids.row(c) = data.block(samples[c], start, 1, sub_dim);
+
+        std::vector<int> assignment (samples.size(), 0);
+
+        for(int it=0; it < iterations; it++)
+        {
+            for(size_t i=0; i < samples.size(); i++)
+            {
+                Eigen::VectorXf::Index best;
+                (centroids.rowwise() - data.row(samples[i]).segment(start, sub_dim)).rowwise().squaredNorm().minCoeff(&best);
+                assignment[i] = best;
+            }
+
+            RowMatrixXf sum = RowMatrixXf::Zero(num_centroids, sub_dim);
+            std::vector<int> count (num_centroids, 0);
+            for(size_t i=0; i < samples.size(); i++)
+            {
+                sum.row( assignment[i] ) += data.block(samples[i], start, 1, sub_dim);
+                count[ assignment[i] ]++;
+            }
+
+            for(int c=0; c < num_centroids; c++)
+            {
+                if( count[c] )
+                    centroids.row(c) = sum.row(c) / count[c];
+            }
+        }
+
+        // encode all data
+        for(int i=0; i < num_data; i++)
+        {
+            Eigen::VectorXf::Index best;
+            (centroids.rowwise() - data.row(i).segment(start, sub_dim)).rowwise().squaredNorm().minCoeff(&best);
+            pq_codes_[ (size_t)i * num_subspaces + m ] = best;
+        }
+    }
+}
+
+void
+EigenFLANN::pqSearch(const RowMatrixXf &queries, Eigen::MatrixXi &indices, Eigen::MatrixXf &distances) const
+{
+    const int num_queries = queries.rows();
+    const int num_data = flann_data_->rows;
+    const int dim = flann_data_->cols;
+    const int num_subspaces = pq_codebooks_.size();
+    const int k = std::min(param_.knn_, num_data);
+    const int metric = param_.distance_metric_;
+    const int num_candidates = std::min(num_data, std::max(k, param_.pq_rerank_));
+    Eigen::Map<const RowMatrixXf> data (flann_data_->ptr(), num_data, dim);
+
+    CHECK( queries.cols() == dim ) << "Query dimension (" << queries.cols() << ") does not match data dimension (" << dim << ")!";
+
+    indices.resize( num_queries, k );
+    distances.resize( num_queries, k );
+
+#pragma omp parallel for schedule(dynamic)
+    for(int q=0; q < num_queries; q++)
+    {
+        // distance of the query to each centroid, per sub-quantizer (all metrics are sums over the dimensions)
+        std::vector<float> table ( num_subspaces * 256, 0.f );
+        for(int m=0; m < num_subspaces; m++)
+        {
+            const int start = pq_subspace_start_[m];
+            const int sub_dim = pq_subspace_start_[m+1] - start;
+            for(int c=0; c < pq_codebooks_[m].rows(); c++)
+                table[m * 256 + c] = distance( queries.block(q, start, 1, sub_dim), pq_codebooks_[m].row(c), metric );
+        }
+
+        std::vector<int> cand_idx (num_candidates, -1);
+        std::vector<float> cand_dist (num_candidates, std::numeric_limits<float>::max());
+        KnnList candidates (num_candidates, &cand_idx[0], &cand_dist[0]);
+
+        const unsigned char *code = &pq_codes_[0];
+        for(int i=0; i < num_data; i++, code += num_subspaces)
+        {
+            float d = 0.f;
+            for(int m=0; m < num_subspaces; m++)
+                d += table[m * 256 + code[m]];
+            candidates.insert(i, d);
+        }
+
+        std::vector<int> idx (k, -1);
+        std::vector<float> dist (k, std::numeric_limits<float>::max());
+        KnnList result (k, &idx[0], &dist[0]);
+
+        for(int c=0; c < candidates.size_; c++)
+        {
+            if( param_.pq_rerank_ > 0 )
+                result.insert( cand_idx[c], distance( queries.row(q), data.row( cand_idx[c] ), metric ) );
+            else
+                result.insert( cand_idx[c], cand_dist[c] );
+        }
+
+        for(int i=0; i < k; i++)
+        {
+            indices(q, i) = idx[i];
+            distances(q, i) = dist[i];
+        }
+    }
+}
+
 bool
 EigenFLANN::createFLANN ( const Eigen::MatrixXf &data)
 {
@@ -63,6 +385,25 @@ EigenFLANN::createFLANN ( const Eigen::MatrixXf &data)
             flann_data_->ptr() [row_id * data.cols() + col_id] = data(row_id, col_id);
     }
 
+    flann_index_l1_.reset();
+    flann_index_l2_.reset();
+    pq_codebooks_.clear();
+    pq_codes_.clear();
+
+    if( param_.index_type_ == BRUTE_FORCE || param_.index_type_ == PQ || param_.distance_metric_ == 3 )
+    {
+        if( param_.index_type_ == KDTREE )
+            LOG(WARNING) << "ChiSquare distance is not supported by the kd-tree index. Using exact search instead.";
+
+        Eigen::Map<const RowMatrixXf> rows (flann_data_->ptr(), data.rows(), data.cols());
+        data_sq_norms_ = rows.rowwise().squaredNorm();
+
+        if( param_.index_type_ == PQ )
+            trainPQ();
+
+        return true;
+    }
+
     if(param_.distance_metric_==2)
     {
         flann_index_l2_.reset( new flann::Index<flann::L2<float> > (*flann_data_, flann::KDTreeIndexParams ( 4 )));
@@ -39,6 +39,7 @@
 #include <v4r/core/macros.h>
 
 #include <v4r/features/ImGDescOrientation.h>
+#include <v4r/features/ImGradientMaps.h>
 
 
 namespace v4r 
@@ -52,9 +53,14 @@ public:
   public:
     int win_size;
     ImGDescOrientation::Parameter goParam;
+    bool use_gradient_maps;               // sample the keypoints from image gradient maps instead of warped patches
+                                          // (only for models trained with gradient map descriptors)
+    ImGradientMaps::Parameter gmParam;
     Parameter(int _win_size=34, 
-      const ImGDescOrientation::Parameter &_goParam=ImGDescOrientation::Parameter())
-    : win_size(_win_size), goParam(_goParam) {}
+      const ImGDescOrientation::Parameter &_goParam=ImGDescOrientation::Parameter(),
+      bool _use_gradient_maps=false,
+      const ImGradientMaps::Parameter &_gmParam=ImGradientMaps::Parameter())
+    : win_size(_win_size), goParam(_goParam), use_gradient_maps(_use_gradient_maps), gmParam(_gmParam) {}
   };
 
 private:
@@ -62,6 +68,8 @@ private:
 
   int h_win;
 
+  ImGradientMaps::Ptr maps;
+
 public:
  
 
@@ -71,9 +79,12 @@ public:
   void compute(const cv::Mat_<unsigned char> &image, const std::vector<cv::Point2f> &pts, 
         std::vector<cv::KeyPoint> &keys);
   void compute(const cv::Mat_<unsigned char> &image, std::vector<cv::KeyPoint> &keys);
+  void compute(const ImGradientMaps &_maps, std::vector<cv::KeyPoint> &keys);
   //void compute(const cv::Mat_<unsigned char> &image, std::vector<AffKeypoint> &keys);
 
 
+  inline const Parameter &getParameter() const { return param; }
+
   typedef SmartPtr< ::v4r::ComputeImGDescOrientations> Ptr;
   typedef SmartPtr< ::v4r::ComputeImGDescOrientations const> ConstPtr;
 
@@ -38,6 +38,7 @@
 #include <opencv2/features2d/features2d.hpp>
 
 #include "ImGradientDescriptor.h"
+#include "ImGradientMaps.h"
 
 namespace v4r 
 {
@@ -50,9 +51,14 @@ public:
   public:
     int win_size;
     ImGradientDescriptor::Parameter ghParam;
+    bool use_gradient_maps;               // sample the keypoints from image gradient maps instead of warped patches
+                                          // (only for models trained with gradient map descriptors)
+    ImGradientMaps::Parameter gmParam;
     Parameter(int _win_size=34, 
-      const ImGradientDescriptor::Parameter &_ghParam=ImGradientDescriptor::Parameter())
-    : win_size(_win_size), ghParam(_ghParam) {}
+      const ImGradientDescriptor::Parameter &_ghParam=ImGradientDescriptor::Parameter(),
+      bool _use_gradient_maps=false,
+      const ImGradientMaps::Parameter &_gmParam=ImGradientMaps::Parameter())
+    : win_size(_win_size), ghParam(_ghParam), use_gradient_maps(_use_gradient_maps), gmParam(_gmParam) {}
   };
 
 private:
@@ -60,6 +66,8 @@ private:
 
   int h_win;
 
+  ImGradientMaps::Ptr maps;
+
 public:
  
 
@@ -70,12 +78,16 @@ public:
         cv::Mat &descriptors);
   void compute(const cv::Mat_<unsigned char> &image, const std::vector<cv::KeyPoint> &keys, 
         cv::Mat &descriptors);
+  void compute(const ImGradientMaps &_maps, const std::vector<cv::KeyPoint> &keys, 
+        cv::Mat &descriptors);
   //void compute(const cv::Mat_<unsigned char> &image, const std::vector<AffKeypoint> &keys, 
   //      cv::Mat &descriptors);
 
 
 
 
+  inline const Parameter &getParameter() const { return param; }
+
   typedef SmartPtr< ::v4r::ComputeImGradientDescriptors> Ptr;
   typedef SmartPtr< ::v4r::ComputeImGradientDescriptors const> ConstPtr;
 
@@ -0,0 +1,54 @@
+/**
+ * $Id$
+ *
+ * Software License Agreement (GNU General Public License)
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#ifndef KP_FAST_MATH_HH
+#define KP_FAST_MATH_HH
+
+#include <math.h>
+#include <float.h>
+
+
+namespace v4r
+{
+
+/**
+ * @brief fastAtan2
+ * polynomial approximation (max. error ~1e-5 rad), branch free so that gradient loops vectorize
+ * (shared by SiftCPU and the gradient map based ImGradientDescriptor/ImGDescOrientation)
+ * @return angle in [0,2pi)
+ */
+inline float fastAtan2(const float &y, const float &x)
+{
+  const float ax = fabsf(x), ay = fabsf(y);
+  const float a = (ax<ay ? ax : ay) / ((ax>ay ? ax : ay) + FLT_EPSILON);
+  const float s = a*a;
+  float r = ((-0.0464964749f*s + 0.15931422f)*s - 0.327622764f)*s*a + a;
+  r = (ay > ax ? 1.57079637f - r : r);
+  r = (x < 0 ? 3.14159274f - r : r);
+  r = (y < 0 ? 6.28318548f - r : r);
+  return r;
+}
+
+
+} //--END--
+
+#endif
+
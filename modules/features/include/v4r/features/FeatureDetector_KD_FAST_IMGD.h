@@ -36,6 +36,8 @@
 #include <opencv2/features2d/features2d.hpp>
 #include <v4r/features/FeatureDetector.h>
 #include <v4r/features/ComputeImGradientDescriptors.h>
+#include <v4r/features/ComputeImGDescOrientations.h>
+#include <v4r/features/ImGradientMaps.h>
 #include <v4r/features/FeatureSelection.h>
 
 
@@ -56,15 +58,16 @@ public:
     int tiles;
     ComputeImGradientDescriptors::Parameter gdParam;
     bool do_feature_selection;
+    bool gdesc_orientation;    // replace the ORB orientation with the gradient descriptor orientation
 
     Parameter(int _nfeatures=1000, float _scaleFactor=1.44, 
       int _nlevels=2, int _patchSize=17, int _tiles=1,
       const ComputeImGradientDescriptors::Parameter &_gdParam=ComputeImGradientDescriptors::Parameter(),
-      bool _do_feature_selection=false)
+      bool _do_feature_selection=false, bool _gdesc_orientation=false)
     : nfeatures(_nfeatures), scaleFactor(_scaleFactor), 
       nlevels(_nlevels), patchSize(_patchSize), tiles(_tiles),
       gdParam(_gdParam),
-      do_feature_selection(_do_feature_selection) {}
+      do_feature_selection(_do_feature_selection), gdesc_orientation(_gdesc_orientation) {}
   };
 
 private:
@@ -80,10 +83,17 @@ private:
 
   cv::Ptr<cv::ORB> orb;
   ComputeImGradientDescriptors::Ptr imGDesc;
+  ComputeImGDescOrientations::Ptr imGOri;
+  ImGradientMaps::Ptr maps;            // shared by orientation and description (gdParam.use_gradient_maps)
+  const unsigned char *maps_data;      // image the maps have been computed for in detect(), reused by extract()
+  cv::Size maps_size;
 
   FeatureSelection::Ptr fs;
 
   inline void getExpandedRect(int u, int v, int rows, int cols, cv::Rect &rect);
+  void computeOrientations(std::vector<cv::KeyPoint> &keys);
+  void computeDescriptors(std::vector<cv::KeyPoint> &keys, cv::Mat &descriptors);
+  void computeMaps(const cv::Mat &image);
 
 public:
   FeatureDetector_KD_FAST_IMGD(const Parameter &_p=Parameter());
@@ -39,10 +39,12 @@
 #include <vector>
 #include <opencv2/core/core.hpp>
 #include <opencv2/imgproc/imgproc.hpp>
+#include <opencv2/features2d/features2d.hpp>
 #include <Eigen/Dense>
 #include <stdexcept>
 #include <v4r/core/macros.h>
 #include <v4r/common/impl/SmartPtr.hpp>
+#include <v4r/features/ImGradientMaps.h>
 
 namespace v4r 
 {
@@ -68,9 +70,15 @@ private:
 
   std::vector<float> hist;
 
+  // sampling grid of the gradient map based orientation
+  int grid_win_size;
+  std::vector<float> grid_u, grid_v, grid_w;
+  std::vector<float> gx, gy;
+
   void ComputeGradients(const cv::Mat_<unsigned char> &im);
   void ComputeAngle(const cv::Mat_<float> &weight, float &angle);
   void ComputeLTGaussCirc(const cv::Mat_<unsigned char> &im);
+  void ComputeGrid(int win_size);
 
 
 public:
@@ -80,6 +88,7 @@ public:
 
   void compute(const cv::Mat_<unsigned char> &im, float &angle);
   void compute(const cv::Mat_<unsigned char> &im, const cv::Mat_<float> &weight, float &angle);
+  void compute(const ImGradientMaps &maps, const cv::KeyPoint &key, int win_size, float &angle);
 
   typedef SmartPtr< ::v4r::ImGDescOrientation> Ptr;
   typedef SmartPtr< ::v4r::ImGDescOrientation const> ConstPtr;
@@ -40,9 +40,11 @@
 #include <set>
 #include <opencv2/core/core.hpp>
 #include <opencv2/imgproc/imgproc.hpp>
+#include <opencv2/features2d/features2d.hpp>
 #include <Eigen/Dense>
 #include <stdexcept>
 #include <v4r/common/impl/SmartPtr.hpp>
+#include <v4r/features/ImGradientMaps.h>
 
 namespace v4r 
 {
@@ -72,14 +74,24 @@ private:
   cv::Mat_<short> im_dx, im_dy;
   cv::Mat_<float> lt_gauss;
 
+  // sampling grid of the gradient map based descriptor (one entry per patch pixel)
+  int grid_win_size;
+  std::vector<float> grid_u, grid_v;      // position relative to the patch center
+  std::vector<float> grid_w;              // gaussian weight
+  std::vector<float> grid_r, grid_c;      // continuous spatial bin
+  std::vector<float> gx, gy;
+
   void ComputeGradients(const cv::Mat_<unsigned char> &im);
   void ComputeDescriptor(std::vector<float> &desc, const cv::Mat_<float> &weight);
   void ComputeDescriptorInterpolate(std::vector<float> &desc, const cv::Mat_<float> &weight);
-  void ComputeLTGauss(const cv::Mat_<unsigned char> &im);
-  void ComputeLTGaussCirc(const cv::Mat_<unsigned char> &im);
-  void ComputeLTGaussLin(const cv::Mat_<unsigned char> &im);
+  void ComputeDescriptorTrilinear(std::vector<float> &desc);
+  void ComputeLTGauss(int rows, int cols);
+  void ComputeLTGaussCirc(int rows, int cols);
+  void ComputeLTGaussLin(int rows, int cols);
+  void ComputeGrid(int win_size);
   void Normalize(std::vector<float> &desc);
   void Cut(std::vector<float> &desc);
+  void PostProcess(std::vector<float> &desc);
 
   inline int sign(const float &v);
 
@@ -91,6 +103,7 @@ public:
 
   void compute(const cv::Mat_<unsigned char> &im, std::vector<float> &desc);
   void compute(const cv::Mat_<unsigned char> &im,const cv::Mat_<float> &weight, std::vector<float> &desc);
+  void compute(const ImGradientMaps &maps, const cv::KeyPoint &key, int win_size, std::vector<float> &desc);
 
   typedef SmartPtr< ::v4r::ImGradientDescriptor> Ptr;
   typedef SmartPtr< ::v4r::ImGradientDescriptor const> ConstPtr;
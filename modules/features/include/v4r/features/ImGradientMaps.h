@@ -0,0 +1,96 @@
+/**
+ * $Id$
+ *
+ * Software License Agreement (GNU General Public License)
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#ifndef KP_IM_GRADIENT_MAPS_HH
+#define KP_IM_GRADIENT_MAPS_HH
+
+#include <vector>
+#include <opencv2/core/core.hpp>
+#include <v4r/core/macros.h>
+#include <v4r/common/impl/SmartPtr.hpp>
+
+
+namespace v4r
+{
+
+/**
+ * @brief The ImGradientMaps class
+ * Image pyramid with sobel gradient maps which are computed once per image. ImGradientDescriptor and
+ * ImGDescOrientation sample the (rotated and scaled) keypoint patches from these maps instead of warping
+ * an image patch and recomputing the gradients for each keypoint.
+ */
+class V4R_EXPORTS ImGradientMaps
+{
+public:
+  class Parameter
+  {
+  public:
+    bool smooth;          ///< 3x3 box filter before the sobel operator (as the patch based descriptors)
+    float scale_factor;   ///< scale between two pyramid levels
+    int nb_levels;        ///< max. number of pyramid levels
+    Parameter(bool _smooth=true, float _scale_factor=2., int _nb_levels=4)
+    : smooth(_smooth), scale_factor(_scale_factor), nb_levels(_nb_levels) {}
+  };
+
+  class Level
+  {
+  public:
+    cv::Mat_<float> dx, dy;     ///< sobel gradients
+    float scale_x, scale_y;     ///< level pixel per image pixel
+    Level() : scale_x(1.), scale_y(1.) {}
+  };
+
+private:
+  Parameter param;
+
+  std::vector<Level> pyr;
+  cv::Mat_<unsigned char> im_smooth;
+
+  void computeGradients(const cv::Mat_<unsigned char> &im, Level &level);
+
+public:
+  ImGradientMaps(const Parameter &p=Parameter());
+  ~ImGradientMaps();
+
+  void compute(const cv::Mat_<unsigned char> &image);
+
+  int getLevelIndex(const float &step) const;
+
+  void sample(const cv::Point2f &pt, const float &step, const float &angle, const float *pu, const float *pv,
+              int n, float *gx, float *gy) const;
+
+  inline bool empty() const { return pyr.empty(); }
+  inline int size() const { return (int)pyr.size(); }
+  inline const Level &getLevel(int i) const { return pyr[i]; }
+
+  typedef SmartPtr< ::v4r::ImGradientMaps> Ptr;
+  typedef SmartPtr< ::v4r::ImGradientMaps const> ConstPtr;
+};
+
+
+
+/*************************** INLINE METHODES **************************/
+
+
+} //--END--
+
+#endif
+
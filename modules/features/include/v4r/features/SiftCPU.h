@@ -0,0 +1,162 @@
+/**
+ * $Id$
+ *
+ * Software License Agreement (GNU General Public License)
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef KP_SIFT_CPU_HH
+#define KP_SIFT_CPU_HH
+
+#include <vector>
+#include <string>
+#include <utility>
+#include <opencv2/core/core.hpp>
+#include <boost/shared_ptr.hpp>
+#include <v4r/core/macros.h>
+
+
+namespace v4r
+{
+
+/**
+ * @brief The SiftCPU class
+ * Multi-threaded CPU implementation of the SIFT detector and descriptor. Keypoints and
+ * descriptors follow the SiftGPU conventions (x/y in pixel, s = sigma in pixel, o = orientation
+ * in rad, 128-D unit length descriptors in Lowe's bin order), so that models trained with
+ * SiftGPU can be matched against features computed here and vice versa.
+ * The scale-space and the gradient pyramid are computed once per image and shared by all keypoints.
+ */
+class V4R_EXPORTS SiftCPU
+{
+public:
+  class Parameter
+  {
+  public:
+    int first_octave;             ///< -1 upsamples the input image (as SiftGPU "-fo -1")
+    int nb_levels;                ///< DoG levels per octave
+    int max_octaves;              ///< 0 ... as many as the image size allows
+    float sigma0;                 ///< sigma of the first level of each octave
+    float sigma_init;             ///< assumed blur of the input image
+    float dog_threshold;          ///< contrast threshold (intensities in [0,1])
+    float edge_threshold;         ///< max. ratio of the principal curvatures
+    int max_orientations;         ///< max. number of orientations per keypoint
+    float orientation_peak_ratio; ///< secondary orientation peaks have to be above ratio*max
+    float desc_magnification;     ///< width of a descriptor bin in units of the keypoint scale
+    int nb_threads;               ///< 0 ... omp default
+    Parameter(int _first_octave=-1, int _nb_levels=3, int _max_octaves=0, float _sigma0=1.6, float _sigma_init=0.5,
+      float _dog_threshold=0.02/3., float _edge_threshold=10., int _max_orientations=2, float _orientation_peak_ratio=0.8,
+      float _desc_magnification=3., int _nb_threads=0)
+    : first_octave(_first_octave), nb_levels(_nb_levels), max_octaves(_max_octaves), sigma0(_sigma0), sigma_init(_sigma_init),
+      dog_threshold(_dog_threshold), edge_threshold(_edge_threshold), max_orientations(_max_orientations),
+      orientation_peak_ratio(_orientation_peak_ratio), desc_magnification(_desc_magnification), nb_threads(_nb_threads) {}
+  };
+
+  /** same layout as SiftGPU::SiftKeypoint **/
+  struct Keypoint
+  {
+    float x, y;   ///< location in pixel
+    float s;      ///< scale (sigma in pixel)
+    float o;      ///< orientation in rad
+    Keypoint() : x(0), y(0), s(0), o(0) {}
+    Keypoint(float _x, float _y, float _s, float _o) : x(_x), y(_y), s(_s), o(_o) {}
+  };
+
+private:
+  /** one level of the scale-space **/
+  class Level
+  {
+  public:
+    cv::Mat_<float> im;     ///< gaussian smoothed image
+    cv::Mat_<float> dog;    ///< difference to the next level
+    cv::Mat_<float> mag;    ///< gradient magnitude (on demand)
+    cv::Mat_<float> ori;    ///< gradient orientation in [0,2pi) (on demand)
+    bool have_gradients;
+    Level() : have_gradients(false) {}
+  };
+
+  /** keypoint in octave coordinates **/
+  struct OctaveKeypoint
+  {
+    int octave, level;
+    float x, y;           ///< sub-pixel location in the octave
+    float sigma;          ///< scale in the octave
+    float ori;
+  };
+
+  /** scratch memory used by one thread **/
+  class Buffer
+  {
+  public:
+    std::vector<float> rbin, cbin, obin, w;   ///< gathered samples (structure of arrays)
+    std::vector<float> gw;                    ///< separable gaussian weights
+    std::vector<float> hist;
+  };
+
+  Parameter param;
+
+  cv::Mat_<float> im_float;
+  std::vector< std::vector<Level> > pyr;    ///< [octave][level]
+  std::vector<Buffer> buffers;              ///< one per thread
+
+  std::vector< std::pair<std::string,float> > elapsed_time;
+
+  int getNumThreads() const;
+  void buildScaleSpace(const cv::Mat &image);
+  void computeGradients(Level &level);
+  void prepareGradients(const std::vector<OctaveKeypoint> &keys);
+  void findExtrema(int o, int l, std::vector<OctaveKeypoint> &keys);
+  bool refineExtremum(int o, int &l, int &r, int &c, OctaveKeypoint &key) const;
+  int computeOrientations(const OctaveKeypoint &key, Buffer &buf, float *oris) const;
+  void computeDescriptor(const OctaveKeypoint &key, Buffer &buf, float *desc) const;
+  void toOctaveKeypoint(const Keypoint &key, OctaveKeypoint &okey) const;
+  void toImageKeypoint(const OctaveKeypoint &okey, Keypoint &key) const;
+  void addElapsedTime(const std::string &desc, const double &t0);
+
+public:
+  SiftCPU(const Parameter &p=Parameter());
+  ~SiftCPU();
+
+  /**
+   * detect keypoints and compute descriptors (one row per keypoint, CV_32F)
+   */
+  void detect(const cv::Mat &image, std::vector<Keypoint> &keys, cv::Mat &descriptors);
+
+  /**
+   * compute descriptors for given keypoints (e.g. dense sampling)
+   * if keys_have_orientation is false, the dominant orientation is estimated for each keypoint
+   */
+  void compute(const cv::Mat &image, std::vector<Keypoint> &keys, cv::Mat &descriptors, bool keys_have_orientation=true);
+
+  /** timings of the last call ("stage", ms) **/
+  inline const std::vector< std::pair<std::string,float> > &getElapsedTimes() const { return elapsed_time; }
+
+  inline const Parameter &getParameter() const { return param; }
+  inline int descriptorSize() const { return 128; }
+
+  typedef boost::shared_ptr< ::v4r::SiftCPU> Ptr;
+  typedef boost::shared_ptr< ::v4r::SiftCPU const> ConstPtr;
+};
+
+
+
+/*************************** INLINE METHODES **************************/
+
+
+} //--END--
+
+#endif
+
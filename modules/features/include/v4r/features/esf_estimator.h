@@ -50,6 +50,12 @@ public:
 
     bool needNormals() const { return false; }
 
+    typename GlobalEstimator<PointT>::Ptr
+    clone() const
+    {
+        return typename GlobalEstimator<PointT>::Ptr( new ESFEstimation<PointT>(*this) );
+    }
+
     typedef boost::shared_ptr< ESFEstimation<PointT> > Ptr;
     typedef boost::shared_ptr< ESFEstimation<PointT> const> ConstPtr;
 };
@@ -120,6 +120,12 @@ public:
 
     bool needNormals() const { return false; }
 
+    typename GlobalEstimator<PointT>::Ptr
+    clone() const
+    {
+        return typename GlobalEstimator<PointT>::Ptr( new GlobalColorEstimator<PointT>(*this) );
+    }
+
     typedef boost::shared_ptr< GlobalColorEstimator<PointT> > Ptr;
     typedef boost::shared_ptr< GlobalColorEstimator<PointT> const> ConstPtr;
 };
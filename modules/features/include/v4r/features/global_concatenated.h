@@ -162,6 +162,8 @@ public:
 
     bool needNormals() const { return need_normals_; }
 
+    typename GlobalEstimator<PointT>::Ptr clone() const;
+
     typedef boost::shared_ptr< GlobalConcatEstimator<PointT> > Ptr;
     typedef boost::shared_ptr< GlobalConcatEstimator<PointT> const> ConstPtr;
 };
@@ -108,6 +108,16 @@ namespace v4r
         virtual bool
         needNormals() const = 0;
 
+        /**
+         * @brief clone
+         * @return copy of the estimator which can be used concurrently to this instance (empty if the estimator can not be copied)
+         */
+        virtual boost::shared_ptr< GlobalEstimator<PointT> >
+        clone() const
+        {
+            return boost::shared_ptr< GlobalEstimator<PointT> >();
+        }
+
         typedef boost::shared_ptr< GlobalEstimator<PointT> > Ptr;
         typedef boost::shared_ptr< GlobalEstimator<PointT> const> ConstPtr;
     };
@@ -55,6 +55,12 @@ public:
 
     bool needNormals() const { return false; }
 
+    typename GlobalEstimator<PointT>::Ptr
+    clone() const
+    {
+        return typename GlobalEstimator<PointT>::Ptr( new SimpleShapeEstimator<PointT>(*this) );
+    }
+
     typedef boost::shared_ptr< SimpleShapeEstimator<PointT> > Ptr;
     typedef boost::shared_ptr< SimpleShapeEstimator<PointT> const> ConstPtr;
 };
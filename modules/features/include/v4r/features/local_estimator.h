@@ -23,6 +23,7 @@
 
 #pragma once
 
+#include <Eigen/Dense>
 #include <v4r/common/normal_estimator.h>
 #include <v4r/core/macros.h>
 #include <vector>
@@ -30,6 +31,12 @@
 namespace v4r
 {
 
+/**
+ * @brief contiguous, row-major block of local feature descriptors (one descriptor per row).
+ * The data can be handed to FLANN (flann::Matrix) without copying.
+ */
+typedef Eigen::Matrix<float, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor> LocalDescriptorMatrix;
+
 template<typename PointT>
 class V4R_EXPORTS LocalEstimator
 {
@@ -120,10 +127,10 @@ public:
 
     /**
      * @brief compute features from given input cloud
-     * @param signatures
+     * @param signatures (one row per keypoint)
      */
     virtual void
-    compute (std::vector<std::vector<float> > & signatures)=0;
+    compute (LocalDescriptorMatrix & signatures)=0;
 
     typedef boost::shared_ptr< LocalEstimator<PointT> > Ptr;
     typedef boost::shared_ptr< LocalEstimator<PointT> const> ConstPtr;
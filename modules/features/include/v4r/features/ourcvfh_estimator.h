@@ -84,5 +84,11 @@ public:
     {
         return true;
     }
+
+    typename GlobalEstimator<PointT>::Ptr
+    clone() const
+    {
+        return typename GlobalEstimator<PointT>::Ptr( new OURCVFHEstimator<PointT>(*this) );
+    }
 };
 }
@@ -120,7 +120,7 @@ namespace v4r
         }
 
         void
-        compute(std::vector<std::vector<float> > & signatures);
+        compute(LocalDescriptorMatrix & signatures);
 
         bool
         needNormals () const
@@ -34,7 +34,7 @@
 #ifdef HAVE_SIFTGPU
 #include <SiftGPU/SiftGPU.h>
 #else
-#include <opencv2/nonfree/features2d.hpp> // requires OpenCV non-free module
+#include <v4r/features/SiftCPU.h>
 #endif
 
 //This stuff is needed to be able to make the SIFT histograms persistent
@@ -58,7 +58,7 @@ class V4R_EXPORTS SIFTLocalEstimation : public LocalEstimator<PointT>
 #ifdef HAVE_SIFTGPU
     boost::shared_ptr<SiftGPU> sift_;
 #else
-    boost::shared_ptr<cv::SIFT> sift_;
+    SiftCPU::Ptr sift_;
 #endif
 
 public:
@@ -68,10 +68,12 @@ public:
         bool dense_extraction_;
         bool use_rootSIFT_; ///< enables RootSIFT as described in Arandjelovic and Zisserman, Three things everyone should know to improve object retrieval (CVPR, 2012)
         int stride_;    ///< is dense_extraction, this will define the stride in pixel for extracting SIFT keypoints
+        float dense_scale_; ///< if dense_extraction, scale (sigma in pixel) of the extracted SIFT keypoints
         Parameter ( ):
             dense_extraction_ ( false ),
             use_rootSIFT_( true ),
-            stride_ ( 20 )
+            stride_ ( 20 ),
+            dense_scale_ ( 2.f )
         {}
     }param_;
 
@@ -105,19 +107,35 @@ public:
     }
 
 #else
-    SIFTLocalEstimation (double threshold = 0.03, double edge_threshold = 10.0)
+    /**
+     * @brief CPU implementation (no GL context needed). Keypoints and descriptors are compatible
+     * to SiftGPU, i.e. models trained with either of them can be used.
+     */
+    SIFTLocalEstimation (const SiftCPU::Parameter &p = SiftCPU::Parameter())
+        : max_distance_ (std::numeric_limits<float>::max())
+    {
+        descr_name_ = "sift";
+        descr_type_ = FeatureType::SIFT_OPENCV;
+        descr_dims_ = 128;
+        sift_.reset(new SiftCPU(p));
+    }
+
+    /**
+     * @brief getElapsedTimes
+     * @return timings of the individual SIFT stages of the last call (stage, ms)
+     */
+    const std::vector< std::pair<std::string,float> > &
+    getElapsedTimes() const
     {
-      this->descr_name_ = "sift_opencv";
-        this->descr_type_ = FeatureType::SIFT_OPENCV;
-      sift_.reset(new cv::SIFT(0, 3, threshold, edge_threshold));
+        return sift_->getElapsedTimes();
     }
 #endif
 
     void
-    compute (const cv::Mat_<cv::Vec3b> &colorImage, Eigen::Matrix2Xf &keypoints, std::vector<std::vector<float> > &signatures);
+    compute (const cv::Mat_<cv::Vec3b> &colorImage, Eigen::Matrix2Xf &keypoints, LocalDescriptorMatrix &signatures);
 
     void
-    compute (std::vector<std::vector<float> > & signatures);
+    compute (LocalDescriptorMatrix & signatures);
 
     bool 
 	acceptsIndices() const
@@ -145,12 +163,12 @@ public:
 #ifdef HAVE_SIFTGPU
     /**
      * @brief matchSIFT matches two sets of SIFT descriptors
-     * @param desc1 descriptor 1
-     * @param desc2 descriptor 2
+     * @param desc1 descriptor 1 (one descriptor per row)
+     * @param desc2 descriptor 2 (one descriptor per row)
      * @return indices of the matching descriptors
      */
     std::vector<std::pair<int, int> >
-    matchSIFT( const std::vector<std::vector<float> >& desc1, const std::vector<std::vector<float> >& desc2);
+    matchSIFT( const LocalDescriptorMatrix& desc1, const LocalDescriptorMatrix& desc2);
 #endif
 
     typedef boost::shared_ptr< SIFTLocalEstimation<PointT> > Ptr;
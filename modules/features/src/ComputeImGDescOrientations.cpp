@@ -90,6 +90,14 @@ void ComputeImGDescOrientations::compute(const cv::Mat_<unsigned char> &image, c
  */
 void ComputeImGDescOrientations::compute(const cv::Mat_<unsigned char> &image, std::vector<cv::KeyPoint> &keys)
 {
+  if (param.use_gradient_maps)
+  {
+    if (maps.get()==0) maps.reset(new ImGradientMaps(param.gmParam));
+    maps->compute(image);
+    compute(*maps, keys);
+    return;
+  }
+
   ImGDescOrientation gradOri(param.goParam);
 
   cv::Mat_<float> M(2,3);
@@ -119,6 +127,22 @@ void ComputeImGDescOrientations::compute(const cv::Mat_<unsigned char> &image, s
  
 }
 
+/**
+ * compute orientations from precomputed gradient maps (no patch warping)
+ * the maps can be shared with ComputeImGradientDescriptors
+ */
+void ComputeImGDescOrientations::compute(const ImGradientMaps &_maps, std::vector<cv::KeyPoint> &keys)
+{
+  #pragma omp parallel
+  {
+    ImGDescOrientation gradOri(param.goParam);
+
+    #pragma omp for schedule(dynamic,64)
+    for (int i=0; i<(int)keys.size(); i++)
+      gradOri.compute(_maps, keys[i], param.win_size, keys[i].angle);
+  }
+}
+
 /**
  * compute descriptors
  */
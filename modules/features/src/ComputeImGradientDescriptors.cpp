@@ -89,6 +89,14 @@ void ComputeImGradientDescriptors::compute(const cv::Mat_<unsigned char> &image,
  */
 void ComputeImGradientDescriptors::compute(const cv::Mat_<unsigned char> &image, const std::vector<cv::KeyPoint> &keys, cv::Mat &descriptors)
 {
+  if (param.use_gradient_maps)
+  {
+    if (maps.get()==0) maps.reset(new ImGradientMaps(param.gmParam));
+    maps->compute(image);
+    compute(*maps, keys, descriptors);
+    return;
+  }
+
   ImGradientDescriptor gradDesc(param.ghParam);
 
   cv::Mat_<float> M(2,3);
@@ -124,6 +132,28 @@ void ComputeImGradientDescriptors::compute(const cv::Mat_<unsigned char> &image,
  
 }
 
+/**
+ * compute descriptors from precomputed gradient maps (no patch warping)
+ * the maps can be shared with ComputeImGDescOrientations
+ */
+void ComputeImGradientDescriptors::compute(const ImGradientMaps &_maps, const std::vector<cv::KeyPoint> &keys, cv::Mat &descriptors)
+{
+  descriptors = cv::Mat_<float>(keys.size(), 128);
+
+  #pragma omp parallel
+  {
+    ImGradientDescriptor gradDesc(param.ghParam);
+    std::vector<float> desc(128);
+
+    #pragma omp for schedule(dynamic,64)
+    for (int i=0; i<(int)keys.size(); i++)
+    {
+      gradDesc.compute(_maps, keys[i], param.win_size, desc);
+      memcpy(&descriptors.at<float>(i,0), &desc[0], 128*sizeof(float));
+    }
+  }
+}
+
 /**
  * compute descriptors
  */
@@ -49,7 +49,7 @@ using namespace std;
  * Constructor/Destructor
  */
 FeatureDetector_KD_FAST_IMGD::FeatureDetector_KD_FAST_IMGD(const Parameter &_p)
- : FeatureDetector(KD_FAST_IMGD), param(_p)
+ : FeatureDetector(KD_FAST_IMGD), param(_p), maps_data(0)
 { 
   //orb = new cv::ORB(10000, 1.2, 6, 13, 0, 2, cv::ORB::HARRIS_SCORE, 13); //31
   //orb = new cv::ORB(1000, 1.44, 2, 17, 0, 2, cv::ORB::HARRIS_SCORE, 17);
@@ -61,6 +61,16 @@ FeatureDetector_KD_FAST_IMGD::FeatureDetector_KD_FAST_IMGD(const Parameter &_p)
 
   imGDesc.reset(new ComputeImGradientDescriptors(param.gdParam));
 
+  if (param.gdesc_orientation)
+  {
+    const ImGradientDescriptor::Parameter &gh = param.gdParam.ghParam;
+    imGOri.reset(new ComputeImGDescOrientations( ComputeImGDescOrientations::Parameter(param.gdParam.win_size,
+              ImGDescOrientation::Parameter(gh.smooth, gh.sigma), param.gdParam.use_gradient_maps, param.gdParam.gmParam) ));
+  }
+
+  if (param.gdParam.use_gradient_maps)
+    maps.reset(new ImGradientMaps(param.gdParam.gmParam));
+
   fs.reset( new FeatureSelection(FeatureSelection::Parameter(2.,0.5)) );
 }
 
@@ -68,6 +78,40 @@ FeatureDetector_KD_FAST_IMGD::~FeatureDetector_KD_FAST_IMGD()
 {
 }
 
+/**
+ * computeMaps
+ * computes the gradient maps of im_gray and remembers the image they belong to
+ */
+void FeatureDetector_KD_FAST_IMGD::computeMaps(const cv::Mat &image)
+{
+  maps->compute(im_gray);
+  maps_data = image.data;
+  maps_size = image.size();
+}
+
+/**
+ * computeOrientations
+ * (the gradient maps of im_gray have to be up to date if they are used)
+ */
+void FeatureDetector_KD_FAST_IMGD::computeOrientations(std::vector<cv::KeyPoint> &keys)
+{
+  if (maps.get()!=0)
+    imGOri->compute(*maps, keys);
+  else imGOri->compute(im_gray, keys);
+}
+
+/**
+ * computeDescriptors
+ * (the gradient maps of im_gray have to be up to date if they are used)
+ */
+void FeatureDetector_KD_FAST_IMGD::computeDescriptors(std::vector<cv::KeyPoint> &keys, cv::Mat &descriptors)
+{
+  if (maps.get()!=0)
+    imGDesc->compute(*maps, keys, descriptors);
+  else imGDesc->compute(im_gray, keys, descriptors);
+}
+
+
 /***************************************************************************************/
 
 /**
@@ -84,7 +128,11 @@ void FeatureDetector_KD_FAST_IMGD::detect(const cv::Mat &image, std::vector<cv::
 
   orb->detect(im_gray,keys);
 
-  imGDesc->compute(im_gray, keys, descriptors);
+  if (maps.get()!=0) maps->compute(im_gray);
+  if (param.gdesc_orientation) computeOrientations(keys);
+
+  computeDescriptors(keys, descriptors);
+  maps_data = 0;
 }
 
 /**
@@ -128,6 +176,14 @@ void FeatureDetector_KD_FAST_IMGD::detect(const cv::Mat &image, std::vector<cv::
       } 
     }
   } else orb->detect(im_gray,keys);
+
+  maps_data = 0;
+
+  if (param.gdesc_orientation)
+  {
+    if (maps.get()!=0) computeMaps(image);
+    computeOrientations(keys);
+  }
 }
 
 /**
@@ -135,14 +191,23 @@ void FeatureDetector_KD_FAST_IMGD::detect(const cv::Mat &image, std::vector<cv::
  */
 void FeatureDetector_KD_FAST_IMGD::extract(const cv::Mat &image, std::vector<cv::KeyPoint> &keys, cv::Mat &descriptors)
 {
-  if( image.type() != CV_8U ) cv::cvtColor( image, im_gray, CV_RGB2GRAY );
-  else im_gray = image;  
+  // reuse the gradient maps if detect() already computed them for this image
+  bool have_maps = (maps.get()!=0 && maps_data!=0 && maps_data==image.data && maps_size==image.size());
+  maps_data = 0;
 
-  #ifndef HAVE_OCV_2
-  cv::ocl::setUseOpenCL(false);
-  #endif
+  if (!have_maps)
+  {
+    if( image.type() != CV_8U ) cv::cvtColor( image, im_gray, CV_RGB2GRAY );
+    else im_gray = image;  
+
+    #ifndef HAVE_OCV_2
+    cv::ocl::setUseOpenCL(false);
+    #endif
+
+    if (maps.get()!=0) maps->compute(im_gray);
+  }
 
-  imGDesc->compute(im_gray, keys, descriptors);
+  computeDescriptors(keys, descriptors);
 
   if (param.do_feature_selection)
   {
@@ -31,6 +31,13 @@
  */
 
 #include <v4r/features/ImGDescOrientation.h>
+#include <v4r/features/FastMath.h>
+
+#if defined(_OPENMP) && _OPENMP >= 201307
+#define V4R_OMP_SIMD _Pragma("omp simd")
+#else
+#define V4R_OMP_SIMD
+#endif
 
 namespace v4r
 {
@@ -43,7 +50,7 @@ using namespace std;
  * Constructor/Destructor
  */
 ImGDescOrientation::ImGDescOrientation(const Parameter &p)
- : param(p)
+ : param(p), grid_win_size(0)
 { 
   hist.resize(360);
 }
@@ -131,6 +138,39 @@ void ImGDescOrientation::ComputeLTGaussCirc(const cv::Mat_<unsigned char> &im)
 }
 
 
+/**
+ * ComputeGrid
+ * sampling positions and gaussian weights of a win_size x win_size patch (without the 1px border)
+ */
+void ImGDescOrientation::ComputeGrid(int win_size)
+{
+  if (grid_win_size==win_size)
+    return;
+
+  ComputeLTGaussCirc(cv::Mat_<unsigned char>(win_size,win_size));
+
+  int n = win_size-2;
+  int h_win = win_size/2;
+
+  grid_u.resize(n*n);
+  grid_v.resize(n*n);
+  grid_w.resize(n*n);
+  gx.resize(n*n);
+  gy.resize(n*n);
+
+  for (int v=1, i=0; v<=n; v++)
+  {
+    for (int u=1; u<=n; u++, i++)
+    {
+      grid_u[i] = u-h_win;
+      grid_v[i] = v-h_win;
+      grid_w[i] = lt_gauss(v,u);
+    }
+  }
+
+  grid_win_size = win_size;
+}
+
 
 /***************************************************************************************/
 
@@ -160,5 +200,51 @@ void ImGDescOrientation::compute(const cv::Mat_<unsigned char> &im, const cv::Ma
   ComputeAngle(weight, angle);
 }
 
+
+/**
+ * compute dominant orientation from precomputed gradient maps
+ * the patch is sampled at the scale of the keypoint (key.size), the angle follows the
+ * convention of the patch based version (atan2 in deg + 180)
+ * @param win_size patch size incl. 1px border (e.g. 34)
+ */
+void ImGDescOrientation::compute(const ImGradientMaps &maps, const cv::KeyPoint &key, int win_size, float &angle)
+{
+  ComputeGrid(win_size);
+
+  const int n = grid_u.size();
+  const float N_RAD_GRAD = 180./M_PI;
+  float *d_gx = &gx[0], *d_gy = &gy[0];
+  const float *d_w = &grid_w[0];
+
+  maps.sample(key.pt, key.size/float(win_size-2), 0., &grid_u[0], &grid_v[0], n, d_gx, d_gy);
+
+  // weighted magnitude and histogram bin, computed in place
+  V4R_OMP_SIMD
+  for (int i=0; i<n; i++)
+  {
+    const float mag = (fabsf(d_gx[i])+fabsf(d_gy[i])) * d_w[i];
+    const float a = fastAtan2(d_gy[i],d_gx[i])*N_RAD_GRAD;
+    d_gy[i] = (a > 180.f ? a-360.f : a);      // (-180,180] as atan2
+    d_gx[i] = mag;
+  }
+
+  hist.assign(360,0.);
+
+  for (int i=0; i<n; i++)
+    hist[(int(d_gy[i])+180)%360] += d_gx[i];
+
+  float max=0;
+  unsigned idx=0;
+  for (unsigned i=0; i<hist.size(); i++)
+  {
+    if (hist[i]>max)
+    {
+      max = hist[i];
+      idx=i;
+    }
+  }
+
+  angle = idx;
 }
 
+}
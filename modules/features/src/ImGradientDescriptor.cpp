@@ -31,9 +31,16 @@
  */
 
 #include <v4r/features/ImGradientDescriptor.h>
+#include <v4r/features/FastMath.h>
 
 //#define IMGD_INTERPOLATED
 
+#if defined(_OPENMP) && _OPENMP >= 201307
+#define V4R_OMP_SIMD _Pragma("omp simd")
+#else
+#define V4R_OMP_SIMD
+#endif
+
 
 namespace v4r
 {
@@ -46,7 +53,7 @@ using namespace std;
  * Constructor/Destructor
  */
 ImGradientDescriptor::ImGradientDescriptor(const Parameter &p)
- : param(p)
+ : param(p), grid_win_size(0)
 { 
   //param.computeRootGD = false;
 }
@@ -186,27 +193,27 @@ void ImGradientDescriptor::ComputeDescriptorInterpolate(std::vector<float> &desc
 /**
  * ComputeLTGauss
  */
-void ImGradientDescriptor::ComputeLTGauss(const cv::Mat_<unsigned char> &im)
+void ImGradientDescriptor::ComputeLTGauss(int rows, int cols)
 {
-  if (lt_gauss.rows!=im.rows || lt_gauss.cols!=im.cols)
+  if (lt_gauss.rows!=rows || lt_gauss.cols!=cols)
   {
     if (param.gauss_lin)
-      ComputeLTGaussLin(im);
-    else ComputeLTGaussCirc(im);
+      ComputeLTGaussLin(rows, cols);
+    else ComputeLTGaussCirc(rows, cols);
   }
 }
 
 /**
  * ComputeLTGaussCirc
  */
-void ImGradientDescriptor::ComputeLTGaussCirc(const cv::Mat_<unsigned char> &im)
+void ImGradientDescriptor::ComputeLTGaussCirc(int rows, int cols)
 {  
-  if (im.rows!=im.cols || (im.rows-2)%4 != 0)
+  if (rows!=cols || (rows-2)%4 != 0)
     throw std::runtime_error("[ImGradientDescriptor::ComputeLTGaussCirc] Invalid patch size!");
 
-  lt_gauss=cv::Mat_<float>(im.rows,im.cols);
+  lt_gauss=cv::Mat_<float>(rows,cols);
 
-  float h_size = im.rows/2;
+  float h_size = rows/2;
   float invSqrSigma;
 
   invSqrSigma = param.sigma*(float)(h_size-1);
@@ -220,9 +227,9 @@ void ImGradientDescriptor::ComputeLTGaussCirc(const cv::Mat_<unsigned char> &im)
     }
   }
 
-  /*cv::Mat_<unsigned char> tmp(im.rows,im.cols);
-  for (int v=0; v<im.rows; v++)
-    for (int u=0; u<im.cols; u++)
+  /*cv::Mat_<unsigned char> tmp(rows,cols);
+  for (int v=0; v<rows; v++)
+    for (int u=0; u<cols; u++)
       tmp(v,u) = lt_gauss(v,u)*255;
   cv::imshow("image",tmp);
   cv::waitKey(0);*/
@@ -231,14 +238,14 @@ void ImGradientDescriptor::ComputeLTGaussCirc(const cv::Mat_<unsigned char> &im)
 /**
  * ComputeLTGaussLin
  */
-void ImGradientDescriptor::ComputeLTGaussLin(const cv::Mat_<unsigned char> &im)
+void ImGradientDescriptor::ComputeLTGaussLin(int rows, int cols)
 {  
-  if ((im.cols-2)%4 != 0 || (im.rows-2)%4 != 0)
+  if ((cols-2)%4 != 0 || (rows-2)%4 != 0)
     throw std::runtime_error("[ImGradientDescriptor::ComputeLTGaussLin] Invalid patch size!");
 
-  lt_gauss.resize(im.rows,im.cols);
+  lt_gauss.resize(rows,cols);
 
-  float h_size = im.rows/2;
+  float h_size = rows/2;
   float invSqrSigma;
 
   invSqrSigma = param.sigma*(float)(h_size-1);
@@ -246,7 +253,7 @@ void ImGradientDescriptor::ComputeLTGaussLin(const cv::Mat_<unsigned char> &im)
   
   for (int v=-h_size; v<h_size; v++)
   {
-    for (int u=0; u<im.cols; u++)
+    for (int u=0; u<cols; u++)
     {
       lt_gauss(v+h_size,u) = exp(invSqrSigma*(u*u));
     }
@@ -254,6 +261,97 @@ void ImGradientDescriptor::ComputeLTGaussLin(const cv::Mat_<unsigned char> &im)
 }
 
 
+/**
+ * ComputeGrid
+ * sampling positions, gaussian weights and spatial bins of a win_size x win_size patch
+ * (the same layout as the warped patches, i.e. without the 1px border)
+ */
+void ImGradientDescriptor::ComputeGrid(int win_size)
+{
+  if (grid_win_size==win_size)
+    return;
+
+  ComputeLTGauss(win_size, win_size);
+
+  int n = win_size-2;
+  int h_win = win_size/2;
+  float inv_d = 4./float(n);
+
+  grid_u.resize(n*n);
+  grid_v.resize(n*n);
+  grid_w.resize(n*n);
+  grid_r.resize(n*n);
+  grid_c.resize(n*n);
+  gx.resize(n*n);
+  gy.resize(n*n);
+
+  for (int v=1, i=0; v<=n; v++)
+  {
+    for (int u=1; u<=n; u++, i++)
+    {
+      grid_u[i] = u-h_win;
+      grid_v[i] = v-h_win;
+      grid_w[i] = lt_gauss(v,u);
+      grid_c[i] = (u-.5)*inv_d - .5;
+      grid_r[i] = (v-.5)*inv_d - .5;
+    }
+  }
+
+  grid_win_size = win_size;
+}
+
+/**
+ * ComputeDescriptorTrilinear
+ * bins the sampled gradients (gx, gy) with trilinear interpolation (4x4 spatial, 8 orientations)
+ */
+void ImGradientDescriptor::ComputeDescriptorTrilinear(std::vector<float> &desc)
+{
+  const int n = gx.size();
+  const float ori_scale = 8./(2.*M_PI);
+  float *d_gx = &gx[0], *d_gy = &gy[0];
+  const float *d_w = &grid_w[0];
+
+  desc.assign(128,0.);
+
+  // magnitude (L1, as the patch based version) and continuous orientation bin, computed in place
+  V4R_OMP_SIMD
+  for (int i=0; i<n; i++)
+  {
+    const float mag = (fabsf(d_gx[i])+fabsf(d_gy[i])) * d_w[i];
+    d_gy[i] = fastAtan2(d_gy[i],d_gx[i])*ori_scale - .5f;
+    d_gx[i] = mag;
+  }
+
+  for (int i=0; i<n; i++)
+  {
+    const float mag = d_gx[i];
+    if (mag <= 0.)
+      continue;
+
+    const float r = grid_r[i], c = grid_c[i], o = d_gy[i];
+    const int r0 = (int)floor(r), c0 = (int)floor(c), o0 = (int)floor(o);
+    const float dr = r-r0, dc = c-c0, dor = o-o0;
+    const int ob0 = (o0+8)&7, ob1 = (o0+9)&7;
+
+    for (int rr=0; rr<2; rr++)
+    {
+      const int rb = r0+rr;
+      if (rb<0 || rb>=4) continue;
+      const float vr = mag*(rr==0 ? 1.f-dr : dr);
+
+      for (int cc=0; cc<2; cc++)
+      {
+        const int cb = c0+cc;
+        if (cb<0 || cb>=4) continue;
+        const float vc = vr*(cc==0 ? 1.f-dc : dc);
+        float *d = &desc[(rb*4+cb)*8];
+        d[ob0] += vc*(1.f-dor);
+        d[ob1] += vc*dor;
+      }
+    }
+  }
+}
+
 /**
  * Normalize
  */
@@ -289,6 +387,28 @@ void ImGradientDescriptor::Cut(std::vector<float> &desc)
 }
 
 
+/**
+ * PostProcess
+ * normalization and root gradient descriptor
+ */
+void ImGradientDescriptor::PostProcess(std::vector<float> &desc)
+{
+  if (param.normalize)
+  {
+    Normalize(desc);   // to 1
+    Cut(desc);         // cut 0.2
+    Normalize(desc);   // renormalize to 1
+  }
+
+  if (param.computeRootGD)
+  {
+    Eigen::Map<Eigen::VectorXf> eig_desc(&desc[0], desc.size());
+    float norm = eig_desc.lpNorm<1>();
+    eig_desc.array() /= norm;
+    eig_desc.array() = eig_desc.array().sqrt();
+  }
+}
+
 
 /***************************************************************************************/
 
@@ -299,7 +419,7 @@ void ImGradientDescriptor::Cut(std::vector<float> &desc)
  */
 void ImGradientDescriptor::compute(const cv::Mat_<unsigned char> &im, std::vector<float> &desc)
 {
-  ComputeLTGauss(im);
+  ComputeLTGauss(im.rows, im.cols);
 
   ComputeGradients(im);
 
@@ -309,20 +429,7 @@ void ImGradientDescriptor::compute(const cv::Mat_<unsigned char> &im, std::vecto
   ComputeDescriptor(desc, lt_gauss);
   #endif
 
-  if (param.normalize)
-  {
-    Normalize(desc);   // to 1
-    Cut(desc);         // cut 0.2
-    Normalize(desc);   // renormalize to 1
-  }
-
-  if (param.computeRootGD)
-  {
-    Eigen::Map<Eigen::VectorXf> eig_desc(&desc[0], desc.size());
-    float norm = eig_desc.lpNorm<1>();
-    eig_desc.array() /= norm;
-    eig_desc.array() = eig_desc.array().sqrt();
-  }
+  PostProcess(desc);
 }
 
 /**
@@ -340,19 +447,27 @@ void ImGradientDescriptor::compute(const cv::Mat_<unsigned char> &im, const cv::
   ComputeDescriptor(desc, weight);
   #endif
 
-  if (param.normalize)
-  {
-    Normalize(desc);   // to 1
-    Cut(desc);         // cut 0.2
-    Normalize(desc);   // renormalize to 1
-  }
+  PostProcess(desc);
+}
 
-  if (param.computeRootGD)
-  {
-    Eigen::Map<Eigen::VectorXf> eig_desc(&desc[0], desc.size());
-    float norm = eig_desc.lpNorm<1>();
-    eig_desc.array() /= norm;
-    eig_desc.array() = eig_desc.array().sqrt();
-  }
+/**
+ * compute gradient descriptor of a keypoint from precomputed gradient maps
+ * the patch is sampled as the warped patches of ComputeImGradientDescriptors (key.size/key.angle),
+ * but the gradients are interpolated from the maps and binned trilinear
+ * @param win_size patch size incl. 1px border (e.g. 34)
+ */
+void ImGradientDescriptor::compute(const ImGradientMaps &maps, const cv::KeyPoint &key, int win_size, std::vector<float> &desc)
+{
+  ComputeGrid(win_size);
+
+  float step = key.size/float(win_size-2);
+  float dir = key.angle*(float)(CV_PI/180);
+
+  maps.sample(key.pt, step, dir, &grid_u[0], &grid_v[0], grid_u.size(), &gx[0], &gy[0]);
+
+  ComputeDescriptorTrilinear(desc);
+
+  PostProcess(desc);
 }
+
 }
@@ -0,0 +1,174 @@
+/**
+ * $Id$
+ *
+ * Software License Agreement (GNU General Public License)
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#include <v4r/features/ImGradientMaps.h>
+#include <opencv2/imgproc/imgproc.hpp>
+#include <math.h>
+
+#if defined(_OPENMP) && _OPENMP >= 201307
+#define V4R_OMP_SIMD _Pragma("omp simd")
+#else
+#define V4R_OMP_SIMD
+#endif
+
+
+namespace v4r
+{
+
+using namespace std;
+
+
+/************************************************************************************
+ * Constructor/Destructor
+ */
+ImGradientMaps::ImGradientMaps(const Parameter &p)
+ : param(p)
+{
+}
+
+ImGradientMaps::~ImGradientMaps()
+{
+}
+
+/**
+ * @brief ImGradientMaps::computeGradients
+ * same gradient operator as ImGradientDescriptor::ComputeGradients, but for the whole image
+ */
+void ImGradientMaps::computeGradients(const cv::Mat_<unsigned char> &im, Level &level)
+{
+  if (param.smooth)
+    cv::blur(im, im_smooth, cv::Size(3,3));
+  else im_smooth = im;
+
+  cv::Sobel(im_smooth, level.dx, CV_32F, 1, 0, 3, 1, 0, cv::BORDER_DEFAULT );
+  cv::Sobel(im_smooth, level.dy, CV_32F, 0, 1, 3, 1, 0, cv::BORDER_DEFAULT );
+}
+
+
+
+/***************************************************************************************/
+
+/**
+ * @brief ImGradientMaps::compute
+ * computes the image pyramid and the gradient maps of all levels
+ * @param image
+ */
+void ImGradientMaps::compute(const cv::Mat_<unsigned char> &image)
+{
+  cv::Mat_<unsigned char> im_level = image;
+  int nb_levels = std::max(1, param.nb_levels);
+
+  pyr.resize(nb_levels);
+
+  for (int i=0; i<nb_levels; i++)
+  {
+    Level &level = pyr[i];
+
+    if (i>0)
+    {
+      float scale = 1./pow(param.scale_factor, i);
+      cv::Size sz(cvRound(image.cols*scale), cvRound(image.rows*scale));
+      if (sz.width < 16 || sz.height < 16)
+      {
+        pyr.resize(i);
+        break;
+      }
+      cv::resize(image, im_level, sz, 0, 0, cv::INTER_AREA);
+    }
+
+    level.scale_x = float(im_level.cols)/float(image.cols);
+    level.scale_y = float(im_level.rows)/float(image.rows);
+    computeGradients(im_level, level);
+  }
+}
+
+/**
+ * @brief ImGradientMaps::getLevelIndex
+ * @param step sampling distance in image pixel
+ * @return the finest level which is not upsampled at the given sampling distance
+ */
+int ImGradientMaps::getLevelIndex(const float &step) const
+{
+  if (step <= 1. || pyr.size() < 2)
+    return 0;
+
+  int idx = (int)(log(step)/log(param.scale_factor) + 1e-3);
+  return (idx < (int)pyr.size() ? idx : (int)pyr.size()-1);
+}
+
+/**
+ * @brief ImGradientMaps::sample
+ * bilinear interpolation of the gradients at the patch positions pu/pv (relative to the patch center).
+ * The patch is rotated by angle (rad) and scaled by step (image pixel per patch pixel) like the warped
+ * patches of ComputeImGradientDescriptors, and the gradients are returned in the patch frame.
+ * Samples outside of the image are set to zero.
+ */
+void ImGradientMaps::sample(const cv::Point2f &pt, const float &step, const float &angle, const float *pu, const float *pv,
+                            int n, float *gx, float *gy) const
+{
+  const Level &level = pyr[getLevelIndex(step)];
+  const cv::Mat_<float> &dx = level.dx;
+  const cv::Mat_<float> &dy = level.dy;
+
+  const float co = cos(angle), si = sin(angle);
+  const float x0 = (pt.x+.5f)*level.scale_x - .5f;
+  const float y0 = (pt.y+.5f)*level.scale_y - .5f;
+  const float a00 = co*step*level.scale_x, a01 = si*step*level.scale_x;
+  const float a10 = -si*step*level.scale_y, a11 = co*step*level.scale_y;
+
+  // positions in the level (computed in place)
+  V4R_OMP_SIMD
+  for (int i=0; i<n; i++)
+  {
+    gx[i] = x0 + a00*pu[i] + a01*pv[i];
+    gy[i] = y0 + a10*pu[i] + a11*pv[i];
+  }
+
+  const float max_x = dx.cols-1, max_y = dx.rows-1;
+
+  for (int i=0; i<n; i++)
+  {
+    const float x = gx[i], y = gy[i];
+
+    if (!(x>=0 && y>=0 && x<max_x && y<max_y))
+    {
+      gx[i] = gy[i] = 0.;
+      continue;
+    }
+
+    const int xi = (int)x, yi = (int)y;
+    const float ax = x-xi, ay = y-yi;
+    const float w00 = (1.f-ax)*(1.f-ay), w01 = ax*(1.f-ay), w10 = (1.f-ax)*ay, w11 = ax*ay;
+    const float *dx0 = &dx(yi,xi), *dx1 = &dx(yi+1,xi);
+    const float *dy0 = &dy(yi,xi), *dy1 = &dy(yi+1,xi);
+
+    const float ix = w00*dx0[0] + w01*dx0[1] + w10*dx1[0] + w11*dx1[1];
+    const float iy = w00*dy0[0] + w01*dy0[1] + w10*dy1[0] + w11*dy1[1];
+
+    // rotate to the patch frame
+    gx[i] = co*ix - si*iy;
+    gy[i] = si*ix + co*iy;
+  }
+}
+
+
+}
+
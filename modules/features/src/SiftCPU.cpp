@@ -0,0 +1,751 @@
+/**
+ * $Id$
+ *
+ * Software License Agreement (GNU General Public License)
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <v4r/features/SiftCPU.h>
+#include <v4r/features/FastMath.h>
+#include <opencv2/imgproc/imgproc.hpp>
+#include <Eigen/Dense>
+#include <algorithm>
+#include <climits>
+#include <omp.h>
+
+#if defined(_OPENMP) && _OPENMP >= 201307
+#define V4R_OMP_SIMD _Pragma("omp simd")
+#else
+#define V4R_OMP_SIMD
+#endif
+
+
+namespace v4r
+{
+
+using namespace std;
+
+static const int SIFT_IMG_BORDER = 5;
+static const int SIFT_MAX_INTERP_STEPS = 5;
+static const int SIFT_ORI_HIST_BINS = 36;
+static const float SIFT_ORI_SIG_FCTR = 1.5f;
+static const float SIFT_ORI_RADIUS = 3.f * SIFT_ORI_SIG_FCTR;
+static const int SIFT_DESCR_WIDTH = 4;
+static const int SIFT_DESCR_HIST_BINS = 8;
+static const float SIFT_DESCR_MAG_THR = 0.2f;
+static const float SIFT_2PI = 6.28318548f;
+
+
+/************************************************************************************
+ * Constructor/Destructor
+ */
+SiftCPU::SiftCPU(const Parameter &p)
+ : param(p)
+{
+}
+
+SiftCPU::~SiftCPU()
+{
+}
+
+
+
+
+/***************************************************************************************/
+
+/**
+ * @brief SiftCPU::getNumThreads
+ */
+int SiftCPU::getNumThreads() const
+{
+  return (param.nb_threads>0 ? param.nb_threads : omp_get_max_threads());
+}
+
+/**
+ * @brief SiftCPU::addElapsedTime
+ */
+void SiftCPU::addElapsedTime(const std::string &desc, const double &t0)
+{
+  elapsed_time.push_back( std::make_pair(desc, (float)(1000.*(cv::getTickCount()-t0)/cv::getTickFrequency())) );
+}
+
+/**
+ * @brief SiftCPU::buildScaleSpace
+ * gaussian and DoG pyramid (gradients are computed on demand, see prepareGradients)
+ * @param image
+ */
+void SiftCPU::buildScaleSpace(const cv::Mat &image)
+{
+  cv::Mat gray;
+  if (image.channels()==3) cv::cvtColor(image, gray, CV_BGR2GRAY);
+  else gray = image;
+
+  if (gray.depth()==CV_8U) gray.convertTo(im_float, CV_32F, 1./255.);
+  else gray.convertTo(im_float, CV_32F);
+
+  cv::Mat_<float> base;
+  float sigma_init = param.sigma_init;
+
+  if (param.first_octave < 0)
+  {
+    float scale = (float)(1<<(-param.first_octave));
+    cv::resize(im_float, base, cv::Size(), scale, scale, cv::INTER_LINEAR);
+    sigma_init *= scale;
+  }
+  else if (param.first_octave > 0)
+  {
+    float scale = 1./(float)(1<<param.first_octave);
+    cv::resize(im_float, base, cv::Size(), scale, scale, cv::INTER_AREA);
+    sigma_init *= scale;
+  }
+  else base = im_float;
+
+  int nb_octaves = std::max(1, (int)floor(log((double)std::min(base.rows,base.cols))/log(2.)) - 3);
+  if (param.max_octaves>0) nb_octaves = std::min(nb_octaves, param.max_octaves);
+
+  const int nb_gauss = param.nb_levels+3;
+  const double k = pow(2., 1./param.nb_levels);
+  std::vector<double> sig_diff(nb_gauss);
+  sig_diff[0] = sqrt(std::max((double)param.sigma0*param.sigma0 - sigma_init*sigma_init, 0.01));
+  for (int i=1; i<nb_gauss; i++)
+  {
+    double sig_prev = pow(k, (double)(i-1)) * param.sigma0;
+    double sig_total = sig_prev*k;
+    sig_diff[i] = sqrt(sig_total*sig_total - sig_prev*sig_prev);
+  }
+
+  pyr.resize(nb_octaves);
+
+  for (int o=0; o<nb_octaves; o++)
+  {
+    std::vector<Level> &oct = pyr[o];
+    oct.resize(nb_gauss);
+
+    if (o==0) cv::GaussianBlur(base, oct[0].im, cv::Size(), sig_diff[0], sig_diff[0]);
+    else
+    {
+      const cv::Mat_<float> &src = pyr[o-1][param.nb_levels].im;
+      cv::resize(src, oct[0].im, cv::Size(src.cols/2, src.rows/2), 0, 0, cv::INTER_NEAREST);
+    }
+
+    for (int i=1; i<nb_gauss; i++)
+      cv::GaussianBlur(oct[i-1].im, oct[i].im, cv::Size(), sig_diff[i], sig_diff[i]);
+
+    #pragma omp parallel for num_threads(getNumThreads())
+    for (int i=0; i<nb_gauss; i++)
+    {
+      oct[i].have_gradients = false;
+      if (i<nb_gauss-1) cv::subtract(oct[i+1].im, oct[i].im, oct[i].dog);
+    }
+  }
+}
+
+/**
+ * @brief SiftCPU::computeGradients
+ * gradient magnitude and orientation of a gaussian level (vectorized)
+ * @param level
+ */
+void SiftCPU::computeGradients(Level &level)
+{
+  const cv::Mat_<float> &im = level.im;
+  level.mag.create(im.rows, im.cols);
+  level.ori.create(im.rows, im.cols);
+
+  // border pixels are never sampled, but keep them defined
+  level.mag.row(0).setTo(0.); level.mag.row(im.rows-1).setTo(0.);
+  level.ori.row(0).setTo(0.); level.ori.row(im.rows-1).setTo(0.);
+
+  #pragma omp parallel for num_threads(getNumThreads())
+  for (int v=1; v<im.rows-1; v++)
+  {
+    const float *d_prev = &im(v-1,0);
+    const float *d = &im(v,0);
+    const float *d_next = &im(v+1,0);
+    float *d_mag = &level.mag(v,0);
+    float *d_ori = &level.ori(v,0);
+
+    V4R_OMP_SIMD
+    for (int u=1; u<im.cols-1; u++)
+    {
+      const float dx = d[u+1]-d[u-1];
+      const float dy = d_next[u]-d_prev[u];
+      d_mag[u] = sqrtf(dx*dx+dy*dy);
+      d_ori[u] = fastAtan2(dy,dx);
+    }
+    d_mag[0] = d_ori[0] = d_mag[im.cols-1] = d_ori[im.cols-1] = 0.f;
+  }
+
+  level.have_gradients = true;
+}
+
+/**
+ * @brief SiftCPU::prepareGradients
+ * computes the gradients of all levels which are needed by the keypoints
+ * @param keys
+ */
+void SiftCPU::prepareGradients(const std::vector<OctaveKeypoint> &keys)
+{
+  for (unsigned i=0; i<keys.size(); i++)
+  {
+    Level &level = pyr[keys[i].octave][keys[i].level];
+    if (!level.have_gradients)
+      computeGradients(level);
+  }
+}
+
+/**
+ * @brief SiftCPU::refineExtremum
+ * sub-pixel/sub-scale interpolation, contrast and edge test (Lowe, 2004)
+ * @return true if the extremum is stable
+ */
+bool SiftCPU::refineExtremum(int o, int &l, int &r, int &c, OctaveKeypoint &key) const
+{
+  const std::vector<Level> &oct = pyr[o];
+  const int rows = oct[0].dog.rows, cols = oct[0].dog.cols;
+  Eigen::Vector3f dD, X;
+  Eigen::Matrix3f H;
+  float dxx=0, dyy=0, dxy=0;
+  int i=0;
+
+  for ( ; i<SIFT_MAX_INTERP_STEPS; i++)
+  {
+    if (l<1 || l>param.nb_levels || c<SIFT_IMG_BORDER || c>=cols-SIFT_IMG_BORDER ||
+        r<SIFT_IMG_BORDER || r>=rows-SIFT_IMG_BORDER)
+      return false;
+
+    const cv::Mat_<float> &img = oct[l].dog;
+    const cv::Mat_<float> &prev = oct[l-1].dog;
+    const cv::Mat_<float> &next = oct[l+1].dog;
+
+    dD = Eigen::Vector3f( 0.5f*(img(r,c+1)-img(r,c-1)), 0.5f*(img(r+1,c)-img(r-1,c)), 0.5f*(next(r,c)-prev(r,c)) );
+
+    const float v2 = 2.f*img(r,c);
+    dxx = img(r,c+1) + img(r,c-1) - v2;
+    dyy = img(r+1,c) + img(r-1,c) - v2;
+    const float dss = next(r,c) + prev(r,c) - v2;
+    dxy = 0.25f*(img(r+1,c+1) - img(r+1,c-1) - img(r-1,c+1) + img(r-1,c-1));
+    const float dxs = 0.25f*(next(r,c+1) - next(r,c-1) - prev(r,c+1) + prev(r,c-1));
+    const float dys = 0.25f*(next(r+1,c) - next(r-1,c) - prev(r+1,c) + prev(r-1,c));
+
+    H << dxx, dxy, dxs,
+         dxy, dyy, dys,
+         dxs, dys, dss;
+
+    if (fabs(H.determinant()) < 1e-12)
+      return false;
+
+    X = -H.inverse()*dD;
+
+    if (fabs(X[0])<0.5f && fabs(X[1])<0.5f && fabs(X[2])<0.5f)
+      break;
+
+    if (fabs(X[0])>(float)(INT_MAX/3) || fabs(X[1])>(float)(INT_MAX/3) || fabs(X[2])>(float)(INT_MAX/3))
+      return false;
+
+    c += (int)floor(X[0]+0.5f);
+    r += (int)floor(X[1]+0.5f);
+    l += (int)floor(X[2]+0.5f);
+  }
+
+  if (i>=SIFT_MAX_INTERP_STEPS)
+    return false;
+
+  const float contr = oct[l].dog(r,c) + 0.5f*dD.dot(X);
+  if (fabs(contr) < param.dog_threshold)
+    return false;
+
+  const float tr = dxx+dyy;
+  const float det = dxx*dyy - dxy*dxy;
+  if (det<=0 || tr*tr*param.edge_threshold >= (param.edge_threshold+1)*(param.edge_threshold+1)*det)
+    return false;
+
+  key.octave = o;
+  key.level = l;
+  key.x = c + X[0];
+  key.y = r + X[1];
+  key.sigma = param.sigma0 * pow(2.f, (l+X[2])/param.nb_levels);
+  key.ori = 0.f;
+  return true;
+}
+
+/**
+ * @brief SiftCPU::findExtrema
+ * scale-space extrema of a DoG level (parallel over the rows, deterministic order)
+ * @param o octave
+ * @param l level
+ * @param keys detected keypoints are appended
+ */
+void SiftCPU::findExtrema(int o, int l, std::vector<OctaveKeypoint> &keys)
+{
+  const cv::Mat_<float> &img = pyr[o][l].dog;
+  const cv::Mat_<float> &prev = pyr[o][l-1].dog;
+  const cv::Mat_<float> &next = pyr[o][l+1].dog;
+  const float threshold = 0.8f*param.dog_threshold;
+  const int step = (int)(img.step/sizeof(float));
+
+  std::vector< std::vector<OctaveKeypoint> > row_keys(img.rows);
+
+  #pragma omp parallel for schedule(dynamic,8) num_threads(getNumThreads())
+  for (int r=SIFT_IMG_BORDER; r<img.rows-SIFT_IMG_BORDER; r++)
+  {
+    const float *d = &img(r,0);
+    const float *d_prev = &prev(r,0);
+    const float *d_next = &next(r,0);
+
+    for (int c=SIFT_IMG_BORDER; c<img.cols-SIFT_IMG_BORDER; c++)
+    {
+      const float val = d[c];
+      if (fabs(val) <= threshold)
+        continue;
+
+      bool is_extremum = true;
+      if (val>0)
+      {
+        for (int dr=-1; dr<=1 && is_extremum; dr++)
+          for (int dc=-1; dc<=1; dc++)
+          {
+            const int idx = c + dr*step + dc;
+            if ( (dr||dc) && val<d[idx] ) { is_extremum = false; break; }
+            if ( val<d_prev[idx] || val<d_next[idx] ) { is_extremum = false; break; }
+          }
+      }
+      else
+      {
+        for (int dr=-1; dr<=1 && is_extremum; dr++)
+          for (int dc=-1; dc<=1; dc++)
+          {
+            const int idx = c + dr*step + dc;
+            if ( (dr||dc) && val>d[idx] ) { is_extremum = false; break; }
+            if ( val>d_prev[idx] || val>d_next[idx] ) { is_extremum = false; break; }
+          }
+      }
+
+      if (!is_extremum)
+        continue;
+
+      int rr=r, cc=c, ll=l;
+      OctaveKeypoint key;
+      if (refineExtremum(o, ll, rr, cc, key))
+        row_keys[r].push_back(key);
+    }
+  }
+
+  for (unsigned i=0; i<row_keys.size(); i++)
+    keys.insert(keys.end(), row_keys[i].begin(), row_keys[i].end());
+}
+
+/**
+ * @brief SiftCPU::computeOrientations
+ * 36 bin gradient orientation histogram. The samples are gathered in a vectorized pass
+ * and binned in a second (scalar) pass.
+ * @param key
+ * @param buf thread local buffer
+ * @param oris max. param.max_orientations orientations (strongest first)
+ * @return number of orientations
+ */
+int SiftCPU::computeOrientations(const OctaveKeypoint &key, Buffer &buf, float *oris) const
+{
+  const Level &level = pyr[key.octave][key.level];
+  const int n = SIFT_ORI_HIST_BINS;
+  const float sigma_w = SIFT_ORI_SIG_FCTR*key.sigma;
+  const int radius = std::max(1, (int)floor(SIFT_ORI_RADIUS*key.sigma+0.5f));
+  const int xi = (int)floor(key.x+0.5f), yi = (int)floor(key.y+0.5f);
+  const float exp_scale = -1.f/(2.f*sigma_w*sigma_w);
+  const float bins_per_rad = n/SIFT_2PI;
+
+  const int len = 2*radius+1;
+  buf.gw.resize(len);
+  buf.w.resize(len*len);
+  buf.obin.resize(len*len);
+  for (int i=-radius; i<=radius; i++)
+    buf.gw[i+radius] = expf(i*i*exp_scale);
+
+  int k=0;
+  for (int i=-radius; i<=radius; i++)
+  {
+    const int y = yi+i;
+    if (y<=0 || y>=level.im.rows-1)
+      continue;
+    const int x0 = std::max(xi-radius, 1), x1 = std::min(xi+radius, level.im.cols-2);
+    if (x0>x1)
+      continue;
+    const int nx = x1-x0+1;
+    const float wy = buf.gw[i+radius];
+    const float *d_mag = &level.mag(y,x0);
+    const float *d_ori = &level.ori(y,x0);
+    const float *gw = &buf.gw[x0-xi+radius];
+    float *w = &buf.w[k];
+    float *obin = &buf.obin[k];
+
+    V4R_OMP_SIMD
+    for (int j=0; j<nx; j++)
+    {
+      w[j] = wy*gw[j]*d_mag[j];
+      obin[j] = d_ori[j]*bins_per_rad;
+    }
+    k += nx;
+  }
+
+  float hist[SIFT_ORI_HIST_BINS+4];
+  float *h = &hist[2];
+  for (int i=0; i<n+4; i++) hist[i]=0.f;
+
+  for (int i=0; i<k; i++)
+  {
+    int b = (int)floor(buf.obin[i]+0.5f);
+    if (b>=n) b-=n;
+    else if (b<0) b+=n;
+    h[b] += buf.w[i];
+  }
+
+  // smooth the histogram
+  float tmp[SIFT_ORI_HIST_BINS];
+  h[-1] = h[n-1]; h[-2] = h[n-2];
+  h[n] = h[0]; h[n+1] = h[1];
+  for (int i=0; i<n; i++)
+    tmp[i] = (h[i-2]+h[i+2])*(1.f/16.f) + (h[i-1]+h[i+1])*(4.f/16.f) + h[i]*(6.f/16.f);
+
+  float max_val = tmp[0];
+  for (int i=1; i<n; i++)
+    if (tmp[i]>max_val) max_val = tmp[i];
+
+  if (max_val<=0.f)
+    return 0;
+
+  const float mag_thr = param.orientation_peak_ratio*max_val;
+  std::vector< std::pair<float,float> > peaks;   // (magnitude, orientation)
+
+  for (int i=0; i<n; i++)
+  {
+    const int l = (i>0 ? i-1 : n-1);
+    const int r = (i<n-1 ? i+1 : 0);
+    if (tmp[i]>tmp[l] && tmp[i]>tmp[r] && tmp[i]>=mag_thr)
+    {
+      float bin = i + 0.5f*(tmp[l]-tmp[r]) / (tmp[l]-2.f*tmp[i]+tmp[r]);
+      bin = (bin<0 ? n+bin : (bin>=n ? bin-n : bin));
+      peaks.push_back(std::make_pair(tmp[i], bin/bins_per_rad));
+    }
+  }
+
+  std::sort(peaks.begin(), peaks.end(), std::greater< std::pair<float,float> >());
+
+  const int nb = std::min((int)peaks.size(), std::max(1,param.max_orientations));
+  for (int i=0; i<nb; i++)
+    oris[i] = peaks[i].second;
+
+  return nb;
+}
+
+/**
+ * @brief SiftCPU::computeDescriptor
+ * 4x4x8 SIFT descriptor (Lowe's bin order). The rotated sample coordinates, gaussian weights and
+ * orientation bins are computed in a vectorized gather pass, the tri-linear binning is done afterwards.
+ * @param key
+ * @param buf thread local buffer
+ * @param desc 128 floats
+ */
+void SiftCPU::computeDescriptor(const OctaveKeypoint &key, Buffer &buf, float *desc) const
+{
+  const Level &level = pyr[key.octave][key.level];
+  const int d = SIFT_DESCR_WIDTH, n = SIFT_DESCR_HIST_BINS;
+  const float hist_width = param.desc_magnification*key.sigma;
+  int radius = (int)floor(hist_width*1.4142135f*(d+1)*0.5f+0.5f);
+  radius = std::min(radius, (int)sqrt((double)level.im.cols*level.im.cols + level.im.rows*level.im.rows));
+  const float cos_t = cosf(key.ori)/hist_width;
+  const float sin_t = sinf(key.ori)/hist_width;
+  const float bins_per_rad = n/SIFT_2PI;
+  const float exp_scale = -1.f/(d*d*0.5f);
+  const float key_ori_bin = key.ori*bins_per_rad;
+  const int xi = (int)floor(key.x+0.5f), yi = (int)floor(key.y+0.5f);
+
+  const int len = (2*radius+1)*(2*radius+1);
+  buf.rbin.resize(len);
+  buf.cbin.resize(len);
+  buf.obin.resize(len);
+  buf.w.resize(len);
+
+  // gather pass
+  int k=0;
+  for (int i=-radius; i<=radius; i++)
+  {
+    const int y = yi+i;
+    if (y<=0 || y>=level.im.rows-1)
+      continue;
+    const int x0 = std::max(xi-radius, 1), x1 = std::min(xi+radius, level.im.cols-2);
+    if (x0>x1)
+      continue;
+    const int nx = x1-x0+1;
+    const float dy = y-key.y;
+    const float dx0 = x0-key.x;
+    const float *d_mag = &level.mag(y,x0);
+    const float *d_ori = &level.ori(y,x0);
+    float *rbin = &buf.rbin[k];
+    float *cbin = &buf.cbin[k];
+    float *obin = &buf.obin[k];
+    float *w = &buf.w[k];
+
+    V4R_OMP_SIMD
+    for (int j=0; j<nx; j++)
+    {
+      const float dx = dx0+j;
+      const float c_rot = dx*cos_t + dy*sin_t;
+      const float r_rot = -dx*sin_t + dy*cos_t;
+      const float rb = r_rot + 0.5f*d - 0.5f;
+      const float cb = c_rot + 0.5f*d - 0.5f;
+      const bool valid = (rb>-1.f && rb<d && cb>-1.f && cb<d);
+      float ob = d_ori[j]*bins_per_rad - key_ori_bin;
+      ob = (ob<0.f ? ob+n : ob);
+      rbin[j] = (valid ? rb : 0.f);
+      cbin[j] = (valid ? cb : 0.f);
+      obin[j] = ob;
+      w[j] = (valid ? expf((c_rot*c_rot + r_rot*r_rot)*exp_scale)*d_mag[j] : 0.f);
+    }
+    k += nx;
+  }
+
+  // tri-linear binning
+  const int hist_len = (d+2)*(d+2)*(n+2);
+  buf.hist.assign(hist_len, 0.f);
+  float *hist = &buf.hist[0];
+
+  for (int i=0; i<k; i++)
+  {
+    const float mag = buf.w[i];
+    if (mag==0.f)
+      continue;
+
+    float rb = buf.rbin[i], cb = buf.cbin[i], ob = buf.obin[i];
+    const int r0 = (int)floor(rb);
+    const int c0 = (int)floor(cb);
+    int o0 = (int)floor(ob);
+    rb -= r0;
+    cb -= c0;
+    ob -= o0;
+    if (o0<0) o0+=n;
+    if (o0>=n) o0-=n;
+
+    const float v_r1 = mag*rb, v_r0 = mag-v_r1;
+    const float v_rc11 = v_r1*cb, v_rc10 = v_r1-v_rc11;
+    const float v_rc01 = v_r0*cb, v_rc00 = v_r0-v_rc01;
+    const float v_rco111 = v_rc11*ob, v_rco110 = v_rc11-v_rco111;
+    const float v_rco101 = v_rc10*ob, v_rco100 = v_rc10-v_rco101;
+    const float v_rco011 = v_rc01*ob, v_rco010 = v_rc01-v_rco011;
+    const float v_rco001 = v_rc00*ob, v_rco000 = v_rc00-v_rco001;
+
+    const int idx = ((r0+1)*(d+2) + c0+1)*(n+2) + o0;
+    hist[idx] += v_rco000;
+    hist[idx+1] += v_rco001;
+    hist[idx+(n+2)] += v_rco010;
+    hist[idx+(n+3)] += v_rco011;
+    hist[idx+(d+2)*(n+2)] += v_rco100;
+    hist[idx+(d+2)*(n+2)+1] += v_rco101;
+    hist[idx+(d+3)*(n+2)] += v_rco110;
+    hist[idx+(d+3)*(n+2)+1] += v_rco111;
+  }
+
+  // finalize (wrap orientation bins) and normalize
+  for (int i=0; i<d; i++)
+  {
+    for (int j=0; j<d; j++)
+    {
+      const int idx = ((i+1)*(d+2) + (j+1))*(n+2);
+      hist[idx] += hist[idx+n];
+      hist[idx+1] += hist[idx+n+1];
+      for (int o=0; o<n; o++)
+        desc[(i*d+j)*n+o] = hist[idx+o];
+    }
+  }
+
+  const int dim = d*d*n;
+  float nrm2 = 0.f;
+  V4R_OMP_SIMD
+  for (int i=0; i<dim; i++)
+    nrm2 += desc[i]*desc[i];
+
+  const float thr = sqrtf(nrm2)*SIFT_DESCR_MAG_THR;
+  nrm2 = 0.f;
+  for (int i=0; i<dim; i++)
+  {
+    desc[i] = std::min(desc[i], thr);
+    nrm2 += desc[i]*desc[i];
+  }
+
+  const float inv_nrm = (nrm2>0.f ? 1.f/sqrtf(nrm2) : 0.f);
+  V4R_OMP_SIMD
+  for (int i=0; i<dim; i++)
+    desc[i] *= inv_nrm;
+}
+
+/**
+ * @brief SiftCPU::toOctaveKeypoint
+ * selects the octave/level of the scale-space which best fits the keypoint scale
+ */
+void SiftCPU::toOctaveKeypoint(const Keypoint &key, OctaveKeypoint &okey) const
+{
+  const int nb_octaves = pyr.size();
+  float t = (key.s>0 ? log(key.s/param.sigma0)/log(2.) : 0.f) - param.first_octave;
+  int o = (int)floor(t);
+  int l = (int)floor((t-o)*param.nb_levels+0.5f);
+
+  if (o<0) { o=0; l=0; }
+  else if (o>=nb_octaves) { o=nb_octaves-1; l=param.nb_levels; }
+  if (l>param.nb_levels+1) l = param.nb_levels+1;
+
+  const float scale = pow(2.f, (float)(o+param.first_octave));
+  okey.octave = o;
+  okey.level = l;
+  okey.x = key.x/scale;
+  okey.y = key.y/scale;
+  okey.sigma = (key.s>0 ? key.s/scale : param.sigma0);
+  okey.ori = fmod(key.o, SIFT_2PI);
+  if (okey.ori<0) okey.ori += SIFT_2PI;
+}
+
+/**
+ * @brief SiftCPU::toImageKeypoint
+ */
+void SiftCPU::toImageKeypoint(const OctaveKeypoint &okey, Keypoint &key) const
+{
+  const float scale = pow(2.f, (float)(okey.octave+param.first_octave));
+  key.x = okey.x*scale;
+  key.y = okey.y*scale;
+  key.s = okey.sigma*scale;
+  key.o = okey.ori;
+}
+
+
+
+
+/***************************************************************************************/
+
+/**
+ * @brief SiftCPU::detect
+ * @param image gray scale or BGR image
+ * @param keys detected keypoints
+ * @param descriptors one row per keypoint
+ */
+void SiftCPU::detect(const cv::Mat &image, std::vector<Keypoint> &keys, cv::Mat &descriptors)
+{
+  elapsed_time.clear();
+  keys.clear();
+
+  double t0 = cv::getTickCount();
+  buildScaleSpace(image);
+  addElapsedTime("scale space", t0);
+
+  // detect extrema
+  t0 = cv::getTickCount();
+  std::vector<OctaveKeypoint> candidates;
+  for (unsigned o=0; o<pyr.size(); o++)
+    for (int l=1; l<=param.nb_levels; l++)
+      findExtrema(o, l, candidates);
+  addElapsedTime("detection", t0);
+
+  t0 = cv::getTickCount();
+  prepareGradients(candidates);
+  addElapsedTime("gradients", t0);
+
+  // orientation assignment
+  t0 = cv::getTickCount();
+  const int nb_threads = getNumThreads();
+  const int max_ori = std::max(1,param.max_orientations);
+  buffers.resize(nb_threads);
+  std::vector<float> oris(candidates.size()*max_ori);
+  std::vector<int> nb_oris(candidates.size());
+
+  #pragma omp parallel for schedule(dynamic,16) num_threads(nb_threads)
+  for (int i=0; i<(int)candidates.size(); i++)
+    nb_oris[i] = computeOrientations(candidates[i], buffers[omp_get_thread_num()], &oris[i*max_ori]);
+
+  std::vector<OctaveKeypoint> okeys;
+  okeys.reserve(candidates.size()*2);
+  for (unsigned i=0; i<candidates.size(); i++)
+  {
+    for (int j=0; j<nb_oris[i]; j++)
+    {
+      okeys.push_back(candidates[i]);
+      okeys.back().ori = oris[i*max_ori+j];
+    }
+  }
+  addElapsedTime("orientation", t0);
+
+  // descriptors
+  t0 = cv::getTickCount();
+  descriptors = cv::Mat_<float>(okeys.size(), 128);
+  keys.resize(okeys.size());
+
+  #pragma omp parallel for schedule(dynamic,16) num_threads(nb_threads)
+  for (int i=0; i<(int)okeys.size(); i++)
+  {
+    computeDescriptor(okeys[i], buffers[omp_get_thread_num()], descriptors.ptr<float>(i));
+    toImageKeypoint(okeys[i], keys[i]);
+  }
+  addElapsedTime("descriptors", t0);
+}
+
+/**
+ * @brief SiftCPU::compute
+ * @param image gray scale or BGR image
+ * @param keys given keypoints (orientation is updated if keys_have_orientation==false)
+ * @param descriptors one row per keypoint
+ * @param keys_have_orientation
+ */
+void SiftCPU::compute(const cv::Mat &image, std::vector<Keypoint> &keys, cv::Mat &descriptors, bool keys_have_orientation)
+{
+  elapsed_time.clear();
+
+  double t0 = cv::getTickCount();
+  buildScaleSpace(image);
+  addElapsedTime("scale space", t0);
+
+  t0 = cv::getTickCount();
+  std::vector<OctaveKeypoint> okeys(keys.size());
+  for (unsigned i=0; i<keys.size(); i++)
+    toOctaveKeypoint(keys[i], okeys[i]);
+  prepareGradients(okeys);
+  addElapsedTime("gradients", t0);
+
+  const int nb_threads = getNumThreads();
+  buffers.resize(nb_threads);
+
+  if (!keys_have_orientation)
+  {
+    t0 = cv::getTickCount();
+    std::vector<float> oris(std::max(1,param.max_orientations));
+
+    #pragma omp parallel for schedule(dynamic,16) num_threads(nb_threads) firstprivate(oris)
+    for (int i=0; i<(int)okeys.size(); i++)
+    {
+      // keep a 1:1 relation to the given keypoints (only the dominant orientation)
+      int nb = computeOrientations(okeys[i], buffers[omp_get_thread_num()], &oris[0]);
+      okeys[i].ori = (nb>0 ? oris[0] : 0.f);
+      keys[i].o = okeys[i].ori;
+    }
+    addElapsedTime("orientation", t0);
+  }
+
+  t0 = cv::getTickCount();
+  descriptors = cv::Mat_<float>(okeys.size(), 128);
+
+  #pragma omp parallel for schedule(dynamic,16) num_threads(nb_threads)
+  for (int i=0; i<(int)okeys.size(); i++)
+    computeDescriptor(okeys[i], buffers[omp_get_thread_num()], descriptors.ptr<float>(i));
+  addElapsedTime("descriptors", t0);
+}
+
+
+}
+
@@ -150,6 +150,30 @@ GlobalConcatEstimator<PointT>::compute (Eigen::MatrixXf &signature)
     return true;
 }
 
+template<typename PointT>
+typename GlobalEstimator<PointT>::Ptr
+GlobalConcatEstimator<PointT>::clone() const
+{
+#ifdef HAVE_CAFFE
+    if(cnn_feat_estimator_)  // the network is not copied
+        return typename GlobalEstimator<PointT>::Ptr();
+#endif
+
+    typename GlobalConcatEstimator<PointT>::Ptr copy ( new GlobalConcatEstimator<PointT>(*this) );
+
+    // deep copy of the sub-estimators (they keep input cloud and indices)
+    if(esf_estimator_)
+        copy->esf_estimator_.reset( new ESFEstimation<PointT>(*esf_estimator_) );
+    if(simple_shape_estimator_)
+        copy->simple_shape_estimator_.reset( new SimpleShapeEstimator<PointT>(*simple_shape_estimator_) );
+    if(color_estimator_)
+        copy->color_estimator_.reset( new GlobalColorEstimator<PointT>(*color_estimator_) );
+    if(ourcvfh_estimator_)
+        copy->ourcvfh_estimator_.reset( new OURCVFHEstimator<PointT>(*ourcvfh_estimator_) );
+
+    return copy;
+}
+
 template class V4R_EXPORTS GlobalConcatEstimator<pcl::PointXYZRGB>;
 }
 
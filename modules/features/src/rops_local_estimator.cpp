@@ -8,13 +8,14 @@
 #include <pcl/surface/gp3.h>
 #include <pcl/features/rops_estimation.h>
 #include <glog/logging.h>
+#include <cstring>
 
 namespace v4r
 {
 
 template<typename PointT>
 void
-ROPSLocalEstimation<PointT>::compute (std::vector<std::vector<float> > & signatures)
+ROPSLocalEstimation<PointT>::compute (LocalDescriptorMatrix & signatures)
 {
 //    if (param_.adaptative_MLS_)
 //    {
@@ -92,12 +93,11 @@ ROPSLocalEstimation<PointT>::compute (std::vector<std::vector<float> > & signatu
     CHECK( descriptors.points.size() == indices_.size() );
     keypoint_indices_ = indices_;
 
-    int size_feat = 352;
-    signatures = std::vector<std::vector<float> > (descriptors.points.size (), std::vector<float>(size_feat) );
+    const int size_feat = 135;
+    signatures.resize(descriptors.points.size (), size_feat);
 
     for (size_t k = 0; k < descriptors.points.size (); k++)
-        for (int i = 0; i < size_feat; i++)
-            signatures[k][i] = descriptors.points[k].histogram[i];
+        memcpy( signatures.row(k).data(), descriptors.points[k].histogram, size_feat * sizeof(float) );
 }
 
 template class V4R_EXPORTS ROPSLocalEstimation<pcl::PointXYZ>;
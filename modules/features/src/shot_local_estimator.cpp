@@ -3,16 +3,17 @@
 #include <pcl/surface/mls.h>
 #include <v4r/features/shot_local_estimator.h>
 #include <glog/logging.h>
+#include <cstring>
 
 namespace v4r
 {
 
 template<typename PointT>
 void
-SHOTLocalEstimation<PointT>::compute (std::vector<std::vector<float> > & signatures)
+SHOTLocalEstimation<PointT>::compute (LocalDescriptorMatrix & signatures)
 {
     CHECK( cloud_->points.size() == normals_->points.size() );
-    signatures.clear();
+    signatures.resize(0, descr_dims_);
 
     typename pcl::PointCloud<PointT>::Ptr cloud_wo_nan (new pcl::PointCloud<PointT>);
     pcl::PointCloud<pcl::Normal>::Ptr normals_wo_nan (new pcl::PointCloud<pcl::Normal>);
@@ -61,11 +62,10 @@ SHOTLocalEstimation<PointT>::compute (std::vector<std::vector<float> > & signatu
 
     keypoint_indices_ = indices_;
 
-    signatures = std::vector<std::vector<float> > (shots.points.size(), std::vector<float>(352));
+    signatures.resize(shots.points.size(), 352);
 
     for (size_t k = 0; k < shots.points.size (); k++)
-        for (size_t i = 0; i < 352; i++)
-            signatures[k][i] = shots.points[k].descriptor[i];
+        memcpy( signatures.row(k).data(), shots.points[k].descriptor, 352 * sizeof(float) );
 }
 
 template class V4R_EXPORTS SHOTLocalEstimation<pcl::PointXYZ>;
@@ -3,6 +3,7 @@
 #include <v4r/common/pcl_opencv.h>
 #include <pcl/common/io.h>
 #include <glog/logging.h>
+#include <cstring>
 
 #include <v4r/features/sift_local_estimator.h>
 
@@ -15,7 +16,7 @@ namespace v4r
 
 template<typename PointT>
 void
-SIFTLocalEstimation<PointT>::compute (std::vector<std::vector<float> > &signatures)
+SIFTLocalEstimation<PointT>::compute (LocalDescriptorMatrix &signatures)
 {
     CHECK( cloud_ && cloud_->isOrganized() );
 
@@ -32,13 +33,14 @@ SIFTLocalEstimation<PointT>::compute (std::vector<std::vector<float> > &signatur
 
         if( pcl::isFinite(cloud_->points[idx]) && cloud_->points[idx].z < max_distance_)
         {
-            signatures[kept] = signatures[i];
+            if( kept != i )
+                signatures.row(kept) = signatures.row(i);
             keypoint_indices_[kept] = idx;
             kept++;
         }
     }
 
-    signatures.resize(kept);
+    signatures.conservativeResize(kept, signatures.cols());
     keypoint_indices_.resize(kept);
     indices_.clear();
 }
@@ -46,7 +48,7 @@ SIFTLocalEstimation<PointT>::compute (std::vector<std::vector<float> > &signatur
 
 template<typename PointT>
 void
-SIFTLocalEstimation<PointT>::compute (const cv::Mat_ < cv::Vec3b > &colorImage, Eigen::Matrix2Xf &keypoints, std::vector<std::vector<float> > &signatures)
+SIFTLocalEstimation<PointT>::compute (const cv::Mat_ < cv::Vec3b > &colorImage, Eigen::Matrix2Xf &keypoints, LocalDescriptorMatrix &signatures)
 {
     cv::Mat grayImage;
     cv::cvtColor (colorImage, grayImage, CV_BGR2GRAY);
@@ -62,173 +64,129 @@ SIFTLocalEstimation<PointT>::compute (const cv::Mat_ < cv::Vec3b > &colorImage,
 
 
 #ifdef HAVE_SIFTGPU
-    if (sift_->CreateContextGL () != SiftGPU::SIFTGPU_FULL_SUPPORTED)
-        throw std::runtime_error ("SiftGPU: No GL support!");
+    typedef SiftGPU::SiftKeypoint SiftKeypoint;
+#else
+    typedef SiftCPU::Keypoint SiftKeypoint;
+#endif
 
-    sift_->VerifyContextGL();
+    std::vector<SiftKeypoint> ks;
+    cv::Mat descriptors;
 
     if(param_.dense_extraction_)
     {
-        std::vector<SiftGPU::SiftKeypoint> dense_ks;
-        for(int u=0; u<colorImage.cols; u++)
+        for(int v=0; v<colorImage.rows; v+=param_.stride_)
         {
-            for(int v=0; v<colorImage.rows; v++)
+            for(int u=0; u<colorImage.cols; u+=param_.stride_)
             {
-                if( u%param_.stride_ == 0 && v%param_.stride_ == 0 )
-                {
-                    SiftGPU::SiftKeypoint kp;
-                    kp.x = u;
-                    kp.y = v;
-                    dense_ks.push_back(kp);
-                }
+                SiftKeypoint kp;
+                kp.x = u;
+                kp.y = v;
+                kp.s = param_.dense_scale_;
+                kp.o = 0.f;
+                ks.push_back(kp);
             }
         }
-        SiftGPU::SiftKeypoint *ksp = new SiftGPU::SiftKeypoint[ dense_ks.size() ];
-        for(size_t i=0; i<dense_ks.size(); i++)
-            ksp[i] = dense_ks[i];
-        sift_->SetKeypointList(dense_ks.size(), ksp, false);
-        delete[] ksp;
     }
 
-    if (sift_->RunSIFT (grayImage.cols, grayImage.rows, grayImage.ptr<uchar> (0), GL_LUMINANCE, GL_UNSIGNED_BYTE))
+#ifdef HAVE_SIFTGPU
+    if( !param_.dense_extraction_ || !ks.empty() ) // an empty dense grid (e.g. empty image) yields no features
     {
-        int num = sift_->GetFeatureNum();
-        if (num>0)
-        {
-            std::vector<SiftGPU::SiftKeypoint> ks (num);
-            cv::Mat descriptors(num,128,CV_32F);
-            sift_->GetFeatureVector(&ks[0], descriptors.ptr<float>(0));
-            keypoints = Eigen::Matrix2Xf(2, ks.size());
-            signatures.resize (ks.size (), std::vector<float>(128));
-
-            keypoint_indices_.resize( ks.size() );
-            size_t kept = 0;
-            for(size_t i=0; i < ks.size(); i++)
-            {
-                const SiftGPU::SiftKeypoint &kp = ks[i];
-                int u = std::min<int>( colorImage.cols -1, kp.x+0.5f );
-                int v = std::min<int>( colorImage.rows -1, kp.y+0.5f );
-                int idx = v * colorImage.cols + u;
-
-                if( obj_mask[idx] ) // keypoint does not belong to given object mask
-                {
-                    if( param_.use_rootSIFT_ )
-                    {
-                        double norm_L1 = cv::norm(descriptors.row(i), cv::NORM_L1);
+        if (sift_->CreateContextGL () != SiftGPU::SIFTGPU_FULL_SUPPORTED)
+            throw std::runtime_error ("SiftGPU: No GL support!");
 
-                        for (size_t k = 0; k < 128; k++)
-                            descriptors.at<float>(i,k) = sqrt( descriptors.at<float>(i,k) / norm_L1 );
+        sift_->VerifyContextGL();
 
-//                        double norm_L2 = cv::norm( descriptors.row(i) );
-//                        descriptors.row(i) /= norm_L2;
-                    }
+        if(param_.dense_extraction_)
+            sift_->SetKeypointList(ks.size(), &ks[0], false);
 
-                    for (size_t k = 0; k < 128; k++)
-                        signatures[kept][k] = descriptors.at<float>(i,k);
+        if ( !sift_->RunSIFT (grayImage.cols, grayImage.rows, grayImage.ptr<uchar> (0), GL_LUMINANCE, GL_UNSIGNED_BYTE) )
+            throw std::runtime_error ("SiftGPU:::Detect: SiftGPU Error!");
 
-                    keypoints(0,kept) = kp.x;
-                    keypoints(1,kept) = kp.y;
-                    keypoint_indices_[kept] = idx;
-                    kept++;
-                }
-            }
-            signatures.resize(kept);
-            keypoints.conservativeResize(2, kept);
-            keypoint_indices_.resize( kept );
-        }
-        else
+        int num = sift_->GetFeatureNum();
+        ks.resize(num);
+        if (num>0)
         {
-            LOG(WARNING) << "No SIFT features found!";
-            keypoint_indices_.clear();
+            descriptors = cv::Mat(num,128,CV_32F);
+            sift_->GetFeatureVector(&ks[0], descriptors.ptr<float>(0));
         }
     }
+#else
+    if(param_.dense_extraction_)
+        sift_->compute(grayImage, ks, descriptors, false);
     else
+        sift_->detect(grayImage, ks, descriptors);
+
+    for(const std::pair<std::string,float> &t : sift_->getElapsedTimes())
+        VLOG(1) << "SIFT (CPU) " << t.first << " took " << t.second << " ms.";
+#endif
+
+    if ( ks.empty() )
     {
-        throw std::runtime_error ("SiftGPU:::Detect: SiftGPU Error!");
+        LOG(WARNING) << "No SIFT features found!";
+        signatures.resize(0, 128);
+        keypoints.resize(2, 0);
+        keypoint_indices_.clear();
         return;
     }
-#else
-    std::vector<cv::KeyPoint> ks;
-    sift_->operator ()(grayImage, cv::Mat(), ks, descriptors, false);
 
+    keypoints = Eigen::Matrix2Xf(2, ks.size());
+    signatures.resize (ks.size (), 128);
+    keypoint_indices_.resize( ks.size() );
 
-    int num = ks.size();
-    if (num>0)
+    size_t kept = 0;
+    for(size_t i=0; i < ks.size(); i++)
     {
-        std::vector<SiftGPU::SiftKeypoint> ks (num);
-        cv::Mat descriptors(num,128,CV_32F);
-        sift_->GetFeatureVector(&ks[0], descriptors.ptr<float>(0));
-        keypoints = Eigen::Matrix2Xf(2, ks.size());
-        signatures.resize (ks.size (), std::vector<float>(128));
-
-        keypoint_indices_.resize( ks.size() );
-        size_t kept = 0;
-        for(size_t i=0; i < ks.size(); i++)
-        {
-            int u = std::min<int>( colorImage.cols -1, ks[i].pt.x+0.5f );
-            int v = std::min<int>( colorImage.rows -1, ks[i].pt.y+0.5f );
-            int idx = v * colorImage.cols + u;
+        const SiftKeypoint &kp = ks[i];
+        int u = std::max<int>( 0, std::min<int>( colorImage.cols -1, kp.x+0.5f ) );
+        int v = std::max<int>( 0, std::min<int>( colorImage.rows -1, kp.y+0.5f ) );
+        int idx = v * colorImage.cols + u;
 
-            if( obj_mask[idx] ) // keypoint does not belong to given object mask
+        if( obj_mask[idx] ) // keypoint does not belong to given object mask
+        {
+            if( param_.use_rootSIFT_ )
             {
-                if( param_.use_rootSIFT_ )
-                {
-                    double norm_L1 = cv::norm(descriptors.row(i), cv::NORM_L1);
+                double norm_L1 = cv::norm(descriptors.row(i), cv::NORM_L1);
 
-                    for (size_t k = 0; k < 128; k++)
-                        descriptors.at<float>(i,k) = sqrt( descriptors.at<float>(i,k) / norm_L1 );
+                for (size_t k = 0; k < 128; k++)
+                    descriptors.at<float>(i,k) = sqrt( descriptors.at<float>(i,k) / norm_L1 );
 
 //                        double norm_L2 = cv::norm( descriptors.row(i) );
 //                        descriptors.row(i) /= norm_L2;
-                }
+            }
 
-                for (size_t k = 0; k < 128; k++)
-                    signatures[kept][k] = descriptors.at<float>(i,k);
+            memcpy( signatures.row(kept).data(), descriptors.ptr<float>(i), 128 * sizeof(float) );
 
-                keypoints(0,kept) = ks[i].pt.x;
-                keypoints(1,kept) = ks[i].pt.y;
-                keypoint_indices_[kept] = idx;
-                kept++;
-            }
+            keypoints(0,kept) = kp.x;
+            keypoints(1,kept) = kp.y;
+            keypoint_indices_[kept] = idx;
+            kept++;
         }
-        signatures.resize(kept);
-        keypoints.conservativeResize(2, kept);
-        keypoint_indices_.resize( kept );
     }
-#endif
+    signatures.conservativeResize(kept, 128);
+    keypoints.conservativeResize(2, kept);
+    keypoint_indices_.resize( kept );
 }
 
 
 #ifdef HAVE_SIFTGPU
 template<typename PointT>
 std::vector<std::pair<int, int> >
-SIFTLocalEstimation<PointT>::matchSIFT( const std::vector<std::vector<float> >& desc1, const std::vector<std::vector<float> >& desc2)
+SIFTLocalEstimation<PointT>::matchSIFT( const LocalDescriptorMatrix& desc1, const LocalDescriptorMatrix& desc2)
 {
+    CHECK( desc1.cols() == 128 && desc2.cols() == 128 );
+
     SiftMatchGPU matcher(4096 * 4);
     matcher.VerifyContextGL();
 
-    std::vector<float> desc_1 ( desc1.size() * 128);
-    std::vector<float> desc_2 ( desc2.size() * 128);
-    for(size_t i=0; i<desc1.size(); i++)
-    {
-        for(size_t j=0; j<128; j++)
-            desc_1[i*128+j] = desc1[i][j];
-    }
-
-    for(size_t i=0; i<desc2.size(); i++)
-    {
-        for(size_t j=0; j<128; j++)
-            desc_2[i*128+j] = desc2[i][j];
-    }
-
-    matcher.SetDescriptors(0, desc1.size(), &desc_1[0]); //image 1
-    matcher.SetDescriptors(1, desc2.size(), &desc_2[0]); //image 2
+    // descriptors are stored row-major and contiguous, i.e. in the layout SiftGPU expects
+    matcher.SetDescriptors(0, desc1.rows(), desc1.data()); //image 1
+    matcher.SetDescriptors(1, desc2.rows(), desc2.data()); //image 2
 
     //match and get result.
-    int (*match_buf)[2] = new int[desc1.size()][2];
+    int (*match_buf)[2] = new int[desc1.rows()][2];
 
 //        int num_match = matcher->GetSiftMatch(num1, match_buf,0.75, 0.8, 1);
-    int num_match = matcher.GetSiftMatch(desc1.size(), match_buf, 0.5, 0.95, 1);
+    int num_match = matcher.GetSiftMatch(desc1.rows(), match_buf, 0.5, 0.95, 1);
 
     std::vector<std::pair<int, int> > matches(num_match);
     for(int j = 0; j < num_match; j++)
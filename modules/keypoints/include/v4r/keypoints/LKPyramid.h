@@ -0,0 +1,66 @@
+/**
+ * $Id$
+ */
+
+#ifndef KP_LK_PYRAMID_HH
+#define KP_LK_PYRAMID_HH
+
+#include <vector>
+#include <opencv2/core/core.hpp>
+#include <v4r/common/impl/SmartPtr.hpp>
+#include <v4r/core/macros.h>
+
+
+namespace v4r
+{
+
+/**
+ * LKPyramid
+ * Image pyramid (incl. gradients) in the layout of cv::buildOpticalFlowPyramid.
+ * Build it once per frame and pass it to all trackers calling cv::calcOpticalFlowPyrLK,
+ * which then neither rebuild the pyramid of the current nor of the previous/keyframe image.
+ */
+class V4R_EXPORTS LKPyramid
+{
+public:
+  std::vector<cv::Mat> pyr;     // [level0, deriv0, level1, deriv1, ...] (with_derivatives) or [level0, level1, ...]
+  cv::Size win_size;            // border size the pyramid has been built for
+  int max_level;                // requested number of levels
+  int nb_levels;                // number of levels above level 0 (can be less than max_level for small images)
+  bool with_derivatives;
+
+  LKPyramid() : max_level(0), nb_levels(0), with_derivatives(false) {}
+  LKPyramid(const cv::Mat &image, const cv::Size &_win_size, int _max_level, bool _with_derivatives=true) {
+    build(image, _win_size, _max_level, _with_derivatives);
+  }
+
+  /** build the pyramid (the image data is copied, i.e. the image buffer can be reused) **/
+  void build(const cv::Mat &image, const cv::Size &_win_size, int _max_level, bool _with_derivatives=true);
+
+  inline void release() { pyr.clear(); nb_levels=0; }
+  inline bool empty() const { return pyr.empty(); }
+
+  /** a pyramid can be used by cv::calcOpticalFlowPyrLK if the border is large enough, missing levels are clamped **/
+  inline bool isCompatible(const cv::Size &_win_size, int _max_level) const {
+    return !pyr.empty() && _win_size.width<=win_size.width && _win_size.height<=win_size.height && _max_level<=max_level;
+  }
+
+  /** level 0 (a view into the padded buffer) **/
+  inline const cv::Mat &getImage() const { return pyr[0]; }
+
+  typedef SmartPtr< ::v4r::LKPyramid> Ptr;
+  typedef SmartPtr< ::v4r::LKPyramid const> ConstPtr;
+};
+
+
+/**
+ * getLKPyramid
+ * keeps the cached pyramid if it is compatible, otherwise pyr is reset to a new pyramid built from image
+ */
+V4R_EXPORTS void getLKPyramid(const cv::Mat &image, const cv::Size &win_size, int max_level, LKPyramid::Ptr &pyr);
+
+
+} //--END--
+
+#endif
+
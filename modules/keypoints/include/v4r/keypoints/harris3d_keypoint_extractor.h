@@ -26,6 +26,7 @@
 
 #include <pcl/common/io.h>
 #include <v4r/keypoints/keypoint_extractor.h>
+#include <sstream>
 #include <boost/program_options.hpp>
 
 namespace po = boost::program_options;
@@ -114,6 +115,13 @@ public:
 
     std::string getKeypointExtractorName() const { return "harris3d"; }
 
+    std::string getKeypointExtractorParameters() const
+    {
+        std::stringstream ss;
+        ss << param_.threshold_ << "_" << param_.search_radius_ << "_" << param_.refine_;
+        return ss.str();
+    }
+
     typename pcl::PointCloud<PointT>::Ptr
     getKeypoints()
     {
@@ -122,6 +130,12 @@ public:
         return keypoints_;
     }
 
+    typename KeypointExtractor<PointT>::Ptr
+    clone() const
+    {
+        return typename KeypointExtractor<PointT>::Ptr( new Harris3DKeypointExtractor<PointT>(*this) );
+    }
+
     typedef boost::shared_ptr< Harris3DKeypointExtractor<PointT> > Ptr;
     typedef boost::shared_ptr< Harris3DKeypointExtractor<PointT> const> ConstPtr;
 };
@@ -44,6 +44,7 @@
 #include <v4r/common/impl/SmartPtr.hpp>
 #include <v4r/core/macros.h>
 #include <v4r/keypoints/impl/triple.hpp>
+#include <v4r/keypoints/LKPyramid.h>
 
 
 namespace v4r
@@ -78,6 +79,7 @@ public:
   int camera_id;
   Eigen::Vector3f center;
   cv::Mat_<unsigned char> image;               // ... this camera view
+  LKPyramid::Ptr image_pyr;                    // cached LK pyramid of image (use getImagePyramid, shared by trackers)
   cv::Mat descs;
   std::vector<cv::KeyPoint> keys;
   std::vector<unsigned> points;
@@ -118,6 +120,9 @@ public:
   /** get camera pose **/
   inline const Eigen::Matrix4f &getCamera() const;
 
+  /** cached LK pyramid of image, built on first use (thread safe, the returned pointer stays valid if the view is cleared) **/
+  LKPyramid::Ptr getImagePyramid(const cv::Size &win_size, int max_level);
+
   /* clear */
   void clear();
 
@@ -25,6 +25,7 @@
 #pragma once
 
 #include <v4r/keypoints/keypoint_extractor.h>
+#include <sstream>
 #include <boost/program_options.hpp>
 
 namespace po = boost::program_options;
@@ -137,6 +138,21 @@ public:
 
     std::string getKeypointExtractorName() const { return "iss"; }
 
+    std::string getKeypointExtractorParameters() const
+    {
+        std::stringstream ss;
+        ss << param_.salient_radius_ << "_" << param_.non_max_radius_ << "_" << param_.normal_radius_ << "_" << param_.border_radius_ << "_"
+           << param_.gamma_21_ << "_" << param_.gamma_32_ << "_" << param_.min_neighbors_ << "_" << param_.with_border_estimation_ << "_"
+           << param_.angle_thresh_deg_;
+        return ss.str();
+    }
+
+    typename KeypointExtractor<PointT>::Ptr
+    clone() const
+    {
+        return typename KeypointExtractor<PointT>::Ptr( new IssKeypointExtractor<PointT>(*this) );
+    }
+
     typedef boost::shared_ptr< IssKeypointExtractor<PointT> > Ptr;
     typedef boost::shared_ptr< IssKeypointExtractor<PointT> const> ConstPtr;
 };
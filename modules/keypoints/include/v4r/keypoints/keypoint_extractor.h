@@ -26,6 +26,7 @@
 
 #include <v4r/core/macros.h>
 #include <pcl/common/common.h>
+#include <string>
 #include <v4r/keypoints/types.h>
 
 namespace v4r
@@ -94,6 +95,16 @@ public:
      */
     virtual std::string getKeypointExtractorName() const = 0;
 
+    /**
+     * @brief getKeypointExtractorParameters
+     * @return parameters that influence the extracted keypoints as string (together with the name, this identifies
+     * the keypoints an extractor computes for a given cloud, e.g. for caching)
+     */
+    virtual std::string getKeypointExtractorParameters() const
+    {
+        return "";
+    }
+
     /**
      * @brief compute
      * @param keypoints
@@ -101,6 +112,16 @@ public:
     virtual void
     compute () = 0;
 
+    /**
+     * @brief clone
+     * @return copy of the keypoint extractor which can be used concurrently to this instance (empty if the extractor can not be copied)
+     */
+    virtual boost::shared_ptr< KeypointExtractor<PointT> >
+    clone() const
+    {
+        return boost::shared_ptr< KeypointExtractor<PointT> >();
+    }
+
     /**
      * @brief getKeypoints
      * @return extracted keypoints
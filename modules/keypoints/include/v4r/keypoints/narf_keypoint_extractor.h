@@ -27,6 +27,7 @@
 #include <pcl/common/io.h>
 #include <v4r/common/camera.h>
 #include <v4r/keypoints/keypoint_extractor.h>
+#include <sstream>
 #include <boost/program_options.hpp>
 
 namespace po = boost::program_options;
@@ -137,6 +138,18 @@ public:
     int getKeypointExtractorType() const { return KeypointType::NARF; }
     std::string getKeypointExtractorName() const { return "narf"; }
 
+    std::string getKeypointExtractorParameters() const
+    {
+        std::stringstream ss;
+        ss << param_.noise_level_ << "_" << param_.minimum_range_ << "_" << param_.support_size_ << "_"
+           << param_.min_distance_between_interest_points_ << "_" << param_.optimal_distance_to_high_surface_change_ << "_"
+           << param_.min_interest_value_ << "_" << param_.min_surface_change_score_ << "_" << param_.optimal_range_image_patch_size_;
+        if(param_.cam_)
+            ss << "_" << param_.cam_->getWidth() << "x" << param_.cam_->getHeight() << "_" << param_.cam_->getFocalLength()
+               << "_" << param_.cam_->getCx() << "_" << param_.cam_->getCy();
+        return ss.str();
+    }
+
 
     typename pcl::PointCloud<PointT>::Ptr
     getKeypoints()
@@ -146,6 +159,12 @@ public:
         return keypoints_;
     }
 
+    typename KeypointExtractor<PointT>::Ptr
+    clone() const
+    {
+        return typename KeypointExtractor<PointT>::Ptr( new NarfKeypointExtractor<PointT>(*this) );
+    }
+
     typedef boost::shared_ptr< NarfKeypointExtractor<PointT> > Ptr;
     typedef boost::shared_ptr< NarfKeypointExtractor<PointT> const> ConstPtr;
 };
@@ -26,6 +26,7 @@
 
 #include <pcl/common/io.h>
 #include <v4r/keypoints/keypoint_extractor.h>
+#include <sstream>
 #include <boost/program_options.hpp>
 
 namespace po = boost::program_options;
@@ -99,6 +100,13 @@ public:
     int getKeypointExtractorType() const { return KeypointType::UniformSampling; }
     std::string getKeypointExtractorName() const { return "uniform_sampling"; }
 
+    std::string getKeypointExtractorParameters() const
+    {
+        std::stringstream ss;
+        ss << param_.sampling_density_;
+        return ss.str();
+    }
+
     typename pcl::PointCloud<PointT>::Ptr
     getKeypoints()
     {
@@ -107,6 +115,12 @@ public:
         return keypoints_;
     }
 
+    typename KeypointExtractor<PointT>::Ptr
+    clone() const
+    {
+        return typename KeypointExtractor<PointT>::Ptr( new UniformSamplingExtractor<PointT>(*this) );
+    }
+
     typedef boost::shared_ptr< UniformSamplingExtractor<PointT> > Ptr;
     typedef boost::shared_ptr< UniformSamplingExtractor<PointT> const> ConstPtr;
 };
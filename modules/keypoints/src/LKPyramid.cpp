@@ -0,0 +1,44 @@
+/**
+ * $Id$
+ */
+
+#include <v4r/keypoints/LKPyramid.h>
+#include <opencv2/imgproc/imgproc.hpp>
+#include <opencv2/video/tracking.hpp>
+
+
+namespace v4r
+{
+
+
+/**
+ * build
+ */
+void LKPyramid::build(const cv::Mat &image, const cv::Size &_win_size, int _max_level, bool _with_derivatives)
+{
+  cv::Mat im_gray;
+  if (image.type()!=CV_8U) cv::cvtColor( image, im_gray, CV_RGB2GRAY );
+  else im_gray = image;
+
+  win_size = _win_size;
+  max_level = _max_level;
+  with_derivatives = _with_derivatives;
+  nb_levels = cv::buildOpticalFlowPyramid(im_gray, pyr, win_size, max_level, with_derivatives);
+}
+
+
+/**
+ * getLKPyramid
+ */
+void getLKPyramid(const cv::Mat &image, const cv::Size &win_size, int max_level, LKPyramid::Ptr &pyr)
+{
+  if (!pyr.empty() && pyr->isCompatible(win_size, max_level))
+    return;
+
+  // do not rebuild in place, the pyramid might be shared (and image might be a view into it)
+  pyr.reset(new LKPyramid(image, win_size, max_level));
+}
+
+
+}
+
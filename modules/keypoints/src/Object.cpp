@@ -1,10 +1,14 @@
 
 #include <v4r/keypoints/impl/Object.hpp>
+#include <boost/thread/mutex.hpp>
 
 
 namespace v4r
 {
 
+// guards the cached image pyramids of the views (trackers sharing a model build them concurrently)
+static boost::mutex mtx_image_pyr;
+
 
 
 /******************** impl ObjectView **************************/
@@ -92,10 +96,22 @@ void ObjectView::copyTo(ObjectView &view) {
   view.object = object;
 }
 
+/** cached LK pyramid of image **/
+LKPyramid::Ptr ObjectView::getImagePyramid(const cv::Size &win_size, int max_level)
+{
+  boost::mutex::scoped_lock lock(mtx_image_pyr);
+  getLKPyramid(image, win_size, max_level, image_pyr);
+  return image_pyr;
+}
+
 /** clear **/
 void ObjectView::clear() {
   camera_id = -1;
   image = cv::Mat_<unsigned char>();
+  {
+    boost::mutex::scoped_lock lock(mtx_image_pyr);
+    image_pyr.reset(0);
+  }
   descs = cv::Mat();
   keys.clear();
   points.clear();
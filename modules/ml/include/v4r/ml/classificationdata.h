@@ -43,6 +43,7 @@
 #include <algorithm>
 #include <boost/format.hpp>
 #include <boost/random.hpp>
+#include <boost/shared_ptr.hpp>
 
 #include <v4r/core/macros.h>
 
@@ -74,6 +75,16 @@ private:
   std::map<int, unsigned int> pointsPerLabel;
   unsigned int totalPoints;
   boost::mt19937 randomGenerator;
+
+  // memory mapped binary training data (see LoadFromBinaryFile). Features are stored columnar in row groups
+  // of rowsPerGroup points, points are sorted by label. The loaded points (current bag or refinement chunk)
+  // are not copied, loadedPoints holds their index in the mapping
+  boost::shared_ptr<const char> mappedFile;
+  const float* mappedData;
+  unsigned int rowsPerGroup;
+  std::map<int, size_t> firstPointPerLabel;
+  std::vector<size_t> loadedPoints;
+  size_t GetLoadedCount();
   
 public:
     
@@ -84,17 +95,23 @@ public:
   std::map< int, unsigned int >& GetCountPerLabel();
   int GetCount();
   std::vector<int>& GetAvailableLabels();
+  std::vector<int>& GetTrainingLabels();
+  std::vector<float>& GetLabelWeights();
+  unsigned int Quantize(int nBins, std::vector<unsigned char>& bins, std::vector< std::vector<float> >& thresholds);
   std::pair<float, float> GetMinMax(std::vector< unsigned int >::iterator startidx, std::vector< unsigned int >::iterator stopidx, int dimension);
   std::pair<float, float> GetMinMax(int dimension);
   std::vector< unsigned int >::iterator Partition(std::vector< unsigned int >::iterator startidx, std::vector< unsigned int >::iterator stopidx, int dimension, float threshold);
-  float GetFeature(int pointIdx, int featureIdx);
-  std::vector<float> GetFeatures(int pointIdx);
+  float GetFeature(size_t pointIdx, int featureIdx);
+  std::vector<float> GetFeatures(size_t pointIdx);
   float GetInformationGain(std::vector< unsigned int >::const_iterator startidx, std::vector< unsigned int >::const_iterator stopidx, std::vector< unsigned int >::const_iterator divider);
   std::pair<std::vector<unsigned int >, std::vector< float > > CalculateNormalizedHistogram(std::vector<unsigned int>::const_iterator startidx, std::vector<unsigned int>::const_iterator stopidx);
   void LoadDemoSpiral(int nPoints, float noise);
   void SaveToFile(std::string filepath);
   void LoadFromFile(std::string trainingFilePath, std::string categoryFilePath);
   unsigned int LoadFromDirectory(std::string directory, std::vector< int > labelIDs);
+  bool ConvertToBinaryFile(std::string directory, std::vector< int > labelIDs, std::string filepath, unsigned int rowsPerGroup = 65536);
+  unsigned int LoadFromBinaryFile(std::string filepath);
+  bool IsMapped();
   virtual ~ClassificationData();
 };
 
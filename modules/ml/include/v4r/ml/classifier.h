@@ -32,6 +32,18 @@
 
 namespace v4r
 {
+
+/**
+ * @brief result of one classification call. Each query produces one row in each matrix.
+ */
+class V4R_EXPORTS ClassificationResult
+{
+public:
+    Eigen::MatrixXi predicted_label_;       ///< most probable predictions, sorted - most likely one is on the left
+    Eigen::MatrixXi training_sample_ids_;   ///< training samples that lead to the predictions (only for nearest neighbor classifiers, empty otherwise)
+    Eigen::MatrixXf distances_;             ///< distances of these training samples to the query
+};
+
 class V4R_EXPORTS Classifier
 {
 public:
@@ -54,6 +66,23 @@ public:
     virtual void
     predict(const Eigen::MatrixXf &query_data, Eigen::MatrixXi &predicted_label) const = 0;
 
+    /**
+     * @brief predict the target values of a batch of queries. Does not change the state of the classifier,
+     * i.e. a trained classifier can be shared by several threads
+     * @param query_data (each query is a row entry, the feature dimensions are equal to the number of columns)
+     * @param result predicted labels (and training samples / distances if supported by the classifier)
+     */
+    virtual void
+    predict(const Eigen::MatrixXf &query_data, ClassificationResult &result) const
+    {
+        predict(query_data, result.predicted_label_);
+        result.training_sample_ids_.resize(0,0);
+        result.distances_.resize(0,0);
+    }
+
+    /**
+     * @brief training samples of the last predict call (not thread-safe, use predict with ClassificationResult instead)
+     */
     virtual void
     getTrainingSampleIDSforPredictions(Eigen::MatrixXi &predicted_training_sample_indices, Eigen::MatrixXf &distances)
     {
@@ -30,6 +30,7 @@
 #define FOREST_H
 
 #include <algorithm>
+#include <limits>
 #include <time.h>
 #include "boost/random.hpp"
 #include <fstream>
@@ -56,6 +57,9 @@ namespace RandomForest {
 // how many data points to load into RAM at once
 #define MAX_DATAPOINTS_TO_LOAD 1000000
 
+// how many data points traverse a tree together in batch classification
+#define FOREST_BATCH_SIZE 16
+
 class V4R_EXPORTS Forest
 {   
 private:
@@ -88,17 +92,33 @@ private:
   bool splitNodesStoreLabelDistribution;
 
   std::vector<int> labels;
+
+  // compiled inference layout: split nodes of all trees packed in breadth-first order and
+  // all label distributions in one table (row 0 is all zeros). Not serialized, rebuilt by Compile()
+  std::vector<FlatNode> flatNodes;
+  std::vector<int> flatRoots;
+  std::vector<float> flatLabelDistributions;
+
   void RefineLeafNodes(ClassificationData& data, int verbosityLevel = 1);
+  void Compile();
   
 public:
   Forest();
   Forest(std::string filename);
   Forest(int nTrees, int maxDepth = 8, float baggingRatio = 0.5, int testedSplittingFunctions = 100, float minInformationGain = 0.02, int minPointsForSplit = 5);
   void Train(ClassificationData& trainingData, int verbosityLevel = 1);
+  // trainingData can be loaded from a directory (bags and refinement chunks are read from text files) or
+  // memory mapped with ClassificationData::LoadFromBinaryFile (bags and chunks only hold point indices and labels,
+  // works for data sets larger than RAM)
   void TrainLarge(ClassificationData& trainingData, bool allNodesStoreLabelDistribution, bool refineWithAllTrainingData = false, int verbosityLevel = 1);
-  std::vector<float> SoftClassify(std::vector<float>& point, int depth = -1, int useNTrees = -1);
+  std::vector<float> SoftClassify(const std::vector<float>& point, int depth = -1, int useNTrees = -1) const;
   void EraseSplitNodeLabelDistributions();
-  int ClassifyPoint(std::vector<float>& point, int depth = -1, int useNTrees = -1);
+  int ClassifyPoint(const std::vector<float>& point, int depth = -1, int useNTrees = -1) const;
+
+  // batch classification of nPoints row-major points with dims features each.
+  // labelDist has to hold nPoints * GetLabels().size() values, labelIdx nPoints values (index into GetLabels())
+  void SoftClassifyBatch(const float* points, int nPoints, int dims, float* labelDist, int depth = -1, int useNTrees = -1) const;
+  void ClassifyBatch(const float* points, int nPoints, int dims, int* labelIdx, int depth = -1, int useNTrees = -1) const;
   void SaveToFile(std::string filename);
   void LoadFromFile(std::string filename);
   void CreateVisualizations(std::string directory);
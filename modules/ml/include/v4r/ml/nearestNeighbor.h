@@ -37,16 +37,25 @@ namespace v4r
     public:
         int kdtree_splits_;
         size_t knn_;  ///< nearest neighbors to search for when checking feature descriptions of the scene
-        int distance_metric_; ///< defines the norm used for feature matching (1... L1 norm, 2... L2 norm)
+        int distance_metric_; ///< defines the norm used for feature matching (1... L1 norm, 2... L2 norm, 3... ChiSquare)
+        int index_type_; ///< search structure (0... FLANN kd-tree, 1... exact brute force, 2... product quantization)
+        int pq_subspaces_; ///< number of sub-quantizers for product quantization
+        int pq_rerank_; ///< product quantization candidates re-ranked with exact distances (0... none)
 
         NearestNeighborClassifierParameter(
                 int kdtree_splits = 512,
                 size_t knn = 1,
-                int distance_metric = 2
+                int distance_metric = 2,
+                int index_type = EigenFLANN::KDTREE,
+                int pq_subspaces = 16,
+                int pq_rerank = 64
                 )
             : kdtree_splits_ (kdtree_splits),
               knn_ ( knn ),
-              distance_metric_ (distance_metric)
+              distance_metric_ (distance_metric),
+              index_type_ (index_type),
+              pq_subspaces_ (pq_subspaces),
+              pq_rerank_ (pq_rerank)
         {}
 
 
@@ -75,7 +84,10 @@ namespace v4r
                     ("help,h", "produce help message")
                     ("nn_kdtree_splits", po::value<int>(&kdtree_splits_)->default_value(kdtree_splits_), "")
                     ("nn_knn", po::value<size_t>(&knn_)->default_value(knn_), "nearest neighbors to search for when checking feature descriptions of the scene")
-                    ("nn_distance_metric", po::value<int>(&distance_metric_)->default_value(distance_metric_), "defines the norm used for feature matching (1... L1 norm, 2... L2 norm)")
+                    ("nn_distance_metric", po::value<int>(&distance_metric_)->default_value(distance_metric_), "defines the norm used for feature matching (1... L1 norm, 2... L2 norm, 3... ChiSquare)")
+                    ("nn_index_type", po::value<int>(&index_type_)->default_value(index_type_), "search structure (0... FLANN kd-tree, 1... exact brute force, 2... product quantization). Exact search is usually faster for low-dimensional global descriptors.")
+                    ("nn_pq_subspaces", po::value<int>(&pq_subspaces_)->default_value(pq_subspaces_), "number of sub-quantizers for product quantization")
+                    ("nn_pq_rerank", po::value<int>(&pq_rerank_)->default_value(pq_rerank_), "product quantization candidates per query re-ranked with exact distances (0... none)")
                     ;
             po::variables_map vm;
             po::parsed_options parsed = po::command_line_parser(command_line_arguments).options(desc).allow_unregistered().run();
@@ -107,11 +119,19 @@ namespace v4r
         void
         predict(const Eigen::MatrixXf &query_data, Eigen::MatrixXi &predicted_label) const;
 
+        /**
+         * @brief predict labels of a batch of queries, the nearest neighbor search is split over all available threads
+         * @param query_data (each query is a row entry)
+         * @param result predicted labels, indices of the nearest training samples and their distances
+         */
+        void
+        predict(const Eigen::MatrixXf &query_data, ClassificationResult &result) const;
+
         void
         train(const Eigen::MatrixXf &training_data, const Eigen::VectorXi & training_label);
 
         /**
-         * @brief getTrainingSampleIDSforPredictions
+         * @brief getTrainingSampleIDSforPredictions (of the last call to predict(query_data, predicted_label), not thread-safe)
          * @param predicted_training_sample_indices
          * @param distances of the training sample to the corresponding query data
          */
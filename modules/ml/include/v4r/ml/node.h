@@ -75,48 +75,64 @@ public:
   void ClearSplitNodeLabelDistribution();
   void AddToAbsLabelDistribution(int labelIdx);
   void UpdateLabelDistribution(std::vector< int > labels, std::map< int, unsigned int >& pointsPerLabel);
-  inline int GetLeftChildIdx();
-  inline int GetRightChildIdx();
+  inline int GetLeftChildIdx() const;
+  inline int GetRightChildIdx() const;
   inline std::vector<float>& GetLabelDistribution();
-  inline float GetThreshold();
-  inline int GetSplitFeatureIdx();
-  inline bool IsSplitNode();
-  inline int EvaluateNode(std::vector< float >& point);
+  inline const std::vector<float>& GetLabelDistribution() const;
+  inline float GetThreshold() const;
+  inline int GetSplitFeatureIdx() const;
+  inline bool IsSplitNode() const;
+  inline int EvaluateNode(const std::vector< float >& point) const;
   virtual ~Node();
 };
 
+// packed node of the compiled (inference only) forest layout
+// children of a split node are stored next to each other, i.e. right child = leftChildIdx + 1
+struct FlatNode
+{
+  int splitOnFeatureIdx;      // -1 for leaf nodes
+  float threshold;
+  int leftChildIdx;
+  int labelDistributionIdx;   // row in the label distribution table of the forest
+};
+
 inline std::vector< float >& Node::GetLabelDistribution()
 {
   return labelDistribution_;
 }
 
-inline bool Node::IsSplitNode()
+inline const std::vector< float >& Node::GetLabelDistribution() const
+{
+  return labelDistribution_;
+}
+
+inline bool Node::IsSplitNode() const
 {
   return isSplitNode_;
 }
  
 // for testing, does point go left or right?
-inline int Node::EvaluateNode(std::vector< float >& point)
+inline int Node::EvaluateNode(const std::vector< float >& point) const
 {  
   return point[splitOnFeatureIdx_] > threshold_ ? rightChildIdx_ : leftChildIdx_;
 }
 
-inline int Node::GetLeftChildIdx()
+inline int Node::GetLeftChildIdx() const
 {
   return leftChildIdx_;
 }
 
-inline int Node::GetRightChildIdx()
+inline int Node::GetRightChildIdx() const
 {
   return rightChildIdx_;
 }
 
-inline int Node::GetSplitFeatureIdx()
+inline int Node::GetSplitFeatureIdx() const
 {
   return splitOnFeatureIdx_;
 }
 
-inline float Node::GetThreshold()
+inline float Node::GetThreshold() const
 {
   return threshold_;
 }
@@ -160,6 +160,14 @@ public:
     void
     predict(const Eigen::MatrixXf &query_data, Eigen::MatrixXi &predicted_label) const;
 
+    /**
+         * @brief predict labels of a batch of queries (classified in parallel)
+         * @param query_data (each query is a row entry)
+         * @param result predicted labels (no training samples for SVMs)
+         */
+    void
+    predict(const Eigen::MatrixXf &query_data, ClassificationResult &result) const;
+
     /**
          * @brief saveModel save current svm model
          * @param filename filename to save trained model
@@ -50,6 +50,17 @@ namespace v4r
 
 namespace RandomForest {
 
+// number of bins per feature used for histogram based split search (at most 256)
+#define HISTOGRAM_SPLIT_BINS 256
+
+// nodes with at most this many points, or whose points fall into less than HISTOGRAM_MIN_OCCUPIED_BINS
+// of the global bins of a feature, search exact thresholds on the sorted feature values
+#define HISTOGRAM_EXACT_MAX_POINTS 4096
+#define HISTOGRAM_MIN_OCCUPIED_BINS 32
+
+// nodes with less points evaluate features and children sequentially
+#define HISTOGRAM_PARALLEL_MIN_POINTS 20000
+
 class V4R_EXPORTS Tree
 {
 private:
@@ -71,15 +82,27 @@ private:
   int testedSplittingFunctions;
   
   int trainRecursively(ClassificationData& data, std::vector< unsigned int > indices, int maxDepth, int testedSplittingFunctions, float minInformationGain, int minPointsForSplit, bool allNodesStoreLabelDistribution, int currentDepth);
-  int trainRecursivelyParallel(ClassificationData& data, std::vector< unsigned int > indices, int maxDepth, int testedSplittingFunctions, float minInformationGain, int minPointsForSplit, bool allNodesStoreLabelDistribution, int currentDepth);
+
+  // quantized training data for histogram based split search
+  struct BinnedData
+  {
+    std::vector<unsigned char> bins;                // feature major, bins[feature * nPoints + point]
+    std::vector< std::vector<float> > thresholds;   // split threshold after each bin, per feature
+    unsigned int nPoints;
+  };
+
+  int trainHistogram(ClassificationData& data, const BinnedData& binned, std::vector< unsigned int >::iterator startidx, std::vector< unsigned int >::iterator stopidx, int maxDepth, int testedSplittingFunctions, float minInformationGain, int minPointsForSplit, bool allNodesStoreLabelDistribution, int currentDepth);
+  void findBestSplit(ClassificationData& data, const BinnedData& binned, std::vector< unsigned int >::const_iterator startidx, std::vector< unsigned int >::const_iterator stopidx, int feature, int minPointsForSplit, float& bestGain, float& bestThreshold) const;
+  int addNode(const Node& node, int currentDepth);
   
 public:
   Tree();
   Tree(boost::mt19937* randomGenerator);
   inline Node* GetRootNode();
-  std::vector< float >& Classify(std::vector< float >& point);
-  std::vector< float >& Classify(std::vector< float >& point, int depth);
-  int GetResultingLeafNode(std::vector< float > point);
+  std::vector< float >& Classify(const std::vector< float >& point);
+  std::vector< float >& Classify(const std::vector< float >& point, int depth);
+  int GetResultingLeafNode(const std::vector< float >& point);
+  int Flatten(std::vector< FlatNode >& flatNodes, std::vector< float >& labelDistributions, int nLabels) const;
   void ClearLeafNodes();
   void RefineLeafNodes(ClassificationData& data, int nPoints, int labelIdx);
   void UpdateLeafNodes(std::vector<int> labels, std::map<int, unsigned int >& pointsPerLabel);
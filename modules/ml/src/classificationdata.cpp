@@ -29,10 +29,45 @@
 #include <v4r/ml/classificationdata.h>
 #include "boost/filesystem.hpp"
 
+#include <fcntl.h>
+#include <stdint.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
 using namespace boost::filesystem;
 using namespace v4r::RandomForest;
 
-ClassificationData::ClassificationData()
+// header of the binary training data format, followed by one LabelEntry per label and the row groups
+// (64 byte aligned). Each row group stores the features of its points column by column
+struct BinaryHeader
+{
+  char magic[8];
+  uint32_t version;
+  uint32_t dimensions;
+  uint32_t nLabels;
+  uint32_t rowsPerGroup;
+  uint64_t totalPoints;
+};
+
+struct LabelEntry
+{
+  int32_t labelID;
+  uint32_t reserved;
+  uint64_t firstPoint;
+  uint64_t count;
+};
+
+static const char BINARY_MAGIC[8] = {'V','4','R','C','D','A','T','A'};
+static const uint32_t BINARY_VERSION = 1;
+
+static size_t binaryDataOffset(uint32_t nLabels)
+{
+  size_t offset = sizeof(BinaryHeader) + nLabels * sizeof(LabelEntry);
+  return (offset + 63) & ~(size_t)63;
+}
+
+ClassificationData::ClassificationData() : mappedData(0), rowsPerGroup(0)
 {
 
 }
@@ -71,8 +106,11 @@ std::vector< unsigned int > ClassificationData::NewBag(float baggingRatio)
   // creates a new "bag" of training data containing the same number of
   // points of each label
   
-  data.clear();
-  trainingLabels.clear();   
+  if(!mappedData)
+  {
+    data.clear();
+    trainingLabels.clear();
+  }
   
   int nPoints = totalPoints * baggingRatio;
   unsigned int maxPpLabel = nPoints / availableLabels.size();
@@ -95,6 +133,34 @@ std::vector< unsigned int > ClassificationData::NewBag(float baggingRatio)
       labelWeights.push_back(N/n);
   }
 
+  if(mappedData)
+  {
+    // no copy, the bag refers to the mapped points. Sorted indices give sequential reads
+    loadedPoints.clear();
+    loadedPoints.reserve(nPoints);
+    trainingLabels.clear();
+    trainingLabels.reserve(nPoints);
+
+    for(unsigned int i=0; i<availableLabels.size(); i++)
+    {
+      unsigned int n = std::min(maxPpLabel, pointsPerLabel[availableLabels[i]]);
+      std::vector<unsigned int> linenumbers = generateRandomIndices(n, pointsPerLabel[availableLabels[i]]);
+      std::sort(linenumbers.begin(), linenumbers.end());
+
+      for(unsigned int j=0; j < n; j++)
+      {
+        loadedPoints.push_back(firstPointPerLabel[availableLabels[i]] + linenumbers[j]);
+        trainingLabels.push_back(i);
+      }
+    }
+
+    std::vector<unsigned int > indices(loadedPoints.size());
+    for(unsigned int j=0; j < indices.size(); j++)
+      indices[j] = j;
+
+    return indices;
+  }
+
   data.assign(nPoints*dimensions, 0.0f);
   trainingLabels.reserve(nPoints);
   std::vector<unsigned int > indices(nPoints);
@@ -139,6 +205,20 @@ std::vector< unsigned int > ClassificationData::NewBag(float baggingRatio)
 
 int ClassificationData::LoadChunkForLabel(int labelID, int nPoints)
 {
+  if(mappedData)
+  {
+    // the points of a label are stored consecutively, a chunk is the next range of them
+    size_t pos = trainingDataFilePos[labelID];
+    size_t n = std::min<size_t>(nPoints, pointsPerLabel[labelID] - pos);
+
+    loadedPoints.resize(n);
+    for(size_t i=0; i < n; ++i)
+      loadedPoints[i] = firstPointPerLabel[labelID] + pos + i;
+
+    trainingDataFilePos[labelID] = pos + n;
+    return n;
+  }
+
   data.clear();
     
   std::string filename = str(boost::format("%1$s/%2$04d.data") % directory % labelID);    
@@ -190,13 +270,14 @@ std::pair<float, float> ClassificationData::GetMinMax(std::vector< unsigned int
 
 std::pair<float, float> ClassificationData::GetMinMax(int dimension)
 {
-  float min = data[dimension];
+  size_t nPoints = GetLoadedCount();
+  float min = GetFeature(0, dimension);
   float max = min;
   
   float f = 0.0f;
   
-  for(unsigned int i=0; i<data.size()/dimensions; ++i){
-    f = data[i*dimensions + dimension];
+  for(size_t i=0; i<nPoints; ++i){
+    f = GetFeature(i, dimension);
     
     if(f < min)
       min = f;
@@ -212,13 +293,37 @@ int ClassificationData::GetCount()
   return totalPoints;
 }
 
-float ClassificationData::GetFeature(int pointIdx, int featureIdx)
+size_t ClassificationData::GetLoadedCount()
+{
+  if(mappedData)
+    return loadedPoints.size();
+
+  return dimensions > 0 ? data.size() / dimensions : 0;
+}
+
+float ClassificationData::GetFeature(size_t pointIdx, int featureIdx)
 {
+  if(mappedData)
+  {
+    const size_t p = loadedPoints[pointIdx];
+    const size_t first = (p / rowsPerGroup) * rowsPerGroup;
+    const size_t rows = std::min<size_t>(rowsPerGroup, totalPoints - first);
+    return mappedData[first*dimensions + (size_t)featureIdx*rows + (p-first)];
+  }
+
   return data[pointIdx*dimensions + featureIdx];
 }
 
-std::vector< float > ClassificationData::GetFeatures(int pointIdx)
+std::vector< float > ClassificationData::GetFeatures(size_t pointIdx)
 {  
+  if(mappedData)
+  {
+    std::vector<float> p(dimensions);
+    for(int k=0; k < dimensions; ++k)
+      p[k] = GetFeature(pointIdx, k);
+    return p;
+  }
+
   std::vector<float> p(&data[pointIdx*dimensions], &data[(pointIdx+1)*dimensions]);
   return p;
 }
@@ -226,6 +331,9 @@ std::vector< float > ClassificationData::GetFeatures(int pointIdx)
 
 void ClassificationData::LoadDemoSpiral(int nPoints, float noise)
 {
+  mappedFile.reset();
+  mappedData = 0;
+  loadedPoints.clear();
   trainingLabels.clear();
   data.clear();
   directory = "";
@@ -539,6 +647,68 @@ std::vector< int >& ClassificationData::GetAvailableLabels()
   return availableLabels;
 }
 
+std::vector< int >& ClassificationData::GetTrainingLabels()
+{
+  return trainingLabels;
+}
+
+std::vector< float >& ClassificationData::GetLabelWeights()
+{
+  return labelWeights;
+}
+
+unsigned int ClassificationData::Quantize(int nBins, std::vector< unsigned char >& bins, std::vector< std::vector< float > >& thresholds)
+{
+  // quantizes all loaded data points (the current bag) into at most nBins (<= 256) bins per feature. Bin edges are quantiles
+  // of (a subsample of) the data, point i falls into bin b of feature k iff thresholds[k][b-1] < value <= thresholds[k][b].
+  // bins are stored feature major: bins[k*nPoints + i]. Returns the number of quantized points
+  unsigned int nPoints = GetLoadedCount();
+  const unsigned int maxSamples = 100000;
+  const unsigned int step = std::max(1u, nPoints / maxSamples);
+
+  bins.resize((size_t)nPoints * dimensions);
+  thresholds.assign(dimensions, std::vector<float>());
+
+  #pragma omp parallel for schedule(dynamic)
+  for(int k=0; k < dimensions; ++k)
+  {
+    std::vector<float> values;
+    values.reserve(nPoints / step + 1);
+
+    for(unsigned int i=0; i < nPoints; i+=step)
+      values.push_back(GetFeature(i, k));
+
+    std::sort(values.begin(), values.end());
+
+    std::vector<float>& t = thresholds[k];
+    const size_t m = values.size();
+
+    for(int b=1; b < nBins && m > 0; ++b)
+    {
+      size_t idx = (size_t)b * m / nBins;
+
+      if(idx == 0)
+        continue;
+
+      float v = values[idx-1];
+
+      // a split at the max value would not separate anything
+      if(v >= values.back())
+        break;
+
+      if(t.empty() || v > t.back())
+        t.push_back(v);
+    }
+
+    unsigned char* b = bins.empty() ? 0 : &bins[(size_t)k * nPoints];
+
+    for(unsigned int i=0; i < nPoints; ++i)
+      b[i] = std::lower_bound(t.begin(), t.end(), GetFeature(i, k)) - t.begin();
+  }
+
+  return nPoints;
+}
+
 unsigned int ClassificationData::LoadFromDirectory(std::string directory, std::vector< int > labelIDs)
 {
   // loads files specified by directory and the labelIDs and counts the number of available
@@ -551,6 +721,9 @@ unsigned int ClassificationData::LoadFromDirectory(std::string directory, std::v
         return 0;
     }
 
+    mappedFile.reset();
+    mappedData = 0;
+    loadedPoints.clear();
     totalPoints = 0;
     this->directory = directory;
     availableLabels = labelIDs;
@@ -603,6 +776,9 @@ std::map<int, unsigned int >& ClassificationData::GetCountPerLabel()
 
 void ClassificationData::LoadFromFile(std::string trainingFilePath, std::string categoryFilePath)
 {
+  mappedFile.reset();
+  mappedData = 0;
+  loadedPoints.clear();
   trainingLabels.clear();
   data.clear();
   
@@ -657,6 +833,175 @@ void ClassificationData::LoadFromFile(std::string trainingFilePath, std::string
   dimensions = data.size() / trainingLabels.size();
 }
 
+static void writeRowGroup(std::ofstream& out, const std::vector<float>& rowBuffer, std::vector<float>& columnBuffer, unsigned int rows, int dimensions)
+{
+  // transpose the buffered points into columns
+  for(int k=0; k < dimensions; ++k)
+    for(unsigned int r=0; r < rows; ++r)
+      columnBuffer[(size_t)k*rows + r] = rowBuffer[(size_t)r*dimensions + k];
+
+  out.write(reinterpret_cast<const char*>(&columnBuffer[0]), (size_t)rows * dimensions * sizeof(float));
+}
+
+bool ClassificationData::ConvertToBinaryFile(std::string directory, std::vector< int > labelIDs, std::string filepath, unsigned int rowsPerGroup)
+{
+  // converts the text training files of a directory (see LoadFromDirectory) into the binary format
+  // for LoadFromBinaryFile. Only one row group is kept in memory
+  if(LoadFromDirectory(directory, labelIDs) == 0 || rowsPerGroup == 0)
+    return false;
+
+  std::ofstream out(filepath.c_str(), std::ios::out | std::ios::binary);
+
+  if(!out.is_open())
+  {
+    std::cerr << "Could not open " << filepath << " for writing!" << std::endl;
+    return false;
+  }
+
+  BinaryHeader header;
+  memcpy(header.magic, BINARY_MAGIC, sizeof(header.magic));
+  header.version = BINARY_VERSION;
+  header.dimensions = dimensions;
+  header.nLabels = labelIDs.size();
+  header.rowsPerGroup = rowsPerGroup;
+  header.totalPoints = totalPoints;
+  out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+  uint64_t firstPoint = 0;
+
+  for(unsigned int i=0; i < labelIDs.size(); ++i)
+  {
+    LabelEntry entry;
+    entry.labelID = labelIDs[i];
+    entry.reserved = 0;
+    entry.firstPoint = firstPoint;
+    entry.count = pointsPerLabel[labelIDs[i]];
+    out.write(reinterpret_cast<const char*>(&entry), sizeof(entry));
+    firstPoint += entry.count;
+  }
+
+  std::vector<char> padding(binaryDataOffset(labelIDs.size()) - sizeof(BinaryHeader) - labelIDs.size()*sizeof(LabelEntry), 0);
+  if(!padding.empty())
+    out.write(&padding[0], padding.size());
+
+  std::vector<float> rowBuffer((size_t)rowsPerGroup * dimensions);
+  std::vector<float> columnBuffer(rowBuffer.size());
+  unsigned int rows = 0;
+  float value;
+
+  for(unsigned int i=0; i < labelIDs.size(); ++i)
+  {
+    std::string filename = str(boost::format("%1$s/%2$04d.data") % this->directory % labelIDs[i]);
+    std::ifstream trainingfile(filename.c_str());
+
+    for(unsigned int j=0; j < pointsPerLabel[labelIDs[i]]; ++j)
+    {
+      for(int k=0; k < dimensions; ++k)
+      {
+        trainingfile >> value;
+        rowBuffer[(size_t)rows*dimensions + k] = value;
+      }
+
+      if(++rows == rowsPerGroup)
+      {
+        writeRowGroup(out, rowBuffer, columnBuffer, rows, dimensions);
+        rows = 0;
+      }
+    }
+
+    trainingfile.close();
+  }
+
+  if(rows > 0)
+    writeRowGroup(out, rowBuffer, columnBuffer, rows, dimensions);
+
+  out.close();
+  return !out.fail();
+}
+
+unsigned int ClassificationData::LoadFromBinaryFile(std::string filepath)
+{
+  // memory maps a file written by ConvertToBinaryFile. Features are read directly from the mapping,
+  // so the data set does not have to fit into RAM
+  int fd = open(filepath.c_str(), O_RDONLY);
+
+  if(fd < 0)
+  {
+    std::cout << "Training data file " << filepath << " does not exist!" << std::endl;
+    return 0;
+  }
+
+  struct stat st;
+  if(fstat(fd, &st) != 0 || (size_t)st.st_size < sizeof(BinaryHeader))
+  {
+    close(fd);
+    std::cerr << "Training data file " << filepath << " is not valid!" << std::endl;
+    return 0;
+  }
+
+  const size_t size = st.st_size;
+  void* addr = mmap(0, size, PROT_READ, MAP_SHARED, fd, 0);
+  close(fd);
+
+  if(addr == MAP_FAILED)
+  {
+    std::cerr << "Could not map training data file " << filepath << "!" << std::endl;
+    return 0;
+  }
+
+  boost::shared_ptr<const char> file(static_cast<const char*>(addr), [size](const char* p) { munmap(const_cast<char*>(p), size); });
+
+  BinaryHeader header;
+  memcpy(&header, file.get(), sizeof(header));
+
+  if(memcmp(header.magic, BINARY_MAGIC, sizeof(header.magic)) != 0 || header.version != BINARY_VERSION || header.rowsPerGroup == 0 ||
+     size < binaryDataOffset(header.nLabels) + header.totalPoints * header.dimensions * sizeof(float))
+  {
+    std::cerr << "Training data file " << filepath << " is not valid!" << std::endl;
+    return 0;
+  }
+
+  data.clear();
+  directory = "";
+  availableLabels.clear();
+  pointsPerLabel.clear();
+  firstPointPerLabel.clear();
+  trainingDataFilePos.clear();
+  trainingLabels.clear();
+  loadedPoints.clear();
+
+  for(uint32_t i=0; i < header.nLabels; ++i)
+  {
+    LabelEntry entry;
+    memcpy(&entry, file.get() + sizeof(BinaryHeader) + i*sizeof(LabelEntry), sizeof(entry));
+
+    if(entry.firstPoint + entry.count > header.totalPoints)
+    {
+      std::cerr << "Training data file " << filepath << " is not valid!" << std::endl;
+      return 0;
+    }
+
+    availableLabels.push_back(entry.labelID);
+    pointsPerLabel[entry.labelID] = entry.count;
+    firstPointPerLabel[entry.labelID] = entry.firstPoint;
+    trainingDataFilePos[entry.labelID] = 0;
+  }
+
+  mappedFile = file;
+  mappedData = reinterpret_cast<const float*>(file.get() + binaryDataOffset(header.nLabels));
+  rowsPerGroup = header.rowsPerGroup;
+  dimensions = header.dimensions;
+  totalPoints = header.totalPoints;
+  labelStatus = LABELED;
+
+  return totalPoints;
+}
+
+bool ClassificationData::IsMapped()
+{
+  return mappedData != 0;
+}
+
 ClassificationData::~ClassificationData()
 {
 
@@ -42,6 +42,7 @@ Forest::Forest()
   minInformationGain = 0.02;
   minPointsForSplit = 5;
   baggingRatio = 0.5;
+  splitNodesStoreLabelDistribution = false;
 }
 
 Forest::Forest(std::string filename)
@@ -60,25 +61,32 @@ Forest::Forest(int nTrees, int maxDepth, float baggingRatio, int testedSplitting
   this->minInformationGain = minInformationGain;
   this->minPointsForSplit = minPointsForSplit;
   this->baggingRatio = baggingRatio;
+  this->splitNodesStoreLabelDistribution = false;
 }
 
-std::vector< float > Forest::SoftClassify(std::vector< float >& point, int depth, int useNTrees)
+std::vector< float > Forest::SoftClassify(const std::vector< float >& point, int depth, int useNTrees) const
 {
-  std::vector<float> labelDist(labels.size());
- 
-  // initialize label distribution array
-  for(unsigned int i=0; i < labelDist.size(); i++)
-    labelDist[i] = 0.0f;   
-  
-  if(useNTrees < 0 || (unsigned int)useNTrees > trees.size())
-      useNTrees = trees.size();
+  std::vector<float> labelDist(labels.size(), 0.0f);
 
-  // label distribution for every tree
-  std::vector< std::vector<float> > labelDistPerTree(useNTrees);//trees.size());
-  
-  // initialize for parallelization
-  for(int i=0; i < useNTrees; ++i)//nTrees; i++)
-	labelDistPerTree[i].reserve(labelDist.size());
+  if(!point.empty() && !labelDist.empty())
+    SoftClassifyBatch(&point[0], 1, point.size(), &labelDist[0], depth, useNTrees);
+
+  return labelDist;
+}
+
+int Forest::ClassifyPoint(const std::vector< float >& point, int depth, int useNTrees) const
+{
+  // take max value of label distribution for hard classification
+  std::vector<float> labelDist = SoftClassify(point, depth, useNTrees);
+  return std::distance(labelDist.begin(), std::max_element(labelDist.begin(), labelDist.end()));
+}
+
+void Forest::SoftClassifyBatch(const float* points, int nPoints, int dims, float* labelDist, int depth, int useNTrees) const
+{
+  const int nLabels = labels.size();
+
+  if(useNTrees < 0 || (unsigned int)useNTrees > flatRoots.size())
+      useNTrees = flatRoots.size();
 
   if(depth >= 0 && !splitNodesStoreLabelDistribution)
   {
@@ -87,50 +95,86 @@ std::vector< float > Forest::SoftClassify(std::vector< float >& point, int depth
       depth = -1;
   }
 
-  if(depth < 0)
-  {
-        // get label distribution for every tree
-        #pragma omp parallel
-        {
-            #pragma omp for nowait
-            for(int i=0; i < useNTrees; ++i)//< nTrees; i++)
-            {
-              labelDistPerTree[i] = trees[i].Classify(point);
-            }
-        }
-  }
-  else
+  const int maxSteps = depth < 0 ? std::numeric_limits<int>::max() : depth + 1;
+  const int nBlocks = (nPoints + FOREST_BATCH_SIZE - 1) / FOREST_BATCH_SIZE;
+
+  // a block of points traverses each tree in lockstep, so the node loads of different points overlap
+  #pragma omp parallel for schedule(static) if(nBlocks > 1)
+  for(int b=0; b < nBlocks; ++b)
   {
-      // get label distribution for every tree, traverse tree max. to defined depth
-      #pragma omp parallel
+    const int start = b * FOREST_BATCH_SIZE;
+    const int n = std::min(FOREST_BATCH_SIZE, nPoints - start);
+    const float* p = points + (size_t)start * dims;
+    float* dist = labelDist + (size_t)start * nLabels;
+    int idx[FOREST_BATCH_SIZE];
+
+    std::fill(dist, dist + n * nLabels, 0.0f);
+
+    for(int t=0; t < useNTrees; ++t)
+    {
+      for(int i=0; i < n; ++i)
+        idx[i] = flatRoots[t];
+
+      bool active = true;
+      for(int step=0; step < maxSteps && active; ++step)
       {
-          #pragma omp for nowait
-          for(int i=0; i < useNTrees; ++i)//< nTrees; i++)
+        active = false;
+        for(int i=0; i < n; ++i)
+        {
+          const FlatNode& node = flatNodes[idx[i]];
+          if(node.splitOnFeatureIdx >= 0)
           {
-            labelDistPerTree[i] = trees[i].Classify(point, depth);
+            idx[i] = node.leftChildIdx + (p[i*dims + node.splitOnFeatureIdx] > node.threshold);
+            active = true;
           }
+        }
+      }
+
+      // accumulate label distributions of the reached nodes
+      for(int i=0; i < n; ++i)
+      {
+        const float* d = &flatLabelDistributions[(size_t)flatNodes[idx[i]].labelDistributionIdx * nLabels];
+        for(int j=0; j < nLabels; ++j)
+          dist[i*nLabels + j] += d[j];
       }
+    }
+
+    // normalize by number of trees to get final distribution
+    for(int i=0; i < n * nLabels; ++i)
+      dist[i] /= useNTrees;
   }
-  
-  // average label distributions of all trees
-  for(int i=0; i < useNTrees; ++i)//< nTrees; i++)
+}
+
+void Forest::ClassifyBatch(const float* points, int nPoints, int dims, int* labelIdx, int depth, int useNTrees) const
+{
+  const int nLabels = labels.size();
+  std::vector<float> labelDist((size_t)nPoints * nLabels);
+
+  if(labelDist.empty())
+    return;
+
+  SoftClassifyBatch(points, nPoints, dims, &labelDist[0], depth, useNTrees);
+
+  for(int i=0; i < nPoints; ++i)
   {
-    for(unsigned int j=0; j<labelDist.size(); j++)
-	  labelDist[j] += labelDistPerTree[i][j];
+    const float* d = &labelDist[(size_t)i * nLabels];
+    labelIdx[i] = std::distance(d, std::max_element(d, d + nLabels));
   }
-    
-  // normalize by number of trees to get final distribution
-  for(unsigned int i=0; i < labelDist.size(); i++)
-    labelDist[i] /= useNTrees;//nTrees;
- 
-  return labelDist;
 }
 
-int Forest::ClassifyPoint(std::vector< float >& point, int depth, int useNTrees)
+void Forest::Compile()
 {
-  // take max value of label distribution for hard classification
-  std::vector<float> labelDist = SoftClassify(point, depth, useNTrees);
-  return std::distance(labelDist.begin(), std::max_element(labelDist.begin(), labelDist.end()));
+  const int nLabels = labels.size();
+
+  flatNodes.clear();
+  flatRoots.clear();
+  flatLabelDistributions.assign(nLabels, 0.0f);
+
+  if(nLabels == 0)
+    return;
+
+  for(size_t t=0; t < trees.size(); ++t)
+    flatRoots.push_back(trees[t].Flatten(flatNodes, flatLabelDistributions, nLabels));
 }
 
 void Forest::EraseSplitNodeLabelDistributions()
@@ -141,6 +185,7 @@ void Forest::EraseSplitNodeLabelDistributions()
     }
 
     splitNodesStoreLabelDistribution = false;
+    Compile();
 }
 
 void Forest::Train(ClassificationData& trainingData, int verbosityLevel)
@@ -202,6 +247,8 @@ void Forest::Train(ClassificationData& trainingData, int verbosityLevel)
         
     trees[i].Train(trainingData, dataPointIndices, maxDepth, testedSplittingFunctions, minInformationGain, minPointsForSplit, verbosityLevel);
   }
+
+  Compile();
   
   if(verbosityLevel > 0)
   {
@@ -268,6 +315,7 @@ void Forest::TrainLarge(ClassificationData& trainingData, bool allNodesStoreLabe
   }
   
   splitNodesStoreLabelDistribution = allNodesStoreLabelDistribution;
+  Compile();
 
   if(verbosityLevel > 0)
   {
@@ -340,6 +388,7 @@ void Forest::LoadFromFile(std::string filename)
   ia >> f;
   *this = f;
   ifs.close();
+  Compile();
 }
 
 Forest::~Forest()
@@ -1,5 +1,10 @@
 #include <v4r/ml/nearestNeighbor.h>
 #include <glog/logging.h>
+#include <algorithm>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
 
 namespace v4r
 {
@@ -13,25 +18,66 @@ NearestNeighborClassifier::train(const Eigen::MatrixXf &training_data, const Eig
     flann_->param_.knn_ = param_.knn_;
     flann_->param_.distance_metric_ = param_.distance_metric_;
     flann_->param_.kdtree_splits_ = param_.kdtree_splits_;
+    flann_->param_.index_type_ = param_.index_type_;
+    flann_->param_.pq_subspaces_ = param_.pq_subspaces_;
+    flann_->param_.pq_rerank_ = param_.pq_rerank_;
     flann_->createFLANN(training_data);
 
     training_label_ = training_label;
 }
 
 void
-NearestNeighborClassifier::predict(const Eigen::MatrixXf &query_data, Eigen::MatrixXi &predicted_label) const
+NearestNeighborClassifier::predict(const Eigen::MatrixXf &query_data, ClassificationResult &result) const
 {
-    flann_->nearestKSearch(query_data, knn_indices_, knn_distances_);
+    const int num_queries = query_data.rows();
+    const int min_queries_per_thread = 16;
+    const int knn = std::min<int>( param_.knn_, training_label_.rows() );  // the search returns at most as many neighbors as training samples
+
+    result.training_sample_ids_.resize( num_queries, knn );
+    result.distances_.resize( num_queries, knn );
+    result.predicted_label_.resize( num_queries, knn );
 
-    predicted_label.resize( knn_indices_.rows() ,knn_indices_.cols() );
+    // FLANN search is read-only on the index, so blocks of queries can be searched concurrently
+    int num_blocks = 1;
+#ifdef _OPENMP
+    num_blocks = std::max(1, std::min( omp_get_max_threads(), num_queries / min_queries_per_thread ) );
+#endif
 
-    for(int row_id=0; row_id<knn_indices_.rows(); row_id++)
+#pragma omp parallel for schedule(static) if(num_blocks > 1)
+    for(int b=0; b<num_blocks; b++)
     {
-        for (int col_id = 0; col_id < knn_indices_.cols(); col_id++)
+        const int start = (long)num_queries * b / num_blocks;
+        const int rows = (long)num_queries * (b+1) / num_blocks - start;
+
+        if( !rows )
+            continue;
+
+        Eigen::MatrixXi knn_indices;
+        Eigen::MatrixXf knn_distances;
+        flann_->nearestKSearch(query_data.middleRows(start, rows), knn_indices, knn_distances);
+
+        result.training_sample_ids_.middleRows(start, rows) = knn_indices;
+        result.distances_.middleRows(start, rows) = knn_distances;
+
+        for(int row_id=0; row_id<rows; row_id++)
         {
-            predicted_label(row_id, col_id ) = training_label_( knn_indices_(row_id, col_id) );
+            for (int col_id = 0; col_id < knn_indices.cols(); col_id++)
+            {
+                int idx = knn_indices(row_id, col_id);
+                result.predicted_label_(start + row_id, col_id ) = idx >= 0 ? training_label_( idx ) : -1;  // the approximate kd-tree search can stop early
+            }
         }
     }
 }
 
+void
+NearestNeighborClassifier::predict(const Eigen::MatrixXf &query_data, Eigen::MatrixXi &predicted_label) const
+{
+    ClassificationResult result;
+    predict(query_data, result);
+    predicted_label = result.predicted_label_;
+    knn_indices_ = result.training_sample_ids_;
+    knn_distances_ = result.distances_;
+}
+
 }
@@ -10,73 +10,62 @@
 namespace v4r
 {
 
-void svmClassifier::predict(const Eigen::MatrixXf &query_data, Eigen::MatrixXi &predicted_label) const
+void svmClassifier::predict(const Eigen::MatrixXf &query_data, ClassificationResult &result) const
 {
     int num_examples = query_data.rows();
     int num_attributes = query_data.cols();
+    Eigen::MatrixXi &predicted_label = result.predicted_label_;
 
     if(param_.svm_.probability)
         predicted_label.resize(num_examples, param_.knn_);
     else
         predicted_label.resize(num_examples, 1);
 
-    Eigen::MatrixXf query_data_scaled = query_data;
-
-    if(param_.do_scaling_)
-    {
-        for(int row = 0 ; row < num_examples; row++)
-        {
-            query_data_scaled.row(row).array() *= scale_.array();
-        }
-    }
-
+    result.training_sample_ids_.resize(0,0);
+    result.distances_.resize(0,0);
 
-    for(int i=0; i<num_examples; i++)
+    // libsvm prediction only reads the model, so queries are classified in parallel
+#pragma omp parallel
     {
-        ::svm_node *svm_n_test = new ::svm_node[ num_attributes+1 ];
+        std::vector< ::svm_node > svm_n_test ( num_attributes+1 );
+        std::vector<double> probs;
 
-        for(int kk=0; kk<num_attributes; kk++)
+#pragma omp for schedule(dynamic, 16)
+        for(int i=0; i<num_examples; i++)
         {
-            svm_n_test[kk].value = query_data_scaled(i, kk);
-            svm_n_test[kk].index = kk+1;
-        }
-        svm_n_test[ num_attributes ].index = -1;
-
-        if(param_.svm_.probability)
-        {
-            double *prob_estimates;
-            try
-            {
-                prob_estimates = new double[ svm_mod_->nr_class ];
-            }
-            catch (std::bad_alloc&)
+            for(int kk=0; kk<num_attributes; kk++)
             {
-                std::cerr << "Error allocating memory " << std::endl;
+                svm_n_test[kk].value = param_.do_scaling_ ? query_data(i, kk) * scale_(kk) : query_data(i, kk);
+                svm_n_test[kk].index = kk+1;
             }
+            svm_n_test[ num_attributes ].index = -1;
 
-            double bla = svm_predict_probability(svm_mod_, svm_n_test, prob_estimates);
-            (void) bla;
-
-            std::vector<double> probs ( svm_mod_->nr_class );
-            for(int label_id=0; label_id<svm_mod_->nr_class; label_id++)
-                probs[label_id] = prob_estimates[label_id];
-
-            std::vector<size_t> indices = sort_indexes(probs);  //NOTE sorted in ascending order. We want highest values!
+            if(param_.svm_.probability)
+            {
+                probs.resize( svm_mod_->nr_class );
+                double bla = svm_predict_probability(svm_mod_, &svm_n_test[0], &probs[0]);
+                (void) bla;
 
-            for(int k=0; k<param_.knn_; k++)
-                predicted_label(i, k) = indices[ indices.size() - 1 - k ];
+                std::vector<size_t> indices = sort_indexes(probs);  //NOTE sorted in ascending order. We want highest values!
 
-            delete [] prob_estimates;
-        }
-        else
-        {
-            predicted_label(i, 0) = (int)::svm_predict(svm_mod_, svm_n_test);
+                for(int k=0; k<param_.knn_; k++)
+                    predicted_label(i, k) = indices[ indices.size() - 1 - k ];
+            }
+            else
+            {
+                predicted_label(i, 0) = (int)::svm_predict(svm_mod_, &svm_n_test[0]);
+            }
         }
-
-        delete [] svm_n_test;
     }
 }
 
+void svmClassifier::predict(const Eigen::MatrixXf &query_data, Eigen::MatrixXi &predicted_label) const
+{
+    ClassificationResult result;
+    predict(query_data, result);
+    predicted_label = result.predicted_label_;
+}
+
 void svmClassifier::train(const Eigen::MatrixXf &training_data, const Eigen::VectorXi & training_label)
 {
     CHECK(training_data.rows() == training_label.rows() );
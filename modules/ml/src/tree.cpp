@@ -27,6 +27,7 @@
 
 
 #include <v4r/ml/tree.h>
+#include <algorithm>
 
 using namespace v4r::RandomForest;
 
@@ -50,11 +51,22 @@ void Tree::Train(ClassificationData& data, std::vector< unsigned int >& indices,
   trainRecursively(data, indices, maxDepth, testedSplittingFunctions, minInformationGain, minPointsForSplit, allNodesStoreLabelDistribution, 0);
 }
 
+// histogram based training: features are quantized once, every sampled feature is evaluated with all its
+// bin thresholds in a single scan and indices are partitioned in place (the order of indices changes).
+// Nodes and features are evaluated in parallel (OpenMP tasks)
 void Tree::TrainParallel(ClassificationData& data, std::vector< unsigned int >& indices, int maxDepth, int testedSplittingFunctions, float minInformationGain, int minPointsForSplit, bool allNodesStoreLabelDistribution, int verbosityLevel)
 {   
   this->verbosityLevel = verbosityLevel;
+
+  BinnedData binned;
+  binned.nPoints = data.Quantize(HISTOGRAM_SPLIT_BINS, binned.bins, binned.thresholds);
+
   // start recursion with depth 0
-  trainRecursivelyParallel(data, indices, maxDepth, testedSplittingFunctions, minInformationGain, minPointsForSplit, allNodesStoreLabelDistribution, 0);
+  #pragma omp parallel
+  {
+    #pragma omp single
+    trainHistogram(data, binned, indices.begin(), indices.end(), maxDepth, testedSplittingFunctions, minInformationGain, minPointsForSplit, allNodesStoreLabelDistribution, 0);
+  }
 }
 
 void Tree::EraseSplitNodeLabelDistributions()
@@ -65,7 +77,7 @@ void Tree::EraseSplitNodeLabelDistributions()
     }
 }
 
-std::vector< float >& Tree::Classify(std::vector< float >& point)
+std::vector< float >& Tree::Classify(const std::vector< float >& point)
 {
   // get root node and traverse through tree until leaf node is reached
   Node* curNode = GetRootNode();
@@ -77,7 +89,7 @@ std::vector< float >& Tree::Classify(std::vector< float >& point)
 }
 
 // to classify only down to a certain depth level (for evaluation)
-std::vector< float >& Tree::Classify(std::vector< float >& point, int depth)
+std::vector< float >& Tree::Classify(const std::vector< float >& point, int depth)
 {
   // get root node and traverse through tree until leaf node is reached
   Node* curNode = GetRootNode();
@@ -88,7 +100,7 @@ std::vector< float >& Tree::Classify(std::vector< float >& point, int depth)
   return curNode->GetLabelDistribution();
 }
 
-int Tree::GetResultingLeafNode(std::vector< float > point)
+int Tree::GetResultingLeafNode(const std::vector< float >& point)
 {
   // get root node and traverse through tree until leaf node is reached
   Node* curNode = GetRootNode();
@@ -105,6 +117,57 @@ int Tree::GetResultingLeafNode(std::vector< float > point)
   return idx;
 }
 
+// appends the tree in breadth-first order to the packed node array of a forest, returns index of the root node.
+// Label distribution rows are appended to the table, nodes without distribution point to row 0 (has to be all zeros)
+int Tree::Flatten(std::vector< FlatNode >& flatNodes, std::vector< float >& labelDistributions, int nLabels) const
+{
+  const int rootIdx = flatNodes.size();
+
+  if(nodes.empty())
+  {
+    FlatNode leaf = { -1, 0.0f, -1, 0 };
+    flatNodes.push_back(leaf);
+    return rootIdx;
+  }
+
+  // nodes are emitted in queue order, so both children of a split node get consecutive indices
+  std::vector<int> queue(1, rootNodeIdx);
+  for(size_t q=0; q < queue.size(); ++q)
+  {
+    const Node& node = nodes[queue[q]];
+    const std::vector<float>& dist = node.GetLabelDistribution();
+    FlatNode fn;
+
+    if(dist.empty())
+      fn.labelDistributionIdx = 0;
+    else
+    {
+      fn.labelDistributionIdx = labelDistributions.size() / nLabels;
+      labelDistributions.insert(labelDistributions.end(), dist.begin(), dist.begin() + std::min<size_t>(dist.size(), nLabels));
+      labelDistributions.resize((fn.labelDistributionIdx+1) * nLabels, 0.0f);
+    }
+
+    if(node.IsSplitNode())
+    {
+      fn.splitOnFeatureIdx = node.GetSplitFeatureIdx();
+      fn.threshold = node.GetThreshold();
+      fn.leftChildIdx = rootIdx + queue.size();
+      queue.push_back(node.GetLeftChildIdx());
+      queue.push_back(node.GetRightChildIdx());
+    }
+    else
+    {
+      fn.splitOnFeatureIdx = -1;
+      fn.threshold = 0.0f;
+      fn.leftChildIdx = -1;
+    }
+
+    flatNodes.push_back(fn);
+  }
+
+  return rootIdx;
+}
+
 void Tree::ClearLeafNodes()
 {
   // go through all leaf nodes and reset their label distributions
@@ -137,156 +200,6 @@ void Tree::UpdateLeafNodes(std::vector< int > labels, std::map< int, unsigned in
 }
 
 int Tree::trainRecursively(ClassificationData& data, std::vector<unsigned int > indices, int maxDepth, int testedSplittingFunctions, float minInformationGain, int minPointsForSplit, bool allNodesStoreLabelDistribution, int currentDepth)
-{
-  std::vector< unsigned int >::iterator startidx = indices.begin();
-  std::vector< unsigned int >::iterator stopidx = indices.end();
-
-  // abort conditions for recursion:
-  if(currentDepth == maxDepth){
-    // max depth reached, stop with leaf node
-
-    if(verbosityLevel > 2)
-    {
-      std::cout << "  - Create LEAF node at depth " << currentDepth << " (max depth reached)" << std::endl;
-    }
-
-    // create leaf node with current label distribution
-    nodes.push_back(Node(data.CalculateNormalizedHistogram(startidx, stopidx)));
-    return (int)nodes.size()-1;		// return index of new node
-  }
-  if(std::distance(startidx, stopidx) < minPointsForSplit){ //indices.size() < 5){
-    // too few data points, no point in splitting any more
-
-    if(verbosityLevel > 2)
-    {
-      std::cout << "  - Create LEAF node at depth " << currentDepth << " (too few points)" << std::endl;
-    }
-
-    // create leaf node with current label distribution
-    nodes.push_back(Node(data.CalculateNormalizedHistogram(startidx, stopidx)));
-    return (int)nodes.size()-1;		// return index of new node
-  }
-
-  // distributions for random generator
-  boost::uniform_real<float> realDist(0.0f, 1.0f);
-  boost::uniform_int<int> intDist(0, data.GetDimensions()-1);
-
-  // vectors to save different parameter sets
-  std::vector<float> gains(testedSplittingFunctions);
-  std::vector<int> features(testedSplittingFunctions);
-  std::vector<float> thresholds(testedSplittingFunctions);
-
-  for(int i=0; i < testedSplittingFunctions; i++)
-  {
-    // reinitialize iterators because every thread has its own copy of the indices array
-    std::vector< unsigned int >::iterator start  = indices.begin();
-    std::vector< unsigned int >::iterator stop = indices.end();
-
-    std::pair<float,float> minmax;
-    std::vector<unsigned int>::iterator divider;
-
-    // randomly choose one of the offered features
-    int curFeature = intDist(*randomGenerator);
-
-    // get range of data points for selected feature
-    minmax = data.GetMinMax(start, stop, curFeature);
-
-    if(minmax.first == minmax.second)
-    {
-      // all datapoints have same value, no split possible for this feature
-      gains[i] = -1;
-      continue;
-    }
-
-    // randomly choose a threshold in the range of the datapoints for selected feature
-    float threshold = realDist(*randomGenerator) * (minmax.second-minmax.first) + minmax.first;
-
-    if(threshold == minmax.first || threshold == minmax.second)
-    {
-      // don't split on max or min value of data points
-      gains[i] = -1;
-      continue;
-    }
-
-    // do left/right split with threshold
-    divider = data.Partition(start, stop, curFeature, threshold);
-
-    if(divider == start || divider == stop)
-    {
-      // prevent splits at first or last element
-      gains[i] = -1;
-      continue;
-    }
-
-    // evaluate split (calc information gain) and store corresponding feature index and threshold
-    gains[i] = data.GetInformationGain(start, stop, divider);
-    features[i] = curFeature;
-    thresholds[i] = threshold;
-  }
-
-  // find best split (max information gain)
-  std::vector<float>::iterator it = std::max_element(gains.begin(), gains.end());
-  float bestIGain = *it;
-  // get corresponding feature index and threshold
-  int idx = std::distance(gains.begin(), it);
-  int bestFeature = features[idx];
-  float bestThreshold = thresholds[idx];
-
-  // another abort condition for the recursion
-  if(bestIGain < minInformationGain)
-  {
-    // too little information gain at this point, no sense in splitting data any further
-
-    if(verbosityLevel > 2)
-    {
-      std::cout << "  - Create LEAF node at depth " << currentDepth << " (too little info gain: " << bestIGain << ")" << std::endl;
-    }
-
-    // create leaf node with current label distribution
-    nodes.push_back(Node(data.CalculateNormalizedHistogram(startidx, stopidx)));
-
-    if(currentDepth == 0)
-      rootNodeIdx = (int)nodes.size()-1;	// set root node of tree
-
-    return (int)nodes.size()-1;		// return index of current node
-  }
-
-  // perform split again with best parameters found
-  std::vector<unsigned int>::iterator divider = data.Partition(startidx, stopidx, bestFeature, bestThreshold);
-
-  if(verbosityLevel > 2)
-  {
-    std::cout << "  - Create SPLIT node at depth " << currentDepth << " on feature " << bestFeature << ". Threshold: " << bestThreshold << " GAIN: " << bestIGain << std::endl;
-    std::cout << "    - " << std::distance(startidx, divider) << " points left, " << std::distance(divider, stopidx) << " points right." << std::endl;
-  }
-
-  // repeat process for left and right child nodes
-  std::vector<unsigned int > left(startidx, divider);	// all indices of points going to left child node
-  std::vector<unsigned int > right(divider, stopidx);	// all indices of points going to right child node
-  int leftChildIdx = trainRecursivelyParallel(data,left, maxDepth, testedSplittingFunctions, minInformationGain, minPointsForSplit, allNodesStoreLabelDistribution, currentDepth+1);
-  int rightChildIdx = trainRecursivelyParallel(data,right, maxDepth, testedSplittingFunctions, minInformationGain, minPointsForSplit, allNodesStoreLabelDistribution, currentDepth+1);
-
-  // create and add split node with learned parameters
-  Node splitNode;
-
-  if(allNodesStoreLabelDistribution)
-  {
-    splitNode = Node(bestFeature,bestThreshold,leftChildIdx,rightChildIdx, data.CalculateNormalizedHistogram(startidx, stopidx));
-  }
-  else
-  {
-    splitNode = Node(bestFeature,bestThreshold,leftChildIdx,rightChildIdx);
-  }
-
-  nodes.push_back(splitNode);
-
-  if(currentDepth == 0)
-    rootNodeIdx = (int)nodes.size()-1;	// set root node of tree
-
-  return (int)nodes.size()-1;		// return index of current node
-}
-
-int Tree::trainRecursivelyParallel(ClassificationData& data, std::vector<unsigned int > indices, int maxDepth, int testedSplittingFunctions, float minInformationGain, int minPointsForSplit, bool allNodesStoreLabelDistribution, int currentDepth)
 {
   std::vector< unsigned int >::iterator startidx = indices.begin();
   std::vector< unsigned int >::iterator stopidx = indices.end();
@@ -433,8 +346,8 @@ int Tree::trainRecursivelyParallel(ClassificationData& data, std::vector<unsigne
   // repeat process for left and right child nodes 
   std::vector<unsigned int > left(startidx, divider);	// all indices of points going to left child node
   std::vector<unsigned int > right(divider, stopidx);	// all indices of points going to right child node
-  int leftChildIdx = trainRecursivelyParallel(data,left, maxDepth, testedSplittingFunctions, minInformationGain, minPointsForSplit, allNodesStoreLabelDistribution, currentDepth+1);
-  int rightChildIdx = trainRecursivelyParallel(data,right, maxDepth, testedSplittingFunctions, minInformationGain, minPointsForSplit, allNodesStoreLabelDistribution, currentDepth+1);
+  int leftChildIdx = trainRecursively(data,left, maxDepth, testedSplittingFunctions, minInformationGain, minPointsForSplit, allNodesStoreLabelDistribution, currentDepth+1);
+  int rightChildIdx = trainRecursively(data,right, maxDepth, testedSplittingFunctions, minInformationGain, minPointsForSplit, allNodesStoreLabelDistribution, currentDepth+1);
   
   // create and add split node with learned parameters
   Node splitNode;
@@ -456,6 +369,265 @@ int Tree::trainRecursivelyParallel(ClassificationData& data, std::vector<unsigne
   return (int)nodes.size()-1;		// return index of current node
 }
 	
+int Tree::addNode(const Node& node, int currentDepth)
+{
+  int idx;
+
+  #pragma omp critical(tree_add_node)
+  {
+    nodes.push_back(node);
+    idx = (int)nodes.size()-1;
+
+    if(currentDepth == 0)
+      rootNodeIdx = idx;	// set root node of tree
+  }
+
+  return idx;
+}
+
+// same measure as ClassificationData::GetInformationGain, computed from weighted label histograms
+static float informationGain(const std::vector<float>& total, const std::vector<float>& left, const std::vector<float>& right)
+{
+  float sum = 0.0f, sumleft = 0.0f, sumright = 0.0f;
+
+  for(size_t l=0; l < total.size(); l++)
+  {
+    sum += total[l];
+    sumleft += left[l];
+    sumright += right[l];
+  }
+
+  if(sum == 0 || sumleft == 0 || sumright == 0)
+    return -1;
+
+  float entropyBefore = 0.0f, entropyLeft = 0.0f, entropyRight = 0.0f;
+
+  for(size_t l=0; l < total.size(); l++)
+  {
+    float p = (total[l]+1) / (sum+1);
+    entropyBefore -= p * log2(p);
+    p = (left[l]+1) / (sumleft+1);
+    entropyLeft -= p * log2(p);
+    p = (right[l]+1) / (sumright+1);
+    entropyRight -= p * log2(p);
+  }
+
+  return entropyBefore - (entropyLeft*sumleft + entropyRight*sumright) / sum;
+}
+
+void Tree::findBestSplit(ClassificationData& data, const BinnedData& binned, std::vector< unsigned int >::const_iterator startidx, std::vector< unsigned int >::const_iterator stopidx, int feature, int minPointsForSplit, float& bestGain, float& bestThreshold) const
+{
+  bestGain = -1;
+  bestThreshold = 0.0f;
+
+  if(binned.thresholds[feature].empty())
+    return;   // all datapoints have same value, no split possible for this feature
+
+  const int nLabels = data.GetAvailableLabels().size();
+  const std::vector<int>& labels = data.GetTrainingLabels();
+  const std::vector<float>& weights = data.GetLabelWeights();
+  const unsigned int nPoints = std::distance(startidx, stopidx);
+
+  // weighted label histogram, point count and split threshold per bin. Points in bins <= k go left.
+  // Large nodes use the global quantization. If their points occupy only a few of the global bins
+  // (and for small nodes) the sorted feature values of the node points are used as bins instead
+  std::vector<float> hist;
+  std::vector<unsigned int> count;
+  std::vector<float> thresholds;
+  int nBins = 0;
+  bool exact = nPoints <= HISTOGRAM_EXACT_MAX_POINTS;
+
+  if(!exact)
+  {
+    thresholds = binned.thresholds[feature];
+    nBins = thresholds.size() + 1;
+    hist.assign(nBins * nLabels, 0.0f);
+    count.assign(nBins, 0);
+
+    const unsigned char* b = &binned.bins[(size_t)feature * binned.nPoints];
+
+    for(std::vector<unsigned int>::const_iterator i = startidx; i != stopidx; i++)
+    {
+      const int l = labels[*i];
+      hist[b[*i]*nLabels + l] += weights[l];
+      count[b[*i]]++;
+    }
+
+    int occupied = 0;
+    for(int k=0; k < nBins; k++)
+      occupied += count[k] > 0;
+
+    exact = occupied < HISTOGRAM_MIN_OCCUPIED_BINS && occupied < nBins;
+  }
+
+  if(exact)
+  {
+    std::vector< std::pair<float, int> > values;
+    values.reserve(nPoints);
+
+    for(std::vector<unsigned int>::const_iterator i = startidx; i != stopidx; i++)
+      values.push_back(std::pair<float, int>(data.GetFeature(*i, feature), labels[*i]));
+
+    std::sort(values.begin(), values.end());
+
+    // one bin per distinct value
+    hist.clear();
+    count.clear();
+    thresholds.clear();
+    nBins = 0;
+
+    for(unsigned int i=0; i < nPoints; i++)
+    {
+      if(i == 0 || values[i].first != values[i-1].first)
+      {
+        if(i > 0)
+          thresholds.push_back(values[i-1].first);
+
+        nBins++;
+        hist.resize(nBins * nLabels, 0.0f);
+        count.push_back(0);
+      }
+
+      hist[(nBins-1)*nLabels + values[i].second] += weights[values[i].second];
+      count[nBins-1]++;
+    }
+  }
+
+  std::vector<float> total(nLabels, 0.0f), left(nLabels, 0.0f), right(nLabels);
+
+  for(int k=0; k < nBins; k++)
+    for(int l=0; l < nLabels; l++)
+      total[l] += hist[k*nLabels + l];
+
+  // scan all thresholds
+  unsigned int nLeft = 0;
+
+  for(int k=0; k < nBins-1; k++)
+  {
+    for(int l=0; l < nLabels; l++)
+      left[l] += hist[k*nLabels + l];
+
+    nLeft += count[k];
+
+    // empty bins give the same split as the previous threshold
+    if(count[k] == 0)
+      continue;
+
+    // prevent splits causing too few points on one side
+    if(nLeft < (unsigned int)minPointsForSplit || nPoints - nLeft < (unsigned int)minPointsForSplit)
+      continue;
+
+    for(int l=0; l < nLabels; l++)
+      right[l] = std::max(0.0f, total[l] - left[l]);
+
+    float gain = informationGain(total, left, right);
+
+    if(gain > bestGain)
+    {
+      bestGain = gain;
+      bestThreshold = thresholds[k];
+    }
+  }
+}
+
+int Tree::trainHistogram(ClassificationData& data, const BinnedData& binned, std::vector< unsigned int >::iterator startidx, std::vector< unsigned int >::iterator stopidx, int maxDepth, int testedSplittingFunctions, float minInformationGain, int minPointsForSplit, bool allNodesStoreLabelDistribution, int currentDepth)
+{
+  const int nPoints = std::distance(startidx, stopidx);
+
+  // abort conditions for recursion:
+  if(currentDepth == maxDepth || nPoints < minPointsForSplit)
+  {
+    if(verbosityLevel > 2)
+    {
+      std::cout << "  - Create LEAF node at depth " << currentDepth << (currentDepth == maxDepth ? " (max depth reached)" : " (too few points)") << std::endl;
+    }
+
+    // create leaf node with current label distribution
+    return addNode(Node(data.CalculateNormalizedHistogram(startidx, stopidx)), currentDepth);
+  }
+
+  // randomly sample the features to test, each of them is evaluated with all its thresholds at once
+  std::vector<int> features(testedSplittingFunctions);
+
+  #pragma omp critical(tree_random_generator)
+  {
+    boost::uniform_int<int> intDist(0, data.GetDimensions()-1);
+
+    for(int i=0; i < testedSplittingFunctions; i++)
+      features[i] = intDist(*randomGenerator);
+  }
+
+  std::sort(features.begin(), features.end());
+  features.erase(std::unique(features.begin(), features.end()), features.end());
+
+  std::vector<float> gains(features.size(), -1);
+  std::vector<float> thresholds(features.size(), 0.0f);
+  const bool parallel = nPoints >= HISTOGRAM_PARALLEL_MIN_POINTS;
+
+  for(size_t i=0; i < features.size(); i++)
+  {
+    #pragma omp task default(shared) firstprivate(i) if(parallel)
+    findBestSplit(data, binned, startidx, stopidx, features[i], minPointsForSplit, gains[i], thresholds[i]);
+  }
+  #pragma omp taskwait
+
+  // find best split (max information gain)
+  std::vector<float>::iterator it = std::max_element(gains.begin(), gains.end());
+  float bestIGain = it == gains.end() ? -1 : *it;
+
+  // another abort condition for the recursion
+  if(bestIGain < minInformationGain)
+  {
+    // too little information gain at this point, no sense in splitting data any further
+
+    if(verbosityLevel > 2)
+    {
+      std::cout << "  - Create LEAF node at depth " << currentDepth << " (too little info gain: " << bestIGain << ")" << std::endl;
+    }
+
+    // create leaf node with current label distribution
+    return addNode(Node(data.CalculateNormalizedHistogram(startidx, stopidx)), currentDepth);
+  }
+
+  // get corresponding feature index and threshold
+  int idx = std::distance(gains.begin(), it);
+  int bestFeature = features[idx];
+  float bestThreshold = thresholds[idx];
+
+  // split indices in place, points with values <= threshold go left (see Node::EvaluateNode)
+  std::vector<unsigned int>::iterator divider = std::partition(startidx, stopidx, [&data, bestFeature, bestThreshold](unsigned int i) { return data.GetFeature(i, bestFeature) <= bestThreshold; });
+
+  if(verbosityLevel > 2)
+  {
+    std::cout << "  - Create SPLIT node at depth " << currentDepth << " on feature " << bestFeature << ". Threshold: " << bestThreshold << " GAIN: " << bestIGain << std::endl;
+    std::cout << "    - " << std::distance(startidx, divider) << " points left, " << std::distance(divider, stopidx) << " points right." << std::endl;
+  }
+
+  // repeat process for left and right child nodes
+  int leftChildIdx, rightChildIdx;
+
+  #pragma omp task default(shared) if(parallel)
+  leftChildIdx = trainHistogram(data, binned, startidx, divider, maxDepth, testedSplittingFunctions, minInformationGain, minPointsForSplit, allNodesStoreLabelDistribution, currentDepth+1);
+
+  rightChildIdx = trainHistogram(data, binned, divider, stopidx, maxDepth, testedSplittingFunctions, minInformationGain, minPointsForSplit, allNodesStoreLabelDistribution, currentDepth+1);
+
+  #pragma omp taskwait
+
+  // create and add split node with learned parameters
+  Node splitNode;
+
+  if(allNodesStoreLabelDistribution)
+  {
+    splitNode = Node(bestFeature,bestThreshold,leftChildIdx,rightChildIdx, data.CalculateNormalizedHistogram(startidx, stopidx));
+  }
+  else
+  {
+    splitNode = Node(bestFeature,bestThreshold,leftChildIdx,rightChildIdx);
+  }
+
+  return addNode(splitNode, currentDepth);
+}
+
 void Tree::CreateVisualization(std::string filename)
 {
   std::ofstream os(filename.c_str());
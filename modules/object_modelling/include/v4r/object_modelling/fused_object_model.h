@@ -0,0 +1,134 @@
+/******************************************************************************
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ ******************************************************************************/
+
+
+#ifndef V4R_OBJECT_MODELLING_FUSED_OBJECT_MODEL_H__
+#define V4R_OBJECT_MODELLING_FUSED_OBJECT_MODEL_H__
+
+#include <stdint.h>
+#include <unordered_map>
+#include <vector>
+
+#include <boost/shared_ptr.hpp>
+#include <pcl/common/common.h>
+#include <v4r/core/macros.h>
+#include <v4r/registration/noise_model_based_cloud_integration.h>
+
+namespace v4r
+{
+    namespace object_modelling
+    {
+        /**
+        * @brief Persistent object model fused from a sequence of registered views. The model is a sparse voxel grid
+        * (voxel size NMBasedCloudIntegrationParameter::octree_resolution_) of surfels in the global frame. Each view is
+        * merged once with the same noise-model based weighting NMBasedCloudIntegration uses, i.e. each voxel either keeps
+        * its best observed point (lowest determinant of the noise covariance) or the average of all its observations.
+        * Adding a view and exporting the model therefore cost time proportional to the view and the model size, not to
+        * the number of views integrated so far.
+        * Note: the voxel grid is anchored at the origin of the global frame, whereas NMBasedCloudIntegration anchors its
+        * octree at the bounding box of the input data. Voxel boundaries therefore differ and the exported model can differ
+        * slightly from the one NMBasedCloudIntegration computes for the same views.
+        * */
+        class V4R_EXPORTS FusedObjectModel
+        {
+        public:
+            typedef pcl::PointXYZRGB PointT;
+            typedef boost::shared_ptr<FusedObjectModel> Ptr;
+            typedef boost::shared_ptr<FusedObjectModel const> ConstPtr;
+
+        private:
+            typedef uint64_t Key;
+
+            NMBasedCloudIntegrationParameter param_;
+
+            std::unordered_map<Key, size_t> voxel_idx_;     ///< voxel -> surfel index
+            pcl::PointCloud<PointT> points_;                ///< surfel positions and colors (global frame)
+            pcl::PointCloud<pcl::Normal> normals_;          ///< surfel normals (global frame)
+            std::vector<float> weights_;                    ///< noise weight of each surfel (lower is better)
+            std::vector<size_t> num_pts_;                   ///< number of observations merged into each surfel
+            std::vector<int> origin_;                       ///< view the (best) observation of each surfel comes from
+
+            Key getKey(const Eigen::Vector3f &p) const;
+
+        public:
+            FusedObjectModel(const NMBasedCloudIntegrationParameter &p = NMBasedCloudIntegrationParameter()) :
+                param_(p)
+            { }
+
+            /**
+             * @brief merges the object points of one view into the model
+             * @param[in] cloud organized point cloud of the view (camera frame)
+             * @param[in] normals normals of the view (camera frame)
+             * @param[in] pt_properties noise model properties for each pixel (lateral and axial noise, distance to depth discontinuity)
+             * @param[in] indices object points of the view
+             * @param[in] camera_pose transform aligning the view to the global frame
+             * @param[in] view_id identifier of the view stored as origin of the surfels it contributes
+             */
+            void integrate(const pcl::PointCloud<PointT> &cloud,
+                           const pcl::PointCloud<pcl::Normal> &normals,
+                           const std::vector<std::vector<float> > &pt_properties,
+                           const std::vector<size_t> &indices,
+                           const Eigen::Matrix4f &camera_pose,
+                           int view_id = -1);
+
+            /**
+             * @brief returns all surfels which are supported by at least min_points_per_voxel_ observations
+             * @param[out] cloud surfel positions and colors
+             * @param[out] normals surfel normals
+             */
+            void getModel(pcl::PointCloud<PointT> &cloud, pcl::PointCloud<pcl::Normal> &normals) const;
+
+            /**
+             * @brief returns all surfels regardless of their support (e.g. for transferring the object into a new view)
+             */
+            const pcl::PointCloud<PointT> &getSurfels() const
+            {
+                return points_;
+            }
+
+            /**
+             * @brief view each surfel has been (best) observed from
+             */
+            const std::vector<int> &getOrigins() const
+            {
+                return origin_;
+            }
+
+            size_t size() const
+            {
+                return points_.points.size();
+            }
+
+            void clear()
+            {
+                voxel_idx_.clear();
+                points_.points.clear();
+                normals_.points.clear();
+                weights_.clear();
+                num_pts_.clear();
+                origin_.clear();
+            }
+        };
+    }
+}
+
+
+#endif //V4R_OBJECT_MODELLING_FUSED_OBJECT_MODEL_H__
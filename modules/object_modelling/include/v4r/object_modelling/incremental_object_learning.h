@@ -35,6 +35,7 @@
 #include <v4r/keypoints/ClusterNormalsToPlanes.h>
 #include <v4r/common/PointTypes.h>
 #include <v4r/registration/noise_model_based_cloud_integration.h>
+#include <v4r/object_modelling/fused_object_model.h>
 #include <v4r/object_modelling/model_view.h>
 
 #include <boost/graph/adjacency_list.hpp>
@@ -66,8 +67,9 @@ struct CamConnect
  * the user by means of an initial object mask (indices of the point cloud belonging to the object).
  * The method projects the incrementally learnt object cloud to each view by a transformation given
  * from the camera pose and looks for nearest neighbors. After some filtering, these points are then
- * used for growing the object over the points in the current view. The final model is obtained
- * by a noise-model based cloud integration of all the points labelled as objects.
+ * used for growing the object over the points in the current view. The points labelled as object
+ * are merged into a persistent noise-model based fused model once per view, which is also the
+ * object that gets transferred into the next view.
  *
  * @author Thomas Faeulhammer
  * @date July 2015
@@ -163,6 +165,9 @@ protected:
     std::vector<int> vis_viewpoint_;
 
     std::vector<modelView> grph_;
+    FusedObjectModel::Ptr fused_model_; ///< object model all views are merged into (global frame)
+    std::vector<size_t> labelled_view_ids_; ///< views with a user provided object mask (used for occlusion reasoning)
+    std::vector<modelView::SuperPlane> filtered_planes_; ///< planes filtered in any of the views so far
     pcl::octree::OctreePointCloudSearch<PointT> octree_;
 
     void computeAbsolutePoses(const Graph & grph,
@@ -358,6 +363,12 @@ public:
         big_cloud_segmented_->points.clear();
         big_cloud_segmented_refined_->points.clear();
         grph_.clear();
+        fused_model_.reset();
+        labelled_view_ids_.clear();
+        filtered_planes_.clear();
+        keyframes_used_.clear();
+        cameras_used_.clear();
+        object_indices_clouds_used_.clear();
         gs_.clearing_graph();
         gs_.clear();
         vis_viewpoint_.clear();
@@ -0,0 +1,152 @@
+/******************************************************************************
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ ******************************************************************************/
+
+
+#include <v4r/object_modelling/fused_object_model.h>
+
+#include <cmath>
+#include <limits>
+
+namespace v4r
+{
+namespace object_modelling
+{
+
+FusedObjectModel::Key
+FusedObjectModel::getKey(const Eigen::Vector3f &p) const
+{
+    // 21 bit per axis
+    static const int offset = 1 << 20;
+    static const Key mask = (1 << 21) - 1;
+    const Key x = static_cast<Key>( static_cast<int>( std::floor( p(0) / param_.octree_resolution_ ) ) + offset ) & mask;
+    const Key y = static_cast<Key>( static_cast<int>( std::floor( p(1) / param_.octree_resolution_ ) ) + offset ) & mask;
+    const Key z = static_cast<Key>( static_cast<int>( std::floor( p(2) / param_.octree_resolution_ ) ) + offset ) & mask;
+    return x | (y << 21) | (z << 42);
+}
+
+void
+FusedObjectModel::integrate(const pcl::PointCloud<PointT> &cloud,
+                            const pcl::PointCloud<pcl::Normal> &normals,
+                            const std::vector<std::vector<float> > &pt_properties,
+                            const std::vector<size_t> &indices,
+                            const Eigen::Matrix4f &camera_pose,
+                            int view_id)
+{
+    const Eigen::Matrix3f rotation = camera_pose.block<3,3>(0,0);
+    const Eigen::Vector3f translation = camera_pose.block<3,1>(0,3);
+
+    for(size_t idx : indices)
+    {
+        const PointT &pt = cloud.points[idx];
+        const pcl::Normal &n = normals.points[idx];
+
+        if ( !pcl::isFinite(pt) || !pcl::isFinite(n) )
+            continue;
+
+        const std::vector<float> &props = pt_properties[idx];
+        if ( props[2] <= param_.min_px_distance_to_depth_discontinuity_ )
+            continue;
+
+        // determinant of the noise covariance (invariant to the rotation into the global frame)
+        const double det = static_cast<double>(props[0]) * props[0] * props[1];
+        const float weight = ( std::isfinite(det) && det > 0 ) ? static_cast<float>(det) : std::numeric_limits<float>::max();
+
+        PointT pt_aligned = pt;
+        pt_aligned.getVector3fMap() = rotation * pt.getVector3fMap() + translation;
+        pcl::Normal n_aligned = n;
+        n_aligned.getNormalVector3fMap() = rotation * n.getNormalVector3fMap();
+
+        std::pair<std::unordered_map<Key, size_t>::iterator, bool> voxel =
+                voxel_idx_.insert( std::make_pair( getKey( pt_aligned.getVector3fMap() ), points_.points.size() ) );
+
+        if ( voxel.second )  // new surfel
+        {
+            points_.points.push_back( pt_aligned );
+            normals_.points.push_back( n_aligned );
+            weights_.push_back( weight );
+            num_pts_.push_back( 1 );
+            origin_.push_back( view_id );
+            continue;
+        }
+
+        const size_t s = voxel.first->second;
+        num_pts_[s]++;
+
+        if ( param_.average_ )
+        {
+            const float w_new = 1.f / num_pts_[s];
+            const float w_old = 1.f - w_new;
+
+            PointT &p = points_.points[s];
+            p.getVector3fMap() = w_old * p.getVector3fMap() + w_new * pt_aligned.getVector3fMap();
+            p.r = static_cast<uint8_t>( w_old * p.r + w_new * pt_aligned.r + 0.5f );
+            p.g = static_cast<uint8_t>( w_old * p.g + w_new * pt_aligned.g + 0.5f );
+            p.b = static_cast<uint8_t>( w_old * p.b + w_new * pt_aligned.b + 0.5f );
+
+            pcl::Normal &normal = normals_.points[s];
+            normal.getNormalVector3fMap() = w_old * normal.getNormalVector3fMap() + w_new * n_aligned.getNormalVector3fMap().normalized();
+            normal.curvature = w_old * normal.curvature + w_new * n_aligned.curvature;
+
+            if ( weight < weights_[s] )
+            {
+                weights_[s] = weight;
+                origin_[s] = view_id;
+            }
+        }
+        else if ( weight < weights_[s] )    // keep only the point with the lowest noise
+        {
+            points_.points[s] = pt_aligned;
+            normals_.points[s] = n_aligned;
+            weights_[s] = weight;
+            origin_[s] = view_id;
+        }
+    }
+
+    points_.width = normals_.width = points_.points.size();
+    points_.height = normals_.height = 1;
+}
+
+void
+FusedObjectModel::getModel(pcl::PointCloud<PointT> &cloud, pcl::PointCloud<pcl::Normal> &normals) const
+{
+    cloud.points.resize( points_.points.size() );
+    normals.points.resize( points_.points.size() );
+
+    size_t kept = 0;
+    for(size_t s=0; s < points_.points.size(); s++)
+    {
+        if ( num_pts_[s] < param_.min_points_per_voxel_ )
+            continue;
+
+        cloud.points[kept] = points_.points[s];
+        normals.points[kept] = normals_.points[s];
+        kept++;
+    }
+
+    cloud.points.resize(kept);
+    normals.points.resize(kept);
+    cloud.width = normals.width = kept;
+    cloud.height = normals.height = 1;
+    cloud.is_dense = normals.is_dense = true;
+}
+
+}
+}
@@ -308,58 +308,14 @@ IOL::write_model_to_disk (const std::string &models_dir, const std::string &mode
 bool
 IOL::save_model (const std::string &models_dir, const std::string &model_name, bool save_individual_views)
 {
-    size_t num_frames = grph_.size();
+    const size_t num_frames = grph_.size();
+    const size_t kept_keyframes = keyframes_used_.size();
 
-    std::vector< pcl::PointCloud<pcl::Normal>::ConstPtr > normals_used (num_frames);
-    keyframes_used_.resize(num_frames);
-    cameras_used_.resize(num_frames);
-    object_indices_clouds_used_.resize(num_frames);
-
-    // only used keyframes with have object points in them
-    size_t kept_keyframes=0;
-    for (size_t view_id = 0; view_id < grph_.size(); view_id++)
-    {
-        if ( createIndicesFromMask<size_t>(grph_[view_id].obj_mask_step_.back()).size() )
-        {
-            keyframes_used_[ kept_keyframes ] = grph_[view_id].cloud_;
-            normals_used [ kept_keyframes ] = grph_[view_id].normal_;
-            cameras_used_ [ kept_keyframes ] = grph_[view_id].camera_pose_;
-            object_indices_clouds_used_[ kept_keyframes ] = createIndicesFromMask<size_t>( grph_[view_id].obj_mask_step_.back() );
-            kept_keyframes++;
-        }
-    }
-
-    keyframes_used_.resize(kept_keyframes);
-    normals_used.resize(kept_keyframes);
-    cameras_used_.resize(kept_keyframes);
-    object_indices_clouds_used_.resize(kept_keyframes);
-    std::vector<std::vector<std::vector<float> > > pt_properties (kept_keyframes);
-
-    if ( kept_keyframes > 0)
+    if ( kept_keyframes > 0 && fused_model_ )
     {
-        //compute noise weights
-        for(size_t i=0; i < kept_keyframes; i++)
-        {
-            NguyenNoiseModelParameter nm_param;
-            nm_param.use_depth_edges_ = true;
-            NguyenNoiseModel<PointT> nm (nm_param);
-            nm.setInputCloud(keyframes_used_[i]);
-            nm.setInputNormals(normals_used[i]);
-            nm.compute();
-            pt_properties[i] = nm.getPointProperties();
-        }
-
         pcl::PointCloud<PointT>::Ptr octree_cloud(new pcl::PointCloud<PointT>);
-        NMBasedCloudIntegration<PointT> nmIntegration (nm_int_param_);
-        nmIntegration.setInputClouds(keyframes_used_);
-        nmIntegration.setTransformations(cameras_used_);
-        nmIntegration.setInputNormals(normals_used);
-        nmIntegration.setIndices( object_indices_clouds_used_ );
-        nmIntegration.setPointProperties( pt_properties );
-        nmIntegration.compute(octree_cloud);
-
-        pcl::PointCloud<pcl::Normal>::Ptr octree_normals;
-        nmIntegration.getOutputNormals(octree_normals);
+        pcl::PointCloud<pcl::Normal>::Ptr octree_normals (new pcl::PointCloud<pcl::Normal>);
+        fused_model_->getModel(*octree_cloud, *octree_normals);
 
         pcl::PointCloud<pcl::PointXYZRGBNormal>::Ptr filtered_with_normals_oriented (new pcl::PointCloud<pcl::PointXYZRGBNormal>());
         pcl::concatenateFields(*octree_normals, *octree_cloud, *filtered_with_normals_oriented);
@@ -504,6 +460,7 @@ IOL::learn_object (const pcl::PointCloud<PointT> &cloud, const Eigen::Matrix4f &
         remove_nan_points(*view.cloud_, initial_mask);
         view.obj_mask_step_.push_back( initial_mask );
         view.is_pre_labelled_ = true;
+        labelled_view_ids_.push_back( view.id_ );
 
         // remove nan values and points further away than chop_z_ parameter
         std::vector<size_t> initial_indices_wo_nan (initial_indices.size());
@@ -548,44 +505,41 @@ IOL::learn_object (const pcl::PointCloud<PointT> &cloud, const Eigen::Matrix4f &
     }
     else
     {
+        // transfer the fused object model (instead of each previous view separately) into the current view
+        if ( fused_model_ && fused_model_->size() )
+        {
+            pcl::PointCloud<PointT>::Ptr model_aligned (new pcl::PointCloud<PointT>());
+            pcl::transformPointCloud(fused_model_->getSurfels(), *model_aligned, view.camera_pose_.inverse());
+
+            pcl::IterativeClosestPoint<PointT, PointT> icp;
+            icp.setInputSource(model_aligned);
+            icp.setInputTarget(view.cloud_);
+            icp.setMaxCorrespondenceDistance (0.02f);
+            pcl::PointCloud<PointT>::Ptr icp_aligned_cloud (new pcl::PointCloud<PointT>());
+            icp.align(*icp_aligned_cloud, Eigen::Matrix4f::Identity());
+            *view.transferred_cluster_ += *icp_aligned_cloud;
+        }
+
         boost::dynamic_bitset<> is_occluded;
-        for (size_t view_id = 0; view_id < grph_.size(); view_id++)
+        for (size_t labelled_id : labelled_view_ids_)
         {
-            if( view.id_ != grph_[view_id].id_)
-            {
-                pcl::PointCloud<PointT>::Ptr new_search_pts, new_search_pts_aligned;
-                new_search_pts.reset(new pcl::PointCloud<PointT>());
-                new_search_pts_aligned.reset(new pcl::PointCloud<PointT>());
-                pcl::copyPointCloud(*grph_[view_id].cloud_, grph_[view_id].obj_mask_step_.back(), *new_search_pts);
-                const Eigen::Matrix4f tf = view.camera_pose_.inverse() * grph_[view_id].camera_pose_;
-                pcl::transformPointCloud(*new_search_pts, *new_search_pts_aligned, tf);
-
-                pcl::IterativeClosestPoint<PointT, PointT> icp;
-                icp.setInputSource(new_search_pts_aligned);
-                icp.setInputTarget(view.cloud_);
-                icp.setMaxCorrespondenceDistance (0.02f);
-                pcl::PointCloud<PointT>::Ptr icp_aligned_cloud (new pcl::PointCloud<PointT>());
-                icp.align(*icp_aligned_cloud, Eigen::Matrix4f::Identity());
-                *view.transferred_cluster_ += *icp_aligned_cloud;
-
-                if (grph_[view_id].is_pre_labelled_)
-                {
-                    typename pcl::PointCloud<PointT>::Ptr view_trans (new pcl::PointCloud<PointT>);
-                    Eigen::Matrix4f tf_inv = tf.inverse();
-                    pcl::transformPointCloud(*view.cloud_, *view_trans, tf_inv);
-                    OcclusionReasoner<PointT, PointT> occ_reasoner;
-                    occ_reasoner.setCamera(cam_);
-                    occ_reasoner.setInputCloud( view_trans );
-                    occ_reasoner.setOcclusionCloud( grph_[view_id].cloud_ );
-                    occ_reasoner.setOcclusionThreshold( 0.01f );
-                    boost::dynamic_bitset<> is_occluded_tmp = occ_reasoner.computeVisiblePoints();
-
-                    if( is_occluded.size() == is_occluded_tmp.size())
-                        is_occluded &= is_occluded_tmp; // is this correct?
-                    else
-                        is_occluded = is_occluded_tmp;
-                }
-            }
+            const modelView &labelled_view = grph_[labelled_id];
+            const Eigen::Matrix4f tf = view.camera_pose_.inverse() * labelled_view.camera_pose_;
+
+            typename pcl::PointCloud<PointT>::Ptr view_trans (new pcl::PointCloud<PointT>);
+            Eigen::Matrix4f tf_inv = tf.inverse();
+            pcl::transformPointCloud(*view.cloud_, *view_trans, tf_inv);
+            OcclusionReasoner<PointT, PointT> occ_reasoner;
+            occ_reasoner.setCamera(cam_);
+            occ_reasoner.setInputCloud( view_trans );
+            occ_reasoner.setOcclusionCloud( labelled_view.cloud_ );
+            occ_reasoner.setOcclusionThreshold( 0.01f );
+            boost::dynamic_bitset<> is_occluded_tmp = occ_reasoner.computeVisiblePoints();
+
+            if( is_occluded.size() == is_occluded_tmp.size())
+                is_occluded &= is_occluded_tmp; // is this correct?
+            else
+                is_occluded = is_occluded_tmp;
         }
 
         boost::dynamic_bitset<> obj_mask_nn_search (view.cloud_->points.size(), 0);
@@ -601,21 +555,11 @@ IOL::learn_object (const pcl::PointCloud<PointT> &cloud, const Eigen::Matrix4f &
     boost::dynamic_bitset<> pixel_is_neglected (view.cloud_->points.size(), 0);
     for (size_t p_id=0; p_id<view.planes_.size(); p_id++)
     {
-        for (size_t view_id = 0; view_id < grph_.size(); view_id++)
+        for (const modelView::SuperPlane &filtered_plane : filtered_planes_)
         {
-            if( view.id_ != grph_[view_id].id_)
-            {
-                for (size_t p2_id=0; p2_id<grph_[view_id].planes_.size(); p2_id++)
-                {
-//                    std::cout << "Checking cluster new " << p_id << " and cluster old " <<
-//                                 p2_id << " from view " << view_id << std::endl;
-//                    std::cout << merging_planes_reasonable(view.planes_[p_id], grph_[view_id].planes_[p2_id]) << std::endl;
-
-                    // if the planes can be merged (based on normals and distance), then filter new plane if old one has been filtered
-                    if (grph_[view_id].planes_[p2_id].is_filtered && merging_planes_reasonable(view.planes_[p_id], grph_[view_id].planes_[p2_id]) && !plane_has_object(view.planes_[p_id]))
-                        view.planes_[p_id].is_filtered = true;
-                }
-            }
+            // if the planes can be merged (based on normals and distance), then filter new plane if old one has been filtered
+            if (merging_planes_reasonable(view.planes_[p_id], filtered_plane) && !plane_has_object(view.planes_[p_id]))
+                view.planes_[p_id].is_filtered = true;
         }
         if ( plane_is_filtered( view.planes_[p_id] ) )
             view.planes_[p_id].is_filtered = true;
@@ -626,6 +570,12 @@ IOL::learn_object (const pcl::PointCloud<PointT> &cloud, const Eigen::Matrix4f &
                 pixel_is_neglected [ view.planes_[p_id].indices[ c_pt_id ] ] = true;
         }
     }
+    for (const modelView::SuperPlane &plane : view.planes_)
+    {
+        if ( plane.is_filtered )
+            filtered_planes_.push_back( plane );
+    }
+
     for(size_t pt=0; pt<view.cloud_->points.size(); pt++)
     {
         if (view.cloud_->points[pt].z > param_.chop_z_)
@@ -665,6 +615,26 @@ IOL::learn_object (const pcl::PointCloud<PointT> &cloud, const Eigen::Matrix4f &
         view.obj_mask_step_.back() = view.obj_mask_step_[0];
         std::cout << "After postprocessing the initial frame not enough points are left. Therefore taking the original provided indices." << std::endl;
     }
+
+    // merge the object points of this view into the model once (only keyframes which have object points in them are used)
+    const std::vector<size_t> object_indices = createIndicesFromMask<size_t>( view.obj_mask_step_.back() );
+    if ( !object_indices.empty() )
+    {
+        NguyenNoiseModelParameter nm_param;
+        nm_param.use_depth_edges_ = true;
+        NguyenNoiseModel<PointT> nm (nm_param);
+        nm.setInputCloud(view.cloud_);
+        nm.setInputNormals(view.normal_);
+        nm.compute();
+
+        if ( !fused_model_ )
+            fused_model_.reset( new FusedObjectModel(nm_int_param_) );
+        fused_model_->integrate(*view.cloud_, *view.normal_, nm.getPointProperties(), object_indices, view.camera_pose_, view.id_);
+
+        keyframes_used_.push_back( view.cloud_ );
+        cameras_used_.push_back( view.camera_pose_ );
+        object_indices_clouds_used_.push_back( object_indices );
+    }
 //    visualize();
     return true;
 }
@@ -22,14 +22,6 @@ namespace object_modelling
 void
 IOL::createBigCloud()
 {
-     size_t num_frames = grph_.size();
-     std::vector< pcl::PointCloud<PointT>::ConstPtr > keyframes_used (num_frames);
-     std::vector< pcl::PointCloud<pcl::Normal>::ConstPtr > normals_used (num_frames);
-     std::vector<Eigen::Matrix4f, Eigen::aligned_allocator<Eigen::Matrix4f> > cameras_used (num_frames);
-     std::vector<std::vector<size_t> > indices_used (num_frames);
-
-     // only used keyframes with have object points in them
-     size_t kept_keyframes=0;
      for (size_t view_id = 0; view_id < grph_.size(); view_id++)
      {
          // scene reconstruction without noise model
@@ -41,47 +33,14 @@ IOL::createBigCloud()
          pcl::PointCloud<PointT>::Ptr segmented_trans (new pcl::PointCloud<PointT>());
          pcl::copyPointCloud(*cloud_trans, grph_[view_id].obj_mask_step_.back(), *segmented_trans);
          *big_cloud_segmented_ += *segmented_trans;
-
-         //using noise model
-         if ( grph_[view_id].obj_mask_step_.back().size() )
-         {
-             keyframes_used[ kept_keyframes ] = grph_[view_id].cloud_;
-             normals_used  [ kept_keyframes ] = grph_[view_id].normal_;
-             cameras_used  [ kept_keyframes ] = grph_[view_id].camera_pose_;
-             indices_used  [ kept_keyframes ] = createIndicesFromMask<size_t>( grph_[view_id].obj_mask_step_.back() );
-             kept_keyframes++;
-         }
      }
-     indices_used.resize(kept_keyframes);
-     keyframes_used.resize(kept_keyframes);
-     normals_used.resize(kept_keyframes);
-     cameras_used.resize(kept_keyframes);
-     std::vector<std::vector<std::vector<float> > > pt_properties (kept_keyframes);
 
-     if ( kept_keyframes > 0)
+     //using noise model (already fused incrementally)
+     if ( fused_model_ && fused_model_->size() )
      {
-         //compute noise weights
-         for(size_t i=0; i < kept_keyframes; i++)
-         {
-             NguyenNoiseModelParameter nm_param;
-             nm_param.use_depth_edges_ = true;
-             NguyenNoiseModel<PointT> nm (nm_param);
-             nm.setInputCloud(keyframes_used[i]);
-             nm.setInputNormals(normals_used[i]);
-             nm.compute();
-             pt_properties[i] = nm.getPointProperties();
-         }
-
          pcl::PointCloud<PointT>::Ptr octree_cloud(new pcl::PointCloud<PointT>);
-         NMBasedCloudIntegration<PointT> nmIntegration (nm_int_param_);
-         nmIntegration.setInputClouds(keyframes_used);
-         nmIntegration.setTransformations(cameras_used);
-         nmIntegration.setInputNormals(normals_used);
-         nmIntegration.setIndices( indices_used );
-         nmIntegration.setPointProperties( pt_properties );
-         nmIntegration.compute(octree_cloud);
-         pcl::PointCloud<pcl::Normal>::Ptr octree_normals;
-         nmIntegration.getOutputNormals(octree_normals);
+         pcl::PointCloud<pcl::Normal>::Ptr octree_normals (new pcl::PointCloud<pcl::Normal>);
+         fused_model_->getModel(*octree_cloud, *octree_normals);
 
          pcl::PointCloud<pcl::PointXYZRGBNormal>::Ptr filtered_with_normals_oriented (new pcl::PointCloud<pcl::PointXYZRGBNormal>());
          pcl::concatenateFields(*octree_normals, *octree_cloud, *filtered_with_normals_oriented);
@@ -314,9 +314,31 @@ private:
     std::vector<std::string> categories_;   ///< classification results
     std::vector<float> confidences_;   ///< confidences associated to the classification results (normalized to 0...1)
     typename GlobalEstimator<PointT>::Ptr estimator_; ///< estimator used for describing the object
+    std::vector<typename GlobalEstimator<PointT>::Ptr> thread_estimators_; ///< copies of the estimator used for describing clusters concurrently (element 0 is estimator_)
     Classifier::Ptr classifier_; ///< classifier object
 
-    void featureEncodingAndMatching();
+    typedef std::vector<Eigen::Matrix4f, Eigen::aligned_allocator<Eigen::Matrix4f> > TransformVector;
+
+    /**
+     * @brief computeSignature describes a cluster of the input cloud
+     * @param estimator feature estimator (not shared between threads)
+     */
+    void
+    computeSignature(GlobalEstimator<PointT> &estimator, const Cluster &cluster, Eigen::MatrixXf &signature, TransformVector &descriptor_transforms) const;
+
+    /**
+     * @brief generateHypotheses creates object hypotheses for a cluster from the classification results of its signatures
+     * @param predicted_label predicted labels (one row for each signature of the cluster)
+     * @param knn_indices training sample ids of the predictions (only needed for pose estimation with a KNN classifier or descriptor transforms)
+     */
+    void
+    generateHypotheses(const Cluster &query_cluster,
+                       const Eigen::MatrixXi &predicted_label,
+                       const Eigen::MatrixXi &knn_indices,
+                       const Eigen::MatrixXf &knn_distances,
+                       const TransformVector &descriptor_transforms,
+                       std::vector<typename ObjectHypothesis::Ptr> &obj_hyps_filtered,
+                       std::vector<typename ObjectHypothesis::Ptr> &all_obj_hyps) const;
 
     bool keep_all_hypotheses_;
 
@@ -348,6 +370,7 @@ public:
     setFeatureEstimator (const typename GlobalEstimator<PointT>::Ptr & feat)
     {
         estimator_ = feat;
+        thread_estimators_.clear();
     }
 
     std::string
@@ -467,6 +490,18 @@ public:
     void
     recognize ();
 
+    /**
+     * @brief recognize classifies a set of clusters at once. The clusters are described concurrently (with a copy of the
+     * feature estimator for each thread) and all signatures are classified in a single batch.
+     * @param clusters clusters of the input cloud
+     * @param filtered_hypotheses generated (potentially filtered) object hypotheses for each cluster
+     * @param all_hypotheses all generated object hypotheses for each cluster
+     */
+    void
+    recognize (const std::vector<typename Cluster::Ptr> &clusters,
+               std::vector<std::vector<typename ObjectHypothesis::Ptr> > &filtered_hypotheses,
+               std::vector<std::vector<typename ObjectHypothesis::Ptr> > &all_hypotheses);
+
     /**
      * @brief setVisualizationParameter
      * @param vis_param
@@ -146,7 +146,7 @@ protected:
 
     std::vector<std::vector<PtFitness> > scene_pts_explained_solution_;
 
-    static std::vector<std::pair<std::string, float> > elapsed_time_; ///< measurements of computation times for various components
+    std::vector<std::pair<std::string, float> > elapsed_time_; ///< measurements of computation times for various components (per instance, so verifiers can run concurrently)
 
     float initial_temp_;
     boost::shared_ptr<GHVCostFunctionLogger<ModelT,SceneT> > cost_logger_;
@@ -376,11 +376,12 @@ protected:
     class StopWatch
     {
         std::string desc_;
+        std::vector<std::pair<std::string, float> > &elapsed_time_;
         boost::posix_time::ptime start_time_;
 
     public:
-        StopWatch(const std::string &desc)
-            :desc_ (desc), start_time_ (boost::posix_time::microsec_clock::local_time ())
+        StopWatch(const std::string &desc, std::vector<std::pair<std::string, float> > &elapsed_time)
+            :desc_ (desc), elapsed_time_ (elapsed_time), start_time_ (boost::posix_time::microsec_clock::local_time ())
         {}
 
         ~StopWatch()
@@ -388,6 +389,7 @@ protected:
             boost::posix_time::ptime end_time = boost::posix_time::microsec_clock::local_time ();
             float elapsed_time = static_cast<float> (((end_time - start_time_).total_milliseconds ()));
             VLOG(1) << desc_ << " took " << elapsed_time << " ms.";
+#pragma omp critical (hv_elapsed_time)  // stop watches of the parallel sections finish concurrently
             elapsed_time_.push_back( std::pair<std::string,float>(desc_, elapsed_time) );
         }
     };
@@ -65,7 +65,11 @@ MultiviewRecognizer<PointT>::calcSiftFeatures (const typename pcl::PointCloud<Po
 {
     SIFTLocalEstimation<PointT> estimator(sift_);
     estimator.setInputCloud(cloud_src);
-    estimator.compute (sift_signatures);
+    LocalDescriptorMatrix signatures;
+    estimator.compute (signatures);
+    sift_signatures.resize( signatures.rows() );
+    for(int i=0; i < signatures.rows(); i++)
+        sift_signatures[i].assign( signatures.row(i).data(), signatures.row(i).data() + signatures.cols() );
     sift_keypoint_indices = estimator.getKeypointIndices(  );
     return true;
 }
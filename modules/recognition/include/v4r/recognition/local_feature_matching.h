@@ -27,6 +27,7 @@
 #include <boost/archive/xml_iarchive.hpp>
 #include <boost/archive/xml_oarchive.hpp>
 #include <boost/serialization/serialization.hpp>
+#include <boost/dynamic_bitset.hpp>
 #include <flann/flann.h>
 #include <glog/logging.h>
 #include <pcl/common/common.h>
@@ -166,7 +167,8 @@ public:
     boost::shared_ptr<flann::Index<flann::L2<float> > > flann_index_l2_;
     boost::shared_ptr<flann::Index<flann::ChiSquareDistance<float> > > flann_index_chisquare_;
     boost::shared_ptr<flann::Index<flann::HellingerDistance<float> > > flann_index_hellinger_;
-    boost::shared_ptr<flann::Matrix<float> > flann_data_;
+    LocalDescriptorMatrix all_signatures_; ///< signatures of all object models (one per row)
+    boost::shared_ptr<flann::Matrix<float> > flann_data_;   ///< view on all_signatures_ (does not own its memory)
 
     /**
      * @brief The flann_model class stores for each signature to which model and which keypoint it belongs to
@@ -180,6 +182,103 @@ public:
     std::vector<flann_model> flann_models_;
 };
 
+/**
+ * @brief The LocalTrainingView class stores a preprocessed training view (cloud, normals, object mask and pose) together with the
+ * keypoints and filter masks computed on it, so that they are shared by all feature estimators trained on this view
+ */
+template<typename PointT>
+class V4R_EXPORTS LocalTrainingView
+{
+public:
+    std::string filename_; ///< cloud filename of the training view (model id if the full 3D model is used for training)
+    typename pcl::PointCloud<PointT>::ConstPtr cloud_; ///< point cloud of the view (points outside the object mask are set to NaN)
+    pcl::PointCloud<pcl::Normal>::ConstPtr normals_; ///< surface normals of the point cloud
+    std::vector<int> obj_indices_; ///< object indices (if empty, the whole cloud belongs to the object)
+    Eigen::Matrix4f pose_; ///< camera pose of the view
+    std::map<std::string, std::vector<int> > keypoints_; ///< filtered keypoint indices for each keypoint extraction and filter setup
+    std::map<int, boost::dynamic_bitset<> > boundary_masks_; ///< points close to a depth discontinuity for each boundary width
+
+    LocalTrainingView() : pose_ (Eigen::Matrix4f::Identity()) { }
+
+    EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+
+    typedef boost::shared_ptr< LocalTrainingView<PointT> > Ptr;
+    typedef boost::shared_ptr< LocalTrainingView<PointT> const> ConstPtr;
+};
+
+/**
+ * @brief The LocalTrainingViewCache class loads the training views of the object models (in parallel over views and models) and keeps
+ * them until released. Local feature matchers sharing a cache do not repeat loading, normal computation, keypoint extraction and filtering.
+ */
+template<typename PointT>
+class V4R_EXPORTS LocalTrainingViewCache
+{
+private:
+    typename NormalEstimator<PointT>::Ptr normal_estimator_;    ///< normal estimator used for computing surface normals of the training views
+    std::map<std::string, std::vector<typename LocalTrainingView<PointT>::Ptr> > views_; ///< training views for each model id
+    std::map<std::string, typename LocalTrainingView<PointT>::Ptr> full_models_; ///< full 3D model for each model id
+
+    typename LocalTrainingView<PointT>::Ptr
+    loadView(const Model<PointT> &m, const TrainingView<PointT> &tv, NormalEstimator<PointT> &ne) const;
+
+public:
+    LocalTrainingViewCache(const typename NormalEstimator<PointT>::Ptr &normal_estimator = typename NormalEstimator<PointT>::Ptr())
+        : normal_estimator_ (normal_estimator)
+    { }
+
+    void
+    setNormalEstimator(const typename NormalEstimator<PointT>::Ptr &normal_estimator)
+    {
+        normal_estimator_ = normal_estimator;
+    }
+
+    /**
+     * @brief load preprocesses the training views of the given models concurrently (models already in the cache are skipped)
+     * @param models object models
+     * @param individual_views if true, loads each training view. Otherwise the full 3D model.
+     */
+    void
+    load(const std::vector<typename Model<PointT>::ConstPtr> &models, bool individual_views);
+
+    /**
+     * @brief getViews returns the preprocessed views of a model (loads them if they are not in the cache)
+     * @param m object model
+     * @param individual_views if true, returns each training view. Otherwise the full 3D model as a single view.
+     */
+    std::vector<typename LocalTrainingView<PointT>::Ptr>
+    getViews(const typename Model<PointT>::ConstPtr &m, bool individual_views);
+
+    /**
+     * @brief release removes the views of a model from the cache
+     * @param model_id model id
+     */
+    void
+    release(const std::string &model_id)
+    {
+        views_.erase(model_id);
+        full_models_.erase(model_id);
+    }
+
+    void
+    clear()
+    {
+        views_.clear();
+        full_models_.clear();
+    }
+
+    /**
+     * @brief makeBatches splits models into batches that are loaded together. Each batch has enough views to keep all threads busy,
+     * while the memory needed for keeping the batch in the cache stays bounded.
+     * @param models object models
+     * @param individual_views if true, each training view counts. Otherwise a model counts as one view.
+     */
+    static std::vector< std::vector<typename Model<PointT>::ConstPtr> >
+    makeBatches(const std::vector<typename Model<PointT>::ConstPtr> &models, bool individual_views);
+
+    typedef boost::shared_ptr< LocalTrainingViewCache<PointT> > Ptr;
+    typedef boost::shared_ptr< LocalTrainingViewCache<PointT> const> ConstPtr;
+};
+
 /**
      * \brief Object recognition + 6DOF pose based on local features, GC and HV
      * Contains keypoints/local features computation, matching using FLANN,
@@ -196,7 +295,6 @@ public:
     LocalRecognizerParameter param_; ///< parameters
 
 private:
-    typedef std::vector<float> FeatureDescriptor;
     typedef int KeypointIndex;
 
     typename pcl::PointCloud<PointT>::ConstPtr scene_; ///< Point cloud to be classified
@@ -209,7 +307,7 @@ private:
 
     std::string descr_name_; ///< descriptor name
 
-    std::vector<FeatureDescriptor > scene_signatures_;   ///< signatures extracted from the scene
+    LocalDescriptorMatrix scene_signatures_;   ///< signatures extracted from the scene
     std::vector<KeypointIndex> keypoint_indices_;   ///< scene point indices extracted as keypoints
     std::vector<KeypointIndex> keypoint_indices_unfiltered_;    ///< only for visualization
 
@@ -225,6 +323,24 @@ private:
 
     PCLVisualizationParams::ConstPtr vis_param_;
 
+    typename LocalTrainingViewCache<PointT>::Ptr training_view_cache_; ///< preprocessed training views (if set, shared with other matchers)
+
+    /**
+     * @brief The TrainedModel class stores signatures and keypoints of an object model described by one estimator (until the index is built)
+     */
+    class TrainedModel
+    {
+    public:
+        bool done_;
+        LocalDescriptorMatrix signatures_;
+        LocalObjectModel::Ptr lom_;
+        TrainedModel() : done_ (false) { }
+    };
+
+    std::string trained_dir_; ///< directory where keypoints and signatures of the object models are stored
+    std::vector<typename Model<PointT>::ConstPtr> training_models_; ///< models of the database (in training order)
+    std::vector< std::vector<TrainedModel> > trained_models_; ///< trained data for each estimator and each model
+
     void
     validate()
     {
@@ -254,12 +370,12 @@ private:
     /**
      * @brief featureMatching matches all scene keypoints with model signatures
      * @param kp_indices query keypoint indices
-     * @param signatures query feature descriptors
+     * @param signatures query feature descriptors (one per row, all queried in a single batch)
      * @param lomdb search space
      */
     void
     featureMatching (const std::vector<KeypointIndex> &kp_indices,
-                     const std::vector<FeatureDescriptor> &signatures,
+                     const LocalDescriptorMatrix &signatures,
                      const LocalObjectModelDatabase::ConstPtr &model_keypoints_,
                      size_t model_keypoint_offset = 0);
 
@@ -268,15 +384,29 @@ private:
      * @param est feature estimator
      * @param keypoint_indices given keypoint indices
      * @param filtered_keypoint_indices extracted keypoint indices after removing nan points for instance
-     * @param signatures feature descriptors
+     * @param signatures feature descriptors (one per row)
      */
     void
     featureEncoding (LocalEstimator<PointT> &est,
                      const std::vector<KeypointIndex> &keypoint_indices,
                      std::vector<KeypointIndex> &filtered_keypoint_indices,
-                     std::vector<FeatureDescriptor > &signatures);
+                     LocalDescriptorMatrix &signatures);
 
 
+    /**
+     * @brief extractKeypoints extracts keypoints from a cloud
+     * @param cloud input cloud
+     * @param normals surface normals of the input cloud
+     * @param region_of_interest object indices (if empty, keypoints will be extracted over whole cloud)
+     * @param keypoint_extractors keypoint extractors to use (copies of keypoint_extractor_ when called concurrently)
+     * @return keypoint indices
+     */
+    std::vector<KeypointIndex>
+    extractKeypoints(const typename pcl::PointCloud<PointT>::ConstPtr &cloud,
+                     const pcl::PointCloud<pcl::Normal>::ConstPtr &normals,
+                     const std::vector<int> &region_of_interest,
+                     const std::vector<typename KeypointExtractor<PointT>::Ptr > &keypoint_extractors) const;
+
     /**
      * @brief filterKeypoints filters keypoints based on planarity and closeness to depth discontinuity (if according parameters are set)
      * @param[in] input_keypoints keypoints to be filtered
@@ -286,6 +416,46 @@ private:
     std::vector<int>
     getInlier(const std::vector<KeypointIndex> &input_keypoints) const;
 
+    /**
+     * @brief getInlier filters keypoints of a cloud based on planarity and closeness to depth discontinuity
+     * @param cloud input cloud
+     * @param input_keypoints keypoints to be filtered
+     * @param boundary_mask points close to a depth discontinuity (see computeBoundaryMask)
+     * @return indices of the kept keypoints (with respect to input_keypoints)
+     */
+    std::vector<int>
+    getInlier(const typename pcl::PointCloud<PointT>::ConstPtr &cloud,
+              const std::vector<KeypointIndex> &input_keypoints,
+              const boost::dynamic_bitset<> &boundary_mask) const;
+
+    /**
+     * @brief getInlier filters keypoints of a training view (the boundary mask is computed once per view)
+     */
+    std::vector<int>
+    getInlier(LocalTrainingView<PointT> &view, const std::vector<KeypointIndex> &input_keypoints) const;
+
+    /**
+     * @brief computeBoundaryMask computes points close to depth discontinuities (empty if the cloud is not organized)
+     * @param cloud input cloud
+     * @return mask with the size of the cloud
+     */
+    boost::dynamic_bitset<>
+    computeBoundaryMask(const typename pcl::PointCloud<PointT>::ConstPtr &cloud) const;
+
+    /**
+     * @brief getKeypointCacheKey
+     * @return identifier of the keypoint extraction and filter setup of this matcher (used to share keypoints of training views)
+     */
+    std::string
+    getKeypointCacheKey() const;
+
+    /**
+     * @brief computeTrainingKeypoints extracts and filters keypoints on training views (in parallel, skipping views where they are cached)
+     * @param views training views
+     */
+    void
+    computeTrainingKeypoints(const std::vector<typename LocalTrainingView<PointT>::Ptr> &views);
+
     /**
      * @brief computeFeatures
      * @param est local feature descriptor
@@ -360,6 +530,48 @@ public:
     void
     initialize(const std::string &trained_dir, bool retrain = false);
 
+    /**
+     * @brief beginTraining loads already trained object models from the training directory. Models which still need to be trained
+     * are returned by getModelsToTrain() and have to be passed to trainModel() before calling finishTraining().
+     * (initialize() does all of this. The steps are only needed to train several matchers on a shared LocalTrainingViewCache.)
+     * @param trained_dir training directory
+     * @param retrain if set to true, re-trains all objects no matter if the data already exists in the given training directory
+     */
+    void
+    beginTraining(const std::string &trained_dir, bool retrain = false);
+
+    /**
+     * @brief getModelsToTrain
+     * @return object models that are not trained yet (valid after beginTraining)
+     */
+    std::vector<typename Model<PointT>::ConstPtr>
+    getModelsToTrain() const;
+
+    /**
+     * @brief trainModel extracts keypoints and signatures of an object model for all estimators that need training and stores them in the training directory
+     * @param m object model
+     * @param views preprocessed training views of the model (see LocalTrainingViewCache)
+     */
+    void
+    trainModel(const typename Model<PointT>::ConstPtr &m, const std::vector<typename LocalTrainingView<PointT>::Ptr> &views);
+
+    /**
+     * @brief finishTraining builds the FLANN index for each estimator
+     */
+    void
+    finishTraining();
+
+    /**
+     * @brief setTrainingViewCache sets a cache of preprocessed training views shared with other local feature matchers
+     * (views are not released by this matcher)
+     * @param cache
+     */
+    void
+    setTrainingViewCache(const typename LocalTrainingViewCache<PointT>::Ptr &cache)
+    {
+        training_view_cache_ = cache;
+    }
+
     /**
     * @brief adds a keypoint extractor
     * @param keypoint extractor object
@@ -44,10 +44,17 @@ private:
 
     std::vector<typename RecognitionPipeline<PointT>::Ptr > recognition_pipelines_;
 
-    omp_lock_t rec_lock_;
+    std::vector<int> thread_budgets_;   ///< number of OpenMP threads each recognition pipeline may use (0 = equal share)
 
     /**
-     * @brief recognize
+     * @brief computes the number of threads available to each recognition pipeline when they run concurrently
+     * @return thread budget for each recognition pipeline
+     */
+    std::vector<int>
+    getThreadBudgets() const;
+
+    /**
+     * @brief runs all recognition pipelines concurrently and merges their hypotheses in the order the pipelines were added
      */
     void
     do_recognize();
@@ -75,6 +82,18 @@ public:
         recognition_pipelines_.push_back(rec);
     }
 
+    /**
+     * @brief setThreadBudgets sets the number of OpenMP threads each recognition pipeline may use for its own
+     * parallel regions while all pipelines run concurrently. Pipelines without (or with a non-positive) budget get an
+     * equal share of the remaining threads.
+     * @param thread_budgets number of threads for each recognition pipeline (in the order they have been added)
+     */
+    void
+    setThreadBudgets(const std::vector<int> &thread_budgets)
+    {
+        thread_budgets_ = thread_budgets;
+    }
+
 
     /**
          * @brief needNormals
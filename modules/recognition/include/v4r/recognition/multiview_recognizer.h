@@ -149,6 +149,7 @@ template<typename PointT>
 class V4R_EXPORTS MultiviewRecognizer : public RecognitionPipeline<PointT>
 {
 private:
+    using RecognitionPipeline<PointT>::elapsed_time_;
     using RecognitionPipeline<PointT>::scene_;
     using RecognitionPipeline<PointT>::scene_normals_;
     using RecognitionPipeline<PointT>::m_db_;
@@ -24,6 +24,7 @@
 
 #pragma once
 
+#include <atomic>
 #include <boost/serialization/serialization.hpp>
 #include <boost/serialization/shared_ptr.hpp>
 #include <boost/serialization/split_member.hpp>
@@ -60,7 +61,7 @@ private:
          ;
     }
 
-    static size_t s_counter_; /// unique identifier to avoid transfering hypotheses multiple times when using multi-view recognition
+    static std::atomic<size_t> s_counter_; /// unique identifier to avoid transfering hypotheses multiple times when using multi-view recognition (atomic, hypotheses are created by concurrent pipelines)
 
 public:
     EIGEN_MAKE_ALIGNED_OPERATOR_NEW
@@ -63,16 +63,17 @@ protected:
     Eigen::Vector4f table_plane_;
     bool table_plane_set_;
 
-    static std::vector< std::pair<std::string,float> > elapsed_time_;  ///< to measure performance
+    std::vector< std::pair<std::string,float> > elapsed_time_;  ///< to measure performance (per instance, so pipelines can run concurrently)
 
     class StopWatch
     {
         std::string desc_;
+        std::vector< std::pair<std::string,float> > &elapsed_time_;
         boost::posix_time::ptime start_time_;
 
     public:
-        StopWatch(const std::string &desc)
-            :desc_ (desc), start_time_ (boost::posix_time::microsec_clock::local_time ())
+        StopWatch(const std::string &desc, std::vector< std::pair<std::string,float> > &elapsed_time)
+            :desc_ (desc), elapsed_time_ (elapsed_time), start_time_ (boost::posix_time::microsec_clock::local_time ())
         {}
 
         ~StopWatch()
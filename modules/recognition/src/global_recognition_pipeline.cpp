@@ -34,7 +34,7 @@ GlobalRecognitionPipeline<PointT>::do_recognize()
     clusters_.clear();
 
     {
-        typename RecognitionPipeline<PointT>::StopWatch t("Segmentation");
+        typename RecognitionPipeline<PointT>::StopWatch t("Segmentation", elapsed_time_);
         seg_->setInputCloud(scene_);
         seg_->setNormalsCloud(scene_normals_);
         seg_->segment();
@@ -49,7 +49,27 @@ GlobalRecognitionPipeline<PointT>::do_recognize()
         obj_hypotheses_wo_elongation_check_.resize(clusters_.size() );
     }
 
-    typename RecognitionPipeline<PointT>::StopWatch t("Global recognition");
+    typename RecognitionPipeline<PointT>::StopWatch t("Global recognition", elapsed_time_);
+
+    std::vector<typename GlobalRecognizer<PointT>::Cluster::Ptr> clusters ( clusters_.size() );
+#pragma omp parallel for schedule(dynamic)
+    for(size_t i=0; i<clusters_.size(); i++)
+    {
+        clusters[i].reset( new typename GlobalRecognizer<PointT>::Cluster (*scene_, clusters_[i] ) );
+        clusters[i]->setTablePlane( table_plane_ );
+    }
+
+    // each recognizer describes all clusters at once and classifies them in a single batch
+    std::vector<std::vector<std::vector<typename ObjectHypothesis::Ptr> > > filtered ( global_recognizers_.size() );   // [recognizer][cluster][hypothesis]
+    std::vector<std::vector<std::vector<typename ObjectHypothesis::Ptr> > > unfiltered ( global_recognizers_.size() );
+    for (size_t g_id=0; g_id<global_recognizers_.size(); g_id++)
+    {
+        typename GlobalRecognizer<PointT>::Ptr r = global_recognizers_[g_id];
+        r->setInputCloud( scene_ );
+        r->setSceneNormals( scene_normals_ );
+        r->recognize( clusters, filtered[g_id], unfiltered[g_id] );
+    }
+
     size_t kept=0;
     for(size_t i=0; i<clusters_.size(); i++)
     {
@@ -57,25 +77,14 @@ GlobalRecognitionPipeline<PointT>::do_recognize()
         ohg.ohs_.clear();
         ohg.global_hypotheses_ = true;
 
-        typename GlobalRecognizer<PointT>::Cluster::Ptr cluster (
-                    new typename GlobalRecognizer<PointT>::Cluster (*scene_, clusters_[i] ) );
-
-        cluster->setTablePlane( table_plane_ );
-
-        ///TODO pragma omp parallel with lock
         for (size_t g_id=0; g_id<global_recognizers_.size(); g_id++)
         {
-            typename GlobalRecognizer<PointT>::Ptr r = global_recognizers_[g_id];
-            r->setInputCloud( scene_ );
-            r->setSceneNormals( scene_normals_ );
-            r->setCluster( cluster );
-            r->recognize();
-            std::vector<typename ObjectHypothesis::Ptr > ohs = r->getFilteredHypotheses();
+            const std::vector<typename ObjectHypothesis::Ptr > &ohs = filtered[g_id][i];
             ohg.ohs_.insert( ohg.ohs_.end(), ohs.begin(), ohs.end() );
 
             if(visualize_clusters_)
             {
-                std::vector<typename ObjectHypothesis::Ptr > ohs_unfiltered = r->getAllHypotheses();
+                const std::vector<typename ObjectHypothesis::Ptr > &ohs_unfiltered = unfiltered[g_id][i];
                 obj_hypotheses_wo_elongation_check_[i].ohs_.insert( obj_hypotheses_wo_elongation_check_[i].ohs_.end(), ohs_unfiltered.begin(), ohs_unfiltered.end() );
                 obj_hypotheses_wo_elongation_check_[i].global_hypotheses_ = true;
             }
@@ -295,31 +295,35 @@ GlobalRecognizer<PointT>::initialize(const std::string &trained_dir, bool retrai
 
 template<typename PointT>
 void
-GlobalRecognizer<PointT>::featureEncodingAndMatching(  )
+GlobalRecognizer<PointT>::computeSignature(GlobalEstimator<PointT> &estimator, const Cluster &cluster, Eigen::MatrixXf &signature, TransformVector &descriptor_transforms) const
 {
-    Eigen::MatrixXf query_sig;
+    estimator.setInputCloud(scene_);
+    estimator.setNormals(scene_normals_);
 
-    estimator_->setInputCloud(scene_);
-    estimator_->setNormals(scene_normals_);
+    if( !cluster.indices_.empty() )
+        estimator.setIndices(cluster.indices_);
 
-    if( !cluster_->indices_.empty() )
-        estimator_->setIndices(cluster_->indices_);
+    estimator.compute(signature);
+    descriptor_transforms = estimator.getTransforms( );
+}
 
-    estimator_->compute(query_sig);
-    std::vector<Eigen::Matrix4f, Eigen::aligned_allocator<Eigen::Matrix4f> > descriptor_transforms = estimator_->getTransforms( );
 
-    if( query_sig.cols() == 0 || query_sig.rows() == 0)
-    {
-        LOG(ERROR) << "No signature computed for input cluster!";
-        return;
-    }
-
-    Eigen::MatrixXi predicted_label;
-    classifier_->predict(query_sig, predicted_label);
+template<typename PointT>
+void
+GlobalRecognizer<PointT>::generateHypotheses(const Cluster &query_cluster,
+                                             const Eigen::MatrixXi &predicted_label,
+                                             const Eigen::MatrixXi &knn_indices,
+                                             const Eigen::MatrixXf &knn_distances,
+                                             const TransformVector &descriptor_transforms,
+                                             std::vector<typename ObjectHypothesis::Ptr> &obj_hyps_filtered,
+                                             std::vector<typename ObjectHypothesis::Ptr> &all_obj_hyps) const
+{
+    obj_hyps_filtered.clear();
+    all_obj_hyps.clear();
 
     if( !param_.estimate_pose_ )
     {
-        obj_hyps_filtered_.resize( predicted_label.rows() * predicted_label.cols() );
+        obj_hyps_filtered.resize( predicted_label.rows() * predicted_label.cols() );
         for(int query_id=0; query_id<predicted_label.rows(); query_id++)
         {
             for (int k = 0; k < predicted_label.cols(); k++)
@@ -331,18 +335,14 @@ GlobalRecognizer<PointT>::featureEncodingAndMatching(  )
                 typename ObjectHypothesis::Ptr oh( new ObjectHypothesis);
                 oh->model_id_ = model_name;
                 oh->class_id_ = class_name;
-                obj_hyps_filtered_[query_id*predicted_label.cols()+k] = oh;
+                obj_hyps_filtered[query_id*predicted_label.cols()+k] = oh;
             }
         }
         return;
     }
     else if( !descriptor_transforms.empty() ) // this will be true for OURCVFH - we can estimate the object pose from the computed SGURF (semi-global unique reference frame)
     {
-        Eigen::MatrixXi knn_indices;
-        Eigen::MatrixXf knn_distances;
-        classifier_->getTrainingSampleIDSforPredictions(knn_indices, knn_distances);
-
-        obj_hyps_filtered_.resize( predicted_label.rows() * predicted_label.cols() );
+        obj_hyps_filtered.resize( predicted_label.rows() * predicted_label.cols() );
         for(int query_id=0; query_id<predicted_label.rows(); query_id++)
         {
             for (int k = 0; k < predicted_label.cols(); k++)
@@ -358,7 +358,7 @@ GlobalRecognizer<PointT>::featureEncodingAndMatching(  )
                 oh->model_id_ = f.instance_name_;
                 oh->class_id_ = f.class_name_;
                 oh->transform_ = 1.f * descriptor_transforms[query_id].inverse() * gom->descriptor_transforms_[view_id] * gom->model_poses_[view_id].inverse();
-                obj_hyps_filtered_[query_id*predicted_label.cols()+k] = oh;
+                obj_hyps_filtered[query_id*predicted_label.cols()+k] = oh;
 
 #ifdef _VISUALIZE_
                 pcl::visualization::PCLVisualizer vis;
@@ -380,7 +380,7 @@ GlobalRecognizer<PointT>::featureEncodingAndMatching(  )
 
                 typename pcl::PointCloud<PointT>::Ptr model_view (new pcl::PointCloud<PointT>);
                 typename pcl::PointCloud<PointT>::Ptr model_aligned (new pcl::PointCloud<PointT>);
-                pcl::copyPointCloud(*scene_, cluster_->indices_, *cluster);
+                pcl::copyPointCloud(*scene_, query_cluster.indices_, *cluster);
                 vis.addPointCloud(cluster, "cluster", vp1);
                 vis.addCoordinateSystem(vis_param_->coordinate_axis_scale_, "cluster_co", vp1);
                 pcl::transformPointCloud(*cluster, *cluster_aligned, descriptor_transforms[query_id]);
@@ -407,14 +407,14 @@ GlobalRecognizer<PointT>::featureEncodingAndMatching(  )
     else    // estimate pose using some prior assumptions
     {
         CHECK( !param_.use_table_plane_for_alignment_ ||
-               (param_.use_table_plane_for_alignment_ && cluster_->isTablePlaneSet() ) ) << "Selected to use table plane for pose alignment but table plane has not been set! " << std::endl;
+               (param_.use_table_plane_for_alignment_ && query_cluster.isTablePlaneSet() ) ) << "Selected to use table plane for pose alignment but table plane has not been set! " << std::endl;
 
         Eigen::Matrix4f tf_rot = Eigen::Matrix4f::Identity();
 
         if( param_.use_table_plane_for_alignment_ )   // rotate cluster such that the surface normal of the planar support is aligned with the z-axis. We do not need to know the closest training view.
         {
             // create some arbitrary coordinate system on table plane (s.t. normal corresponds to z axis, and others are orthonormal)
-            Eigen::Vector3f vec_z = cluster_->table_plane_.topRows(3);
+            Eigen::Vector3f vec_z = query_cluster.table_plane_.topRows(3);
             vec_z.normalize();
 
             Eigen::Vector3f dummy; ///NOTE we just need to find any other point on the plane except centroid to create a coordinate system (hopefully this one is not close to zero)
@@ -444,10 +444,10 @@ GlobalRecognizer<PointT>::featureEncodingAndMatching(  )
         else
             max_hypotheses *= 4;
 
-        obj_hyps_filtered_.resize( max_hypotheses );
+        obj_hyps_filtered.resize( max_hypotheses );
 
-        for(size_t i=0; i<obj_hyps_filtered_.size(); i++)
-            obj_hyps_filtered_[i].reset( new ObjectHypothesis );
+        for(size_t i=0; i<obj_hyps_filtered.size(); i++)
+            obj_hyps_filtered[i].reset( new ObjectHypothesis );
 
         size_t kept=0;
         for(int query_id=0; query_id<predicted_label.rows(); query_id++)
@@ -462,15 +462,17 @@ GlobalRecognizer<PointT>::featureEncodingAndMatching(  )
                 else
                     class_name = id_to_model_name_[lbl];
 
-                GlobalObjectModel::ConstPtr gom = gomdb_.global_models_[model_name];
+                auto gom_it = gomdb_.global_models_.find( model_name );
+                CHECK( gom_it != gomdb_.global_models_.end() ) << "could not find model " << model_name << ". There was something wrong with the model initialiazation. Maybe retraining the database helps.";
+                GlobalObjectModel::ConstPtr gom = gom_it->second;
                 const Eigen::Vector3f &elongations_model = gom->model_elongations_.colwise().maxCoeff();    // as we don't know the view, we just take the maximum extent of each axis over all training views
 //                const Eigen::Vector3f &elongations_model = gom->model_elongations_.row( view_id );
 
                 if( param_.check_elongations_ &&
-                   ( cluster_->elongation_(2)/elongations_model(2) < param_.min_elongation_ratio_||
-                     cluster_->elongation_(2)/elongations_model(2) > param_.max_elongation_ratio_||
-                     cluster_->elongation_(1)/elongations_model(1) < param_.min_elongation_ratio_||
-                     cluster_->elongation_(1)/elongations_model(1) > param_.max_elongation_ratio_) )
+                   ( query_cluster.elongation_(2)/elongations_model(2) < param_.min_elongation_ratio_||
+                     query_cluster.elongation_(2)/elongations_model(2) > param_.max_elongation_ratio_||
+                     query_cluster.elongation_(1)/elongations_model(1) < param_.min_elongation_ratio_||
+                     query_cluster.elongation_(1)/elongations_model(1) > param_.max_elongation_ratio_) )
                 {
                     continue;
                 }
@@ -492,17 +494,17 @@ GlobalRecognizer<PointT>::featureEncodingAndMatching(  )
                     // align origin with downprojected cluster centroid
                     float centroid_correction = gom->mean_distance_view_centroid_to_3d_model_centroid_;
 
-                    Eigen::Vector3f centroid_normalized = cluster_->centroid_.head(3).normalized();
-                    Eigen::Vector3f centroid_corrected = cluster_->centroid_.head(3) + centroid_correction * centroid_normalized;
+                    Eigen::Vector3f centroid_normalized = query_cluster.centroid_.head(3).normalized();
+                    Eigen::Vector3f centroid_corrected = query_cluster.centroid_.head(3) + centroid_correction * centroid_normalized;
 
-                    Eigen::Vector3f closest_pt_to_cluster_center = getClosestPointOnPlane(centroid_corrected, cluster_->table_plane_);
+                    Eigen::Vector3f closest_pt_to_cluster_center = getClosestPointOnPlane(centroid_corrected, query_cluster.table_plane_);
                     Eigen::Matrix4f tf_cluster_shift = Eigen::Matrix4f::Identity();
-//                    tf11.block<3,1>(0,3) = -cluster_->centroid_.head(3);
+//                    tf11.block<3,1>(0,3) = -query_cluster.centroid_.head(3);
                     tf_cluster_shift.block<3,1>(0,3) = -closest_pt_to_cluster_center;
 
                     // align table plane surface normal with model coordinate's z-axis
                     Eigen::Matrix4f tf_cluster_rot = Eigen::Matrix4f::Identity();
-                    tf_cluster_rot.block<3,3>(0,0) = computeRotationMatrixToAlignVectors(cluster_->table_plane_.head(3), Eigen::Vector3f::UnitZ()); //Finv * G * F;
+                    tf_cluster_rot.block<3,3>(0,0) = computeRotationMatrixToAlignVectors(query_cluster.table_plane_.head(3), Eigen::Vector3f::UnitZ()); //Finv * G * F;
 
                     const Eigen::Matrix4f align_cluster = tf_cluster_rot * tf_cluster_shift;
 
@@ -560,12 +562,12 @@ GlobalRecognizer<PointT>::featureEncodingAndMatching(  )
                     typename pcl::PointCloud<PointT>::Ptr cluster_shifted_and_aligned_wo_correction (new pcl::PointCloud<PointT>);
                     typename pcl::PointCloud<PointT>::Ptr cluster_shifter_and_aligned_not_downprojected_not_corrected (new pcl::PointCloud<PointT>);
 
-                    pcl::copyPointCloud(*scene_, cluster_->indices_, *cluster);
+                    pcl::copyPointCloud(*scene_, query_cluster.indices_, *cluster);
                     vis.addPointCloud(cluster, "cluster", vp5);
                     vis.addCoordinateSystem(vis_param_->coordinate_axis_scale_, "cluster2", vp5);
 
                     Eigen::Matrix4f tf_cluster_wo_downprojection = Eigen::Matrix4f::Identity();
-                    tf_cluster_wo_downprojection.block<3,1>(0,3) = -cluster_->centroid_.head(3);
+                    tf_cluster_wo_downprojection.block<3,1>(0,3) = -query_cluster.centroid_.head(3);
                     pcl::transformPointCloud(*cluster, *cluster_shifter_and_aligned_not_downprojected_not_corrected, tf_cluster_rot * tf_cluster_wo_downprojection);
                     Eigen::Vector4f min3d_tmp, max3d_tmp;
                     pcl::getMinMax3D(*cluster_shifter_and_aligned_not_downprojected_not_corrected, min3d_tmp, max3d_tmp); ///TODO: Do this computation during initialization
@@ -575,9 +577,9 @@ GlobalRecognizer<PointT>::featureEncodingAndMatching(  )
                     vis.addPointCloud(cluster_shifter_and_aligned_not_downprojected_not_corrected, "cluster_shifter_and_aligned_not_downprojected_not_corrected", vp6);
                     vis.addCoordinateSystem(vis_param_->coordinate_axis_scale_, "cluster_shifter_and_aligned_not_downprojected_not_corrected_co", vp6);
 
-                    Eigen::Vector3f closest_pt_to_cluster_center_wo_correction = getClosestPointOnPlane(cluster_->centroid_.head(3), cluster_->table_plane_);
+                    Eigen::Vector3f closest_pt_to_cluster_center_wo_correction = getClosestPointOnPlane(query_cluster.centroid_.head(3), query_cluster.table_plane_);
                     Eigen::Matrix4f tf_cluster_shift_wo_correction = Eigen::Matrix4f::Identity();
-//                    tf11.block<3,1>(0,3) = -cluster_->centroid_.head(3);
+//                    tf11.block<3,1>(0,3) = -query_cluster.centroid_.head(3);
                     tf_cluster_shift_wo_correction.block<3,1>(0,3) = -closest_pt_to_cluster_center_wo_correction;
                     pcl::transformPointCloud(*cluster, *cluster_shifted_and_aligned_wo_correction, tf_cluster_rot * tf_cluster_shift_wo_correction);
                     vis.addPointCloud(cluster_shifted_and_aligned_wo_correction, "cluster_shifted_and_aligned_wo_correction", vp7);
@@ -613,7 +615,7 @@ GlobalRecognizer<PointT>::featureEncodingAndMatching(  )
                             h->confidence_ =  0.f;
                             h->model_id_ = model_name;
                             h->class_id_ = class_name;
-                            all_obj_hyps_.push_back(h);
+                            all_obj_hyps.push_back(h);
                         }
                     }
 #ifdef _VISUALIZE_
@@ -631,18 +633,15 @@ GlobalRecognizer<PointT>::featureEncodingAndMatching(  )
 
                         Eigen::Matrix4f alignment_tf = align_cluster.inverse() * rot_tmp * tf_om_shift2origin2 * tf_om_shift2origin;
 
-                        obj_hyps_filtered_[kept]->transform_ = alignment_tf;//tf_trans * tf_rot  * rot_tmp;
-                        obj_hyps_filtered_[kept]->confidence_ =  0.f;
-                        obj_hyps_filtered_[kept]->model_id_ = model_name;
-                        obj_hyps_filtered_[kept]->class_id_ = class_name;
+                        obj_hyps_filtered[kept]->transform_ = alignment_tf;//tf_trans * tf_rot  * rot_tmp;
+                        obj_hyps_filtered[kept]->confidence_ =  0.f;
+                        obj_hyps_filtered[kept]->model_id_ = model_name;
+                        obj_hyps_filtered[kept]->class_id_ = class_name;
                         kept++;
                     }
                 }
                 else    // align principal axis with the ones from closest view in training set
                 {
-                    Eigen::MatrixXi knn_indices;
-                    Eigen::MatrixXf knn_distances;
-                    classifier_->getTrainingSampleIDSforPredictions(knn_indices, knn_distances);
                     const GlobalObjectModelDatabase::flann_model &f = gomdb_.flann_models_ [ knn_indices( query_id, k ) ];
                     const size_t view_id = f.view_id_;
                     auto it = gomdb_.global_models_.find( f.instance_name_ );
@@ -650,7 +649,7 @@ GlobalRecognizer<PointT>::featureEncodingAndMatching(  )
                     GlobalObjectModel::ConstPtr gom = it->second;
 
                     Eigen::Matrix4f tf_trans = Eigen::Matrix4f::Identity();
-                    tf_trans.block<3,1>(0,3) = cluster_->centroid_.topRows(3);
+                    tf_trans.block<3,1>(0,3) = query_cluster.centroid_.topRows(3);
 
                     // there are four possibilites (due to sign ambiguity of eigenvector)
                     Eigen::Matrix3f eigenBasis, sign_operator;
@@ -658,29 +657,29 @@ GlobalRecognizer<PointT>::featureEncodingAndMatching(  )
 
                     // once take eigen vector as they are computed
                     sign_operator = identity;
-                    eigenBasis = cluster_->eigen_basis_ * sign_operator;
+                    eigenBasis = query_cluster.eigen_basis_ * sign_operator;
                     Eigen::Matrix4f tf_rot_inv = Eigen::Matrix4f::Identity();
                     tf_rot_inv.block<3,3>(0,0) = eigenBasis.transpose();
                     tf_rot = tf_rot_inv.inverse();
                     Eigen::Matrix4f tf_m_inv = gom->model_poses_[ view_id ].inverse();
-                    obj_hyps_filtered_[kept]->transform_ = tf_trans * tf_rot * gom->eigen_based_pose_[ view_id ] * tf_m_inv;
-                    obj_hyps_filtered_[kept]->confidence_ = knn_distances( query_id, k );
-                    obj_hyps_filtered_[kept]->model_id_ = model_name;
-                    obj_hyps_filtered_[kept]->class_id_ = class_name;
+                    obj_hyps_filtered[kept]->transform_ = tf_trans * tf_rot * gom->eigen_based_pose_[ view_id ] * tf_m_inv;
+                    obj_hyps_filtered[kept]->confidence_ = knn_distances( query_id, k );
+                    obj_hyps_filtered[kept]->model_id_ = model_name;
+                    obj_hyps_filtered[kept]->class_id_ = class_name;
                     kept++;
 
                     // now take the first one negative
                     sign_operator = identity;
                     sign_operator(0,0) = -1;
                     sign_operator(2,2) = -1;   // due to right-hand rule
-                    eigenBasis = cluster_->eigen_basis_ * sign_operator;
+                    eigenBasis = query_cluster.eigen_basis_ * sign_operator;
                     tf_rot_inv = Eigen::Matrix4f::Identity();
                     tf_rot_inv.block<3,3>(0,0) = eigenBasis.transpose();
                     tf_rot = tf_rot_inv.inverse();
-                    obj_hyps_filtered_[kept]->transform_ = tf_trans * tf_rot * gom->eigen_based_pose_[ view_id ] * tf_m_inv;
-                    obj_hyps_filtered_[kept]->confidence_ = knn_distances( query_id, k );
-                    obj_hyps_filtered_[kept]->model_id_ = model_name;
-                    obj_hyps_filtered_[kept]->class_id_ = class_name;
+                    obj_hyps_filtered[kept]->transform_ = tf_trans * tf_rot * gom->eigen_based_pose_[ view_id ] * tf_m_inv;
+                    obj_hyps_filtered[kept]->confidence_ = knn_distances( query_id, k );
+                    obj_hyps_filtered[kept]->model_id_ = model_name;
+                    obj_hyps_filtered[kept]->class_id_ = class_name;
                     kept++;
 
 
@@ -688,14 +687,14 @@ GlobalRecognizer<PointT>::featureEncodingAndMatching(  )
                     sign_operator = identity;
                     sign_operator(1,1) = -1;
                     sign_operator(2,2) = -1;   // due to right-hand rule
-                    eigenBasis = cluster_->eigen_basis_ * sign_operator;
+                    eigenBasis = query_cluster.eigen_basis_ * sign_operator;
                     tf_rot_inv = Eigen::Matrix4f::Identity();
                     tf_rot_inv.block<3,3>(0,0) = eigenBasis.transpose();
                     tf_rot = tf_rot_inv.inverse();
-                    obj_hyps_filtered_[kept]->transform_ = tf_trans * tf_rot * gom->eigen_based_pose_[ view_id ] * tf_m_inv;
-                    obj_hyps_filtered_[kept]->confidence_ = knn_distances( query_id, k );
-                    obj_hyps_filtered_[kept]->model_id_ = model_name;
-                    obj_hyps_filtered_[kept]->class_id_ = class_name;
+                    obj_hyps_filtered[kept]->transform_ = tf_trans * tf_rot * gom->eigen_based_pose_[ view_id ] * tf_m_inv;
+                    obj_hyps_filtered[kept]->confidence_ = knn_distances( query_id, k );
+                    obj_hyps_filtered[kept]->model_id_ = model_name;
+                    obj_hyps_filtered[kept]->class_id_ = class_name;
                     kept++;
 
 
@@ -703,20 +702,123 @@ GlobalRecognizer<PointT>::featureEncodingAndMatching(  )
                     sign_operator = identity;
                     sign_operator(0,0) = -1;
                     sign_operator(1,1) = -1;
-                    eigenBasis = cluster_->eigen_basis_ * sign_operator;
+                    eigenBasis = query_cluster.eigen_basis_ * sign_operator;
                     tf_rot_inv = Eigen::Matrix4f::Identity();
                     tf_rot_inv.block<3,3>(0,0) = eigenBasis.transpose();
                     tf_rot = tf_rot_inv.inverse();
-                    obj_hyps_filtered_[kept]->transform_ = tf_trans * tf_rot * gom->eigen_based_pose_[ view_id ] * tf_m_inv;
-                    obj_hyps_filtered_[kept]->confidence_ = knn_distances( query_id, k );
-                    obj_hyps_filtered_[kept]->model_id_ = model_name;
-                    obj_hyps_filtered_[kept]->class_id_ = class_name;
+                    obj_hyps_filtered[kept]->transform_ = tf_trans * tf_rot * gom->eigen_based_pose_[ view_id ] * tf_m_inv;
+                    obj_hyps_filtered[kept]->confidence_ = knn_distances( query_id, k );
+                    obj_hyps_filtered[kept]->model_id_ = model_name;
+                    obj_hyps_filtered[kept]->class_id_ = class_name;
                     kept++;
                 }
             }
         }
 
-        obj_hyps_filtered_.resize( kept );
+        obj_hyps_filtered.resize( kept );
+    }
+}
+
+template<typename PointT>
+void
+GlobalRecognizer<PointT>::recognize (const std::vector<typename Cluster::Ptr> &clusters,
+                                     std::vector<std::vector<typename ObjectHypothesis::Ptr> > &filtered_hypotheses,
+                                     std::vector<std::vector<typename ObjectHypothesis::Ptr> > &all_hypotheses)
+{
+    const int num_clusters = clusters.size();
+    filtered_hypotheses.clear();
+    filtered_hypotheses.resize( num_clusters );
+    all_hypotheses.clear();
+    all_hypotheses.resize( num_clusters );
+
+    if( !num_clusters )
+        return;
+
+    // estimators keep input cloud and indices as state - each thread needs its own copy
+    bool describe_in_parallel = num_clusters > 1 && omp_get_max_threads() > 1;
+    if( describe_in_parallel )
+    {
+        thread_estimators_.resize( omp_get_max_threads() );
+        thread_estimators_[0] = estimator_;
+        for(size_t t=1; t<thread_estimators_.size() && describe_in_parallel; t++)
+        {
+            if( !thread_estimators_[t] )
+                thread_estimators_[t] = estimator_->clone();
+
+            describe_in_parallel = (bool)thread_estimators_[t];
+        }
+
+        if( !describe_in_parallel )
+            VLOG(1) << "Feature estimator " << estimator_->getFeatureDescriptorName() << " can not be copied. Describing clusters sequentially.";
+    }
+
+    std::vector<Eigen::MatrixXf> signatures ( num_clusters );
+    std::vector<TransformVector> descriptor_transforms ( num_clusters );
+
+#pragma omp parallel for schedule(dynamic) if(describe_in_parallel)
+    for(int i=0; i<num_clusters; i++)
+    {
+        GlobalEstimator<PointT> &estimator = describe_in_parallel ? *thread_estimators_[ omp_get_thread_num() ] : *estimator_;
+        computeSignature( estimator, *clusters[i], signatures[i], descriptor_transforms[i] );
+    }
+
+    // stack all signatures into one query matrix
+    std::vector<int> row_offset (num_clusters + 1, 0);
+    int feature_dims = 0;
+    for(int i=0; i<num_clusters; i++)
+    {
+        int rows = signatures[i].cols() ? signatures[i].rows() : 0;
+        row_offset[i+1] = row_offset[i] + rows;
+
+        if( rows )
+        {
+            CHECK( !feature_dims || feature_dims == signatures[i].cols() ) << "Signatures of clusters have different feature dimensions!";
+            feature_dims = signatures[i].cols();
+        }
+    }
+
+    if( !row_offset.back() )
+    {
+        LOG(ERROR) << "No signature computed for input clusters!";
+        return;
+    }
+
+    Eigen::MatrixXf query_sig ( row_offset.back(), feature_dims );
+    for(int i=0; i<num_clusters; i++)
+    {
+        if( row_offset[i+1] > row_offset[i] )
+            query_sig.middleRows( row_offset[i], row_offset[i+1] - row_offset[i] ) = signatures[i];
+    }
+    signatures.clear();
+
+    ClassificationResult classification;
+    classifier_->predict(query_sig, classification);
+    const Eigen::MatrixXi &predicted_label = classification.predicted_label_;
+    const Eigen::MatrixXi &knn_indices = classification.training_sample_ids_;
+    const Eigen::MatrixXf &knn_distances = classification.distances_;
+
+#ifndef _VISUALIZE_
+#pragma omp parallel for schedule(dynamic)
+#endif
+    for(int i=0; i<num_clusters; i++)
+    {
+        const int rows = row_offset[i+1] - row_offset[i];
+        if( !rows )
+        {
+            LOG(ERROR) << "No signature computed for input cluster!";
+            continue;
+        }
+
+        Eigen::MatrixXi knn_indices_cluster;
+        Eigen::MatrixXf knn_distances_cluster;
+        if( knn_indices.rows() )
+        {
+            knn_indices_cluster = knn_indices.middleRows( row_offset[i], rows );
+            knn_distances_cluster = knn_distances.middleRows( row_offset[i], rows );
+        }
+
+        generateHypotheses( *clusters[i], predicted_label.middleRows( row_offset[i], rows ), knn_indices_cluster, knn_distances_cluster,
+                            descriptor_transforms[i], filtered_hypotheses[i], all_hypotheses[i] );
     }
 }
 
@@ -726,9 +828,14 @@ GlobalRecognizer<PointT>::recognize()
 {
     CHECK( !param_.estimate_pose_ || (param_.estimate_pose_ && cluster_) ) << "Cluster that needs to be classified is not set!";
 
-    obj_hyps_filtered_.clear();
-    all_obj_hyps_.clear();
-    featureEncodingAndMatching(  );
+    std::vector<typename Cluster::Ptr> clusters (1, cluster_);
+    if( !cluster_ )   // describe the whole input cloud
+        clusters[0].reset( new Cluster( *scene_, std::vector<int>(), false ) );
+
+    std::vector<std::vector<typename ObjectHypothesis::Ptr> > filtered_hypotheses, all_hypotheses;
+    recognize( clusters, filtered_hypotheses, all_hypotheses );
+    obj_hyps_filtered_ = filtered_hypotheses[0];
+    all_obj_hyps_ = all_hypotheses[0];
     cluster_.reset();
 }
 
@@ -664,7 +664,7 @@ HypothesisVerification<ModelT, SceneT>::initialize()
     elapsed_time_.push_back( std::pair<std::string, float>( "number of hypotheses",  num_hypotheses)) ;
 
     {
-        StopWatch t("Downsampling scene cloud");
+        StopWatch t("Downsampling scene cloud", elapsed_time_);
         downsampleSceneCloud();
     }
 
@@ -691,7 +691,7 @@ HypothesisVerification<ModelT, SceneT>::initialize()
     {
 #pragma omp section
         {
-            StopWatch t("Computing octree");
+            StopWatch t("Computing octree", elapsed_time_);
             octree_scene_downsampled_.reset(new pcl::octree::OctreePointCloudSearch<SceneT>( param_.resolution_mm_ / 1000.0));
             octree_scene_downsampled_->setInputCloud(scene_cloud_downsampled_);
             octree_scene_downsampled_->addPointsFromInputCloud();
@@ -699,14 +699,14 @@ HypothesisVerification<ModelT, SceneT>::initialize()
 
 #pragma omp section
         {
-            StopWatch t("Computing kd-tree");
+            StopWatch t("Computing kd-tree", elapsed_time_);
             kdtree_scene_.reset( new pcl::search::KdTree<SceneT>);
             kdtree_scene_->setInputCloud (scene_cloud_downsampled_);
         }
 
 #pragma omp section
         {
-            StopWatch t("Computing octrees for model visibility computation");
+            StopWatch t("Computing octrees for model visibility computation", elapsed_time_);
             for(size_t i=0; i<obj_hypotheses_groups_.size(); i++)
             {
                 for(size_t jj=0; jj<obj_hypotheses_groups_[i].size(); jj++)
@@ -736,7 +736,7 @@ HypothesisVerification<ModelT, SceneT>::initialize()
             occlusion_clouds_.push_back(scene_cloud_);
         else
         {
-            StopWatch t("Input point cloud of scene is not organized. Doing depth-buffering to get organized point cloud");
+            StopWatch t("Input point cloud of scene is not organized. Doing depth-buffering to get organized point cloud", elapsed_time_);
             ZBuffering<SceneT> zbuf (cam_);
             typename pcl::PointCloud<SceneT>::Ptr organized_cloud (new pcl::PointCloud<SceneT>);
             zbuf.renderPointCloud( *scene_cloud_, *organized_cloud );
@@ -752,7 +752,7 @@ HypothesisVerification<ModelT, SceneT>::initialize()
 #pragma omp section
         {
             {
-                StopWatch t("Computing visible model points (1st run)");
+                StopWatch t("Computing visible model points (1st run)", elapsed_time_);
 #pragma omp parallel for schedule(dynamic)
                 for(size_t i=0; i<obj_hypotheses_groups_.size(); i++)
                 {
@@ -768,7 +768,7 @@ HypothesisVerification<ModelT, SceneT>::initialize()
             {
                 {
                     std::stringstream desc; desc << "Pose refinement with " << param_.icp_iterations_ << " ICP iterations";
-                    StopWatch t(desc.str());
+                    StopWatch t(desc.str(), elapsed_time_);
 #pragma omp parallel for schedule(dynamic)
                     for(size_t i=0; i<obj_hypotheses_groups_.size(); i++)
                     {
@@ -781,7 +781,7 @@ HypothesisVerification<ModelT, SceneT>::initialize()
                 }
 
                 {
-                    StopWatch t("Computing visible model points (2nd run)");
+                    StopWatch t("Computing visible model points (2nd run)", elapsed_time_);
 #pragma omp parallel for schedule(dynamic)
                     for(size_t i=0; i<obj_hypotheses_groups_.size(); i++)
                     {
@@ -801,6 +801,7 @@ HypothesisVerification<ModelT, SceneT>::initialize()
                             num_visible_object_points+=rm.visible_cloud_->points.size();
                         }
                     }
+#pragma omp critical (hv_elapsed_time)
                     elapsed_time_.push_back( std::pair<std::string, float>( "visible object points",  num_visible_object_points));
                 }
             }
@@ -818,7 +819,7 @@ HypothesisVerification<ModelT, SceneT>::initialize()
 //            }
 
             { //used for checking pairwise intersection of objects (relate amount of overlapping pixel of their 2D silhouette)
-                StopWatch t("Computing 2D silhouette of visible object model");
+                StopWatch t("Computing 2D silhouette of visible object model", elapsed_time_);
 #pragma omp parallel for schedule(dynamic)
                 for(size_t i=0; i<obj_hypotheses_groups_.size(); i++)
                 {
@@ -831,7 +832,7 @@ HypothesisVerification<ModelT, SceneT>::initialize()
             }
 
             {
-                StopWatch t("Computing visible octree nodes");
+                StopWatch t("Computing visible octree nodes", elapsed_time_);
 #pragma omp parallel for schedule(dynamic)
                 for(size_t i=0; i<obj_hypotheses_groups_.size(); i++)
                 {
@@ -850,7 +851,7 @@ HypothesisVerification<ModelT, SceneT>::initialize()
         {
             if(param_.check_smooth_clusters_)
             {
-                StopWatch t("Extracting smooth clusters");
+                StopWatch t("Extracting smooth clusters", elapsed_time_);
                 extractEuclideanClustersSmooth();
             }
         }
@@ -858,7 +859,7 @@ HypothesisVerification<ModelT, SceneT>::initialize()
 #pragma omp section
         if(!param_.ignore_color_even_if_exists_)
         {
-            StopWatch t("Converting scene color values");
+            StopWatch t("Converting scene color values", elapsed_time_);
             colorTransf_->convert(*scene_cloud_downsampled_, scene_color_channels_);
 //            scene_color_channels_.col(0) = (scene_color_channels_.col(0) - Eigen::VectorXf::Ones(scene_color_channels_.rows())*50.f) / 50.f;
 //            scene_color_channels_.col(1) = scene_color_channels_.col(1) / 150.f;
@@ -868,7 +869,7 @@ HypothesisVerification<ModelT, SceneT>::initialize()
 
 
     {
-        StopWatch t("Converting model color values");
+        StopWatch t("Converting model color values", elapsed_time_);
         for(size_t i=0; i<obj_hypotheses_groups_.size(); i++)
         {
             for(size_t jj=0; jj<obj_hypotheses_groups_[i].size(); jj++)
@@ -893,7 +894,7 @@ HypothesisVerification<ModelT, SceneT>::initialize()
     }
 
     {
-        StopWatch t("Computing model to scene fitness");
+        StopWatch t("Computing model to scene fitness", elapsed_time_);
 #pragma omp parallel for schedule(dynamic)
         for(size_t i=0; i<obj_hypotheses_groups_.size(); i++)
         {
@@ -971,7 +972,7 @@ HypothesisVerification<ModelT, SceneT>::initialize()
         return;
 
     {
-        StopWatch t("Computing pairwise intersection");
+        StopWatch t("Computing pairwise intersection", elapsed_time_);
         computePairwiseIntersection();
     }
 
@@ -1016,7 +1017,7 @@ HypothesisVerification<ModelT, SceneT>::optimize ()
     {
     case HV_OptimizationType::LocalSearch:
     {
-        StopWatch t ("local search");
+        StopWatch t("local search", elapsed_time_);
         neigh.UseReplaceMoves(false);
         mets::local_search<GHVmove_manager<ModelT, SceneT> > local ( model, *(cost_logger_.get()), neigh, 0, false);
         local.search ();
@@ -1025,7 +1026,7 @@ HypothesisVerification<ModelT, SceneT>::optimize ()
     }
     case HV_OptimizationType::TabuSearch:
     {
-        StopWatch t ("TABU search");
+        StopWatch t("TABU search", elapsed_time_);
         mets::simple_tabu_list tabu_list ( 5 * global_hypotheses_.size()) ;  // ( initial_solution.size() * sqrt ( 1.0*initial_solution.size() ) ) ;
         mets::best_ever_criteria aspiration_criteria ;
 
@@ -1039,7 +1040,7 @@ HypothesisVerification<ModelT, SceneT>::optimize ()
     }
     case HV_OptimizationType::TabuSearchWithLSRM:
     {
-        StopWatch t("TABU search + LS (RM)");
+        StopWatch t("TABU search + LS (RM)", elapsed_time_);
         GHVmove_manager<ModelT, SceneT> neigh4 ( false);
         neigh4.setIntersectionCost(intersection_cost_);
 
@@ -1062,7 +1063,7 @@ HypothesisVerification<ModelT, SceneT>::optimize ()
     }
     case HV_OptimizationType::SimulatedAnnealing:
     {
-        StopWatch t ("SA search");
+        StopWatch t("SA search", elapsed_time_);
         //Simulated Annealing
         //mets::linear_cooling linear_cooling;
         mets::exponential_cooling linear_cooling;
@@ -1103,7 +1104,7 @@ HypothesisVerification<ModelT, SceneT>::verify()
     elapsed_time_.clear();
 
     {
-        StopWatch t("Verification of object hypotheses");
+        StopWatch t("Verification of object hypotheses", elapsed_time_);
         initialize();
     }
 
@@ -1111,7 +1112,7 @@ HypothesisVerification<ModelT, SceneT>::verify()
         visualize_cues_during_logger_ = boost::bind(&HypothesisVerification<ModelT, SceneT>::visualizeGOcues, this, _1, _2, _3);
 
     {
-        StopWatch t("Optimizing object hypotheses verification cost function");
+        StopWatch t("Optimizing object hypotheses verification cost function", elapsed_time_);
         optimize ();
     }
 
@@ -1299,9 +1300,6 @@ HypothesisVerification<ModelT, SceneT>::computeModelFitness(HVRecognitionModel<M
     VLOG(1) << "model fit of " << rm.oh_->model_id_ << ": " << rm.model_fit_ << " (normalized: " << rm.model_fit_/rm.visible_cloud_->points.size() << ").";
 }
 
-template<typename ModelT, typename SceneT>
-std::vector<std::pair<std::string,float> > HypothesisVerification<ModelT, SceneT>::elapsed_time_;
-
 #define PCL_INSTANTIATE_HypothesisVerification(ModelT, SceneT) template class V4R_EXPORTS HypothesisVerification<ModelT, SceneT>;
 PCL_INSTANTIATE_PRODUCT(HypothesisVerification, ((pcl::PointXYZRGB))((pcl::PointXYZRGB)) )
 
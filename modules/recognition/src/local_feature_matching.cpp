@@ -5,8 +5,6 @@
 #include <v4r/recognition/local_feature_matching.h>
 
 #include <boost/filesystem.hpp>
-#include <boost/archive/binary_oarchive.hpp>
-#include <boost/archive/binary_iarchive.hpp>
 
 #include <pcl/common/time.h>
 #include <pcl/common/transforms.h>
@@ -85,9 +83,93 @@ LocalFeatureMatcher<PointT>::visualizeKeypoints(const std::vector<KeypointIndex>
     vis->spin();
 }
 
+template<typename PointT>
+boost::dynamic_bitset<>
+LocalFeatureMatcher<PointT>::computeBoundaryMask (const typename pcl::PointCloud<PointT>::ConstPtr &cloud) const
+{
+    pcl::ScopeTime t("Computing boundary points");
+
+    if(!cloud->isOrganized())
+    {
+        LOG(ERROR) << "Input scene is not organized so cannot extract edge points.";
+        return boost::dynamic_bitset<>();
+    }
+
+    //compute depth discontinuity edges
+    pcl_1_8::OrganizedEdgeBase<PointT, pcl::Label> oed;
+    oed.setDepthDisconThreshold (0.05f); //at 1m, adapted linearly with depth
+    oed.setMaxSearchNeighbors(100);
+    oed.setEdgeType (  pcl_1_8::OrganizedEdgeBase<PointT, pcl::Label>::EDGELABEL_OCCLUDING
+                     | pcl_1_8::OrganizedEdgeBase<PointT, pcl::Label>::EDGELABEL_OCCLUDED
+                     | pcl_1_8::OrganizedEdgeBase<PointT, pcl::Label>::EDGELABEL_NAN_BOUNDARY
+                     );
+    oed.setInputCloud (cloud);
+
+    pcl::PointCloud<pcl::Label> labels;
+    std::vector<pcl::PointIndices> edge_indices;
+    oed.compute (labels, edge_indices);
+
+    cv::Mat boundary_mask = cv::Mat_<unsigned char>::zeros(cloud->height, cloud->width);
+    for (size_t j = 0; j < edge_indices.size (); j++)
+    {
+        for (size_t i = 0; i < edge_indices[j].indices.size (); i++)
+        {
+            int idx = edge_indices[j].indices[i];
+            int u = idx%cloud->width;
+            int v = idx/cloud->width;
+
+            boundary_mask.at<unsigned char>(v,u) = 255;
+        }
+    }
+
+    cv::Mat element = cv::getStructuringElement( cv::MORPH_ELLIPSE,
+                                                 cv::Size( 2*param_.boundary_width_ + 1, 2*param_.boundary_width_+1 ),
+                                                 cv::Point( param_.boundary_width_, param_.boundary_width_ ) );
+    cv::Mat boundary_mask_dilated;
+    cv::dilate( boundary_mask, boundary_mask_dilated, element );
+
+    boost::dynamic_bitset<> mask ( cloud->points.size(), 0);
+    for(size_t idx=0; idx<cloud->points.size(); idx++)
+    {
+        if ( boundary_mask_dilated.at<unsigned char>(idx/cloud->width, idx%cloud->width) )
+            mask.set(idx);
+    }
+    return mask;
+}
+
 template<typename PointT>
 std::vector<int>
 LocalFeatureMatcher<PointT>::getInlier (const std::vector<KeypointIndex> &input_keypoints) const
+{
+    if (input_keypoints.empty() )
+        return std::vector<int>();
+
+    boost::dynamic_bitset<> boundary_mask;
+    if (param_.filter_border_pts_)
+        boundary_mask = computeBoundaryMask(scene_);
+
+    return getInlier(scene_, input_keypoints, boundary_mask);
+}
+
+template<typename PointT>
+std::vector<int>
+LocalFeatureMatcher<PointT>::getInlier (LocalTrainingView<PointT> &view, const std::vector<KeypointIndex> &input_keypoints) const
+{
+    if (input_keypoints.empty() )
+        return std::vector<int>();
+
+    if ( param_.filter_border_pts_ && !view.boundary_masks_.count(param_.boundary_width_) )
+        view.boundary_masks_[param_.boundary_width_] = computeBoundaryMask(view.cloud_);
+
+    static const boost::dynamic_bitset<> no_mask;
+    return getInlier(view.cloud_, input_keypoints, param_.filter_border_pts_ ? view.boundary_masks_[param_.boundary_width_] : no_mask);
+}
+
+template<typename PointT>
+std::vector<int>
+LocalFeatureMatcher<PointT>::getInlier (const typename pcl::PointCloud<PointT>::ConstPtr &cloud,
+                                        const std::vector<KeypointIndex> &input_keypoints,
+                                        const boost::dynamic_bitset<> &boundary_mask) const
 {
     if (input_keypoints.empty() )
         return std::vector<int>();
@@ -95,15 +177,12 @@ LocalFeatureMatcher<PointT>::getInlier (const std::vector<KeypointIndex> &input_
     boost::dynamic_bitset<> kp_is_kept(input_keypoints.size());
     kp_is_kept.set();
 
-//    if(visualize_keypoints_)
-//        keypoint_indices_unfiltered_ = input_keypoints;
-
     if(param_.filter_planar_)
     {
         pcl::ScopeTime tt("Computing planar keypoints");
         typename pcl::search::KdTree<PointT>::Ptr tree (new pcl::search::KdTree<PointT>);
         pcl::NormalEstimationOMP<PointT, pcl::Normal> normalEstimation;
-        normalEstimation.setInputCloud(scene_);
+        normalEstimation.setInputCloud(cloud);
         boost::shared_ptr< std::vector<int> > IndicesPtr (new std::vector<int>);
         *IndicesPtr = input_keypoints;
         normalEstimation.setIndices(IndicesPtr);
@@ -119,69 +198,13 @@ LocalFeatureMatcher<PointT>::getInlier (const std::vector<KeypointIndex> &input_
         }
     }
 
-    if (param_.filter_border_pts_)
+    if (param_.filter_border_pts_ && !boundary_mask.empty())
     {
-        pcl::ScopeTime t("Computing boundary points");
-        if(scene_->isOrganized())
+        for(size_t i=0; i<input_keypoints.size(); i++)
         {
-            //compute depth discontinuity edges
-            pcl_1_8::OrganizedEdgeBase<PointT, pcl::Label> oed;
-            oed.setDepthDisconThreshold (0.05f); //at 1m, adapted linearly with depth
-            oed.setMaxSearchNeighbors(100);
-            oed.setEdgeType (  pcl_1_8::OrganizedEdgeBase<PointT, pcl::Label>::EDGELABEL_OCCLUDING
-                             | pcl_1_8::OrganizedEdgeBase<PointT, pcl::Label>::EDGELABEL_OCCLUDED
-                             | pcl_1_8::OrganizedEdgeBase<PointT, pcl::Label>::EDGELABEL_NAN_BOUNDARY
-                             );
-            oed.setInputCloud (scene_);
-
-            pcl::PointCloud<pcl::Label> labels;
-            std::vector<pcl::PointIndices> edge_indices;
-            oed.compute (labels, edge_indices);
-
-            // count indices to allocate memory beforehand
-            size_t kept=0;
-            for (size_t j = 0; j < edge_indices.size (); j++)
-                kept += edge_indices[j].indices.size ();
-
-            std::vector<int> discontinuity_edges (kept);
-
-            kept=0;
-            for (size_t j = 0; j < edge_indices.size (); j++)
-            {
-                for (size_t i = 0; i < edge_indices[j].indices.size (); i++)
-                    discontinuity_edges[kept++] = edge_indices[j].indices[i];
-            }
-
-            cv::Mat boundary_mask = cv::Mat_<unsigned char>::zeros(scene_->height, scene_->width);
-            for(size_t i=0; i<discontinuity_edges.size(); i++)
-            {
-                int idx = discontinuity_edges[i];
-                int u = idx%scene_->width;
-                int v = idx/scene_->width;
-
-                boundary_mask.at<unsigned char>(v,u) = 255;
-            }
-
-
-            cv::Mat element = cv::getStructuringElement( cv::MORPH_ELLIPSE,
-                                                         cv::Size( 2*param_.boundary_width_ + 1, 2*param_.boundary_width_+1 ),
-                                                         cv::Point( param_.boundary_width_, param_.boundary_width_ ) );
-            cv::Mat boundary_mask_dilated;
-            cv::dilate( boundary_mask, boundary_mask_dilated, element );
-
-            kept=0;
-            for(size_t i=0; i<input_keypoints.size(); i++)
-            {
-                int idx = input_keypoints[i];
-                int u = idx%scene_->width;
-                int v = idx/scene_->width;
-
-                if ( boundary_mask_dilated.at<unsigned char>(v,u) )
-                    kp_is_kept.reset(i);
-            }
+            if ( boundary_mask[ input_keypoints[i] ] )
+                kp_is_kept.reset(i);
         }
-        else
-           LOG(ERROR) << "Input scene is not organized so cannot extract edge points.";
     }
 
     return createIndicesFromMask<int>( kp_is_kept);
@@ -191,7 +214,17 @@ template<typename PointT>
 std::vector<int>
 LocalFeatureMatcher<PointT>::extractKeypoints (const std::vector<int> &region_of_interest)
 {
-    if(keypoint_extractor_.empty())
+    return extractKeypoints(scene_, scene_normals_, region_of_interest, keypoint_extractor_);
+}
+
+template<typename PointT>
+std::vector<int>
+LocalFeatureMatcher<PointT>::extractKeypoints (const typename pcl::PointCloud<PointT>::ConstPtr &cloud,
+                                               const pcl::PointCloud<pcl::Normal>::ConstPtr &normals,
+                                               const std::vector<int> &region_of_interest,
+                                               const std::vector<typename KeypointExtractor<PointT>::Ptr > &keypoint_extractors) const
+{
+    if(keypoint_extractors.empty())
     {
         LOG(INFO) << "No keypoint extractor given. Using all points as point of interest.";
         return std::vector<int>();
@@ -199,15 +232,15 @@ LocalFeatureMatcher<PointT>::extractKeypoints (const std::vector<int> &region_of
 
     pcl::ScopeTime t("Extracting all keypoints with filtering");
     boost::dynamic_bitset<> obj_mask;
-    boost::dynamic_bitset<> kp_mask ( scene_->points.size(), 0);
+    boost::dynamic_bitset<> kp_mask ( cloud->points.size(), 0);
 
     if( region_of_interest.empty() )    // if empty take whole cloud
     {
-        obj_mask.resize( scene_->points.size(), 0);
+        obj_mask.resize( cloud->points.size(), 0);
         obj_mask.set();
     }
     else
-        obj_mask = createMaskFromIndices(region_of_interest, scene_->points.size());
+        obj_mask = createMaskFromIndices(region_of_interest, cloud->points.size());
 
     bool estimator_need_normals = false;
     for(const typename LocalEstimator<PointT>::ConstPtr &est : estimators_)
@@ -219,10 +252,10 @@ LocalFeatureMatcher<PointT>::extractKeypoints (const std::vector<int> &region_of
         }
     }
 
-    for (typename KeypointExtractor<PointT>::Ptr ke : keypoint_extractor_)
+    for (const typename KeypointExtractor<PointT>::Ptr &ke : keypoint_extractors)
     {
-        ke->setInputCloud (scene_);
-        ke->setNormals (scene_normals_);
+        ke->setInputCloud (cloud);
+        ke->setNormals (normals);
         ke->compute ();
 
         const std::vector<int> kp_indices = ke->getKeypointIndices();
@@ -231,9 +264,9 @@ LocalFeatureMatcher<PointT>::extractKeypoints (const std::vector<int> &region_of
         // belong to the Region of Interest and are not planar (if planarity filter is on)
         for(int idx : kp_indices)
         {
-            if(     obj_mask[idx] && pcl::isFinite( scene_->points[idx] ) &&
-                    ( !estimator_need_normals || pcl::isFinite(scene_normals_->points[idx]))
-                    && scene_->points[idx].getVector3fMap().norm() < param_.max_keypoint_distance_z_ )
+            if(     obj_mask[idx] && pcl::isFinite( cloud->points[idx] ) &&
+                    ( !estimator_need_normals || pcl::isFinite(normals->points[idx]))
+                    && cloud->points[idx].getVector3fMap().norm() < param_.max_keypoint_distance_z_ )
             {
                 kp_mask.set( idx );
             }
@@ -242,264 +275,543 @@ LocalFeatureMatcher<PointT>::extractKeypoints (const std::vector<int> &region_of
     return createIndicesFromMask<int>(kp_mask);
 }
 
+template<typename PointT>
+typename LocalTrainingView<PointT>::Ptr
+LocalTrainingViewCache<PointT>::loadView (const Model<PointT> &m, const TrainingView<PointT> &tv, NormalEstimator<PointT> &ne) const
+{
+    typename LocalTrainingView<PointT>::Ptr view (new LocalTrainingView<PointT>);
+    view->filename_ = tv.filename_;
+
+    if(tv.cloud_)   // point cloud and all relevant information is already in memory (fast but needs a much memory when a lot of training views/objects)
+    {
+        view->cloud_ = tv.cloud_;
+        view->normals_ = tv.normals_;
+        view->obj_indices_ = tv.indices_;
+        view->pose_ = tv.pose_;
+        return view;
+    }
+
+    typename pcl::PointCloud<PointT>::Ptr cloud (new pcl::PointCloud<PointT>);
+    pcl::io::loadPCDFile(tv.filename_, *cloud);
+
+    try
+    {
+        view->pose_ = io::readMatrixFromFile(tv.pose_filename_);
+    }
+    catch (const std::runtime_error &e)
+    {
+        LOG(ERROR) << "Could not read pose from file " << tv.pose_filename_ << "! Setting it to identity" << std::endl;
+        view->pose_ = Eigen::Matrix4f::Identity();
+    }
+
+    // read object mask from file
+    if ( !io::existsFile( tv.indices_filename_ ) )
+    {
+        LOG(WARNING) << "No object indices " << tv.indices_filename_ << " found for object " << m.class_ <<
+                     "/" << m.id_ << " / " << tv.filename_ << "! Taking whole cloud as object of interest!" << std::endl;
+    }
+    else
+    {
+        std::ifstream mi_f ( tv.indices_filename_ );
+        int idx;
+        while ( mi_f >> idx )
+           view->obj_indices_.push_back(idx);
+        mi_f.close();
+
+        boost::dynamic_bitset<> obj_mask = createMaskFromIndices( view->obj_indices_, cloud->points.size() );
+        for(size_t px=0; px<cloud->points.size(); px++)
+        {
+            if( !obj_mask[px] )
+            {
+                PointT &p = cloud->points[px];
+                p.x = p.y = p.z = std::numeric_limits<float>::quiet_NaN();
+            }
+        }
+    }
+
+    view->cloud_ = cloud;
+
+    // always needs normals since we never know if correspondence grouping does!
+    ne.setInputCloud( cloud );
+    view->normals_ = ne.compute();
+    return view;
+}
+
+template<typename PointT>
+void
+LocalTrainingViewCache<PointT>::load (const std::vector<typename Model<PointT>::ConstPtr> &models, bool individual_views)
+{
+    if(!individual_views)
+    {
+        std::vector<typename Model<PointT>::ConstPtr> missing;
+        for(const typename Model<PointT>::ConstPtr &m : models)
+        {
+            if( !full_models_.count(m->id_) )
+                missing.push_back(m);
+        }
+
+        std::vector<typename LocalTrainingView<PointT>::Ptr> loaded ( missing.size() );
+
+#pragma omp parallel for schedule(dynamic)
+        for(size_t i=0; i<missing.size(); i++)
+        {
+            loaded[i].reset( new LocalTrainingView<PointT> );
+            loaded[i]->filename_ = missing[i]->id_;
+            loaded[i]->cloud_ = missing[i]->getAssembled(1);
+            loaded[i]->normals_ = missing[i]->getNormalsAssembled(1);
+        }
+
+        for(size_t i=0; i<missing.size(); i++)
+            full_models_[ missing[i]->id_ ] = loaded[i];
+
+        return;
+    }
+
+    CHECK( normal_estimator_ ) << "No normal estimator set for computing surface normals of the training views!";
+
+    // flatten views of all models such that the work is shared over views and models
+    std::vector<typename Model<PointT>::ConstPtr> view_models;
+    std::vector<typename TrainingView<PointT>::ConstPtr> training_views;
+    for(const typename Model<PointT>::ConstPtr &m : models)
+    {
+        if( views_.count(m->id_) )
+            continue;
+
+        for(const typename TrainingView<PointT>::ConstPtr &tv : m->getTrainingViews())
+        {
+            view_models.push_back(m);
+            training_views.push_back(tv);
+        }
+        views_[m->id_];
+    }
+
+    // one copy of the normal estimator per thread (if it can not be copied, normals are computed sequentially)
+    const int num_threads = omp_get_max_threads();
+    std::vector<typename NormalEstimator<PointT>::Ptr> normal_estimators (num_threads);
+    bool concurrent_normals = true;
+    for(int t=0; t<num_threads && concurrent_normals; t++)
+    {
+        normal_estimators[t] = normal_estimator_->clone();
+        concurrent_normals = (bool)normal_estimators[t];
+    }
+
+    std::vector<typename LocalTrainingView<PointT>::Ptr> loaded ( training_views.size() );
+
+#pragma omp parallel for schedule(dynamic)
+    for(size_t i=0; i<training_views.size(); i++)
+    {
+        std::string txt = "Loading training view " + view_models[i]->class_ + "/" + view_models[i]->id_ + "/" + training_views[i]->filename_;
+        pcl::ScopeTime t( txt.c_str() );
+
+        if(concurrent_normals)
+            loaded[i] = loadView( *view_models[i], *training_views[i], *normal_estimators[ omp_get_thread_num() ] );
+        else
+        {
+#pragma omp critical (training_view_normals)
+            loaded[i] = loadView( *view_models[i], *training_views[i], *normal_estimator_ );
+        }
+    }
+
+    for(size_t i=0; i<training_views.size(); i++)
+        views_[ view_models[i]->id_ ].push_back( loaded[i] );
+}
+
+template<typename PointT>
+std::vector<typename LocalTrainingView<PointT>::Ptr>
+LocalTrainingViewCache<PointT>::getViews (const typename Model<PointT>::ConstPtr &m, bool individual_views)
+{
+    load( std::vector<typename Model<PointT>::ConstPtr>(1, m), individual_views );
+
+    if(!individual_views)
+        return std::vector<typename LocalTrainingView<PointT>::Ptr>(1, full_models_[m->id_]);
+
+    return views_[m->id_];
+}
+
+template<typename PointT>
+std::vector< std::vector<typename Model<PointT>::ConstPtr> >
+LocalTrainingViewCache<PointT>::makeBatches (const std::vector<typename Model<PointT>::ConstPtr> &models, bool individual_views)
+{
+    const size_t min_views_per_batch = 2 * omp_get_max_threads();
+
+    std::vector< std::vector<typename Model<PointT>::ConstPtr> > batches;
+    size_t views_in_batch = 0;
+
+    for(const typename Model<PointT>::ConstPtr &m : models)
+    {
+        if( batches.empty() || views_in_batch >= min_views_per_batch )
+        {
+            batches.push_back( std::vector<typename Model<PointT>::ConstPtr>() );
+            views_in_batch = 0;
+        }
+        batches.back().push_back(m);
+        views_in_batch += individual_views ? m->getTrainingViews().size() : 1;
+    }
+    return batches;
+}
+
+template<typename PointT>
+std::string
+LocalFeatureMatcher<PointT>::getKeypointCacheKey () const
+{
+    // keypoint extractors are identified by their type and parameters, so equally configured extractors
+    // (e.g. of different recognizers or after re-creating the pipeline) share cached keypoints
+    std::stringstream key;
+    for(const typename KeypointExtractor<PointT>::Ptr &ke : keypoint_extractor_)
+        key << ke->getKeypointExtractorName() << "(" << ke->getKeypointExtractorParameters() << ")_";
+
+    bool estimator_need_normals = false;
+    for(const typename LocalEstimator<PointT>::ConstPtr &est : estimators_)
+        estimator_need_normals |= est->needNormals();
+
+    key << estimator_need_normals << "_" << param_.max_keypoint_distance_z_ << "_"
+        << param_.filter_planar_ << "_" << param_.planar_support_radius_ << "_" << param_.threshold_planar_ << "_"
+        << param_.filter_border_pts_ << "_" << param_.boundary_width_;
+    return key.str();
+}
+
+template<typename PointT>
+void
+LocalFeatureMatcher<PointT>::computeTrainingKeypoints (const std::vector<typename LocalTrainingView<PointT>::Ptr> &views)
+{
+    const std::string key = getKeypointCacheKey();
+
+    std::vector<typename LocalTrainingView<PointT>::Ptr> missing;
+    for(const typename LocalTrainingView<PointT>::Ptr &view : views)
+    {
+        if( !view->keypoints_.count(key) )
+            missing.push_back(view);
+    }
+
+    if( missing.empty() )
+        return;
+
+    // keypoint extractors keep their result, so each thread needs its own copy
+    const int num_threads = omp_get_max_threads();
+    std::vector< std::vector<typename KeypointExtractor<PointT>::Ptr > > extractors (num_threads);
+    bool concurrent = true;
+    for(int t=0; t<num_threads && concurrent; t++)
+    {
+        for(const typename KeypointExtractor<PointT>::Ptr &ke : keypoint_extractor_)
+        {
+            typename KeypointExtractor<PointT>::Ptr ke_copy = ke->clone();
+            if(!ke_copy)
+            {
+                concurrent = false;
+                break;
+            }
+            extractors[t].push_back( ke_copy );
+        }
+    }
+
+    std::vector< std::vector<KeypointIndex> > unfiltered_keypoints ( missing.size() );
+    std::vector< std::vector<KeypointIndex> > filtered_keypoints ( missing.size() );
+
+#pragma omp parallel for schedule(dynamic) if(concurrent)
+    for(size_t i=0; i<missing.size(); i++)
+    {
+        LocalTrainingView<PointT> &view = *missing[i];
+        unfiltered_keypoints[i] = extractKeypoints( view.cloud_, view.normals_, view.obj_indices_,
+                                                    concurrent ? extractors[ omp_get_thread_num() ] : keypoint_extractor_ );
+        const std::vector<int> inlier = getInlier( view, unfiltered_keypoints[i] );
+        filtered_keypoints[i] = filterVector<KeypointIndex> (unfiltered_keypoints[i], inlier);
+    }
+
+    for(size_t i=0; i<missing.size(); i++)
+    {
+        missing[i]->keypoints_[key] = filtered_keypoints[i];
+
+        if( visualize_keypoints_ )
+        {
+            scene_ = missing[i]->cloud_;
+            scene_normals_ = missing[i]->normals_;
+            visualizeKeypoints(filtered_keypoints[i], unfiltered_keypoints[i]);
+        }
+    }
+}
+
 template<typename PointT>
 void
 LocalFeatureMatcher<PointT>::initialize (const std::string &trained_dir, bool retrain)
+{
+    beginTraining(trained_dir, retrain);
+
+    typename LocalTrainingViewCache<PointT>::Ptr cache = training_view_cache_;
+    if(!cache)
+        cache.reset( new LocalTrainingViewCache<PointT>(normal_estimator_) );
+
+    const std::vector< std::vector<typename Model<PointT>::ConstPtr> > batches =
+            LocalTrainingViewCache<PointT>::makeBatches( getModelsToTrain(), param_.train_on_individual_views_ );
+
+    for(const std::vector<typename Model<PointT>::ConstPtr> &batch : batches)
+    {
+        cache->load( batch, param_.train_on_individual_views_ );
+
+        for(const typename Model<PointT>::ConstPtr &m : batch)
+        {
+            trainModel( m, cache->getViews(m, param_.train_on_individual_views_) );
+
+            if( !training_view_cache_ )
+                cache->release(m->id_);
+        }
+    }
+
+    finishTraining();
+}
+
+template<typename PointT>
+void
+LocalFeatureMatcher<PointT>::beginTraining (const std::string &trained_dir, bool retrain)
 {
     CHECK ( m_db_ );
     validate();
-    lomdbs_.resize( estimators_.size() );
 
-    std::vector<typename Model<PointT>::ConstPtr> models = m_db_->getModels ();
+    trained_dir_ = trained_dir;
+    training_models_ = m_db_->getModels ();
+    trained_models_.clear();
+    trained_models_.resize( estimators_.size(), std::vector<TrainedModel>( training_models_.size() ) );
 
     for (size_t est_id=0; est_id < estimators_.size(); est_id++)
     {
-        LocalObjectModelDatabase::Ptr lomdb( new LocalObjectModelDatabase );
-        std::vector<FeatureDescriptor> all_signatures; ///< all signatures extracted from all objects in the model database
-
-        typename LocalEstimator<PointT>::Ptr &est = estimators_[est_id];
+        const typename LocalEstimator<PointT>::Ptr &est = estimators_[est_id];
 
-        for( typename Model<PointT>::ConstPtr m : models)
+        for (size_t m_id=0; m_id < training_models_.size(); m_id++)
         {
+            const typename Model<PointT>::ConstPtr &m = training_models_[m_id];
+
             bf::path trained_path_feat = trained_dir; // directory where feature descriptors and keypoints are stored
             trained_path_feat /= m->id_;
             trained_path_feat /= est->getFeatureDescriptorName() + est->getUniqueId();
 
-            std::vector<FeatureDescriptor> model_signatures;
-            pcl::PointCloud<pcl::PointXYZ>::Ptr model_keypoints (new pcl::PointCloud<pcl::PointXYZ>);
-            pcl::PointCloud<pcl::Normal>::Ptr model_kp_normals (new pcl::PointCloud<pcl::Normal>);
-
-            bf::path kp_path = trained_path_feat;
-            kp_path /= "keypoints.pcd";
-            bf::path kp_normals_path = trained_path_feat;
-            kp_normals_path /= "keypoint_normals.pcd";
-            bf::path signatures_path = trained_path_feat;
-            signatures_path /= "signatures.dat";
+            const bf::path kp_path = trained_path_feat / "keypoints.pcd";
+            const bf::path kp_normals_path = trained_path_feat / "keypoint_normals.pcd";
+            const bf::path signatures_path = trained_path_feat / "signatures.bin";
 
             if( !retrain && io::existsFile( kp_path) && io::existsFile( kp_normals_path ) && io::existsFile( signatures_path ) )
             {
-                pcl::io::loadPCDFile( kp_path.string(), *model_keypoints );
-                pcl::io::loadPCDFile( kp_normals_path.string(), *model_kp_normals );
-                ifstream is(signatures_path.string(), ios::binary);
-                boost::archive::binary_iarchive iar(is);
-                iar >> model_signatures;
-                is.close();
+                TrainedModel &tm = trained_models_[est_id][m_id];
+                tm.lom_.reset( new LocalObjectModel );
+                pcl::io::loadPCDFile( kp_path.string(), *tm.lom_->keypoints_ );
+                pcl::io::loadPCDFile( kp_normals_path.string(), *tm.lom_->kp_normals_ );
+                Eigen::read_binary( signatures_path.string(), tm.signatures_ );
+                tm.done_ = true;
             }
-            else
+        }
+    }
+}
+
+template<typename PointT>
+std::vector<typename Model<PointT>::ConstPtr>
+LocalFeatureMatcher<PointT>::getModelsToTrain () const
+{
+    std::vector<typename Model<PointT>::ConstPtr> models;
+
+    for (size_t m_id=0; m_id < training_models_.size(); m_id++)
+    {
+        for (size_t est_id=0; est_id < trained_models_.size(); est_id++)
+        {
+            if( !trained_models_[est_id][m_id].done_ )
+            {
+                models.push_back( training_models_[m_id] );
+                break;
+            }
+        }
+    }
+    return models;
+}
+
+template<typename PointT>
+void
+LocalFeatureMatcher<PointT>::trainModel (const typename Model<PointT>::ConstPtr &m,
+                                         const std::vector<typename LocalTrainingView<PointT>::Ptr> &views)
+{
+    size_t m_id = 0;
+    while( m_id < training_models_.size() && training_models_[m_id]->id_ != m->id_ )
+        m_id++;
+
+    CHECK( m_id < training_models_.size() ) << "Model " << m->id_ << " is not part of the model database!";
+
+    // keypoints do not depend on the feature estimator (SIFT detects its own keypoints)
+    if( !have_sift_estimator_ )
+        computeTrainingKeypoints( views );
+
+    const std::string keypoint_key = getKeypointCacheKey();
+
+    for (size_t est_id=0; est_id < estimators_.size(); est_id++)
+    {
+        TrainedModel &tm = trained_models_[est_id][m_id];
+        if( tm.done_ )
+            continue;
+
+        typename LocalEstimator<PointT>::Ptr &est = estimators_[est_id];
+
+        LocalDescriptorMatrix model_signatures;
+        pcl::PointCloud<pcl::PointXYZ>::Ptr model_keypoints (new pcl::PointCloud<pcl::PointXYZ>);
+        pcl::PointCloud<pcl::Normal>::Ptr model_kp_normals (new pcl::PointCloud<pcl::Normal>);
+        std::vector<Eigen::Matrix4f, Eigen::aligned_allocator<Eigen::Matrix4f> > existing_poses;
+
+        for(const typename LocalTrainingView<PointT>::Ptr &view : views)
+        {
+            std::string txt = "Training " + est->getFeatureDescriptorName() + " (with id \"" + est->getUniqueId() + "\") on view " + m->class_ + "/" + m->id_ + "/" + view->filename_;
+            pcl::ScopeTime t( txt.c_str() );
+
+            const Eigen::Matrix4f &pose = view->pose_;
+
+            bool similar_pose_exists = false;
+            for(const Eigen::Matrix4f &ep : existing_poses)
             {
-                const auto training_views = m->getTrainingViews();
-                std::vector<Eigen::Matrix4f, Eigen::aligned_allocator<Eigen::Matrix4f> > existing_poses;
+                Eigen::Vector3f v1 = pose.block<3,1>(0,0);
+                Eigen::Vector3f v2 = ep.block<3,1>(0,0);
+                v1.normalize();
+                v2.normalize();
+                float dotp = v1.dot(v2);
+                const Eigen::Vector3f crossp = v1.cross(v2);
 
-                if(param_.train_on_individual_views_)
+                float rel_angle_deg = acos(dotp) * 180.f / M_PI;
+                if (crossp(2) < 0)
+                    rel_angle_deg = 360.f - rel_angle_deg;
+
+
+                if (rel_angle_deg < param_.required_viewpoint_change_deg_)
                 {
-                    for(const auto &tv : training_views)
-                    {
-                        std::string txt = "Training " + est->getFeatureDescriptorName() + " (with id \"" + est->getUniqueId() + "\") on view " + m->class_ + "/" + m->id_ + "/" + tv->filename_;
-                        pcl::ScopeTime t( txt.c_str() );
-
-                        std::vector<int> obj_indices;
-
-                        Eigen::Matrix4f pose;
-                        if(tv->cloud_)   // point cloud and all relevant information is already in memory (fast but needs a much memory when a lot of training views/objects)
-                        {
-                            scene_ = tv->cloud_;
-                            scene_normals_ = tv->normals_;
-                            obj_indices = tv->indices_;
-                            pose = tv->pose_;
-                        }
-                        else
-                        {
-                            typename pcl::PointCloud<PointT>::Ptr cloud (new pcl::PointCloud<PointT>);
-                            pcl::io::loadPCDFile(tv->filename_, *cloud);
-
-                            try
-                            {
-                                pose = io::readMatrixFromFile(tv->pose_filename_);
-                            }
-                            catch (const std::runtime_error &e)
-                            {
-                                LOG(ERROR) << "Could not read pose from file " << tv->pose_filename_ << "! Setting it to identity" << std::endl;
-                                pose = Eigen::Matrix4f::Identity();
-                            }
-
-                            // read object mask from file
-                            obj_indices.clear();
-                            if ( !io::existsFile( tv->indices_filename_ ) )
-                            {
-                                LOG(WARNING) << "No object indices " << tv->indices_filename_ << " found for object " << m->class_ <<
-                                             "/" << m->id_ << " / " << tv->filename_ << "! Taking whole cloud as object of interest!" << std::endl;
-                            }
-                            else
-                            {
-                                std::ifstream mi_f ( tv->indices_filename_ );
-                                int idx;
-                                while ( mi_f >> idx )
-                                   obj_indices.push_back(idx);
-                                mi_f.close();
-
-                                boost::dynamic_bitset<> obj_mask = createMaskFromIndices( obj_indices, cloud->points.size() );
-                                for(size_t px=0; px<cloud->points.size(); px++)
-                                {
-                                    if( !obj_mask[px] )
-                                    {
-                                        PointT &p = cloud->points[px];
-                                        p.x = p.y = p.z = std::numeric_limits<float>::quiet_NaN();
-                                    }
-                                }
-                            }
-
-                            scene_ = cloud;
-
-                            if ( 1 ) // always needs normals since we never know if correspondence grouping does! ..... this->needNormals() )
-                            {
-                                normal_estimator_->setInputCloud( cloud );
-                                pcl::PointCloud<pcl::Normal>::Ptr normals;
-                                normals = normal_estimator_->compute();
-                                scene_normals_ = normals;
-                            }
-                        }
-
-
-                        bool similar_pose_exists = false;
-                        for(const Eigen::Matrix4f &ep : existing_poses)
-                        {
-                            Eigen::Vector3f v1 = pose.block<3,1>(0,0);
-                            Eigen::Vector3f v2 = ep.block<3,1>(0,0);
-                            v1.normalize();
-                            v2.normalize();
-                            float dotp = v1.dot(v2);
-                            const Eigen::Vector3f crossp = v1.cross(v2);
-
-                            float rel_angle_deg = acos(dotp) * 180.f / M_PI;
-                            if (crossp(2) < 0)
-                                rel_angle_deg = 360.f - rel_angle_deg;
-
-
-                            if (rel_angle_deg < param_.required_viewpoint_change_deg_)
-                            {
-                                similar_pose_exists = true;
-                                break;
-                            }
-                        }
-                        if(!similar_pose_exists)
-                        {
-                            std::vector<int> filtered_kp_indices;
-
-                            if( have_sift_estimator_ ) // for SIFT we do not need to extract keypoints explicitly
-                                filtered_kp_indices = obj_indices;
-                            else
-                            {
-                                const std::vector<KeypointIndex> keypoint_indices = extractKeypoints( obj_indices );
-                                std::vector<int> inlier = getInlier(keypoint_indices);
-                                filtered_kp_indices = filterVector<KeypointIndex> (keypoint_indices, inlier);
-
-                                if( visualize_keypoints_)
-                                    visualizeKeypoints(filtered_kp_indices, keypoint_indices);
-                            }
-
-                            std::vector<FeatureDescriptor> signatures_view;
-                            featureEncoding( *est, filtered_kp_indices, filtered_kp_indices, signatures_view);
-
-                            if( have_sift_estimator_ ) // for SIFT we do not need to extract keypoints explicitly
-                            {
-                                std::vector<int> inlier = getInlier(filtered_kp_indices);
-                                filtered_kp_indices = filterVector<KeypointIndex> (filtered_kp_indices, inlier);
-                                signatures_view = filterVector<FeatureDescriptor> (signatures_view, inlier);
-                            }
-
-                            if( filtered_kp_indices.empty() )
-                                continue;
-
-                            existing_poses.push_back(pose);
-                            LOG(INFO) << "Adding " << signatures_view.size() << " " << est->getFeatureDescriptorName() <<
-                                         " (with id \"" << est->getUniqueId() << ")\" descriptors to the model database. " << std::endl;
-
-                            CHECK(signatures_view.size() == filtered_kp_indices.size());
-
-                            pcl::PointCloud<pcl::PointXYZ> model_keypoints_tmp;
-                            pcl::PointCloud<pcl::Normal> model_keypoint_normals_tmp;
-                            pcl::copyPointCloud( *scene_, filtered_kp_indices, model_keypoints_tmp );
-                            pcl::copyPointCloud( *scene_normals_, filtered_kp_indices, model_keypoint_normals_tmp );
-                            pcl::transformPointCloud(model_keypoints_tmp, model_keypoints_tmp, pose);
-                            v4r::transformNormals(model_keypoint_normals_tmp, model_keypoint_normals_tmp, pose);
-                            *model_keypoints += model_keypoints_tmp;
-                            *model_kp_normals += model_keypoint_normals_tmp;
-                            model_signatures.insert(model_signatures.end(), signatures_view.begin(), signatures_view.end());
-
-                            indices_.clear();
-                        }
-                        else
-                            LOG(INFO) << "Ignoring view " << tv->filename_ << " because a similar camera pose exists.";
-                    }
+                    similar_pose_exists = true;
+                    break;
                 }
-                else
-                {
-                    scene_ = m->getAssembled(1);
-                    scene_normals_ = m->getNormalsAssembled(1);
+            }
 
-                    const std::vector<KeypointIndex> keypoint_indices = extractKeypoints( );
-                    std::vector<int> inlier = getInlier(keypoint_indices);
-                    std::vector<KeypointIndex> filtered_kp_indices = filterVector<KeypointIndex> (keypoint_indices, inlier);
+            if(similar_pose_exists)
+            {
+                LOG(INFO) << "Ignoring view " << view->filename_ << " because a similar camera pose exists.";
+                continue;
+            }
 
-                    if( visualize_keypoints_ )
-                        visualizeKeypoints(filtered_kp_indices, keypoint_indices);
+            scene_ = view->cloud_;
+            scene_normals_ = view->normals_;
 
-                    std::vector<FeatureDescriptor> signatures;
-                    featureEncoding( *est, filtered_kp_indices, filtered_kp_indices, signatures);
+            std::vector<int> filtered_kp_indices;
 
-                    if( filtered_kp_indices.empty() )
-                        continue;
+            if( have_sift_estimator_ ) // for SIFT we do not need to extract keypoints explicitly
+                filtered_kp_indices = view->obj_indices_;
+            else
+                filtered_kp_indices = view->keypoints_[keypoint_key];
 
-                    LOG(INFO) << "Adding " << signatures.size() << " " << est->getFeatureDescriptorName() <<
-                                 " (with id \"" << est->getUniqueId() << "\") descriptors to the model database. ";
+            LocalDescriptorMatrix signatures_view;
+            featureEncoding( *est, filtered_kp_indices, filtered_kp_indices, signatures_view);
 
-                    CHECK(signatures.size() == filtered_kp_indices.size());
+            if( have_sift_estimator_ ) // for SIFT we do not need to extract keypoints explicitly
+            {
+                std::vector<int> inlier = getInlier(*view, filtered_kp_indices);
+                filtered_kp_indices = filterVector<KeypointIndex> (filtered_kp_indices, inlier);
+                filterRows (signatures_view, inlier);
+            }
 
-                    pcl::PointCloud<pcl::PointXYZ> model_keypoints_tmp;
-                    pcl::PointCloud<pcl::Normal> model_keypoint_normals_tmp;
-                    pcl::copyPointCloud( *scene_, filtered_kp_indices, model_keypoints_tmp );
-                    pcl::copyPointCloud( *scene_normals_, filtered_kp_indices, model_keypoint_normals_tmp );
-                    *model_keypoints += model_keypoints_tmp;
-                    *model_kp_normals += model_keypoint_normals_tmp;
-                    model_signatures.insert(model_signatures.end(), signatures.begin(), signatures.end());
-                }
+            if( filtered_kp_indices.empty() )
+                continue;
+
+            existing_poses.push_back(pose);
+            LOG(INFO) << "Adding " << signatures_view.rows() << " " << est->getFeatureDescriptorName() <<
+                         " (with id \"" << est->getUniqueId() << ")\" descriptors to the model database. " << std::endl;
 
-                io::createDirForFileIfNotExist( kp_path.string() );
-                pcl::io::savePCDFileBinaryCompressed ( kp_path.string(), *model_keypoints);
-                pcl::io::savePCDFileBinaryCompressed ( kp_normals_path.string(), *model_kp_normals);
-                ofstream os( signatures_path.string() , ios::binary);
-                boost::archive::binary_oarchive oar(os);
-                oar << model_signatures;
-                os.close();
+            CHECK(signatures_view.rows() == (int)filtered_kp_indices.size());
+
+            pcl::PointCloud<pcl::PointXYZ> model_keypoints_tmp;
+            pcl::PointCloud<pcl::Normal> model_keypoint_normals_tmp;
+            pcl::copyPointCloud( *scene_, filtered_kp_indices, model_keypoints_tmp );
+            pcl::copyPointCloud( *scene_normals_, filtered_kp_indices, model_keypoint_normals_tmp );
+            if( param_.train_on_individual_views_ )
+            {
+                pcl::transformPointCloud(model_keypoints_tmp, model_keypoints_tmp, pose);
+                v4r::transformNormals(model_keypoint_normals_tmp, model_keypoint_normals_tmp, pose);
             }
+            *model_keypoints += model_keypoints_tmp;
+            *model_kp_normals += model_keypoint_normals_tmp;
+            model_signatures.conservativeResize( model_signatures.rows() + signatures_view.rows(), signatures_view.cols() );
+            model_signatures.bottomRows( signatures_view.rows() ) = signatures_view;
+        }
+
+        bf::path trained_path_feat = trained_dir_; // directory where feature descriptors and keypoints are stored
+        trained_path_feat /= m->id_;
+        trained_path_feat /= est->getFeatureDescriptorName() + est->getUniqueId();
+
+        if( model_signatures.rows() )
+        {
+            const bf::path kp_path = trained_path_feat / "keypoints.pcd";
+            io::createDirForFileIfNotExist( kp_path.string() );
+            pcl::io::savePCDFileBinaryCompressed ( kp_path.string(), *model_keypoints);
+            pcl::io::savePCDFileBinaryCompressed ( (trained_path_feat / "keypoint_normals.pcd").string(), *model_kp_normals);
+            Eigen::write_binary( (trained_path_feat / "signatures.bin").string(), model_signatures );
+        }
+        else
+            LOG(WARNING) << "No " << est->getFeatureDescriptorName() << " signatures extracted for model " << m->id_ << "!";
+
+        tm.lom_.reset( new LocalObjectModel );
+        tm.lom_->keypoints_ = model_keypoints;
+        tm.lom_->kp_normals_ = model_kp_normals;
+        tm.signatures_.swap( model_signatures );
+        tm.done_ = true;
+    }
+
+    indices_.clear();
+}
+
+template<typename PointT>
+void
+LocalFeatureMatcher<PointT>::finishTraining ()
+{
+    lomdbs_.clear();
+    lomdbs_.resize( estimators_.size() );
 
-    //        assert(lom->keypoints_->points.size() == model_signatures.size());
+    for (size_t est_id=0; est_id < estimators_.size(); est_id++)
+    {
+        const typename LocalEstimator<PointT>::Ptr &est = estimators_[est_id];
+        LocalObjectModelDatabase::Ptr lomdb( new LocalObjectModelDatabase );
+
+        for (size_t m_id=0; m_id < training_models_.size(); m_id++)
+        {
+            const TrainedModel &tm = trained_models_[est_id][m_id];
+            const std::string &model_id = training_models_[m_id]->id_;
 
-            all_signatures.insert( all_signatures.end(), model_signatures.begin(), model_signatures.end() );
+            CHECK( tm.done_ ) << "Model " << model_id << " has not been trained for " << est->getFeatureDescriptorName() << "!";
 
-            std::vector<LocalObjectModelDatabase::flann_model> flann_models_tmp ( model_signatures.size() );
-            for (size_t f=0; f<model_signatures.size(); f++)
+            std::vector<LocalObjectModelDatabase::flann_model> flann_models_tmp ( tm.signatures_.rows() );
+            for (size_t f=0; f<flann_models_tmp.size(); f++)
             {
-                flann_models_tmp[f].model_id_ = m->id_;
+                flann_models_tmp[f].model_id_ = model_id;
                 flann_models_tmp[f].keypoint_id_ = f;
             }
             lomdb->flann_models_.insert ( lomdb->flann_models_.end(), flann_models_tmp.begin(), flann_models_tmp.end() );
+            lomdb->l_obj_models_[model_id] = tm.lom_;
+        }
 
-            LocalObjectModel::Ptr lom (new LocalObjectModel );
-            lom->keypoints_ = model_keypoints;
-            lom->kp_normals_ = model_kp_normals;
-            lomdb->l_obj_models_[m->id_] = lom;
+        // stack all model signatures into one contiguous block which is used by FLANN directly (no further copy)
+        size_t total_signatures = 0;
+        int feature_dims = 0;
+        for (size_t m_id=0; m_id < training_models_.size(); m_id++)
+        {
+            const LocalDescriptorMatrix &s = trained_models_[est_id][m_id].signatures_;
+            total_signatures += s.rows();
+            if( s.rows() )
+                feature_dims = s.cols();
         }
 
-        CHECK( lomdb->flann_models_.size() == all_signatures.size() );
+        CHECK( lomdb->flann_models_.size() == total_signatures );
+        CHECK( total_signatures > 0 ) << "No " << est->getFeatureDescriptorName() << " signatures found in the model database!";
 
-        lomdb->flann_data_.reset ( new flann::Matrix<float> (
-                                new float[ all_signatures.size() * all_signatures[0].size()],
-                all_signatures.size(), all_signatures[0].size()));
+        lomdb->all_signatures_.resize( total_signatures, feature_dims );
+        size_t row_offset = 0;
+        for (size_t m_id=0; m_id < training_models_.size(); m_id++)
+        {
+            LocalDescriptorMatrix &s = trained_models_[est_id][m_id].signatures_;
+            if( !s.rows() )
+                continue;
+            CHECK( s.cols() == lomdb->all_signatures_.cols() );
+            lomdb->all_signatures_.middleRows(row_offset, s.rows()) = s;
+            row_offset += s.rows();
+            s.resize(0,0);
+        }
 
-        for (size_t i = 0; i < lomdb->flann_data_->rows; i++)
-            for (size_t j = 0; j < lomdb->flann_data_->cols; j++)
-                lomdb->flann_data_->ptr()[i * lomdb->flann_data_->cols + j] = all_signatures[i][j];
+        lomdb->flann_data_.reset ( new flann::Matrix<float> ( lomdb->all_signatures_.data(),
+                                                              lomdb->all_signatures_.rows(), lomdb->all_signatures_.cols() ) );
 
         LOG(INFO) << "Building the kdtree index for " << lomdb->flann_data_->rows << " elements.";
 
@@ -528,6 +840,9 @@ LocalFeatureMatcher<PointT>::initialize (const std::string &trained_dir, bool re
         lomdbs_[est_id] = lomdb;
     }
 
+    trained_models_.clear();
+    training_models_.clear();
+
     mergeKeypointsFromMultipleEstimators();
     indices_.clear();
 }
@@ -573,40 +888,48 @@ LocalFeatureMatcher<PointT>::mergeKeypointsFromMultipleEstimators()
 template<typename PointT>
 void
 LocalFeatureMatcher<PointT>::featureMatching(const std::vector<KeypointIndex> &kp_indices,
-                                             const std::vector<FeatureDescriptor> &signatures,
+                                             const LocalDescriptorMatrix &signatures,
                                              const LocalObjectModelDatabase::ConstPtr &lomdb,
                                              size_t model_keypoint_offset)
 {
-    CHECK (signatures.size () == kp_indices.size() );
+    CHECK (signatures.rows () == (int)kp_indices.size() );
 
-    LOG(INFO) << "computing " << signatures.size () << " matches.";
+    LOG(INFO) << "computing " << signatures.rows () << " matches.";
 
-    int size_feat = signatures[0].size();
+    if( !signatures.rows() )
+        return;
 
-    ::flann::Matrix<float> distances (new float[param_.knn_], 1, param_.knn_);
-    ::flann::Matrix<int> indices (new int[param_.knn_], 1, param_.knn_);
-    ::flann::Matrix<float> query_desc (new float[size_feat], 1, size_feat);
+    CHECK( signatures.cols() == (int)lomdb->flann_data_->cols );
 
-    for (size_t idx = 0; idx < signatures.size (); idx++)
-    {
-        memcpy (&query_desc.ptr()[0], &signatures[idx][0], size_feat * sizeof(float));
+    // query all descriptors at once - FLANN reads the (row-major, contiguous) signatures in place and parallelizes over the rows
+    const size_t num_queries = signatures.rows();
+    ::flann::Matrix<float> query_desc (const_cast<float*>( signatures.data() ), num_queries, signatures.cols());
+    std::vector<float> distances_buf ( num_queries * param_.knn_ );
+    std::vector<int> indices_buf ( num_queries * param_.knn_ );
+    ::flann::Matrix<float> distances (distances_buf.data(), num_queries, param_.knn_);
+    ::flann::Matrix<int> indices (indices_buf.data(), num_queries, param_.knn_);
 
-        if(param_.distance_metric_==2)
-            lomdb->flann_index_l2_->knnSearch (query_desc, indices, distances, param_.knn_, ::flann::SearchParams (param_.kdtree_splits_));
-        else if(param_.distance_metric_==3)
-            lomdb->flann_index_chisquare_->knnSearch (query_desc, indices, distances, param_.knn_, ::flann::SearchParams (param_.kdtree_splits_));
-        else if(param_.distance_metric_==4)
-            lomdb->flann_index_hellinger_->knnSearch (query_desc, indices, distances, param_.knn_, ::flann::SearchParams (param_.kdtree_splits_));
-        else
-            lomdb->flann_index_l1_->knnSearch (query_desc, indices, distances, param_.knn_, ::flann::SearchParams (param_.kdtree_splits_));
+    ::flann::SearchParams search_param (param_.kdtree_splits_);
+    search_param.cores = 0; // use all available cores
 
-        if(distances[0][0] > param_.max_descriptor_distance_)
+    if(param_.distance_metric_==2)
+        lomdb->flann_index_l2_->knnSearch (query_desc, indices, distances, param_.knn_, search_param);
+    else if(param_.distance_metric_==3)
+        lomdb->flann_index_chisquare_->knnSearch (query_desc, indices, distances, param_.knn_, search_param);
+    else if(param_.distance_metric_==4)
+        lomdb->flann_index_hellinger_->knnSearch (query_desc, indices, distances, param_.knn_, search_param);
+    else
+        lomdb->flann_index_l1_->knnSearch (query_desc, indices, distances, param_.knn_, search_param);
+
+    for (size_t idx = 0; idx < num_queries; idx++)
+    {
+        if(distances[idx][0] > param_.max_descriptor_distance_)
             continue;
 
         for (size_t i = 0; i < param_.knn_; i++)
         {
-            const typename LocalObjectModelDatabase::flann_model &f = lomdb->flann_models_[ indices[0][i] ];
-            float m_dist = param_.correspondence_distance_weight_ * distances[0][i];
+            const typename LocalObjectModelDatabase::flann_model &f = lomdb->flann_models_[ indices[idx][i] ];
+            float m_dist = param_.correspondence_distance_weight_ * distances[idx][i];
 
             typename std::map<std::string, LocalObjectModel::ConstPtr >::const_iterator it = model_keypoints_.find( f.model_id_);
 //            const LocalObjectModel &m_kps = *(it->second);
@@ -632,10 +955,6 @@ LocalFeatureMatcher<PointT>::featureMatching(const std::vector<KeypointIndex> &k
             }
         }
     }
-
-    delete[] indices.ptr ();
-    delete[] distances.ptr ();
-    delete[] query_desc.ptr ();
 }
 
 template<typename PointT>
@@ -643,7 +962,7 @@ void
 LocalFeatureMatcher<PointT>::featureEncoding(LocalEstimator<PointT> &est,
                                              const std::vector<KeypointIndex> &keypoint_indices,
                                              std::vector<KeypointIndex> &filtered_keypoint_indices,
-                                             std::vector<FeatureDescriptor> &signatures )
+                                             LocalDescriptorMatrix &signatures )
 {
     {
         pcl::ScopeTime t("Feature Encoding");
@@ -654,32 +973,27 @@ LocalFeatureMatcher<PointT>::featureEncoding(LocalEstimator<PointT> &est,
         filtered_keypoint_indices = est.getKeypointIndices();
     }
 
-    CHECK ( filtered_keypoint_indices.size() == signatures.size() );
+    CHECK ( (int)filtered_keypoint_indices.size() == signatures.rows() );
 
     // remove signatures (with corresponding keypoints) with nan elements
-    size_t kept=0;
-    for(size_t sig_id=0; sig_id<signatures.size(); sig_id++)
+    int kept=0;
+    for(int sig_id=0; sig_id<signatures.rows(); sig_id++)
     {
-        bool keep_this = true;
-        for(size_t dim=0; dim< signatures[sig_id].size(); dim++)
+        if( !signatures.row(sig_id).allFinite() )
         {
-            if( std::isnan(signatures[sig_id][dim]) || !std::isfinite(signatures[sig_id][dim]) )
-            {
-                keep_this = false;
-                LOG(ERROR) << "DOES THIS REALLY HAPPEN?";
-                break;
-            }
+            LOG(ERROR) << "DOES THIS REALLY HAPPEN?";
+            continue;
         }
 
-        if(keep_this)
+        if( kept != sig_id )
         {
-            signatures[kept] = signatures[sig_id];
+            signatures.row(kept) = signatures.row(sig_id);
             filtered_keypoint_indices[kept] = filtered_keypoint_indices[sig_id];
-            kept++;
         }
+        kept++;
     }
     filtered_keypoint_indices.resize(kept);
-    signatures.resize(kept);
+    signatures.conservativeResize(kept, signatures.cols());
 }
 
 template<typename PointT>
@@ -703,14 +1017,14 @@ LocalFeatureMatcher<PointT>::recognize ()
         typename LocalEstimator<PointT>::Ptr &est = estimators_[est_id];
 
         std::vector<KeypointIndex> filtered_kp_indices_tmp;
-        std::vector<FeatureDescriptor> signatures_tmp;
+        LocalDescriptorMatrix signatures_tmp;
         featureEncoding( *est, filtered_kp_indices, filtered_kp_indices_tmp, signatures_tmp);
 
         if( have_sift_estimator_ ) // for SIFT we do not need to filter keypoints after detection (which includes kp extraction)
         {
             std::vector<int> inlier = getInlier(filtered_kp_indices_tmp);
             filtered_kp_indices_tmp = filterVector<KeypointIndex> (filtered_kp_indices_tmp, inlier);
-            signatures_tmp = filterVector<FeatureDescriptor> (signatures_tmp, inlier);
+            filterRows (signatures_tmp, inlier);
         }
 
         if( filtered_kp_indices_tmp.empty() )
@@ -729,6 +1043,7 @@ LocalFeatureMatcher<PointT>::recognize ()
 
 //template class V4R_EXPORTS LocalFeatureMatcher<pcl::PointXYZ>;
 template class V4R_EXPORTS LocalFeatureMatcher<pcl::PointXYZRGB>;
+template class V4R_EXPORTS LocalTrainingViewCache<pcl::PointXYZRGB>;
 }
 
 
@@ -5,6 +5,8 @@
 #include <pcl/common/time.h>
 #include <pcl/registration/transformation_estimation_svd.h>
 
+#include <set>
+
 namespace v4r
 {
 
@@ -17,13 +19,63 @@ LocalRecognitionPipeline<PointT>::initialize(const std::string &trained_dir, boo
     model_keypoints_.clear();   // need to merge model keypoints from all local recognizers ( like SIFT + SHOT + ...)
     model_kp_idx_range_start_.resize( local_feature_matchers_.size() );
 
+    // all local recognizers are trained on the same training views, which are therefore loaded and preprocessed only once
+    typename LocalTrainingViewCache<PointT>::Ptr cache (new LocalTrainingViewCache<PointT>(normal_estimator_));
+    std::vector< std::set<std::string> > models_to_train ( local_feature_matchers_.size() );
+    std::set<std::string> any_model_to_train;
+
     for(size_t i=0; i<local_feature_matchers_.size(); i++)
     {
         LocalFeatureMatcher<PointT> &r = *local_feature_matchers_[i];
         r.setNormalEstimator(normal_estimator_);
         r.setModelDatabase(m_db_);
         r.setVisualizationParameter(vis_param_);
-        r.initialize(trained_dir, force_retrain);
+        r.setTrainingViewCache(cache);
+        r.beginTraining(trained_dir, force_retrain);
+
+        for(const typename Model<PointT>::ConstPtr &m : r.getModelsToTrain())
+        {
+            models_to_train[i].insert(m->id_);
+            any_model_to_train.insert(m->id_);
+        }
+    }
+
+    std::vector<typename Model<PointT>::ConstPtr> models;
+    for(const typename Model<PointT>::ConstPtr &m : m_db_->getModels())
+    {
+        if( any_model_to_train.count(m->id_) )
+            models.push_back(m);
+    }
+
+    // train batches of models such that only their views need to be kept in memory
+    for(const std::vector<typename Model<PointT>::ConstPtr> &batch : LocalTrainingViewCache<PointT>::makeBatches(models, true))
+    {
+        for(size_t i=0; i<local_feature_matchers_.size(); i++)
+        {
+            LocalFeatureMatcher<PointT> &r = *local_feature_matchers_[i];
+
+            std::vector<typename Model<PointT>::ConstPtr> batch_to_train;
+            for(const typename Model<PointT>::ConstPtr &m : batch)
+            {
+                if( models_to_train[i].count(m->id_) )
+                    batch_to_train.push_back(m);
+            }
+
+            cache->load( batch_to_train, r.param_.train_on_individual_views_ );
+
+            for(const typename Model<PointT>::ConstPtr &m : batch_to_train)
+                r.trainModel( m, cache->getViews(m, r.param_.train_on_individual_views_) );
+        }
+
+        for(const typename Model<PointT>::ConstPtr &m : batch)
+            cache->release(m->id_);
+    }
+
+    for(size_t i=0; i<local_feature_matchers_.size(); i++)
+    {
+        LocalFeatureMatcher<PointT> &r = *local_feature_matchers_[i];
+        r.finishTraining();
+        r.setTrainingViewCache( typename LocalTrainingViewCache<PointT>::Ptr() );
 
         const std::map<std::string, typename LocalObjectModel::ConstPtr> lomdb_tmp = r.getModelKeypoints();
 
@@ -67,7 +119,7 @@ LocalRecognitionPipeline<PointT>::correspondenceGrouping ()
         const LocalObjectHypothesis<PointT> &loh = it->second;
 
         std::stringstream desc; desc << "Correspondence grouping for " << model_id << " ( " << loh.model_scene_corresp_->size() << ")" ;
-        typename RecognitionPipeline<PointT>::StopWatch t(desc.str());
+        typename RecognitionPipeline<PointT>::StopWatch t(desc.str(), elapsed_time_);
 
         pcl::PointCloud<pcl::PointXYZ>::Ptr model_keypoints = model_keypoints_[model_id]->keypoints_;
         pcl::PointCloud<pcl::Normal>::Ptr model_kp_normals = model_keypoints_[model_id]->kp_normals_;
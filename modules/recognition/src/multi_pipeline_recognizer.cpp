@@ -1,3 +1,6 @@
+#include <algorithm>
+#include <exception>
+
 #include <glog/logging.h>
 #include <omp.h>
 
@@ -20,35 +23,112 @@ MultiRecognitionPipeline<PointT>::initialize(const std::string &trained_dir, boo
 }
 
 
+template<typename PointT>
+std::vector<int>
+MultiRecognitionPipeline<PointT>::getThreadBudgets() const
+{
+    const int num_pipelines = recognition_pipelines_.size();
+    std::vector<int> budgets (num_pipelines, 0);
+
+    int remaining_threads = omp_get_max_threads();
+    int num_unassigned = 0;
+    for(int r_id=0; r_id < num_pipelines; r_id++)
+    {
+        if( r_id < (int)thread_budgets_.size() && thread_budgets_[r_id] > 0 )
+        {
+            budgets[r_id] = thread_budgets_[r_id];
+            remaining_threads -= thread_budgets_[r_id];
+        }
+        else
+            num_unassigned++;
+    }
+
+    // split the remaining threads equally (the first pipelines get the remainder)
+    remaining_threads = std::max(0, remaining_threads);
+    for(int r_id=0, i=0; r_id < num_pipelines; r_id++)
+    {
+        if( budgets[r_id] > 0 )
+            continue;
+
+        budgets[r_id] = std::max(1, remaining_threads / num_unassigned + (i < remaining_threads % num_unassigned ? 1 : 0) );
+        i++;
+    }
+
+    return budgets;
+}
+
 template<typename PointT>
 void
 MultiRecognitionPipeline<PointT>::do_recognize()
 {
-    omp_init_lock(&rec_lock_);
+    const int num_pipelines = recognition_pipelines_.size();
 
-//#pragma omp parallel for schedule(dynamic)
-    for(size_t r_id=0; r_id < recognition_pipelines_.size(); r_id++)
+    // pipelines only read the shared inputs, so they can be set up front and run independently
+    for(const typename RecognitionPipeline<PointT>::Ptr &r : recognition_pipelines_)
     {
-        typename RecognitionPipeline<PointT>::Ptr r = recognition_pipelines_[r_id];
         r->setInputCloud( scene_ );
         r->setSceneNormals( scene_normals_ );
 
         if( table_plane_set_ )
             r->setTablePlane( table_plane_ );
+    }
 
-        r->recognize();
+    const std::vector<int> budgets = getThreadBudgets();
+    const bool concurrent = num_pipelines > 1 && omp_get_max_threads() > 1 && !omp_in_parallel();
 
+    // allow one level of nesting so each pipeline can still parallelize internally within its own thread budget
+    const int max_active_levels = omp_get_max_active_levels();
+#if _OPENMP < 201811
+    const int nested = omp_get_nested();
+#endif
+    if( concurrent && max_active_levels < 2 )
+    {
+        omp_set_max_active_levels(2);
+#if _OPENMP < 201811
+        omp_set_nested(1);
+#endif
+    }
+
+    std::vector<std::exception_ptr> errors (num_pipelines);
+
+#pragma omp parallel for schedule(dynamic) num_threads( std::max(1, std::min(num_pipelines, omp_get_max_threads())) ) if(concurrent)
+    for(int r_id=0; r_id < num_pipelines; r_id++)
+    {
+        if( concurrent )
+            omp_set_num_threads( budgets[r_id] );
+
+        try
+        {
+            recognition_pipelines_[r_id]->recognize();
+        }
+        catch(...)
+        {
+            errors[r_id] = std::current_exception();
+        }
+    }
+
+    if( concurrent && max_active_levels < 2 )
+    {
+        omp_set_max_active_levels(max_active_levels);
+#if _OPENMP < 201811
+        omp_set_nested(nested);
+#endif
+    }
+
+    // merge results deterministically in the order the pipelines have been added
+    for(int r_id=0; r_id < num_pipelines; r_id++)
+    {
+        if( errors[r_id] )
+            std::rethrow_exception( errors[r_id] );
+
+        const typename RecognitionPipeline<PointT>::Ptr &r = recognition_pipelines_[r_id];
         std::vector<ObjectHypothesesGroup> oh_tmp = r->getObjectHypothesis();
-        omp_set_lock(&rec_lock_);
         obj_hypotheses_.insert( obj_hypotheses_.end(), oh_tmp.begin(), oh_tmp.end() );
-        omp_unset_lock(&rec_lock_);
 
         std::vector< std::pair<std::string,float> > elapsed_times_tmp = r->getElapsedTimes();
         elapsed_time_.insert( elapsed_time_.end(), elapsed_times_tmp.begin(), elapsed_times_tmp.end() );
     }
 
-    omp_destroy_lock(&rec_lock_);
-
     table_plane_set_ = false;
 }
 
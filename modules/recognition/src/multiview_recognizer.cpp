@@ -35,6 +35,9 @@ MultiviewRecognizer<PointT>::do_recognize()
     recognition_pipeline_->recognize();
     v.obj_hypotheses_ = recognition_pipeline_->getObjectHypothesis();
 
+    std::vector< std::pair<std::string,float> > elapsed_times_tmp = recognition_pipeline_->getElapsedTimes();
+    elapsed_time_.insert( elapsed_time_.end(), elapsed_times_tmp.begin(), elapsed_times_tmp.end() );
+
     table_plane_set_ = false;
 
     obj_hypotheses_ = v.obj_hypotheses_;
@@ -502,7 +505,7 @@ MultiviewRecognizer<PointT>::correspondenceGrouping ()
         const LocalObjectHypothesis<PointT> &loh = it->second;
 
         std::stringstream desc; desc << "Correspondence grouping for " << model_id << " ( " << loh.model_scene_corresp_->size() << ")" ;
-        typename RecognitionPipeline<PointT>::StopWatch t(desc.str());
+        typename RecognitionPipeline<PointT>::StopWatch t(desc.str(), elapsed_time_);
 
         pcl::PointCloud<pcl::PointXYZ>::Ptr model_keypoints = model_keypoints_[model_id]->keypoints_;
         pcl::PointCloud<pcl::Normal>::Ptr model_kp_normals = model_keypoints_[model_id]->kp_normals_;
@@ -4,9 +4,6 @@
 namespace v4r
 {
 
-template<typename PointT>
-std::vector<std::pair<std::string,float> > RecognitionPipeline<PointT>::elapsed_time_;
-
 #define PCL_INSTANTIATE_RecognitionPipeline(T) template class V4R_EXPORTS RecognitionPipeline<T>;
 PCL_INSTANTIATE(RecognitionPipeline, (pcl::PointXYZRGB))
 
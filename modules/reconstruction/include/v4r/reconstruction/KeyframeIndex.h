@@ -0,0 +1,84 @@
+/**
+ * $Id$
+ * 
+ * Software License Agreement (GNU General Public License)
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef KP_KEYFRAME_INDEX_HH
+#define KP_KEYFRAME_INDEX_HH
+
+#include <vector>
+#include <utility>
+#include <opencv2/core/core.hpp>
+#include <v4r/common/impl/SmartPtr.hpp>
+#include <v4r/core/macros.h>
+
+namespace v4r
+{
+
+/**
+ * KeyframeIndex
+ * Incrementally built codebook (leader clustering of the keyframe descriptors) with an
+ * inverted file, used to rank the keyframes for relocalization (tf-idf voting).
+ * The size of the codebook is bounded, so that quantization does not depend on the map size.
+ */
+class V4R_EXPORTS KeyframeIndex
+{
+public:
+  class V4R_EXPORTS Parameter
+  {
+  public:
+    float thr_desc;           // max. descriptor distance to a codeword, otherwise a new word is created
+    int max_words;            // if the codebook is full descriptors are assigned to the nearest word
+    Parameter(float _thr_desc=0.55, int _max_words=10000)
+    : thr_desc(_thr_desc), max_words(_max_words) {}
+  };
+
+private:
+  Parameter param;
+
+  float sqr_thr_desc;
+  cv::Mat_<float> words;
+  std::vector< std::vector< std::pair<int,int> > > inv_file;   // word -> <view_idx, count>
+  std::vector<int> view_nb_words;
+  int nb_views;
+
+  int getNearestWord(const float *d, float &sqr_dist) const;
+
+public:
+  KeyframeIndex(const Parameter &p=Parameter());
+  ~KeyframeIndex();
+
+  void clear();
+  void addView(const cv::Mat &descs, int view_idx);
+  void query(const cv::Mat &descs, std::vector< std::pair<int,float> > &view_rank, int k) const;
+
+  inline int getNumberOfWords() const { return words.rows; }
+  inline int getNumberOfViews() const { return nb_views; }
+
+  typedef SmartPtr< ::v4r::KeyframeIndex> Ptr;
+  typedef SmartPtr< ::v4r::KeyframeIndex const> ConstPtr;
+};
+
+
+
+/*************************** INLINE METHODES **************************/
+
+} //--END--
+
+#endif
+
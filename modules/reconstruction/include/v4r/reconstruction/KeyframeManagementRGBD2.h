@@ -37,13 +37,17 @@
 #include <fstream>
 #include <float.h>
 #include <Eigen/Dense>
+#include <Eigen/StdVector>
 #include <opencv2/core/core.hpp>
 #include <boost/thread/mutex.hpp>
 #include <boost/thread.hpp>
 #include <v4r/keypoints/impl/Object.hpp>
 #include <v4r/reconstruction/ProjLKPoseTrackerRT.h>
 #include <v4r/reconstruction/KeypointPoseDetectorRT.h>
+#include <v4r/reconstruction/KeyframeIndex.h>
+#include <v4r/reconstruction/ProjBundleAdjuster.h>
 #include <v4r/common/impl/SmartPtr.hpp>
+#include <v4r/common/impl/SPSCQueue.hpp>
 #include <v4r/common/impl/DataMatrix2D.hpp>
 #include <v4r/features/FeatureDetector_KD_FAST_IMGD.h>
 #include <v4r/common/ZAdaptiveNormals.h>
@@ -79,17 +83,27 @@ public:
     ZAdaptiveNormals::Parameter n_param;
     KeypointPoseDetectorRT::Parameter kd_param;
     ProjLKPoseTrackerRT::Parameter kt_param;
+    int nb_reloc_candidates;       // number of keyframes (ranked by the keyframe index) tried for relocalization
+    KeyframeIndex::Parameter ki_param;
+    bool optimize_window;          // sliding window bundle adjustment after each new keyframe
+    ProjBundleAdjuster::Parameter ba_param;
     Parameter(unsigned _min_model_points=50, double _max_dist_tracking_view=2., 
       int _min_not_reliable_poses=5, float _inl_dist_px=2, 
       double _min_dist_add_proj=0.02, double _min_conf=.2, double _dist_err_loop=0.02,
       const FeatureDetector_KD_FAST_IMGD::Parameter &_det_param= FeatureDetector_KD_FAST_IMGD::Parameter(300,1.44,3,17,3),
       const ZAdaptiveNormals::Parameter &_n_param= ZAdaptiveNormals::Parameter(0.02,5,true,0.005125,0.003),
       const KeypointPoseDetectorRT::Parameter &_kd_param = KeypointPoseDetectorRT::Parameter(),
-      const ProjLKPoseTrackerRT::Parameter &_kt_param= ProjLKPoseTrackerRT::Parameter() )
+      const ProjLKPoseTrackerRT::Parameter &_kt_param= ProjLKPoseTrackerRT::Parameter(),
+      int _nb_reloc_candidates=5,
+      const KeyframeIndex::Parameter &_ki_param=KeyframeIndex::Parameter(),
+      bool _optimize_window=false,
+      const ProjBundleAdjuster::Parameter &_ba_param=ProjBundleAdjuster::Parameter() )
     : min_model_points(_min_model_points), max_dist_tracking_view(_max_dist_tracking_view),
       min_not_reliable_poses(_min_not_reliable_poses), inl_dist_px(_inl_dist_px),
       min_dist_add_proj(_min_dist_add_proj), min_conf(_min_conf), dist_err_loop(_dist_err_loop),
-      det_param(_det_param), n_param(_n_param), kd_param(_kd_param), kt_param(_kt_param) {}
+      det_param(_det_param), n_param(_n_param), kd_param(_kd_param), kt_param(_kt_param),
+      nb_reloc_candidates(_nb_reloc_candidates), ki_param(_ki_param),
+      optimize_window(_optimize_window), ba_param(_ba_param) {}
   };
 
   /**
@@ -99,27 +113,40 @@ public:
   {
   public:
     boost::mutex mtx_shm;
+
+    inline void lock() { mtx_shm.lock(); }
+    inline void unlock() { mtx_shm.unlock(); }
+  };
+
+  /**
+   * Keyframe handed over to the management thread (move only)
+   */
+  class V4R_EXPORTS Keyframe
+  {
+  public:
     Eigen::Matrix4f pose;
     cv::Mat_<unsigned char> image;
     DataMatrix2D<Eigen::Vector3f> cloud;
-  
     int view_idx;
     std::vector< std::pair<int,cv::Point2f> > im_pts;
 
-    unsigned nb_add;
-    bool process_view;
-
-    inline void lock() { mtx_shm.lock(); }
-    inline void unlock() { mtx_shm.unlock(); }
-    inline void copyTo(Shm &data) {
-      data.pose = pose;
-      image.copyTo(data.image);
-      data.cloud = cloud;
-      data.view_idx = view_idx;
-      data.im_pts = im_pts;
+    Keyframe() : pose(Eigen::Matrix4f::Identity()), view_idx(-1) {}
+    Keyframe(Keyframe &&kf) : pose(Eigen::Matrix4f::Identity()), view_idx(-1) { *this = std::move(kf); }
+    Keyframe(const Keyframe &kf) = delete;
+    Keyframe &operator=(const Keyframe &kf) = delete;
+    inline Keyframe &operator=(Keyframe &&kf) {
+      pose = kf.pose;
+      image = kf.image;           // shallow
+      kf.image = cv::Mat_<unsigned char>();
+      std::swap(cloud.rows, kf.cloud.rows);
+      std::swap(cloud.cols, kf.cloud.cols);
+      cloud.data.swap(kf.cloud.data);
+      view_idx = kf.view_idx;
+      im_pts.swap(kf.im_pts);
+      return *this;
     }
 
-    Shm() : nb_add(0), process_view(false) {}
+    EIGEN_MAKE_ALIGNED_OPERATOR_NEW
   };
 
  
@@ -136,7 +163,6 @@ private:
   // ---- end dbg ----
 
   bool run, have_thread;
-  unsigned nb_add;
   double sqr_max_dist_tracking_view;
   double sqr_dist_err_loop;
   int cnt_not_reliable_pose;
@@ -146,7 +172,13 @@ private:
   Eigen::Matrix4f last_reliable_pose;
 
   Shm shm;
-  Shm local_data;
+  SPSCQueue<Keyframe, Eigen::aligned_allocator<Keyframe> > kf_queue;
+  Keyframe local_data;
+
+  // relocalization
+  boost::mutex mtx_index;
+  KeyframeIndex::Ptr kf_index;
+  std::vector< std::pair<int,float> > reloc_rank;
 
   // create view links (loops)
   bool loop_in_progress;
@@ -169,6 +201,7 @@ private:
   ZAdaptiveNormals::Ptr nest;
   ProjLKPoseTrackerRT::Ptr kpTracker;
   KeypointPoseDetectorRT::Ptr kpDetector;
+  ProjBundleAdjuster::Ptr ba;
 
   std::vector< std::pair<int,cv::Point2f> > im_pts;
 
@@ -179,13 +212,15 @@ private:
   void getPoints3D(const DataMatrix2D<Eigen::Vector3f> &cloud, 
           const std::vector< std::pair<int,cv::Point2f> > &im_pts, 
           std::vector<Eigen::Vector3f> &points);
-  bool createView(Shm &data, ObjectView::Ptr &view_ptr);
+  bool createView(Keyframe &data, ObjectView::Ptr &view_ptr);
   int getGlobalCorrespondences(const std::vector<unsigned> glob_indices,  
           const std::vector< std::pair<int,cv::Point2f> > &im_pts, 
           std::vector<cv::KeyPoint> &keys, std::vector<unsigned> &points,
           std::vector<cv::Point2f> &im_points);
   int selectGuidedRandom(const Eigen::Matrix4f &pose);
+  int selectIndexed(const cv::Mat &query_descs);
   bool closeLoops();
+  void optimizeWindow();
 
 
 
@@ -210,7 +245,8 @@ public:
   void addKeyframe(const cv::Mat &image, const DataMatrix2D<Eigen::Vector3f> &cloud, 
         const Eigen::Matrix4f &pose, int view_idx, 
         const std::vector< std::pair<int,cv::Point2f> > &im_pts);
-  bool getTrackingModel(ObjectView &view, Eigen::Matrix4f &view_pose, const Eigen::Matrix4f &current_pose, bool is_reliable_pose);
+  bool getTrackingModel(ObjectView &view, Eigen::Matrix4f &view_pose, const Eigen::Matrix4f &current_pose, bool is_reliable_pose,
+        const cv::Mat &query_descs=cv::Mat());
 
   int addProjections(const DataMatrix2D<Eigen::Vector3f> &cloud, const Eigen::Matrix4f &pose, int view_idx, const std::vector< std::pair<int,cv::Point2f> > &im_pts);
 
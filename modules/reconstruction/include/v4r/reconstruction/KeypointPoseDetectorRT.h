@@ -105,6 +105,9 @@ public:
 
   void setModel(const ObjectView::Ptr &_model);
 
+  /** descriptors of the last detect call (e.g. to query a keyframe index) **/
+  inline const cv::Mat &getDescriptors() const { return descs; }
+
 
   typedef SmartPtr< ::v4r::KeypointPoseDetectorRT> Ptr;
   typedef SmartPtr< ::v4r::KeypointPoseDetectorRT const> ConstPtr;
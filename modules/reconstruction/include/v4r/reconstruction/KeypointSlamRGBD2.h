@@ -105,6 +105,7 @@ private:
   cv::Mat_<double> intrinsic;
   
   cv::Mat_<unsigned char> im_gray;
+  LKPyramid::Ptr im_pyr;
 
   ObjectView::Ptr view;
   Eigen::Matrix4f view_pose, delta_pose;
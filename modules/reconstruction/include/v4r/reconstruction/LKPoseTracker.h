@@ -43,6 +43,7 @@
 #include <Eigen/Dense>
 #include <v4r/common/impl/SmartPtr.hpp>
 #include <v4r/keypoints/impl/Object.hpp>
+#include <v4r/keypoints/LKPyramid.h>
 
 
 namespace v4r 
@@ -80,7 +81,7 @@ public:
 private:
   Parameter param;
 
-  cv::Mat_<unsigned char> im_gray, im_last;
+  LKPyramid::Ptr pyr_last;
   std::vector< cv::Point2f > im_points0, im_points1;
   std::vector< int > inliers;
 
@@ -116,9 +117,12 @@ public:
   ~LKPoseTracker();
 
   void setLastFrame(const cv::Mat &image, const Eigen::Matrix4f &pose);
+  void setLastFrame(const LKPyramid::Ptr &pyr, const Eigen::Matrix4f &pose);
   double detectIncremental(const cv::Mat &image, Eigen::Matrix4f &pose);
+  double detectIncremental(const LKPyramid::Ptr &pyr, Eigen::Matrix4f &pose);
 
   double detect(const cv::Mat &image, Eigen::Matrix4f &pose);
+  double detect(const LKPyramid::Ptr &pyr, Eigen::Matrix4f &pose);
 
   void setModel(const ObjectView::Ptr &_model);
   void setCameraParameter(const cv::Mat &_intrinsic, const cv::Mat &_dist_coeffs);
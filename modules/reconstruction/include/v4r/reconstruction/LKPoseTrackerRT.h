@@ -45,6 +45,7 @@
 #include <v4r/keypoints/RigidTransformationRANSAC.h>
 #include <v4r/common/impl/DataMatrix2D.hpp>
 #include <v4r/keypoints/impl/Object.hpp>
+#include <v4r/keypoints/LKPyramid.h>
 
 
 namespace v4r
@@ -79,7 +80,7 @@ public:
 private:
   Parameter param;
 
-  cv::Mat_<unsigned char> im_gray, im_last;
+  LKPyramid::Ptr pyr_last;
   std::vector< cv::Point2f > im_points0, im_points1;
   std::vector< int > inliers;
   Eigen::Matrix4f last_pose;
@@ -106,7 +107,11 @@ public:
   ~LKPoseTrackerRT();
 
   double detectIncremental(const cv::Mat &im, const DataMatrix2D<Eigen::Vector3f> &cloud, Eigen::Matrix4f &pose);
+  double detectIncremental(const LKPyramid::Ptr &pyr, const DataMatrix2D<Eigen::Vector3f> &cloud, Eigen::Matrix4f &pose);
   void setLastFrame(const cv::Mat &image, const Eigen::Matrix4f &pose);
+  void setLastFrame(const LKPyramid::Ptr &pyr, const Eigen::Matrix4f &pose);
+
+  inline const Parameter &getParameter() const { return param; }
 
 
   void setModel(const ObjectView::Ptr &_model);
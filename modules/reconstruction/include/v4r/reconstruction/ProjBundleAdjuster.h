@@ -37,6 +37,9 @@
 #include <fstream>
 #include <float.h>
 #include <math.h>
+#include <map>
+#include <list>
+#include <boost/shared_ptr.hpp>
 #include <opencv2/core/core.hpp>
 #include <Eigen/Dense>
 #ifndef KP_NO_CERES_AVAILABLE
@@ -62,31 +65,76 @@ public:
     double depth_error_weight;
     double depth_inl_dist;
     double depth_cut_off;
+    int max_iterations;               // full bundle adjustment (optimize)
+    int max_iterations_incremental;   // warm started solves of optimizeIncremental
+    int window_size;                  // number of keyframes kept in the incremental problem (<=0 .. unbounded)
+    double prior_weight;              // weight per marginalized observation of the point priors
     Parameter(bool _optimize_intrinsic=false, bool _optimize_dist_coeffs=false, 
       bool _use_depth_prior=true, double _depth_error_weight=100., 
-      double _depth_inl_dist=0.02, double _depth_cut_off=2.) 
+      double _depth_inl_dist=0.02, double _depth_cut_off=2.,
+      int _max_iterations=100, int _max_iterations_incremental=10,
+      int _window_size=10, double _prior_weight=10.)
     : optimize_intrinsic(_optimize_intrinsic), optimize_dist_coeffs(_optimize_dist_coeffs),
       use_depth_prior(_use_depth_prior), depth_error_weight(_depth_error_weight), 
-      depth_inl_dist(_depth_inl_dist), depth_cut_off(_depth_cut_off)  {}
+      depth_inl_dist(_depth_inl_dist), depth_cut_off(_depth_cut_off),
+      max_iterations(_max_iterations), max_iterations_incremental(_max_iterations_incremental),
+      window_size(_window_size), prior_weight(_prior_weight) {}
   };
   class Camera
   {
   public:
     int idx;
     Eigen::Matrix<double, 6, 1> pose_Rt;
+    EIGEN_MAKE_ALIGNED_OPERATOR_NEW
   };
 
 private:
+  typedef std::map<int, Camera, std::less<int>, Eigen::aligned_allocator<std::pair<const int, Camera> > > CameraMap;
+
+  class PointPrior
+  {
+  public:
+    ceres::ResidualBlockId id;
+    double weight;
+    PointPrior() : id(0), weight(0.) {}
+  };
+
   Parameter param;
 
   double sqr_depth_inl_dist;
 
   std::vector<Camera> cameras;
 
+  // persistent problem of the incremental (sliding window) bundle adjustment
+  boost::shared_ptr<ceres::Problem> inc_problem;
+  CameraMap inc_cameras;                                      // keyframes in the window
+  std::list<int> inc_window;                                  // camera indices, oldest first
+  std::map<unsigned, Eigen::Vector3d> inc_points;             // global point index -> parameter block
+  std::map<unsigned, int> inc_point_nb_res;                   // number of reprojection residuals per point
+  std::map<unsigned, PointPrior> inc_point_priors;
+  std::map<int, std::vector<double> > inc_intrinsics;
+  std::map<int, std::vector< std::pair<unsigned, ceres::ResidualBlockId> > > inc_cam_residuals;
+  std::vector< std::vector<unsigned> > inc_nb_projs;          // per view and point: projections already in the problem
+  int inc_nb_cameras;
+
+  // window entries of the data as handed to the solver by addIncremental (setIncremental skips entries changed since)
+  std::map<int, Eigen::Matrix4f, std::less<int>, Eigen::aligned_allocator<std::pair<const int, Eigen::Matrix4f> > > inc_cam_snapshot;
+  std::map<unsigned, Eigen::Vector3d> inc_point_snapshot;
+  std::map<int, std::vector<double> > inc_intrinsics_snapshot;
+
   void getCameras(const Object &data, std::vector<Camera> &cameras);
   void setCameras(const std::vector<Camera> &cameras, Object &data);
   void bundle(Object &data, std::vector<Camera> &cameras);
 
+  double *getIncIntrinsics(const Object &data, int cam_idx);
+  double *getIncPoint(const Object &data, unsigned glob_idx);
+  void addIncCamera(const Object &data, int cam_idx);
+  void addIncResidual(const Object &data, const triple<int, cv::Point2f, Eigen::Vector3f> &p, unsigned glob_idx);
+  void addIncPointPrior(unsigned glob_idx, int nb_obs);
+  void removeIncPoint(unsigned glob_idx);
+  bool syncIncremental(const Object &data);
+  void snapshotIncremental(const Object &data);
+
 
   inline void getR(const Eigen::Matrix4f &pose, Eigen::Matrix3d &R);
   inline void getT(const Eigen::Matrix4f &pose, Eigen::Vector3d &t);
@@ -100,8 +148,27 @@ public:
   ProjBundleAdjuster(const Parameter &p=Parameter());
   ~ProjBundleAdjuster();
 
+  /** full bundle adjustment of all cameras and points (resets the incremental problem) */
   void optimize(Object &data);
 
+  /** adds new keyframes/projections of data to the persistent problem, marginalizes keyframes
+   * leaving the window and runs a warm started solve on the remaining window **/
+  void optimizeIncremental(Object &data);
+  /** first step of optimizeIncremental: adds new keyframes/projections and marginalizes keyframes leaving
+   * the window (reads data), returns false if there is nothing to optimize **/
+  bool addIncremental(const Object &data);
+  /** second step: warm started solve of the window (does not access the data, i.e. a threaded
+   * mapping does not need to lock the model) **/
+  void solveIncremental();
+  /** last step: copies the optimized window (cameras, points, intrinsics) back to data, entries which have been
+   * changed in data since addIncremental (e.g. by the tracker or a loop closure) are kept **/
+  void setIncremental(Object &data);
+  /** removes a keyframe from the incremental problem (optionally keeping its information as point priors) **/
+  void removeKeyframe(int cam_idx, bool marginalize=true);
+  void resetIncremental();
+
+  inline int getNumberOfWindowKeyframes() const { return inc_window.size(); }
+
   typedef SmartPtr< ::v4r::ProjBundleAdjuster> Ptr;
   typedef SmartPtr< ::v4r::ProjBundleAdjuster const> ConstPtr;
 };
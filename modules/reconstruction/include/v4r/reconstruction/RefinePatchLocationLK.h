@@ -40,6 +40,7 @@
 #include <opencv2/core/core.hpp>
 #include <opencv2/imgproc/imgproc.hpp>
 #include <v4r/common/impl/SmartPtr.hpp>
+#include <v4r/reconstruction/impl/accumulateLKPatch.hpp>
 
 
 namespace v4r
@@ -71,26 +72,13 @@ private:
   cv::Mat_<unsigned char> im_gray;
   cv::Mat_<float> im_dx, im_dy;
 
-  cv::Mat_<float> patch_dx, patch_dy, diff, sum_dx, sum_dy;
-  cv::Mat_<unsigned char> roi_patch;
-  cv::Mat_<float> roi_dx, roi_dy;
-
-  cv::Mat_<unsigned char> im_src, im_tgt;
-  Eigen::Matrix4f pose_src, pose_tgt;
-  
-  void getIntensityDifference(const cv::Mat_<unsigned char> &im1, cv::Mat_<unsigned char> &im2, 
-        const cv::Point2f &pt1, const cv::Point2f &pt2, int width, int height, cv::Mat_<float> &diff);
-  void getGradientSum(const cv::Mat_<float> &dx1, const cv::Mat_<float> &dy1, const cv::Mat_<float> &dx2, 
-        const cv::Mat_<float> &dy2, const cv::Point2f &pt1, const cv::Point2f &pt2, int width, int height, 
-        cv::Mat_<float> &dx, cv::Mat_<float> &dy);
-  void getGradientMatrix22(const cv::Mat_<float> &dx, const cv::Mat_<float> &dy, float &gxx, float &gxy, float &gyy);
-  void getErrorVector2(const cv::Mat_<float> &diff, const cv::Mat_<float> &dx, const cv::Mat_<float> &dy, 
-        cv::Point2f &err);
-  bool solve(const cv::Point2f &err, float gxx, float gxy, float gyy, cv::Point2f &delta);
-
+  int num_threads;
+  LKPatchBuffer buf;
+  std::vector<LKPatchBuffer> buffers;   // scratch patches of the batched version, one per thread
 
-  inline float getInterpolated(const cv::Mat_<unsigned char> &im, const float &x, const float &y);
-  inline float getInterpolated(const cv::Mat_<float> &im, const float &x, const float &y);
+  bool optimize(const cv::Mat_<unsigned char> &patch, cv::Point2f &pt, LKPatchBuffer &_buf);
+  bool solve(const cv::Point2f &err, float gxx, float gxy, float gyy, cv::Point2f &delta);
+  inline bool isInside(const cv::Point2f &pt, int hw, int hh);
 
 
 public:
@@ -99,7 +87,9 @@ public:
   ~RefinePatchLocationLK();
 
   bool optimize(const cv::Mat_<unsigned char> &patch, cv::Point2f &pt);
+  void optimize(const std::vector< cv::Mat_<unsigned char> > &patches, std::vector<cv::Point2f> &pts, std::vector<int> &converged);
   void setImage(const cv::Mat_<unsigned char> &im);
+  void setNumberOfThreads(int n) { num_threads = n; }
 
   typedef SmartPtr< ::v4r::RefinePatchLocationLK> Ptr;
   typedef SmartPtr< ::v4r::RefinePatchLocationLK const> ConstPtr;
@@ -110,42 +100,17 @@ public:
 
 /*********************** INLINE METHODES **************************/
 
-/** 
- * getInterpolated
- * get a bilinear interpolated pixel
- */
-inline float RefinePatchLocationLK::getInterpolated(const cv::Mat_<unsigned char> &im, const float &x, const float &y)
-{
-  int xt = (int) x;
-  int yt = (int) y;
-  float ax = x - xt;
-  float ay = y - yt;
-
-  return ( (1.-ax) * (1.-ay) * im(yt,xt) + 
-            ax     * (1.-ay) * im(yt,xt+1) +
-           (1.-ax) *  ay     * im(yt+1,xt) +
-            ax     *  ay     * im(yt+1,xt+1) );
-}
-
-/** 
- * getInterpolated
- * get a bilinear interpolated pixel
+/**
+ * isInside
+ * check if the patch at pt (incl. the bilinear interpolation border) is inside the image
  */
-inline float RefinePatchLocationLK::getInterpolated(const cv::Mat_<float> &im, const float &x, const float &y)
+inline bool RefinePatchLocationLK::isInside(const cv::Point2f &pt, int hw, int hh)
 {
-  int xt = (int) x;
-  int yt = (int) y;
-  float ax = x - xt;
-  float ay = y - yt;
-
-  return ( (1.-ax) * (1.-ay) * im(yt,xt) + 
-            ax     * (1.-ay) * im(yt,xt+1) +
-           (1.-ax) *  ay     * im(yt+1,xt) +
-            ax     *  ay     * im(yt+1,xt+1) );
+  return !( pt.x-hw < 0.0f || im_gray.cols-(pt.x+hw) < 1.001 ||
+            pt.y-hh < 0.0f || im_gray.rows-(pt.y+hh) < 1.001 );
 }
 
 
-
 }
 
 #endif
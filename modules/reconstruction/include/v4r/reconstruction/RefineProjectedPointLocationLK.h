@@ -41,6 +41,7 @@
 #include <opencv2/imgproc/imgproc.hpp>
 #include <v4r/common/impl/SmartPtr.hpp>
 #include <v4r/reconstruction/RefineProjectedPointLocationLKbase.h>
+#include <v4r/reconstruction/impl/accumulateLKPatch.hpp>
 #include <v4r/core/macros.h>
 
 
@@ -92,20 +93,10 @@ private:
 
   std::vector<float> residuals;
 
-  void getIntensityDifference(const cv::Mat_<unsigned char> &im1, cv::Mat_<unsigned char> &im2, 
-        const cv::Point2f &pt1, const cv::Point2f &pt2, int width, int height, cv::Mat_<float> &diff);
-  void getPatchInterpolated(const cv::Mat_<unsigned char> &image, const cv::Point2f &pt, 
-        cv::Mat_<unsigned char> &patch, int width, int height);
-  void getGradientSum(const cv::Mat_<float> &dx1, const cv::Mat_<float> &dy1, const cv::Mat_<float> &dx2, 
-        const cv::Mat_<float> &dy2, const cv::Point2f &pt1, const cv::Point2f &pt2, int width, int height, 
-        cv::Mat_<float> &dx, cv::Mat_<float> &dy);
-  void getGradientMatrix22(const cv::Mat_<float> &dx, const cv::Mat_<float> &dy, float &gxx, float &gxy, float &gyy);
-  void getErrorVector2(const cv::Mat_<float> &diff, const cv::Mat_<float> &dx, const cv::Mat_<float> &dy, 
-        cv::Point2f &err);
-  bool solve(const cv::Point2f &err, float gxx, float gxy, float gyy, cv::Point2f &delta);
+  std::vector<LKPatchBuffer> buffers;   // scratch patches, one per thread
 
-  inline float getInterpolated(const cv::Mat_<unsigned char> &im, const float &x, const float &y);
-  inline float getInterpolated(const cv::Mat_<float> &im, const float &x, const float &y);
+  bool solve(const cv::Point2f &err, float gxx, float gxy, float gyy, cv::Point2f &delta);
+  inline bool isInside(const cv::Point2f &pt, int hw, int hh);
 
 
 public:
@@ -136,38 +127,14 @@ public:
 
 /*********************** INLINE METHODES **************************/
 
-/** 
- * getInterpolated
- * get a bilinear interpolated pixel
- */
-inline float RefineProjectedPointLocationLK::getInterpolated(const cv::Mat_<unsigned char> &im, const float &x, const float &y)
-{
-  int xt = (int) x;
-  int yt = (int) y;
-  float ax = x - xt;
-  float ay = y - yt;
-
-  return ( (1.-ax) * (1.-ay) * im(yt,xt) + 
-            ax     * (1.-ay) * im(yt,xt+1) +
-           (1.-ax) *  ay     * im(yt+1,xt) +
-            ax     *  ay     * im(yt+1,xt+1) );
-}
-
-/** 
- * getInterpolated
- * get a bilinear interpolated pixel
+/**
+ * isInside
+ * check if the patch at pt (incl. the bilinear interpolation border) is inside the target image
  */
-inline float RefineProjectedPointLocationLK::getInterpolated(const cv::Mat_<float> &im, const float &x, const float &y)
+inline bool RefineProjectedPointLocationLK::isInside(const cv::Point2f &pt, int hw, int hh)
 {
-  int xt = (int) x;
-  int yt = (int) y;
-  float ax = x - xt;
-  float ay = y - yt;
-
-  return ( (1.-ax) * (1.-ay) * im(yt,xt) + 
-            ax     * (1.-ay) * im(yt,xt+1) +
-           (1.-ax) *  ay     * im(yt+1,xt) +
-            ax     *  ay     * im(yt+1,xt+1) );
+  return !( pt.x-hw < 0.0f || im_tgt.cols-(pt.x+hw) < 1.001 ||
+            pt.y-hh < 0.0f || im_tgt.rows-(pt.y+hh) < 1.001 );
 }
 
 
@@ -468,6 +468,28 @@ struct RadialDistortionReprojectionAndDepthErrorGlobalPose {
   const double depth_err_weight;
 };
 
+// Cost functor which penalizes the deviation of a 3D point from a fixed
+// estimate. Used as (diagonal) prior for points whose observing cameras
+// have been marginalized from the sliding window of the bundle adjuster.
+struct PointPriorError {
+  PointPriorError(const double &_x, const double &_y, const double &_z, const double &_weight)
+      : x(_x), y(_y), z(_z), weight(_weight) {}
+
+  template <typename T>
+  bool operator()(const T* const X,    // Point coordinates 3x1.
+                  T* residuals) const {
+    residuals[0] = T(weight)*(X[0] - T(x));
+    residuals[1] = T(weight)*(X[1] - T(y));
+    residuals[2] = T(weight)*(X[2] - T(z));
+    return true;
+  }
+
+  const double x;
+  const double y;
+  const double z;
+  const double weight;
+};
+
 
 
 }
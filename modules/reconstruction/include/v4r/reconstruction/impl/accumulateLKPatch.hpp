@@ -0,0 +1,174 @@
+/**
+ * $Id$
+ * 
+ * Software License Agreement (GNU General Public License)
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef KP_ACCUMULATE_LK_PATCH_HPP
+#define KP_ACCUMULATE_LK_PATCH_HPP
+
+#include <vector>
+#include <cmath>
+#include <opencv2/core/core.hpp>
+#include <opencv2/imgproc/imgproc.hpp>
+
+namespace v4r
+{
+
+/**
+ * LKPatchBuffer
+ * scratch memory of the patch based lk refinement (one per thread). The template
+ * (interior of the patch without the 1 pixel sobel border) and its gradients are stored
+ * contiguously, so that the inner loops of accumulateLKPatch can be vectorized.
+ */
+class LKPatchBuffer
+{
+public:
+  int rows, cols;
+  cv::Mat_<float> patch_dx, patch_dy;
+  std::vector<float> tmpl, tmpl_dx, tmpl_dy;
+  std::vector<unsigned char> tmpl8, sample8;
+
+  LKPatchBuffer() : rows(0), cols(0) {}
+
+  /** set the template patch (the allocated memory is reused for patches of the same size) **/
+  inline void setTemplate(const cv::Mat_<unsigned char> &patch)
+  {
+    cv::Sobel( patch, patch_dx, CV_32F, 1, 0, 3, 1, 0, cv::BORDER_DEFAULT );
+    cv::Sobel( patch, patch_dy, CV_32F, 0, 1, 3, 1, 0, cv::BORDER_DEFAULT );
+
+    rows = patch.rows-2;
+    cols = patch.cols-2;
+    tmpl.resize(rows*cols);
+    tmpl_dx.resize(rows*cols);
+    tmpl_dy.resize(rows*cols);
+    tmpl8.resize(rows*cols);
+    sample8.resize(rows*cols);
+
+    for (int v=0; v<rows; v++)
+    {
+      const unsigned char *d = &patch(v+1,1);
+      const float *dx = &patch_dx(v+1,1);
+      const float *dy = &patch_dy(v+1,1);
+      for (int u=0; u<cols; u++)
+      {
+        tmpl[v*cols+u] = d[u];
+        tmpl8[v*cols+u] = d[u];
+        tmpl_dx[v*cols+u] = dx[u];
+        tmpl_dy[v*cols+u] = dy[u];
+      }
+    }
+  }
+};
+
+/**
+ * accumulateLKPatch
+ * Computes the gradient matrix [gxx gxy; gxy gyy] and the error vector of one lk step in a single pass.
+ * The image and its gradients are bilinearly sampled at pt (patch center), i.e. the interpolation
+ * weights are the same for all patch pixels. The caller needs to check the bounds.
+ */
+inline void accumulateLKPatch(const cv::Mat_<unsigned char> &im, const cv::Mat_<float> &im_dx, const cv::Mat_<float> &im_dy,
+                              const LKPatchBuffer &buf, const cv::Point2f &pt, float &gxx, float &gxy, float &gyy, cv::Point2f &err)
+{
+  const int xt = (int)pt.x - buf.cols/2;
+  const int yt = (int)pt.y - buf.rows/2;
+  const float ax = pt.x - (int)pt.x;
+  const float ay = pt.y - (int)pt.y;
+  const float w00 = (1.f-ax)*(1.f-ay), w01 = ax*(1.f-ay), w10 = (1.f-ax)*ay, w11 = ax*ay;
+
+  float sxx=0., sxy=0., syy=0., ex=0., ey=0.;
+
+  for (int v=0; v<buf.rows; v++)
+  {
+    const unsigned char *i0 = &im(yt+v,xt), *i1 = &im(yt+v+1,xt);
+    const float *dx0 = &im_dx(yt+v,xt), *dx1 = &im_dx(yt+v+1,xt);
+    const float *dy0 = &im_dy(yt+v,xt), *dy1 = &im_dy(yt+v+1,xt);
+    const float *t = &buf.tmpl[v*buf.cols];
+    const float *tdx = &buf.tmpl_dx[v*buf.cols];
+    const float *tdy = &buf.tmpl_dy[v*buf.cols];
+
+    #pragma omp simd reduction(+:sxx,sxy,syy,ex,ey)
+    for (int u=0; u<buf.cols; u++)
+    {
+      float d = w00*i0[u] + w01*i0[u+1] + w10*i1[u] + w11*i1[u+1] - t[u];
+      float gx = w00*dx0[u] + w01*dx0[u+1] + w10*dx1[u] + w11*dx1[u+1] + tdx[u];
+      float gy = w00*dy0[u] + w01*dy0[u+1] + w10*dy1[u] + w11*dy1[u+1] + tdy[u];
+      sxx += gx*gx;
+      sxy += gx*gy;
+      syy += gy*gy;
+      ex += d*gx;
+      ey += d*gy;
+    }
+  }
+
+  gxx = sxx; gxy = sxy; gyy = syy;
+  err = cv::Point2f(ex,ey);
+}
+
+/**
+ * getLKPatchResidual
+ * mean absolute intensity difference between the template and the image patch at pt
+ */
+inline float getLKPatchResidual(const cv::Mat_<unsigned char> &im, const LKPatchBuffer &buf, const cv::Point2f &pt)
+{
+  const int xt = (int)pt.x - buf.cols/2;
+  const int yt = (int)pt.y - buf.rows/2;
+  const float ax = pt.x - (int)pt.x;
+  const float ay = pt.y - (int)pt.y;
+  const float w00 = (1.f-ax)*(1.f-ay), w01 = ax*(1.f-ay), w10 = (1.f-ax)*ay, w11 = ax*ay;
+
+  float sum = 0.;
+
+  for (int v=0; v<buf.rows; v++)
+  {
+    const unsigned char *i0 = &im(yt+v,xt), *i1 = &im(yt+v+1,xt);
+    const float *t = &buf.tmpl[v*buf.cols];
+
+    #pragma omp simd reduction(+:sum)
+    for (int u=0; u<buf.cols; u++)
+      sum += std::fabs(w00*i0[u] + w01*i0[u+1] + w10*i1[u] + w11*i1[u+1] - t[u]);
+  }
+
+  return sum/float(buf.rows*buf.cols);
+}
+
+/**
+ * sampleLKPatch
+ * bilinear interpolated (truncated) image patch at pt, stored to buf.sample8
+ */
+inline void sampleLKPatch(const cv::Mat_<unsigned char> &im, LKPatchBuffer &buf, const cv::Point2f &pt)
+{
+  const int xt = (int)pt.x - buf.cols/2;
+  const int yt = (int)pt.y - buf.rows/2;
+  const float ax = pt.x - (int)pt.x;
+  const float ay = pt.y - (int)pt.y;
+  const float w00 = (1.f-ax)*(1.f-ay), w01 = ax*(1.f-ay), w10 = (1.f-ax)*ay, w11 = ax*ay;
+
+  for (int v=0; v<buf.rows; v++)
+  {
+    const unsigned char *i0 = &im(yt+v,xt), *i1 = &im(yt+v+1,xt);
+    unsigned char *s = &buf.sample8[v*buf.cols];
+
+    for (int u=0; u<buf.cols; u++)
+      s[u] = (unsigned char)(w00*i0[u] + w01*i0[u+1] + w10*i1[u] + w11*i1[u+1]);
+  }
+}
+
+} //--END--
+
+#endif
+
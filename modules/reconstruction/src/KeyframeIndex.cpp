@@ -0,0 +1,178 @@
+/**
+ * $Id$
+ * 
+ * Software License Agreement (GNU General Public License)
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <v4r/reconstruction/KeyframeIndex.h>
+#include <algorithm>
+#include <float.h>
+#include <cmath>
+#include <stdexcept>
+
+
+namespace v4r
+{
+
+
+using namespace std;
+
+inline bool cmpViewRankDec(const std::pair<int,float> &i, const std::pair<int,float> &j)
+{
+  return (i.second>j.second);
+}
+
+
+/************************************************************************************
+ * Constructor/Destructor
+ */
+KeyframeIndex::KeyframeIndex(const Parameter &p)
+ : param(p), nb_views(0)
+{
+  sqr_thr_desc = param.thr_desc*param.thr_desc;
+}
+
+KeyframeIndex::~KeyframeIndex()
+{
+}
+
+/**
+ * @brief KeyframeIndex::getNearestWord
+ * @param d descriptor (words.cols)
+ * @param sqr_dist squared distance to the word
+ * @return index of the word or -1 if the codebook is empty
+ */
+int KeyframeIndex::getNearestWord(const float *d, float &sqr_dist) const
+{
+  int idx = -1;
+  float dist;
+  sqr_dist = FLT_MAX;
+
+  for (int i=0; i<words.rows; i++)
+  {
+    const float *w = &words(i,0);
+    dist = 0.;
+    for (int j=0; j<words.cols && dist<sqr_dist; j++)
+      dist += (d[j]-w[j])*(d[j]-w[j]);
+    if (dist < sqr_dist)
+    {
+      sqr_dist = dist;
+      idx = i;
+    }
+  }
+
+  return idx;
+}
+
+
+/***************************************************************************************/
+
+/**
+ * @brief KeyframeIndex::clear
+ */
+void KeyframeIndex::clear()
+{
+  words = cv::Mat_<float>();
+  inv_file.clear();
+  view_nb_words.clear();
+  nb_views = 0;
+}
+
+/**
+ * @brief KeyframeIndex::addView
+ * @param descs descriptors of the keyframe (CV_32F, one per row)
+ * @param view_idx
+ */
+void KeyframeIndex::addView(const cv::Mat &descs, int view_idx)
+{
+  if (descs.rows==0) return;
+  if (descs.type()!=CV_32F || (words.rows>0 && descs.cols!=words.cols))
+    throw std::runtime_error("[KeyframeIndex::addView] Invalid descriptors!");
+
+  int idx;
+  float sqr_dist;
+
+  if (view_idx >= (int)view_nb_words.size())
+    view_nb_words.resize(view_idx+1, 0);
+  if (view_nb_words[view_idx]==0) nb_views++;
+
+  for (int i=0; i<descs.rows; i++)
+  {
+    const float *d = &descs.at<float>(i,0);
+    idx = getNearestWord(d, sqr_dist);
+
+    if (idx==-1 || (sqr_dist > sqr_thr_desc && words.rows < param.max_words))
+    {
+      words.push_back(cv::Mat_<float>(1, descs.cols, (float*)d));
+      inv_file.push_back(std::vector< std::pair<int,int> >());
+      idx = words.rows-1;
+    }
+
+    std::vector< std::pair<int,int> > &occs = inv_file[idx];
+    if (occs.size()>0 && occs.back().first==view_idx) occs.back().second++;
+    else occs.push_back(std::make_pair(view_idx,1));
+  }
+
+  view_nb_words[view_idx] += descs.rows;
+}
+
+/**
+ * @brief KeyframeIndex::query
+ * @param descs descriptors of the query frame
+ * @param view_rank <view_idx, score> of the k best ranked keyframes, sorted better first
+ * @param k
+ */
+void KeyframeIndex::query(const cv::Mat &descs, std::vector< std::pair<int,float> > &view_rank, int k) const
+{
+  view_rank.clear();
+
+  if (words.rows==0 || descs.rows==0 || descs.cols!=words.cols || descs.type()!=CV_32F)
+    return;
+
+  int idx;
+  float sqr_dist, idf;
+  std::vector<float> scores(view_nb_words.size(), 0.);
+
+  for (int i=0; i<descs.rows; i++)
+  {
+    idx = getNearestWord(&descs.at<float>(i,0), sqr_dist);
+    if (sqr_dist > sqr_thr_desc) continue;
+
+    const std::vector< std::pair<int,int> > &occs = inv_file[idx];
+    idf = log(float(nb_views)/float(occs.size()));
+
+    for (unsigned j=0; j<occs.size(); j++)
+      scores[occs[j].first] += idf;
+  }
+
+  for (unsigned i=0; i<scores.size(); i++)
+  {
+    if (scores[i]>0)
+      view_rank.push_back(std::make_pair((int)i, scores[i]/sqrt(float(view_nb_words[i]))));
+  }
+
+  if ((int)view_rank.size() > k)
+  {
+    std::partial_sort(view_rank.begin(), view_rank.begin()+k, view_rank.end(), cmpViewRankDec);
+    view_rank.resize(k);
+  }
+  else std::sort(view_rank.begin(), view_rank.end(), cmpViewRankDec);
+}
+
+
+}
+
@@ -52,7 +52,7 @@ inline bool cmpViewsInc(const pair<double,int> &i, const pair<double,int> &j)
  * Constructor/Destructor
  */
 KeyframeManagementRGBD2::KeyframeManagementRGBD2(const Parameter &p)
- : param(p), run(false), have_thread(false), nb_add(0), cnt_not_reliable_pose(0), inv_last_add_proj_pose(Eigen::Matrix4f::Identity()), last_reliable_pose(Eigen::Matrix4f::Identity()), loop_in_progress(false), have_loop_data(0)
+ : param(p), run(false), have_thread(false), cnt_not_reliable_pose(0), inv_last_add_proj_pose(Eigen::Matrix4f::Identity()), last_reliable_pose(Eigen::Matrix4f::Identity()), loop_in_progress(false), have_loop_data(0)
 { 
   sqr_max_dist_tracking_view = p.max_dist_tracking_view*p.max_dist_tracking_view;
   sqr_min_dist_add_proj = p.min_dist_add_proj*p.min_dist_add_proj;
@@ -65,6 +65,8 @@ KeyframeManagementRGBD2::KeyframeManagementRGBD2(const Parameter &p)
   param.kt_param.compute_global_pose = true;
   kpDetector.reset(new KeypointPoseDetectorRT(param.kd_param,det,estDesc));
   kpTracker.reset(new ProjLKPoseTrackerRT(param.kt_param));
+  kf_index.reset(new KeyframeIndex(param.ki_param));
+  ba.reset(new ProjBundleAdjuster(param.ba_param));
 }
 
 KeyframeManagementRGBD2::~KeyframeManagementRGBD2()
@@ -161,7 +163,7 @@ int KeyframeManagementRGBD2::getGlobalCorrespondences(const std::vector<unsigned
 /**
  * createView
  */
-bool KeyframeManagementRGBD2::createView(Shm &data, ObjectView::Ptr &view_ptr)
+bool KeyframeManagementRGBD2::createView(Keyframe &data, ObjectView::Ptr &view_ptr)
 {
   ObjectView &_view = *view_ptr;
 
@@ -336,21 +338,18 @@ void KeyframeManagementRGBD2::operate()
     have_new_view = false;
     do_loops = false;
 
-    shm.lock();
-    if (nb_add != shm.nb_add)
+    if (kf_queue.pop(local_data))
     {
       if(!dbg.empty()) cout<<"[KeyframeManagementRGBD2::operate] create view!"<<endl;
 
+      shm.lock();
       view.reset( new ObjectView(model.get()) );
       view->idx = model->views.size();
-      shm.process_view = true;
-      shm.copyTo(local_data);
-      nb_add = shm.nb_add;
+      shm.unlock();
+
       have_data = true;
+      have_new_view = createView(local_data, view);
     }
-    shm.unlock();
-
-    if (have_data) have_new_view = createView(local_data, view);
 
     shm.lock();
     if (have_new_view)
@@ -359,10 +358,17 @@ void KeyframeManagementRGBD2::operate()
       model->cameras.push_back(local_data.pose);
       model->views.push_back( view );
       model->initProjections( *view );
-      shm.process_view = false;
     }
     shm.unlock();
 
+    // the view is in the model, so it can be returned for relocalization
+    if (have_new_view)
+    {
+      mtx_index.lock();
+      kf_index->addView(view->descs, view->idx);
+      mtx_index.unlock();
+    }
+
     // loops
     shm.lock();
     if (have_loop_data==2) { 
@@ -380,10 +386,34 @@ void KeyframeManagementRGBD2::operate()
     }
     shm.unlock();
 
+    if (have_new_view && param.optimize_window) optimizeWindow();
+
     if (!have_data) usleep(10000);
   }
 }
 
+/**
+ * optimizeWindow
+ * sliding window bundle adjustment of the newest keyframes (the persistent problem is only
+ * extended by the new data, the model is just locked to exchange the data; entries the tracker
+ * or loop closing changed during the solve are not overwritten)
+ */
+void KeyframeManagementRGBD2::optimizeWindow()
+{
+  shm.lock();
+  bool have_window = (model->camera_parameter.size()>0 && ba->addIncremental(*model));
+  shm.unlock();
+
+  if (!have_window)
+    return;
+
+  ba->solveIncremental();
+
+  shm.lock();
+  ba->setIncremental(*model);
+  shm.unlock();
+}
+
 /**
  * selectGuidedRandom
  */
@@ -419,6 +449,28 @@ int KeyframeManagementRGBD2::selectGuidedRandom(const Eigen::Matrix4f &pose)
 }
 
 
+/**
+ * selectIndexed
+ * select a keyframe for relocalization using the keyframe index. The best ranked candidates
+ * are tried one after the other in subsequent frames.
+ * @param query_descs descriptors of the current frame
+ * @return view index or -1
+ */
+int KeyframeManagementRGBD2::selectIndexed(const cv::Mat &query_descs)
+{
+  mtx_index.lock();
+  kf_index->query(query_descs, reloc_rank, param.nb_reloc_candidates);
+  mtx_index.unlock();
+
+  if (reloc_rank.size()==0)
+    return -1;
+
+  int idx = reloc_rank[(cnt_not_reliable_pose-param.min_not_reliable_poses-1) % reloc_rank.size()].first;
+
+  return (idx < (int)model->views.size() ? idx : -1);
+}
+
+
 /***************************************************************************************/
 
 /**
@@ -449,17 +501,18 @@ void KeyframeManagementRGBD2::stop()
  */
 void KeyframeManagementRGBD2::addKeyframe(const cv::Mat &image, const DataMatrix2D<Eigen::Vector3f> &cloud, const Eigen::Matrix4f &pose, int view_idx, const std::vector< std::pair<int,cv::Point2f> > &_im_pts)
 {
-  shm.lock();
-  if (!shm.process_view)
-  {
-    image.copyTo(shm.image);
-    shm.cloud = cloud;
-    shm.pose = pose;
-    shm.view_idx = view_idx;
-    shm.im_pts = _im_pts;
-    shm.nb_add++;
-  }
-  shm.unlock();
+  // the management thread is still busy with the previous keyframes
+  if (kf_queue.full())
+    return;
+
+  Keyframe kf;
+  image.copyTo(kf.image);
+  kf.cloud = cloud;
+  kf.pose = pose;
+  kf.view_idx = view_idx;
+  kf.im_pts = _im_pts;
+
+  kf_queue.push(std::move(kf));
 }
 
 /**
@@ -565,7 +618,7 @@ int KeyframeManagementRGBD2::addLinkHyp2(const cv::Mat &image, const DataMatrix2
 /**
  * getTrackingModel
  */
-bool KeyframeManagementRGBD2::getTrackingModel(ObjectView &_view, Eigen::Matrix4f &view_pose, const Eigen::Matrix4f &current_pose, bool is_reliable_pose)
+bool KeyframeManagementRGBD2::getTrackingModel(ObjectView &_view, Eigen::Matrix4f &view_pose, const Eigen::Matrix4f &current_pose, bool is_reliable_pose, const cv::Mat &query_descs)
 {
   bool have_update = false;
   double angle, min_angle=FLT_MAX;
@@ -602,7 +655,10 @@ bool KeyframeManagementRGBD2::getTrackingModel(ObjectView &_view, Eigen::Matrix4
   if (_view.idx==-1 && model->views.size()==1)
     idx = 0;
   else if (cnt_not_reliable_pose > param.min_not_reliable_poses && model->views.size()>0) 
-    idx = selectGuidedRandom(last_reliable_pose);
+  {
+    if (!query_descs.empty()) idx = selectIndexed(query_descs);
+    if (idx<0) idx = selectGuidedRandom(last_reliable_pose);
+  }
     //idx = rand()%model->views.size()-1;
 
   // return view
@@ -625,16 +681,15 @@ void KeyframeManagementRGBD2::reset()
 {
   stop();
 
-  shm.nb_add = 0;
-  shm.process_view = false;
-  local_data.nb_add = 0;
-  local_data.process_view = false;
+  kf_queue.clear();
+  local_data = Keyframe();
+  kf_index->clear();
 
   model.reset(new Object());
+  ba->resetIncremental();
 
   if (!intrinsic.empty()) model->addCameraParameter(intrinsic, dist_coeffs);
 
-  nb_add = 0;
   cnt_not_reliable_pose =0;
   inv_last_add_proj_pose = Eigen::Matrix4f::Identity();
   last_reliable_pose = Eigen::Matrix4f::Identity();
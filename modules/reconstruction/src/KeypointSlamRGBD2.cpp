@@ -166,6 +166,8 @@ bool KeypointSlamRGBD2::track(const cv::Mat &image, const DataMatrix2D<Eigen::Ve
   if( image.type() != CV_8U ) cv::cvtColor( image, im_gray, CV_RGB2GRAY );
   else image.copyTo(im_gray);
 
+  im_pyr.reset(0);    // built on demand, shared by the lk steps of this frame
+
   if (!dbg.empty()) kpTracker->dbg = dbg;
   if (!dbg.empty()) kpDetector->dbg = dbg;
   //if (!dbg.empty()) lkTracker->dbg = dbg;
@@ -177,13 +179,18 @@ bool KeypointSlamRGBD2::track(const cv::Mat &image, const DataMatrix2D<Eigen::Ve
 
   cam_id = -1;
 
+  cv::Mat query_descs;
+
   // do refinement
   if (view->points.size()>=4)
   {
     im_pts.clear();
 
     if (param.do_inc_pyr_lk && conf > param.conf_reinit) 
-      conf = lkTracker->detectIncremental(im_gray, cloud, delta_pose);
+    {
+      getLKPyramid(im_gray, param.lk_param.win_size, param.lk_param.max_level, im_pyr);
+      conf = lkTracker->detectIncremental(im_pyr, cloud, delta_pose);
+    }
     conf = kpTracker->detect(im_gray, cloud, delta_pose);
 
     if (conf < param.conf_reinit)
@@ -191,6 +198,7 @@ bool KeypointSlamRGBD2::track(const cv::Mat &image, const DataMatrix2D<Eigen::Ve
       //cnt_reinit++;
       if (!dbg.empty()) cout<<"REINIT!!!!!!!!!!"<<endl;
       conf = kpDetector->detect(im_gray, cloud, delta_pose);
+      query_descs = kpDetector->getDescriptors();
       if (conf>0.001) conf = kpTracker->detect(im_gray, cloud, delta_pose);
     }
   }
@@ -203,7 +211,7 @@ bool KeypointSlamRGBD2::track(const cv::Mat &image, const DataMatrix2D<Eigen::Ve
   int tracked_view_idx = view->idx;
 
   // check view update/ handover
-  if(om->getTrackingModel(*view, view_pose, pose, (conf>param.min_conf)))
+  if(om->getTrackingModel(*view, view_pose, pose, (conf>param.min_conf), query_descs))
   {
     kpDetector->setModel(view);
     kpTracker->setModel(view, view_pose);
@@ -223,8 +231,12 @@ bool KeypointSlamRGBD2::track(const cv::Mat &image, const DataMatrix2D<Eigen::Ve
     om->addKeyframe(im_gray, cloud, (view->points.size()<4?Eigen::Matrix4f::Identity():pose), tracked_view_idx, im_pts);
   }  
 
+  // the pyramid of this frame is reused as last frame of the next incremental lk step
   if (conf>param.conf_reinit)
-    lkTracker->setLastFrame(im_gray, delta_pose);
+  {
+    getLKPyramid(im_gray, param.lk_param.win_size, param.lk_param.max_level, im_pyr);
+    lkTracker->setLastFrame(im_pyr, delta_pose);
+  }
 
   // add projections (and add simple loops)
   if (conf_cnt>param.min_conf_cnt) 
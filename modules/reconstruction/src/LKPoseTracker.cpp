@@ -220,8 +220,17 @@ void LKPoseTracker::ransacSolvePnP(const std::vector<cv::Point3f> &points, const
  */
 void LKPoseTracker::setLastFrame(const cv::Mat &image, const Eigen::Matrix4f &pose)
 {
-  if( image.type() != CV_8U ) cv::cvtColor( image, im_last, CV_RGB2GRAY );
-  else image.copyTo(im_last);
+  setLastFrame(LKPyramid::Ptr(new LKPyramid(image, param.win_size, param.max_level)), pose);
+}
+
+/**
+ * setLastFrame
+ * @param pyr pyramid of the last frame (it is not copied, i.e. the pyramid must not be modified by the caller)
+ */
+void LKPoseTracker::setLastFrame(const LKPyramid::Ptr &pyr, const Eigen::Matrix4f &pose)
+{
+  pyr_last = pyr;
+  getLKPyramid(pyr_last->getImage(), param.win_size, param.max_level, pyr_last);
 
   last_pose = pose;
   have_im_last = true;
@@ -231,16 +240,25 @@ void LKPoseTracker::setLastFrame(const cv::Mat &image, const Eigen::Matrix4f &po
  * detect
  */
 double LKPoseTracker::detectIncremental(const cv::Mat &image, Eigen::Matrix4f &pose)
+{
+  if (!have_im_last || pyr_last.empty())
+    return 0.;
+
+  return detectIncremental(LKPyramid::Ptr(new LKPyramid(image, param.win_size, param.max_level)), pose);
+}
+
+/**
+ * detectIncremental
+ * @param pyr pyramid of the current frame (e.g. shared with other trackers)
+ */
+double LKPoseTracker::detectIncremental(const LKPyramid::Ptr &_pyr, Eigen::Matrix4f &pose)
 {
   if (model.get()==0)
     throw std::runtime_error("[LKPoseTracker::detect] No model available!");
   if (intrinsic.empty())
     throw std::runtime_error("[LKPoseTracker::detect] Intrinsic camera parameter not set!");
 
-  if( image.type() != CV_8U ) cv::cvtColor( image, im_gray, CV_RGB2GRAY );
-  else im_gray = image;
-
-  if (!have_im_last || im_last.empty()) {
+  if (!have_im_last || pyr_last.empty()) {
     //last_pose = pose;
     //im_gray.copyTo(im_last);
     return 0.;
@@ -274,7 +292,10 @@ double LKPoseTracker::detectIncremental(const cv::Mat &image, Eigen::Matrix4f &p
     else projectPointToImage(&pt3[0], intrinsic.ptr<double>(), &im_points0[i].x);
   }
 
-  cv::calcOpticalFlowPyrLK(im_last, im_gray, im_points0, im_points1, status, error, param.win_size, param.max_level, param.termcrit, 0, 0.001 );
+  LKPyramid::Ptr pyr = _pyr;
+  getLKPyramid(pyr->getImage(), param.win_size, param.max_level, pyr);
+
+  cv::calcOpticalFlowPyrLK(pyr_last->pyr, pyr->pyr, im_points0, im_points1, status, error, param.win_size, param.max_level, param.termcrit, 0, 0.001 );
 
   for (unsigned i=0; i<im_points0.size(); i++)
   {
@@ -307,14 +328,24 @@ double LKPoseTracker::detectIncremental(const cv::Mat &image, Eigen::Matrix4f &p
  * detect
  */
 double LKPoseTracker::detect(const cv::Mat &image, Eigen::Matrix4f &pose)
+{
+  return detect(LKPyramid::Ptr(new LKPyramid(image, param.win_size, param.max_level)), pose);
+}
+
+/**
+ * detect
+ * @param pyr pyramid of the current frame (e.g. shared with other trackers)
+ */
+double LKPoseTracker::detect(const LKPyramid::Ptr &_pyr, Eigen::Matrix4f &pose)
 {
   if (model.get()==0)
     throw std::runtime_error("[LKPoseTracker::detect] No model available!");
   if (intrinsic.empty())
     throw std::runtime_error("[LKPoseTracker::detect] Intrinsic camera parameter not set!");
 
-  if( image.type() != CV_8U ) cv::cvtColor( image, im_gray, CV_RGB2GRAY );
-  else im_gray = image;
+  LKPyramid::Ptr pyr = _pyr;
+  getLKPyramid(pyr->getImage(), param.win_size, param.max_level, pyr);
+  LKPyramid::Ptr model_pyr = model->getImagePyramid(param.win_size, param.max_level);
 
   ObjectView &m = *model;
 
@@ -339,7 +370,7 @@ double LKPoseTracker::detect(const cv::Mat &image, Eigen::Matrix4f &pose)
     else projectPointToImage(&pt3[0], intrinsic.ptr<double>(), &im_points1[i].x);
   }
 
-  cv::calcOpticalFlowPyrLK(model->image, im_gray, im_points0, im_points1, status, error, param.win_size, param.max_level, param.termcrit, cv::OPTFLOW_USE_INITIAL_FLOW, 0.001 );
+  cv::calcOpticalFlowPyrLK(model_pyr->pyr, pyr->pyr, im_points0, im_points1, status, error, param.win_size, param.max_level, param.termcrit, cv::OPTFLOW_USE_INITIAL_FLOW, 0.001 );
 
 
   for (unsigned i=0; i<im_points0.size(); i++)
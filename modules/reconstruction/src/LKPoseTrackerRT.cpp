@@ -65,16 +65,25 @@ LKPoseTrackerRT::~LKPoseTrackerRT()
  * detect
  */
 double LKPoseTrackerRT::detectIncremental(const cv::Mat &image, const DataMatrix2D<Eigen::Vector3f> &cloud, Eigen::Matrix4f &pose)
+{
+  if (!have_im_last || pyr_last.empty())
+    return 0.;
+
+  return detectIncremental(LKPyramid::Ptr(new LKPyramid(image, param.win_size, param.max_level)), cloud, pose);
+}
+
+/**
+ * detectIncremental
+ * @param pyr pyramid of the current frame (e.g. shared with other trackers)
+ */
+double LKPoseTrackerRT::detectIncremental(const LKPyramid::Ptr &_pyr, const DataMatrix2D<Eigen::Vector3f> &cloud, Eigen::Matrix4f &pose)
 {
   if (model.get()==0)
     throw std::runtime_error("[LKPoseTrackerRT::detect] No model available!");
   if (intrinsic.empty())
     throw std::runtime_error("[LKPoseTrackerRT::detect] Intrinsic camera parameter not set!");
 
-  if( image.type() != CV_8U ) cv::cvtColor( image, im_gray, CV_RGB2GRAY );
-  else im_gray = image;
-
-  if (!have_im_last || im_last.empty()) {
+  if (!have_im_last || pyr_last.empty()) {
     //last_pose = pose;
     //im_gray.copyTo(im_last);
     return 0.;
@@ -110,7 +119,10 @@ double LKPoseTrackerRT::detectIncremental(const cv::Mat &image, const DataMatrix
     else projectPointToImage(&pt3[0], intrinsic.ptr<double>(), &im_points0[i].x);
   }
 
-  cv::calcOpticalFlowPyrLK(im_last, im_gray, im_points0, im_points1, status, error, param.win_size, param.max_level, param.termcrit, 0, 0.001 );
+  LKPyramid::Ptr pyr = _pyr;
+  getLKPyramid(pyr->getImage(), param.win_size, param.max_level, pyr);
+
+  cv::calcOpticalFlowPyrLK(pyr_last->pyr, pyr->pyr, im_points0, im_points1, status, error, param.win_size, param.max_level, param.termcrit, 0, 0.001 );
 
   for (unsigned i=0; i<im_points0.size(); i++)
   {
@@ -159,8 +171,17 @@ double LKPoseTrackerRT::detectIncremental(const cv::Mat &image, const DataMatrix
  */
 void LKPoseTrackerRT::setLastFrame(const cv::Mat &image, const Eigen::Matrix4f &pose)
 {
-  if( image.type() != CV_8U ) cv::cvtColor( image, im_last, CV_RGB2GRAY );
-  else image.copyTo(im_last);
+  setLastFrame(LKPyramid::Ptr(new LKPyramid(image, param.win_size, param.max_level)), pose);
+}
+
+/**
+ * setLastFrame
+ * @param pyr pyramid of the last frame (it is not copied, i.e. the pyramid must not be modified by the caller)
+ */
+void LKPoseTrackerRT::setLastFrame(const LKPyramid::Ptr &pyr, const Eigen::Matrix4f &pose)
+{
+  pyr_last = pyr;
+  getLKPyramid(pyr_last->getImage(), param.win_size, param.max_level, pyr_last);
 
   last_pose = pose;
   have_im_last = true;
@@ -46,7 +46,7 @@ using namespace std;
  * Constructor/Destructor
  */
 ProjBundleAdjuster::ProjBundleAdjuster(const Parameter &p)
- : param(p)
+ : param(p), inc_nb_cameras(0)
 { 
   sqr_depth_inl_dist = param.depth_inl_dist*param.depth_inl_dist;
 }
@@ -225,7 +225,7 @@ void ProjBundleAdjuster::bundle(Object &data, std::vector<Camera> &cameras)
   options.preconditioner_type = ceres::SCHUR_JACOBI;
   options.linear_solver_type = ceres::ITERATIVE_SCHUR;
   options.use_inner_iterations = true;
-  options.max_num_iterations = 100;
+  options.max_num_iterations = param.max_iterations;
 
   if (!dbg.empty()) 
     options.minimizer_progress_to_stdout = true;
@@ -241,6 +241,292 @@ void ProjBundleAdjuster::bundle(Object &data, std::vector<Camera> &cameras)
   }
 }
 
+/**
+ * getIncIntrinsics
+ * returns the (persistent) intrinsic parameter block of a camera, adds it if necessary
+ */
+double *ProjBundleAdjuster::getIncIntrinsics(const Object &data, int cam_idx)
+{
+  int idx = (data.camera_parameter.size()==1 ? 0 : cam_idx);
+
+  std::map<int, std::vector<double> >::iterator it = inc_intrinsics.find(idx);
+  if (it!=inc_intrinsics.end())
+    return &it->second[0];
+
+  std::vector<double> &intrinsics = inc_intrinsics[idx];
+  intrinsics = data.camera_parameter[idx];
+  inc_problem->AddParameterBlock(&intrinsics[0], intrinsics.size());
+
+  if (param.optimize_intrinsic) {
+    if (intrinsics.size()==9 && !param.optimize_dist_coeffs) {
+      std::vector<int> constant_intrinsics;
+      for (int i=4; i<9; i++)
+        constant_intrinsics.push_back(i);
+      inc_problem->SetParameterization(&intrinsics[0], new ceres::SubsetParameterization(9, constant_intrinsics));
+    }
+  } else inc_problem->SetParameterBlockConstant(&intrinsics[0]);
+
+  return &intrinsics[0];
+}
+
+/**
+ * getIncPoint
+ * returns the (persistent) parameter block of a global point, which is initialized from data
+ */
+double *ProjBundleAdjuster::getIncPoint(const Object &data, unsigned glob_idx)
+{
+  std::map<unsigned, Eigen::Vector3d>::iterator it = inc_points.find(glob_idx);
+  if (it==inc_points.end())
+  {
+    it = inc_points.insert(std::make_pair(glob_idx, data.points[glob_idx].pt)).first;
+    inc_point_nb_res[glob_idx] = 0;
+  }
+  return &it->second[0];
+}
+
+/**
+ * addIncCamera
+ * adds a new keyframe to the window (warm start from the current pose)
+ */
+void ProjBundleAdjuster::addIncCamera(const Object &data, int cam_idx)
+{
+  Eigen::Matrix3d R;
+  Eigen::Vector3d t;
+
+  Camera &cam = inc_cameras[cam_idx];
+  getR(data.cameras[cam_idx], R);
+  getT(data.cameras[cam_idx], t);
+  ceres::RotationMatrixToAngleAxis(&R(0,0), &cam.pose_Rt(0));
+  cam.pose_Rt.tail<3>() = t;
+  cam.idx = cam_idx;
+
+  inc_problem->AddParameterBlock(&cam.pose_Rt[0], 6);
+  inc_window.push_back(cam_idx);
+}
+
+/**
+ * addIncResidual
+ * adds the reprojection (and depth) residual of a projection (same model as bundle)
+ */
+void ProjBundleAdjuster::addIncResidual(const Object &data, const triple<int, cv::Point2f, Eigen::Vector3f> &p, unsigned glob_idx)
+{
+  double *intrinsics = getIncIntrinsics(data, p.first);
+  int num_cam_param = data.camera_parameter[data.camera_parameter.size()==1 ? 0 : p.first].size();
+  double *pose_Rt = &inc_cameras[p.first].pose_Rt[0];
+  double *pt3 = getIncPoint(data, glob_idx);
+
+  const Eigen::Matrix4f &pose = data.cameras[p.first];
+  Eigen::Vector3f pt = Eigen::Map<Eigen::Vector3d>(pt3).cast<float>();
+  bool have_depth = ( param.use_depth_prior && !isnan(p.third) && p.third[2]<param.depth_cut_off &&
+                      (pose.topLeftCorner<3,3>()*pt+pose.block<3,1>(0,3) - p.third).squaredNorm() < sqr_depth_inl_dist );
+
+  ceres::ResidualBlockId id = 0;
+
+  if (num_cam_param==4) {
+    if (have_depth) {
+      id = inc_problem->AddResidualBlock(
+            new ceres::AutoDiffCostFunction< NoDistortionReprojectionAndDepthError, 3, 4, 6, 3 >(
+            new NoDistortionReprojectionAndDepthError(p.second.x,p.second.y,1./p.third[2],param.depth_error_weight)), 0, intrinsics, pose_Rt, pt3);
+    } else {
+      id = inc_problem->AddResidualBlock(
+            new ceres::AutoDiffCostFunction< NoDistortionReprojectionError, 2, 4, 6, 3 >(
+            new NoDistortionReprojectionError(p.second.x, p.second.y)), 0, intrinsics, pose_Rt, pt3);
+    }
+  } else if (num_cam_param==9) {
+    if (have_depth) {
+      id = inc_problem->AddResidualBlock(
+            new ceres::AutoDiffCostFunction< RadialDistortionReprojectionAndDepthError, 3, 9, 6, 3 >(
+            new RadialDistortionReprojectionAndDepthError(p.second.x, p.second.y, 1./p.third[2],param.depth_error_weight)), 0, intrinsics, pose_Rt, pt3);
+    } else {
+      id = inc_problem->AddResidualBlock(
+            new ceres::AutoDiffCostFunction< RadialDistortionReprojectionError, 2, 9, 6, 3 >(
+            new RadialDistortionReprojectionError(p.second.x, p.second.y)), 0, intrinsics, pose_Rt, pt3);
+    }
+  }
+
+  if (id!=0)
+  {
+    inc_cam_residuals[p.first].push_back(std::make_pair(glob_idx,id));
+    inc_point_nb_res[glob_idx]++;
+  }
+}
+
+/**
+ * addIncPointPrior
+ * Approximates the marginalization of a camera by a prior on the points it observed
+ * (the point is conditioned on the fixed camera, i.e. no cross correlations are kept)
+ */
+void ProjBundleAdjuster::addIncPointPrior(unsigned glob_idx, int nb_obs)
+{
+  if (param.prior_weight<=0.)
+    return;
+
+  PointPrior &prior = inc_point_priors[glob_idx];
+  if (prior.id!=0) inc_problem->RemoveResidualBlock(prior.id);
+  prior.weight += nb_obs*param.prior_weight;
+
+  Eigen::Vector3d &pt = inc_points[glob_idx];
+  prior.id = inc_problem->AddResidualBlock(
+        new ceres::AutoDiffCostFunction< PointPriorError, 3, 3 >(
+        new PointPriorError(pt[0], pt[1], pt[2], sqrt(prior.weight))), 0, &pt[0]);
+}
+
+/**
+ * removeIncPoint
+ */
+void ProjBundleAdjuster::removeIncPoint(unsigned glob_idx)
+{
+  std::map<unsigned, Eigen::Vector3d>::iterator it = inc_points.find(glob_idx);
+  if (it==inc_points.end())
+    return;
+
+  // also removes the prior
+  if (inc_problem->HasParameterBlock(&it->second[0]))
+    inc_problem->RemoveParameterBlock(&it->second[0]);
+
+  inc_points.erase(it);
+  inc_point_nb_res.erase(glob_idx);
+  inc_point_priors.erase(glob_idx);
+}
+
+/**
+ * syncIncremental
+ * adds new cameras and projections to the persistent problem
+ * @return false if the data structure changed (deleted points), i.e. the problem needs to be rebuilt
+ */
+bool ProjBundleAdjuster::syncIncremental(const Object &data)
+{
+  for (int i=inc_nb_cameras; i<(int)data.cameras.size(); i++)
+    addIncCamera(data, i);
+  inc_nb_cameras = data.cameras.size();
+
+  if (inc_nb_projs.size()>data.views.size())
+    return false;
+
+  inc_nb_projs.resize(data.views.size());
+
+  for (unsigned v=0; v<data.views.size(); v++)
+  {
+    const ObjectView &view = *data.views[v];
+    std::vector<unsigned> &nb_projs = inc_nb_projs[v];
+
+    if (nb_projs.size()>view.projs.size())
+      return false;
+
+    nb_projs.resize(view.projs.size(), 0);
+
+    for (unsigned i=0; i<view.projs.size(); i++)
+    {
+      const std::vector< triple<int, cv::Point2f, Eigen::Vector3f> > &projs = view.projs[i];
+
+      if (projs.size() < 2 || nb_projs[i]==projs.size()) continue;
+      if (nb_projs[i]>projs.size()) return false;
+
+      for (unsigned j=nb_projs[i]; j<projs.size(); j++)
+      {
+        if (inc_cameras.find(projs[j].first)!=inc_cameras.end())
+          addIncResidual(data, projs[j], view.points[i]);
+      }
+
+      nb_projs[i] = projs.size();
+    }
+  }
+
+  return true;
+}
+
+/**
+ * snapshotIncremental
+ * (re-)initializes the window parameter blocks from data and remembers the values,
+ * i.e. changes of the tracker or loop closing since the last solve are not overwritten
+ */
+void ProjBundleAdjuster::snapshotIncremental(const Object &data)
+{
+  Eigen::Matrix3d R;
+  Eigen::Vector3d t;
+
+  inc_cam_snapshot.clear();
+  inc_point_snapshot.clear();
+  inc_intrinsics_snapshot.clear();
+
+  for (CameraMap::iterator it=inc_cameras.begin(); it!=inc_cameras.end(); it++)
+  {
+    Camera &cam = it->second;
+    if (cam.idx>=(int)data.cameras.size()) continue;
+    const Eigen::Matrix4f &pose = data.cameras[cam.idx];
+    getR(pose, R);
+    getT(pose, t);
+    ceres::RotationMatrixToAngleAxis(&R(0,0), &cam.pose_Rt(0));
+    cam.pose_Rt.tail<3>() = t;
+    inc_cam_snapshot[cam.idx] = pose;
+  }
+
+  for (std::map<unsigned, Eigen::Vector3d>::iterator it=inc_points.begin(); it!=inc_points.end(); it++)
+  {
+    if (it->first>=data.points.size()) continue;
+    it->second = data.points[it->first].pt;
+    inc_point_snapshot[it->first] = it->second;
+  }
+
+  for (std::map<int, std::vector<double> >::iterator it=inc_intrinsics.begin(); it!=inc_intrinsics.end(); it++)
+  {
+    if (it->first>=(int)data.camera_parameter.size() || data.camera_parameter[it->first].size()!=it->second.size()) continue;
+    std::copy(data.camera_parameter[it->first].begin(), data.camera_parameter[it->first].end(), it->second.begin());  // keep the parameter block
+    inc_intrinsics_snapshot[it->first] = it->second;
+  }
+}
+
+/**
+ * setIncremental
+ * copies the optimized window (cameras, points, intrinsics) back to data,
+ * entries which have been changed in data since addIncremental are skipped
+ */
+void ProjBundleAdjuster::setIncremental(Object &data)
+{
+  Eigen::Matrix3d R;
+  Eigen::Vector3d t;
+  int nb_skipped = 0;
+
+  for (CameraMap::const_iterator it=inc_cameras.begin(); it!=inc_cameras.end(); it++)
+  {
+    const Camera &cam = it->second;
+    std::map<int, Eigen::Matrix4f, std::less<int>, Eigen::aligned_allocator<std::pair<const int, Eigen::Matrix4f> > >::const_iterator its = inc_cam_snapshot.find(cam.idx);
+    if (its==inc_cam_snapshot.end() || cam.idx>=(int)data.cameras.size() || data.cameras[cam.idx]!=its->second) {
+      nb_skipped++;
+      continue;
+    }
+    ceres::AngleAxisToRotationMatrix(&cam.pose_Rt(0), &R(0,0));
+    t = cam.pose_Rt.tail<3>();
+    setPose(R,t, data.cameras[cam.idx]);
+  }
+
+  for (std::map<unsigned, Eigen::Vector3d>::const_iterator it=inc_points.begin(); it!=inc_points.end(); it++)
+  {
+    std::map<unsigned, Eigen::Vector3d>::const_iterator its = inc_point_snapshot.find(it->first);
+    if (its==inc_point_snapshot.end() || it->first>=data.points.size() || data.points[it->first].pt!=its->second) {
+      nb_skipped++;
+      continue;
+    }
+    data.points[it->first].pt = it->second;
+  }
+
+  if (param.optimize_intrinsic)
+  {
+    for (std::map<int, std::vector<double> >::const_iterator it=inc_intrinsics.begin(); it!=inc_intrinsics.end(); it++)
+    {
+      std::map<int, std::vector<double> >::const_iterator its = inc_intrinsics_snapshot.find(it->first);
+      if (its==inc_intrinsics_snapshot.end() || it->first>=(int)data.camera_parameter.size() || data.camera_parameter[it->first]!=its->second) {
+        nb_skipped++;
+        continue;
+      }
+      data.camera_parameter[it->first] = it->second;
+    }
+  }
+
+  if (!dbg.empty() && nb_skipped>0)
+    std::cout << "[ProjBundleAdjuster::setIncremental] skipped "<<nb_skipped<<" entries changed during the solve"<<std::endl;
+}
+
 /**
  * TODO: that was a test for Kinect calibration
  */
@@ -422,6 +708,9 @@ void ProjBundleAdjuster::optimize(Object &data)
 
   setCameras(cameras, data); 
 
+  // the incremental problem would be stale now
+  resetIncremental();
+
   if (!dbg.empty()) cout<<"[ProjBundleAdjuster::optimize] Number of cameras to bundle: "<<cameras.size()<<endl;
   
   if (!dbg.empty() && param.optimize_intrinsic) {
@@ -433,6 +722,137 @@ void ProjBundleAdjuster::optimize(Object &data)
 }
 
 
+/**
+ * resetIncremental
+ */
+void ProjBundleAdjuster::resetIncremental()
+{
+  inc_problem.reset();
+  inc_cameras.clear();
+  inc_window.clear();
+  inc_points.clear();
+  inc_point_nb_res.clear();
+  inc_point_priors.clear();
+  inc_intrinsics.clear();
+  inc_cam_residuals.clear();
+  inc_nb_projs.clear();
+  inc_nb_cameras = 0;
+  inc_cam_snapshot.clear();
+  inc_point_snapshot.clear();
+  inc_intrinsics_snapshot.clear();
+}
+
+/**
+ * removeKeyframe
+ * @param cam_idx camera index (data.cameras)
+ * @param marginalize if true the observations of the keyframe are kept as priors of the observed points
+ */
+void ProjBundleAdjuster::removeKeyframe(int cam_idx, bool marginalize)
+{
+  CameraMap::iterator it = inc_cameras.find(cam_idx);
+  if (!inc_problem || it==inc_cameras.end())
+    return;
+
+  std::map<unsigned, int> nb_removed;
+  std::map<int, std::vector< std::pair<unsigned, ceres::ResidualBlockId> > >::iterator itr = inc_cam_residuals.find(cam_idx);
+
+  if (itr!=inc_cam_residuals.end())
+  {
+    const std::vector< std::pair<unsigned, ceres::ResidualBlockId> > &res = itr->second;
+    for (unsigned i=0; i<res.size(); i++)
+    {
+      inc_problem->RemoveResidualBlock(res[i].second);
+      inc_point_nb_res[res[i].first]--;
+      nb_removed[res[i].first]++;
+    }
+    inc_cam_residuals.erase(itr);
+  }
+
+  inc_problem->RemoveParameterBlock(&it->second.pose_Rt[0]);
+  inc_cameras.erase(it);
+  inc_window.remove(cam_idx);
+
+  for (std::map<unsigned, int>::iterator itp=nb_removed.begin(); itp!=nb_removed.end(); itp++)
+  {
+    if (inc_point_nb_res[itp->first]<=0)
+      removeIncPoint(itp->first);
+    else if (marginalize)
+      addIncPointPrior(itp->first, itp->second);
+  }
+}
+
+/**
+ * addIncremental
+ * Adds new keyframes/projections to the persistent problem and marginalizes
+ * keyframes leaving the window (point priors)
+ * @return false if there is nothing to optimize
+ */
+bool ProjBundleAdjuster::addIncremental(const Object &data)
+{
+  if (!inc_problem)
+  {
+    ceres::Problem::Options problem_options;
+    problem_options.enable_fast_removal = true;
+    inc_problem.reset(new ceres::Problem(problem_options));
+  }
+
+  if (!syncIncremental(data))
+  {
+    // views have been edited (deleted keypoints) -> rebuild from the current data
+    resetIncremental();
+    return addIncremental(data);
+  }
+
+  while (param.window_size>0 && (int)inc_window.size()>param.window_size)
+    removeKeyframe(inc_window.front(), true);
+
+  snapshotIncremental(data);
+
+  return (inc_window.size()>=2 && inc_problem->NumResidualBlocks()>0);
+}
+
+/**
+ * solveIncremental
+ * The solver is warm started from the last solution of the window
+ */
+void ProjBundleAdjuster::solveIncremental()
+{
+  if (!inc_problem || inc_window.size()<2 || inc_problem->NumResidualBlocks()==0)
+    return;
+
+  ceres::Solver::Options options;
+  options.use_nonmonotonic_steps = true;
+  options.preconditioner_type = ceres::SCHUR_JACOBI;
+  options.linear_solver_type = ceres::ITERATIVE_SCHUR;
+  options.use_inner_iterations = true;
+  options.max_num_iterations = param.max_iterations_incremental;
+  options.minimizer_progress_to_stdout = !dbg.empty();
+
+  ceres::Solver::Summary summary;
+  ceres::Solve(options, inc_problem.get(), &summary);
+
+  if (!dbg.empty())
+  {
+    std::cout << "[ProjBundleAdjuster::solveIncremental] keyframes: "<<inc_window.size()<<", points: "<<inc_points.size()<<std::endl;
+    std::cout << summary.BriefReport() << std::endl;
+  }
+}
+
+/**
+ * optimizeIncremental
+ * Sliding window bundle adjustment: only new keyframes/projections are added to the
+ * persistent problem, keyframes leaving the window are marginalized (point priors)
+ * and the solver is warm started from the last solution.
+ */
+void ProjBundleAdjuster::optimizeIncremental(Object &data)
+{
+  if (!addIncremental(data))
+    return;
+
+  solveIncremental();
+  setIncremental(data);
+}
+
 
 
 
@@ -63,105 +63,6 @@ RefineProjectedPointLocationLK::~RefineProjectedPointLocationLK()
 
 /************************** PRIVATE ************************/
 
-/**
- * getIntensityDifference
- */
-void RefineProjectedPointLocationLK::getIntensityDifference(const cv::Mat_<unsigned char> &im1, cv::Mat_<unsigned char> &im2, const cv::Point2f &pt1, const cv::Point2f &pt2, int width, int height, cv::Mat_<float> &diff)
-{
-  diff = cv::Mat_<float>(height, width);
-  int hw = width/2, hh = height/2;
-
-  for (int v = -hh ; v <= hh ; v++)
-  {
-    for (int u = -hw ; u <= hw ; u++)  
-    {
-      diff(v+hh,u+hw) = getInterpolated(im1, pt1.x+u, pt1.y+v) - im2(pt2.y+v, pt2.x+u);
-    }
-  }
-}
-
-/**
- * getPatchInterpolated
- */
-void RefineProjectedPointLocationLK::getPatchInterpolated(const cv::Mat_<unsigned char> &image, const cv::Point2f &pt, cv::Mat_<unsigned char> &patch, int width, int height)
-{
-  patch = cv::Mat_<unsigned char>(height, width);
-  int hw = width/2, hh = height/2;
-
-  for (int v = -hh ; v <= hh ; v++)
-  {
-    for (int u = -hw ; u <= hw ; u++)
-    {
-      patch(v+hh,u+hw) = (unsigned char)getInterpolated(image, pt.x+u, pt.y+v);
-    }
-  }
-}
-
-
-/**
- * getGradientSum
- */
-void RefineProjectedPointLocationLK::getGradientSum(const cv::Mat_<float> &dx1, const cv::Mat_<float> &dy1, const cv::Mat_<float> &dx2, const cv::Mat_<float> &dy2, const cv::Point2f &pt1, const cv::Point2f &pt2, int width, int height, cv::Mat_<float> &dx, cv::Mat_<float> &dy)
-{
-  dx = cv::Mat_<float>(height,width);
-  dy = cv::Mat_<float>(height,width);
-
-  int hw = width/2, hh = height/2;
-
-  for (int v = -hh ; v <= hh ; v++)
-  {
-    for (int u = -hw ; u <= hw ; u++)  
-    {
-      dx(v+hh,u+hw) = getInterpolated(dx1,pt1.x+u,pt1.y+v) + getInterpolated(dx2,pt2.x+u,pt2.y+v);
-      dy(v+hh,u+hw) = getInterpolated(dy1,pt1.x+u,pt1.y+v) + getInterpolated(dy2,pt2.x+u,pt2.y+v);
-    }
-  }
-}
-
-/**
- * getGradientMatrix22
- */
-void RefineProjectedPointLocationLK::getGradientMatrix22(const cv::Mat_<float> &dx, const cv::Mat_<float> &dy, float &gxx, float &gxy, float &gyy)
-{
-  float gx, gy;
-
-  gxx = gxy = gyy = 0.;
-
-  for (int v=0; v<dx.rows; v++)
-  {
-    for (int u=0; u<dx.cols; u++)
-    {
-      gx = dx(v,u);
-      gy = dy(v,u);
-      gxx += gx*gx;
-      gxy += gx*gy;
-      gyy += gy*gy;
-    }
-  }
-}
-
-/**
- * getErrorVector2
- */
-void RefineProjectedPointLocationLK::getErrorVector2(const cv::Mat_<float> &diff, const cv::Mat_<float> &dx, const cv::Mat_<float> &dy, cv::Point2f &err)
-{
-  float d;
-
-  err = cv::Point2f(0.,0.);
-
-  for (int v=0; v<diff.rows; v++)
-  {
-    for (int u=0; u<diff.cols; u++)
-    {
-      d = diff(v,u);
-      err.x += d * dx(v,u);
-      err.y += d * dy(v,u);
-    }
-  }
-
-  err *= param.step_factor;
-}
-
 /** 
  * solve
  * [gxx gxy] [delta.x] = [err.x]
@@ -193,9 +94,6 @@ void RefineProjectedPointLocationLK::refineImagePoints(const std::vector<Eigen::
 
   cv::Point2f delta, err;
   cv::Mat_<unsigned char> patch;
-  cv::Mat_<float> patch_dx, patch_dy, diff, sum_dx, sum_dy;
-  cv::Mat_<unsigned char> roi_patch, patch1, patch2;
-  cv::Mat_<float> roi_dx, roi_dy;
   float gxx, gxy, gyy;
 
   Eigen::Matrix<float,3,3,Eigen::RowMajor> H, T;
@@ -204,11 +102,13 @@ void RefineProjectedPointLocationLK::refineImagePoints(const std::vector<Eigen::
 
   int hw = (param.patch_size.width-2)/2;
   int hh = (param.patch_size.height-2)/2;
-  cv::Point2f pt_patch(hw,hh);
 
   delta_pose =  pose_src*inv_pose_tgt;
   delta_R = delta_pose.topLeftCorner<3,3>();
   delta_t = delta_pose.block<3,1>(0,3);
+  const Eigen::Matrix3f C = src_C * delta_R;   // H = src_C * (delta_R + 1/d*delta_t*n^T) * tgt_C^-1 * T
+  const Eigen::Vector3f Ct = src_C * delta_t;
+  const Eigen::Matrix3f inv_tgt_C = tgt_C.inverse();
 
   bool have_dist = !tgt_dist_coeffs.empty();
   im_pts_tgt.resize(pts.size());
@@ -220,11 +120,16 @@ void RefineProjectedPointLocationLK::refineImagePoints(const std::vector<Eigen::
     omp_set_num_threads(num_threads);
   }
 
-  #pragma omp parallel for private(d, pt3, n, T, H, gxx, gxy, gyy, roi_dx, roi_dy, roi_patch, patch1, patch2, patch_dx, patch_dy, diff, sum_dx, sum_dy, patch, delta, err)
+  if ((int)buffers.size() < omp_get_max_threads())
+    buffers.resize(omp_get_max_threads());
+
+  #pragma omp parallel for schedule(dynamic,16) private(d, pt3, n, T, H, gxx, gxy, gyy, patch, delta, err)
   for (unsigned i=0; i<pts.size(); i++)
   {
+    LKPatchBuffer &buf = buffers[omp_get_thread_num()];
+
     T.setIdentity();
-    patch = cv::Mat_<unsigned char>(param.patch_size);
+    patch.create(param.patch_size);
 
     converged[i] = 1;
 
@@ -243,8 +148,7 @@ void RefineProjectedPointLocationLK::refineImagePoints(const std::vector<Eigen::
     T(0,2) = pt_im.x - (int)patch.cols/2;
     T(1,2) = pt_im.y - (int)patch.rows/2;
     d = n.transpose()*pt3;
-    H = delta_R + 1./d*delta_t*n.transpose();
-    H = src_C * H * tgt_C.inverse() * T;
+    H = (C + 1./d*Ct*n.transpose()) * inv_tgt_C * T;
 
     bool isok = warpPatchHomography( (const unsigned char*)im_src.ptr(), im_src.rows, im_src.cols,
                          (float*)H.data(), (unsigned char*)patch.ptr(), patch.rows, patch.cols);
@@ -254,28 +158,18 @@ void RefineProjectedPointLocationLK::refineImagePoints(const std::vector<Eigen::
       continue;
     }
 
-    cv::Sobel( patch, patch_dx, CV_32F, 1, 0, 3, 1, 0, cv::BORDER_DEFAULT );
-    cv::Sobel( patch, patch_dy, CV_32F, 0, 1, 3, 1, 0, cv::BORDER_DEFAULT );
-
-    roi_patch = patch(cv::Rect(1,1,patch.cols-2,patch.rows-2));
-    roi_dx = patch_dx(cv::Rect(1,1,patch.cols-2,patch.rows-2));
-    roi_dy = patch_dy(cv::Rect(1,1,patch.cols-2,patch.rows-2));
+    buf.setTemplate(patch);
 
     int z=0;
     do  {
-      if (  pt_im.x-hw < 0.0f || im_tgt.cols-(pt_im.x+hw) < 1.001 ||
-            pt_im.y-hh < 0.0f || im_tgt.rows-(pt_im.y+hh) < 1.001 ) {
+      if (!isInside(pt_im, hw, hh)) {
         converged[i] = -1;
         break;
       }
 
-      getIntensityDifference(im_tgt, roi_patch, pt_im, pt_patch, roi_patch.cols, roi_patch.rows, diff);
-      getGradientSum(im_tgt_dx, im_tgt_dy, roi_dx, roi_dy, pt_im, pt_patch, roi_patch.cols, roi_patch.rows, sum_dx, sum_dy);
+      accumulateLKPatch(im_tgt, im_tgt_dx, im_tgt_dy, buf, pt_im, gxx, gxy, gyy, err);
+      err *= -param.step_factor;
 
-      getGradientMatrix22(sum_dx, sum_dy, gxx, gxy, gyy);
-      getErrorVector2(diff, sum_dx, sum_dy, err);
-      err = -1*err;
-      
       if (!solve(err, gxx, gxy, gyy, delta))
       {
         converged[i] = -2;
@@ -289,8 +183,7 @@ void RefineProjectedPointLocationLK::refineImagePoints(const std::vector<Eigen::
 
     if (converged[i])
     {
-      if (  pt_im.x-hw < 0.0f || im_tgt.cols-(pt_im.x+hw) < 1.001 ||
-            pt_im.y-hh < 0.0f || im_tgt.rows-(pt_im.y+hh) < 1.001 ) 
+      if (!isInside(pt_im, hw, hh))
       {
         converged[i] = -1;
       }
@@ -298,10 +191,7 @@ void RefineProjectedPointLocationLK::refineImagePoints(const std::vector<Eigen::
       {
         if (!param.use_ncc)
         {
-          getIntensityDifference(im_tgt, roi_patch, pt_im, pt_patch, roi_patch.cols, roi_patch.rows, diff);
-
-          cv::Scalar sum = cv::sum(abs(diff));
-          float residual = sum[0]/(roi_patch.rows*roi_patch.cols);
+          float residual = getLKPatchResidual(im_tgt, buf, pt_im);
           residuals[i] = residual;
 
           if (residual > param.max_residual)
@@ -309,10 +199,9 @@ void RefineProjectedPointLocationLK::refineImagePoints(const std::vector<Eigen::
         }
         else
         {
-          getPatchInterpolated(im_tgt, pt_im, patch1, roi_patch.cols, roi_patch.rows);
-          getPatchInterpolated(roi_patch, pt_patch, patch2, roi_patch.cols, roi_patch.rows);
-          
-          float ncc = distanceNCCb(patch1.ptr(), patch2.ptr(), roi_patch.rows*roi_patch.cols);
+          sampleLKPatch(im_tgt, buf, pt_im);
+
+          float ncc = distanceNCCb(&buf.sample8[0], &buf.tmpl8[0], buf.rows*buf.cols);
           residuals[i] = ncc;
           
           if (1.-ncc > param.ncc_residual)
@@ -72,10 +72,13 @@ FeatureBasedRegistration<PointT>::initialize(std::vector<std::pair<int, int> > &
         sift_keypoints_[i].reset(new pcl::PointCloud<PointT>);
         sift_normals_[i].reset(new pcl::PointCloud< pcl::Normal >);
 
-        std::vector<std::vector<float> > sift_descs;
+        LocalDescriptorMatrix sift_desc_matrix;
         estimator.setInputCloud(cloud);
         estimator.setIndices(indices);
-        estimator.compute(sift_descs);
+        estimator.compute(sift_desc_matrix);
+        std::vector<std::vector<float> > sift_descs (sift_desc_matrix.rows());
+        for(int k=0; k < sift_desc_matrix.rows(); k++)
+            sift_descs[k].assign( sift_desc_matrix.row(k).data(), sift_desc_matrix.row(k).data() + sift_desc_matrix.cols() );
         typename pcl::PointCloud< PointT >::Ptr sift_keys (new pcl::PointCloud<PointT>);
         std::vector<int> sift_kp_indices = estimator.getKeypointIndices();
         pcl::copyPointCloud( *cloud, sift_kp_indices, *sift_keys);
@@ -113,6 +113,18 @@ int main(int argc, char** argv)
   surfaceHeightSaliencyMap.setIndices(object_indices_in_the_hull);
   surfaceHeightSaliencyMap.setNormals(normals);
   surfaceHeightSaliencyMap.setModelCoefficients(coefficients);
+  surfaceHeightSaliencyMap.setHeightType(v4r::AM_DISTANCE);
+  
+  v4r::SurfaceHeightSaliencyMap surfaceTallSaliencyMap;
+  surfaceTallSaliencyMap.setWidth(image.cols);
+  surfaceTallSaliencyMap.setHeight(image.rows);
+  surfaceTallSaliencyMap.setCloud(cloud);
+  surfaceTallSaliencyMap.setIndices(object_indices_in_the_hull);
+  surfaceTallSaliencyMap.setNormals(normals);
+  surfaceTallSaliencyMap.setModelCoefficients(coefficients);
+  surfaceTallSaliencyMap.setHeightType(v4r::AM_TALL);
+  
+  relativeSurfaceOrientationMap.setOrientationType(v4r::AM_HORIZONTAL);
   
   printf("Normalization Type: ");
   switch(normalization_type)
@@ -121,18 +133,21 @@ int main(int argc, char** argv)
       printf("LIN \n");
       relativeSurfaceOrientationMap.setNormalizationType(v4r::NT_NONE);
       surfaceHeightSaliencyMap.setNormalizationType(v4r::NT_NONE);
+      surfaceTallSaliencyMap.setNormalizationType(v4r::NT_NONE);
       normalization_type = v4r::NT_NONE;
       break;
     case(1):
       printf("NMS \n");
       relativeSurfaceOrientationMap.setNormalizationType(v4r::NT_NONMAX);
       surfaceHeightSaliencyMap.setNormalizationType(v4r::NT_NONMAX);
+      surfaceTallSaliencyMap.setNormalizationType(v4r::NT_NONMAX);
       normalization_type = v4r::NT_NONMAX;
       break;
     case(2):
       printf("NLM \n");
       relativeSurfaceOrientationMap.setNormalizationType(v4r::NT_FRINTROP_NORM);
       surfaceHeightSaliencyMap.setNormalizationType(v4r::NT_FRINTROP_NORM);
+      surfaceTallSaliencyMap.setNormalizationType(v4r::NT_FRINTROP_NORM);
       normalization_type = v4r::NT_FRINTROP_NORM;
       break;
     default:
@@ -140,31 +155,21 @@ int main(int argc, char** argv)
       return(0);
   }
   
-  printf("[INFO]: Computing surface orientation map HORIZONTAL.\n");
-  relativeSurfaceOrientationMap.setOrientationType(v4r::AM_HORIZONTAL);
-  relativeSurfaceOrientationMap.calculate();
-  
-  if(!relativeSurfaceOrientationMap.getMap(maps.at(0)))
-  {
-    printf("[ERROR]: Computation failed.\n");
-  }
-  
-  printf("[INFO]: Computing surface distance map.\n");
-  surfaceHeightSaliencyMap.setHeightType(v4r::AM_DISTANCE);
-  surfaceHeightSaliencyMap.calculate();
-  
-  if(!surfaceHeightSaliencyMap.getMap(maps.at(1)))
-  {
-    printf("[ERROR]: Computation failed.\n");
-  }
+  // the maps are independent, so they are computed concurrently on one shared pyramid cache
+  std::vector<v4r::BaseMap*> saliencyMaps;
+  saliencyMaps.push_back(&relativeSurfaceOrientationMap);
+  saliencyMaps.push_back(&surfaceHeightSaliencyMap);
+  saliencyMaps.push_back(&surfaceTallSaliencyMap);
   
-  printf("[INFO]: Computing surface TALL map.\n");
-  surfaceHeightSaliencyMap.setHeightType(v4r::AM_TALL);
-  surfaceHeightSaliencyMap.calculate();
+  printf("[INFO]: Computing surface orientation map HORIZONTAL, surface distance map and surface TALL map.\n");
+  v4r::CalculateMaps(saliencyMaps);
   
-  if(!surfaceHeightSaliencyMap.getMap(maps.at(2)))
+  for(unsigned int i = 0; i < saliencyMaps.size(); ++i)
   {
-    printf("[ERROR]: Computation failed.\n");
+    if(!saliencyMaps.at(i)->getMap(maps.at(i)))
+    {
+      printf("[ERROR]: Computation failed.\n");
+    }
   }
   
   
@@ -185,7 +185,7 @@ main (int argc, char ** argv)
                     pcl::ScopeTime t("SIFT Keypoint extraction");
                     typename v4r::SIFTLocalEstimation<PointT>::Ptr sift_estimator (new v4r::SIFTLocalEstimation<PointT>);
                     sift_estimator->setInputCloud( cloud );
-                    std::vector<std::vector<float> > signatures_foo;
+                    v4r::LocalDescriptorMatrix signatures_foo;
                     sift_estimator->compute( signatures_foo );
                     kp_indices = sift_estimator->getKeypointIndices();
                 }